@@ -26,6 +26,11 @@
 #include <falcon/gentree.h>
 #include <falcon/gencode.h>
 #include <falcon/signals.h>
+#include <falcon/profiler.h>
+#include <falcon/vmcounters.h>
+#include <falcon/heapprofiler.h>
+#include <falcon/vfs_archive.h>
+#include <falcon/compilecache.h>
 #include <iostream>
 #include <stdio.h>
 
@@ -409,6 +414,7 @@ void AppFalcon::generateAssembly()
    ml.compileTemplate( m_options.parse_ftd );
    ml.saveModules( false );
    ml.alwaysRecomp( true );
+   ml.optLevel( m_options.opt_level );
 
    // will throw Error* on failure
    Module* mod = loadInput( ml );
@@ -447,6 +453,7 @@ void AppFalcon::generateTree()
    Compiler comp;
    // the load path is not relevant, as we load by file name or stream
    // apply options
+   comp.optLevel( m_options.opt_level );
    Stream* in = 0;
 
    // will throw Error* on failure
@@ -508,6 +515,7 @@ void AppFalcon::buildModule()
    ml.compileTemplate( m_options.parse_ftd );
    ml.saveModules( false );
    ml.alwaysRecomp( true );
+   ml.optLevel( m_options.opt_level );
 
    // will throw Error* on failure
    Module* mod = loadInput( ml );
@@ -522,6 +530,7 @@ void AppFalcon::buildModule()
 
       // Ok, we have the output stream.
       GenCode gcode(mod);
+      gcode.peephole( m_options.opt_level > 1 );
       gcode.generate( ml.compiler().sourceTree() );
       if ( ! mod->save( out ) )
          throw String( "can't write on output stream." );
@@ -580,18 +589,51 @@ void AppFalcon::prepareLoader( ModuleLoader &ml )
 
    // should we forcefully consider input as ftd?
    modLoader->compileTemplate ( m_options.parse_ftd );
+   modLoader->optLevel ( m_options.opt_level );
 
    Engine::setSearchPath( modLoader->getSearchPath() );
 }
 
 
+void AppFalcon::mountArchive()
+{
+   int64 fsError;
+   VFSArchive* archive = VFSArchive::load( m_options.input, "pack", fsError );
+   if ( archive == 0 )
+   {
+      String msg = "can't open the archive '" + m_options.input + "'";
+      if ( fsError != 0 )
+      {
+         String desc;
+         Sys::_describeError( fsError, desc );
+         msg += ": " + desc;
+      }
+      throw msg;
+   }
+
+   if ( archive->mainModule() == "" || ! Engine::addVFS( "pack", archive ) )
+   {
+      delete archive;
+      throw String( "the archive '" + m_options.input + "' can't be run" );
+   }
+
+   // run the main module; its directory, the archive root, goes in the load path.
+   m_options.input = "pack:///" + archive->mainModule();
+}
+
+
 void AppFalcon::runModule()
 {
+   // a packed application is run from the archive.
+   if ( m_options.input.endsWith( ".fpk" ) )
+      mountArchive();
+
    ModuleLoader ml;
    prepareLoader( ml );
 
    // Create the runtime using the given module loader.
    Runtime runtime( &ml );
+   runtime.loadThreads( m_options.load_threads );
 
    // now that we have the main module, inject other requested modules
    ListElement *pliter = m_options.preloaded.begin();
@@ -671,18 +713,73 @@ void AppFalcon::runModule()
    fassert ( script_path != 0 );
    *script_path = new CoreString ( mainMod->path() );
 
+   if ( m_options.prof_file != "" || m_options.prof_table != "" )
+      vmachine->profiler( new Profiler( m_options.prof_rate ) );
+   if ( m_options.counters_file != "" )
+      vmachine->counters( new VMCounters );
+
    // Link the runtime in the VM.
    // We'll be running the modules as we link them in.
    vmachine->launchAtLink( true );
-   if ( vmachine->link( &runtime ) )
+   try
    {
-      // Broadcast OS signals in this VM.
-      //vmachine->becomeSignalTarget();
+      if ( vmachine->link( &runtime ) )
+      {
+         // Broadcast OS signals in this VM.
+         //vmachine->becomeSignalTarget();
 
-      vmachine->launch();
+         vmachine->launch();
 
-      if ( vmachine->regA().isInteger() )
-         exitval( ( int32 ) vmachine->regA().asInteger() );
+         if ( vmachine->regA().isInteger() )
+            exitval( ( int32 ) vmachine->regA().asInteger() );
+      }
+   }
+   catch( Error* )
+   {
+      // the samples up to the error are still worth a look.
+      try {
+         writeProfile( vmachine.vm() );
+      }
+      catch( const String& )
+      {
+         // the script error is more relevant.
+      }
+      throw;
+   }
+
+   writeProfile( vmachine.vm() );
+}
+
+
+void AppFalcon::writeProfile( VMachine* vm )
+{
+   VMCounters* cnt = vm->counters();
+   if ( cnt != 0 && m_options.counters_file != "" )
+   {
+      FileStream out;
+      if ( ! out.create( m_options.counters_file, BaseFileStream::e_aUserRead | BaseFileStream::e_aUserWrite )
+         || ! cnt->writeJSON( &out ) )
+         throw String( "can't write counters to '"+ m_options.counters_file +"'" );
+   }
+
+   Profiler* prof = vm->profiler();
+   if ( prof == 0 )
+      return;
+
+   if ( m_options.prof_file != "" )
+   {
+      FileStream out;
+      if ( ! out.create( m_options.prof_file, BaseFileStream::e_aUserRead | BaseFileStream::e_aUserWrite )
+         || ! prof->writeCollapsed( &out ) )
+         throw String( "can't write profile to '"+ m_options.prof_file +"'" );
+   }
+
+   if ( m_options.prof_table != "" )
+   {
+      FileStream out;
+      if ( ! out.create( m_options.prof_table, BaseFileStream::e_aUserRead | BaseFileStream::e_aUserWrite )
+         || ! prof->writeTable( &out ) )
+         throw String( "can't write profile to '"+ m_options.prof_table +"'" );
    }
 }
 
@@ -692,22 +789,81 @@ void AppFalcon::run()
    size_t memory = gcMemAllocated();
    int32 items = memPool->allocatedItems();
 
-   // determine the operation mode
-   if( m_options.compile_tltable )
-      compileTLTable();
-   else if ( m_options.assemble_out )
-      generateAssembly();
-   else if ( m_options.tree_out )
-      generateTree();
-   else if ( m_options.compile_only )
-      buildModule();
-   else if ( m_options.interactive )
-      makeInteractive();
-   else
-      runModule();
+   // the GC thread writes its statistics while we work.
+   FileStream gcLog;
+   if ( m_options.gc_log != "" )
+   {
+      if ( ! gcLog.create( m_options.gc_log, BaseFileStream::e_aUserRead | BaseFileStream::e_aUserWrite ) )
+         throw String( "can't write GC statistics to '"+ m_options.gc_log +"'" );
+      memPool->statsLog( &gcLog );
+   }
+
+   if ( m_options.heap_prof != "" )
+      HeapProfiler::install()->start();
+
+   String cacheDir = m_options.compile_cache;
+   if ( cacheDir == "" )
+      Sys::_getEnv( "FALCON_COMPILE_CACHE", cacheDir );
+   if ( cacheDir != "" )
+   {
+      int64 cacheSize = m_options.cache_size > 0 ?
+            ((int64) m_options.cache_size) * 1024 * 1024 : (int64) CompileCache::default_size;
+      Engine::setCompileCache( new CompileCache( cacheDir, cacheSize ) );
+   }
+
+   try
+   {
+      // determine the operation mode
+      if( m_options.compile_tltable )
+         compileTLTable();
+      else if ( m_options.assemble_out )
+         generateAssembly();
+      else if ( m_options.tree_out )
+         generateTree();
+      else if ( m_options.compile_only )
+         buildModule();
+      else if ( m_options.interactive )
+         makeInteractive();
+      else
+         runModule();
+   }
+   catch( ... )
+   {
+      memPool->statsLog( 0 );
+      throw;
+   }
 
    memPool->performGC();
 
+   if ( m_options.gc_log != "" )
+   {
+      memPool->statsLog( 0 );
+
+      GCStats stats;
+      String line;
+      memPool->stats( stats );
+      stats.describe( line );
+      gcLog.writeString( line + "\n" );
+   }
+
+   if ( m_options.heap_prof != "" )
+   {
+      // the census of the last collection reports what the script left alive.
+      heapProfiler->stop();
+      FileStream out;
+      if ( ! out.create( m_options.heap_prof, BaseFileStream::e_aUserRead | BaseFileStream::e_aUserWrite )
+         || ! heapProfiler->writeSnapshot( &out ) )
+         throw String( "can't write heap profile to '"+ m_options.heap_prof +"'" );
+   }
+
+   if ( m_options.cache_stats && Engine::getCompileCache() != 0 )
+   {
+      String line;
+      Engine::getCompileCache()->describe( line );
+      AutoCString cline( line );
+      cerr << cline.c_str() << endl;
+   }
+
    if ( m_options.check_memory )
    {
       // be sure we have reclaimed all what's possible to reclaim.
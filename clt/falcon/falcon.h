@@ -46,6 +46,7 @@ class AppFalcon
    void readyStreams();
 
    Stream* openOutputStream( const String &ext );
+   void writeProfile( VMachine* vm );
 
 public:
    /** Prepares the application.
@@ -76,6 +77,7 @@ public:
    void runModule();
    void makeInteractive();
    void prepareLoader( ModuleLoader &ml );
+   void mountArchive();
 
 
    void terminate();
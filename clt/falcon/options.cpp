@@ -19,6 +19,7 @@
 
 #include "options.h"
 #include <iostream>
+#include <stdlib.h>
 
 using namespace std;
 using namespace Falcon;
@@ -46,12 +47,17 @@ FalconOptions::FalconOptions():
    recompile_on_load( true ),
    save_modules( true ),
    wait_after( false ),
+   cache_stats( false ),
    parse_ftd( false ),
 
    compile_tltable( false ),
    interactive( false ),
    ignore_syspath( false ),
-   errOnStdout(false)
+   errOnStdout(false),
+   opt_level( 0 ),
+   prof_rate( 100 ),
+   cache_size( 0 ),
+   load_threads( 1 )
 {}
 
 
@@ -84,7 +90,12 @@ void FalconOptions::usage( bool deep )
       << "   -E <enc>    Source files are in <enc> encoding (overrides -e)" << endl
       << "   -f          force recompilation of modules even when .fam are found" << endl
       << "   -m          do NOT compile in memory (use temporary files)" << endl
+      << "   -O[n]       optimize; 1: constant folding and dead code, 2 (default): also pcode" << endl
       << "   -T          consider given [module] as .ftd (template document)" << endl
+      << "   --cache <dir>       keep the compiled modules in the cache <dir> (or FALCON_COMPILE_CACHE)" << endl
+      << "   --cache-size <mb>   size limit of the compile cache (default 64)" << endl
+      << "   --cache-stats       print the compile cache statistics at exit" << endl
+      << "   --load-threads <n>  compile the required modules with <n> threads (0: one per CPU)" << endl
       << endl
       << "Run options (r_opts):" << endl
       << "   -C          check for memory allocation correctness" << endl
@@ -98,6 +109,12 @@ void FalconOptions::usage( bool deep )
       << "   -p <module> preload (pump in) given module" << endl
       << "   -P          ignore system PATH (and FALCON_LOAD_PATH envvar)" << endl
       << "   -r          do NOT recompile sources (ignore sources)" << endl
+      << "   --prof <file>       sample the running script; write collapsed stacks to <file>" << endl
+      << "   --prof-table <file> sample the running script; write per-function times to <file>" << endl
+      << "   --prof-rate <n>     take <n> profiler samples per second (default 100)" << endl
+      << "   --counters <file>   count opcodes and calls; write them as JSON to <file>" << endl
+      << "   --gc-log <file>     write the garbage collector statistics to <file> every second" << endl
+      << "   --heap-prof <file>  sample allocations by site; write a heap snapshot to <file>" << endl
       << endl
       << "General options:" << endl
       << "   -h/-?       display usage" << endl
@@ -110,6 +127,8 @@ void FalconOptions::usage( bool deep )
       << "Paths must be in falcon file name format: directory separators must be slashes [/] and" << endl
       << "multiple entries must be entered separed by a semicolon (';')" << endl
       << "File names may be set to '-' meaning standard input or output (depending on the option)" << endl
+      << "A packed application archive ('.fpk', made by falpack -a) is served as 'pack:///';" << endl
+      << "running it runs its main module" << endl
       << endl;
    }
    else
@@ -210,6 +229,10 @@ void FalconOptions::parse( int argc, char **argv, int &script_pos )
             case 'm': comp_memory = false; break;
             case 'M': save_modules = false; break;
 
+            case 'O':
+               opt_level = op[2] == 0 ? 2 : atoi( op + 2 );
+               break;
+
             case 'o':
                if ( op[2] == 0 && i + 1< argc )
                   output = argv[++i];
@@ -243,6 +266,62 @@ void FalconOptions::parse( int argc, char **argv, int &script_pos )
                   preloaded.pushBack( new String( "cgi" ) );
                   break;
                }
+               else if( String( op+2 ) == "prof" && i + 1 < argc )
+               {
+                  prof_file = argv[++i];
+                  break;
+               }
+               else if( String( op+2 ) == "prof-table" && i + 1 < argc )
+               {
+                  prof_table = argv[++i];
+                  break;
+               }
+               else if( String( op+2 ) == "counters" && i + 1 < argc )
+               {
+                  counters_file = argv[++i];
+                  break;
+               }
+               else if( String( op+2 ) == "gc-log" && i + 1 < argc )
+               {
+                  gc_log = argv[++i];
+                  break;
+               }
+               else if( String( op+2 ) == "heap-prof" && i + 1 < argc )
+               {
+                  heap_prof = argv[++i];
+                  break;
+               }
+               else if( String( op+2 ) == "cache" && i + 1 < argc )
+               {
+                  compile_cache = argv[++i];
+                  break;
+               }
+               else if( String( op+2 ) == "cache-size" && i + 1 < argc )
+               {
+                  cache_size = atoi( argv[++i] );
+                  if ( cache_size <= 0 )
+                     throw String( "invalid compile cache size" );
+                  break;
+               }
+               else if( String( op+2 ) == "cache-stats" )
+               {
+                  cache_stats = true;
+                  break;
+               }
+               else if( String( op+2 ) == "load-threads" && i + 1 < argc )
+               {
+                  load_threads = atoi( argv[++i] );
+                  if ( load_threads < 0 )
+                     throw String( "invalid number of load threads" );
+                  break;
+               }
+               else if( String( op+2 ) == "prof-rate" && i + 1 < argc )
+               {
+                  prof_rate = atoi( argv[++i] );
+                  if ( prof_rate <= 0 )
+                     throw String( "invalid profiler rate" );
+                  break;
+               }
 
             // else just fallthrough
 
@@ -46,6 +46,18 @@ public:
 #ifndef NDEBUG
    String trace_file;
 #endif
+   /** Collapsed stacks output of the sampling profiler. */
+   String prof_file;
+   /** Per-function table output of the sampling profiler. */
+   String prof_table;
+   /** JSON output of the VM execution counters. */
+   String counters_file;
+   /** Periodic log of the garbage collector statistics. */
+   String gc_log;
+   /** Snapshot of the heap profiler, written at the end of the run. */
+   String heap_prof;
+   /** Directory of the persistent compile cache. */
+   String compile_cache;
 
    List preloaded;
    List directives;
@@ -63,6 +75,7 @@ public:
    bool recompile_on_load;
    bool save_modules;
    bool wait_after;
+   bool cache_stats;
    bool parse_ftd;
 
    bool compile_tltable;
@@ -72,6 +85,17 @@ public:
 
    bool errOnStdout;
 
+   /** Optimization level (0: none, 1: syntactic tree, 2: tree and pcode). */
+   int opt_level;
+
+   /** Profiler samples per second. */
+   int prof_rate;
+
+   /** Size limit of the compile cache, in megabytes (0 for the default). */
+   int cache_size;
+
+   /** Threads loading the dependencies (0: one per processor). */
+   int load_threads;
 
    FalconOptions();
 
@@ -15,6 +15,7 @@
 
 #include <falcon/engine.h>
 #include <falcon/sys.h>
+#include <falcon/vfs_archive.h>
 #include "options.h"
 #include "utils.h"
 #include "falpack_sys.h"
@@ -46,6 +47,7 @@ static void usage()
    stdOut->writeString( "Usage: falpack [options] <main_script>\n" );
    stdOut->writeString( "\n" );
    stdOut->writeString( "Options:\n" );
+   stdOut->writeString( "   -a          Pack modules and resources in a single archive\n" );
    stdOut->writeString( "   -b <module> Blacklists this module (by module name)\n" );
    stdOut->writeString( "   --bin <dir> Specify directory where falcon binary resides\n" );
    stdOut->writeString( "   -e <enc>    Source files encoding\n" );
@@ -580,6 +582,107 @@ bool transferModules( Options &options, const String& mainScript )
 }
 
 
+static bool isPackable( const String& fname )
+{
+   // binary modules and dynlibs (possibly versioned) must stay on disk.
+   String ext = String( "." ) + DllLoader::dllExt();
+   return ! fname.endsWith( ext, true ) && fname.find( ext + "." ) == String::npos;
+}
+
+
+/** Moves the packable files in a directory (and its subdirectories) into the archive. */
+static bool archiveDir( ArchiveWriter& writer, const String& root, const String& dir,
+      const String& archiveName, const String& systemRoot )
+{
+   String path = dir == "" ? root : root + "/" + dir;
+   int32 fsError;
+   DirEntry* entry = Sys::fal_openDir( path, fsError );
+   if( entry == 0 )
+   {
+      error( "Can't open directory " + path );
+      return false;
+   }
+
+   bool bOk = true;
+   String fname;
+   while( bOk && entry->read( fname ) )
+   {
+      if( fname == ".." || fname == "." )
+      {
+         continue;
+      }
+
+      String name = dir == "" ? fname : dir + "/" + fname;
+      FileStat fs;
+      if ( ! Sys::fal_stats( root + "/" + name, fs ) )
+      {
+         continue;
+      }
+
+      if ( fs.m_type == FileStat::t_dir )
+      {
+         bOk = archiveDir( writer, root, name, archiveName, systemRoot );
+      }
+      else if ( fs.m_type == FileStat::t_normal && isPackable( fname ) && name != archiveName )
+      {
+         message( "Archiving " + name );
+         FileStream in;
+         if ( ! in.open( root + "/" + name, BaseFileStream::e_omReadOnly )
+              || ! writer.add( name, &in ) )
+         {
+            error( "Can't store \"" + name + "\" in the archive" );
+            bOk = false;
+         }
+         in.close();
+
+         if( bOk && ! Sys::fal_unlink( root + "/" + name, fsError ) )
+         {
+            warning( "Can't remove \"" + root + "/" + name + "\"" );
+         }
+      }
+   }
+
+   Sys::fal_closeDir( entry );
+
+   // directories left empty are not needed anymore; the system files
+   // are copied in the system directory after the archive is done.
+   if( bOk && dir != "" && dir != systemRoot )
+   {
+      Sys::fal_rmdir( path, fsError );
+   }
+
+   return bOk;
+}
+
+
+bool archiveModules( Options &options )
+{
+   Path mainScript( options.m_sMainScript );
+   String archivePath = options.m_sTargetDir + "/" + mainScript.getFile() + ".fpk";
+   message( "Creating archive \"" + archivePath + "\"" );
+
+   FileStream out;
+   if ( ! out.create( archivePath, (BaseFileStream::t_attributes) 0644 ) )
+   {
+      error( "Can't create \"" + archivePath + "\"" );
+      return false;
+   }
+
+   // the main script is stored at top level.
+   ArchiveWriter writer( &out );
+   bool bOk = archiveDir( writer, options.m_sTargetDir, "", mainScript.getFile() + ".fpk",
+         options.m_sSystemRoot );
+   if ( bOk && ! writer.close( mainScript.getFile() ) )
+   {
+      error( "Can't write \"" + archivePath + "\"" );
+      bOk = false;
+   }
+
+   out.close();
+   return bOk;
+}
+
+
 int main( int argc, char *argv[] )
 {
    Falcon::GetSystemEncoding( io_encoding );
@@ -645,6 +748,11 @@ int main( int argc, char *argv[] )
    {
       bResult = transferModules( options, options.m_sMainScript );
 
+      if ( bResult && options.m_bArchive )
+      {
+         bResult = archiveModules( options );
+      }
+
       if ( bResult )
       {
          bResult = transferSysFiles( options, options.m_bNoSysFile );
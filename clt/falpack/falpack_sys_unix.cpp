@@ -92,12 +92,16 @@ bool transferSysFiles( Options &options, bool bJustScript )
    {
       startScript.writeString( "LD_LIBRARY_PATH=\"" + options.m_sSystemRoot + "\" \\\n" );
       startScript.writeString( "   \""+options.m_sSystemRoot + "/" + binpath.getFilename() + "\" \\\n" );
-      startScript.writeString( "    -L \"" + options.m_sSystemRoot +";.\" \\\n" );
+      // modules packed in the archive are searched before the binary ones.
+      startScript.writeString( "    -L \"" +
+            ( options.m_bArchive ? "pack:///" + options.m_sSystemRoot + ";" : String("") ) +
+            options.m_sSystemRoot +";.\" \\\n" );
    }
 
    // we need to discard the extension, so that the runner decides how to run the program.
    Path scriptName( options.m_sMainScript );
-   startScript.writeString( "    \"" + scriptName.getFile() +"\" $*" );
+   startScript.writeString( "    \"" + scriptName.getFile() +
+         ( options.m_bArchive ? ".fpk" : "" ) + "\" $*" );
 
    startScript.flush();
 
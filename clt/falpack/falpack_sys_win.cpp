@@ -166,12 +166,16 @@ bool transferSysFiles( Options &options, bool bJustScript )
    else
    {
       startScript.writeString( "   \""+options.m_sSystemRoot + "\\" + binpath.getFilename() + "\" " );
-      startScript.writeString( "    -L \"" + options.m_sSystemRoot +";.\" " );
+      // modules packed in the archive are searched before the binary ones.
+      startScript.writeString( "    -L \"" +
+            ( options.m_bArchive ? "pack:///" + options.m_sSystemRoot + ";" : String("") ) +
+            options.m_sSystemRoot +";.\" " );
    }
 
    // we need to discard the extension, so that the runner decides how to run the program.
    Path scriptName( options.m_sMainScript );
-   startScript.writeString( " \"" + scriptName.getFile() +"\" \"%*\"\r\n" );
+   startScript.writeString( " \"" + scriptName.getFile() +
+         ( options.m_bArchive ? ".fpk" : "" ) + "\" \"%*\"\r\n" );
    
    startScript.writeString( "cd %OLD_DIR%\r\n" );
    startScript.flush();
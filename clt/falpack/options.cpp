@@ -25,6 +25,7 @@ Options::Options():
       m_bPackFam( false ),
       m_bStripSources( false ),
       m_bNoSysFile( false ),
+      m_bArchive( false ),
       m_sSystemRoot( "_system" ),
       m_bHelp( false ),
       m_bVersion( false ),
@@ -76,6 +77,7 @@ bool Options::parse( int argc, char* const argv[] )
       {
          switch( word[1] )
          {
+         case 'a': m_bArchive = true; break;
          case 'M': m_bPackFam = true; break;
          case 's': m_bStripSources = true; break;
          case 'S': m_bNoSysFile = true; break;
@@ -28,6 +28,7 @@ public:
    bool m_bPackFam;
    bool m_bStripSources;
    bool m_bNoSysFile;
+   bool m_bArchive;
    String m_sRunner;
    String m_sTargetDir;
    String m_sLoadPath;
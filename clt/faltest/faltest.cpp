@@ -72,6 +72,7 @@ String opt_subcat;
 String opt_path;
 String opt_libpath;
 int opt_tf;
+int opt_optlevel;
 Stream *output;
 
 int passedCount;
@@ -142,6 +143,7 @@ static void usage()
    stdOut->writeString( "   -M          Check for memory allocation correctness.\n" );
    stdOut->writeString( "   -f <n>      set time factor to N for benchmarks\n" );
    stdOut->writeString( "   -o <file>   Output report here (defaults stdout)\n" );
+   stdOut->writeString( "   -O[n]       optimize test scripts (1: tree only, 2: also pcode - default)\n" );
    stdOut->writeString( "   -s          perform module serialization test\n" );
    stdOut->writeString( "   -S          compile via assembly\n" );
    stdOut->writeString( "   -t          record and display timings\n" );
@@ -167,6 +169,7 @@ void parse_options( int argc, char *argv[] )
    opt_timings = false;
    opt_inTimings = false;
    opt_tf = 1;
+   opt_optlevel = 0;
 
    // option decoding
    for ( int i = 1; i < argc; i++ )
@@ -252,6 +255,7 @@ void parse_options( int argc, char *argv[] )
                }
             break;
 
+            case 'O': opt_optlevel = op[2] != 0 ? atoi( op + 2 ) : 2; break;
             case 's': opt_serialize = true; break;
             case 'S': opt_compasm = true; break;
             case 't': opt_timings = true; break;
@@ -563,6 +567,7 @@ bool testScript( ScriptData *script,
 
    Compiler compiler( scriptModule, source );
    compiler.searchPath( Engine::getSearchPath() );
+   compiler.optLevel( opt_optlevel );
 
    if ( opt_timings )
       compTime = Sys::_seconds();
@@ -586,6 +591,7 @@ bool testScript( ScriptData *script,
 
    // now compile the code.
    GenCode gc( compiler.module() );
+   gc.peephole( opt_optlevel > 1 );
    if ( opt_timings )
       genTime = Sys::_seconds();
    gc.generate( compiler.sourceTree() );
@@ -622,6 +628,9 @@ bool testScript( ScriptData *script,
 
    //---------------------------------
    // 2. link
+   if ( opt_timings )
+      linkTime = Sys::_seconds();
+
    VMachineWrapper vmachine;
 
    // so we can link them
@@ -646,12 +655,8 @@ bool testScript( ScriptData *script,
    // we can abandon our reference to the script module
    scriptModule->decref();
 
-   //---------------------------------
-   // 3. execute
    TestSuite::setSuccess( true );
    TestSuite::setTimeFactor( opt_tf );
-   if ( opt_timings )
-         execTime = Sys::_seconds();
 
    // inject args and script name
    Item *sname =vmachine->findGlobalItem( "scriptName" );
@@ -672,7 +677,12 @@ bool testScript( ScriptData *script,
    }
 
    if ( opt_timings )
-      linkTime = Sys::_seconds();
+      linkTime = Sys::_seconds() - linkTime;
+
+   //---------------------------------
+   // 3. execute
+   if ( opt_timings )
+      execTime = Sys::_seconds();
 
    // Become target of the OS signals.
    // vmachine->becomeSignalTarget();
@@ -921,6 +931,7 @@ int main( int argc, char *argv[] )
    modloader->alwaysRecomp( true );
    modloader->saveModules( false );
    modloader->compileInMemory( opt_compmem );
+   modloader->optLevel( opt_optlevel );
    modloader->sourceEncoding( "utf-8" );
 
    int32 error;
@@ -1026,9 +1037,9 @@ int main( int argc, char *argv[] )
          if ( opt_verbose ) {
             output->writeString( "Recorded timings: \n" );
             String temp = "Total compilation time: ";
-            temp.writeNumber( total_time_generate, TIME_PRINT_FMT );
+            temp.writeNumber( total_time_compile, TIME_PRINT_FMT );
             temp += " (mean: ";
-            temp.writeNumber( total_time_generate / (passedCount + failedCount), TIME_PRINT_FMT );
+            temp.writeNumber( total_time_compile / (passedCount + failedCount), TIME_PRINT_FMT );
             temp += ")\n";
 
             temp += "Total generation time: ";
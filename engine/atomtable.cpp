@@ -0,0 +1,210 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: atomtable.cpp
+
+   Process-wide table of interned strings.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:08:27 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/atomtable.h>
+#include <falcon/string.h>
+#include <falcon/memory.h>
+#include <falcon/basealloc.h>
+#include <falcon/mt.h>
+
+#include <string.h>
+
+#define ATOMTABLE_INITIAL_BUCKETS  256
+
+namespace Falcon {
+
+namespace {
+
+class AtomEntry: public BaseAlloc
+{
+public:
+   // must stay the first member; atoms are given out as pointers to it.
+   String m_str;
+   uint32 m_hash;
+   AtomEntry *m_next;
+
+   AtomEntry( const String &str, uint32 hash ):
+      m_str( str ),
+      m_hash( hash ),
+      m_next( 0 )
+   {
+      // atoms live as long as the engine; they are not part of the GC memory.
+      m_str.bufferize();
+      gcMemUnaccount( sizeof( AtomEntry ) + m_str.allocated() );
+   }
+
+   ~AtomEntry()
+   {
+      gcMemAccount( sizeof( AtomEntry ) + m_str.allocated() );
+   }
+};
+
+Mutex s_mtx;
+AtomEntry **s_buckets = 0;
+uint32 s_bucketCount = 0;
+uint32 s_count = 0;
+
+template< class _T >
+inline uint32 s_hashChars( const _T *chars, uint32 len )
+{
+   // FNV-1a on the character values
+   uint32 h = 2166136261U;
+   for ( uint32 i = 0; i < len; ++i )
+   {
+      h ^= (uint32) chars[i];
+      h *= 16777619U;
+   }
+   return h;
+}
+
+AtomEntry *s_findEntry( const String &str, uint32 h )
+{
+   if ( s_buckets == 0 )
+      return 0;
+
+   AtomEntry *e = s_buckets[ h & (s_bucketCount-1) ];
+   while( e != 0 )
+   {
+      if ( e->m_hash == h && e->m_str == str )
+         return e;
+      e = e->m_next;
+   }
+
+   return 0;
+}
+
+void s_freeBuckets()
+{
+   if ( s_buckets != 0 )
+   {
+      gcMemAccount( sizeof( AtomEntry* ) * s_bucketCount );
+      memFree( s_buckets );
+   }
+}
+
+void s_grow()
+{
+   uint32 newCount = s_bucketCount == 0 ? ATOMTABLE_INITIAL_BUCKETS : s_bucketCount * 2;
+   AtomEntry **newBuckets = (AtomEntry **) memAlloc( sizeof( AtomEntry* ) * newCount );
+   gcMemUnaccount( sizeof( AtomEntry* ) * newCount );
+   memset( newBuckets, 0, sizeof( AtomEntry* ) * newCount );
+
+   for ( uint32 i = 0; i < s_bucketCount; ++i )
+   {
+      AtomEntry *e = s_buckets[i];
+      while( e != 0 )
+      {
+         AtomEntry *next = e->m_next;
+         AtomEntry *&head = newBuckets[ e->m_hash & (newCount-1) ];
+         e->m_next = head;
+         head = e;
+         e = next;
+      }
+   }
+
+   s_freeBuckets();
+   s_buckets = newBuckets;
+   s_bucketCount = newCount;
+}
+
+}
+
+
+uint32 AtomTable::hash( const String &str )
+{
+   const byte *storage = str.getRawStorage();
+   switch( str.manipulator()->charSize() )
+   {
+      case 1: return s_hashChars( storage, str.size() );
+      case 2: return s_hashChars( (const uint16 *) storage, str.size() / 2 );
+      default: return s_hashChars( (const uint32 *) storage, str.size() / 4 );
+   }
+}
+
+
+const String *AtomTable::intern( const String &str )
+{
+   uint32 h = hash( str );
+
+   s_mtx.lock();
+   AtomEntry *e = s_findEntry( str, h );
+   if ( e == 0 )
+   {
+      if ( s_count >= s_bucketCount )
+         s_grow();
+
+      e = new AtomEntry( str, h );
+      AtomEntry *&head = s_buckets[ h & (s_bucketCount-1) ];
+      e->m_next = head;
+      head = e;
+      ++s_count;
+   }
+   s_mtx.unlock();
+
+   return &e->m_str;
+}
+
+
+const String *AtomTable::find( const String &str )
+{
+   uint32 h = hash( str );
+
+   s_mtx.lock();
+   AtomEntry *e = s_findEntry( str, h );
+   s_mtx.unlock();
+
+   return e == 0 ? 0 : &e->m_str;
+}
+
+
+uint32 AtomTable::atomHash( const String *atom )
+{
+   return reinterpret_cast<const AtomEntry *>( atom )->m_hash;
+}
+
+
+uint32 AtomTable::count()
+{
+   s_mtx.lock();
+   uint32 c = s_count;
+   s_mtx.unlock();
+   return c;
+}
+
+
+void AtomTable::clear()
+{
+   s_mtx.lock();
+   for ( uint32 i = 0; i < s_bucketCount; ++i )
+   {
+      AtomEntry *e = s_buckets[i];
+      while( e != 0 )
+      {
+         AtomEntry *next = e->m_next;
+         delete e;
+         e = next;
+      }
+   }
+
+   s_freeBuckets();
+   s_buckets = 0;
+   s_bucketCount = 0;
+   s_count = 0;
+   s_mtx.unlock();
+}
+
+}
+
+/* end of atomtable.cpp */
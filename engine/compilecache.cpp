@@ -0,0 +1,265 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: compilecache.cpp
+
+   Persistent cache of compiled modules.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:37:44 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Persistent cache of compiled modules.
+*/
+
+#include <falcon/compilecache.h>
+#include <falcon/module.h>
+#include <falcon/fstream.h>
+#include <falcon/streambuffer.h>
+#include <falcon/filemap.h>
+#include <falcon/mapstream.h>
+#include <falcon/dir_sys.h>
+#include <falcon/timestamp.h>
+#include <falcon/autocstring.h>
+#include <falcon/genericmap.h>
+#include <falcon/traits.h>
+#include <falcon/pcodes.h>
+#include <falcon/sys.h>
+
+#include <stdio.h>
+
+#define CACHE_ENTRY_EXT ".fam"
+
+namespace Falcon {
+
+static uint64 s_fnv( uint64 hash, const byte *data, uint32 size )
+{
+   for ( uint32 i = 0; i < size; ++i )
+   {
+      hash ^= data[i];
+      hash *= 0x100000001b3ULL;
+   }
+   return hash;
+}
+
+
+CompileCache::CompileCache( const String &path, int64 maxSize ):
+   m_path( path ),
+   m_maxSize( maxSize ),
+   m_size( -1 ),
+   m_tempId( 0 )
+{
+}
+
+
+String CompileCache::key( const byte *source, uint32 size, const String &settings )
+{
+   // The settings are hashed along with the engine and the module format versions.
+   String desc = settings;
+   desc += ";engine=";
+   desc.writeNumber( (int64) FALCON_VERSION_NUM );
+   desc += ";pcode=";
+   desc.writeNumber( (int64) ( FALCON_PCODE_VERSION << 8 | FALCON_PCODE_MINOR ) );
+   desc += ";size=";
+   desc.writeNumber( (int64) size );
+   AutoCString cdesc( desc );
+
+   String key;
+   key.writeNumberHex( s_fnv( 0xcbf29ce484222325ULL, source, size ), false, 16 );
+   key.writeNumberHex( s_fnv( 0xcbf29ce484222325ULL, (const byte *) cdesc.c_str(), cdesc.length() ), false, 16 );
+   return key;
+}
+
+
+String CompileCache::entryPath( const String &key ) const
+{
+   return m_path + "/" + key + CACHE_ENTRY_EXT;
+}
+
+
+Stream *CompileCache::find( const String &key )
+{
+   String path = entryPath( key );
+   int64 fsError;
+   FileMap *fmap = FileMap::map( path, false, fsError );
+
+   m_mtx.lock();
+   if ( fmap == 0 )
+      ++m_stats.m_misses;
+   else
+      ++m_stats.m_hits;
+   m_mtx.unlock();
+
+   if ( fmap == 0 )
+      return 0;
+
+   // a used entry is the most recent one.
+   Sys::fal_touch( path );
+
+   Stream *in = new MapStream( fmap );
+   fmap->decref();
+   return in;
+}
+
+
+bool CompileCache::store( const String &key, const Module *mod )
+{
+   int32 fsError;
+   Sys::fal_mkdir( m_path, fsError, true );
+
+   // write a private file, then give it its final name at once.
+   m_mtx.lock();
+   uint32 tempId = ++m_tempId;
+   m_mtx.unlock();
+
+   String temp = m_path + "/" + key + ".";
+   temp.writeNumber( Sys::_getpid() );
+   temp += ".";
+   temp.writeNumber( (int64) tempId );
+   temp += ".tmp";
+
+   FileStream *out = new FileStream;
+   bool bOk = out->create( temp, BaseFileStream::e_aUserRead | BaseFileStream::e_aUserWrite
+         | BaseFileStream::e_aGroupRead | BaseFileStream::e_aOtherRead );
+   int64 size = 0;
+   if ( bOk )
+   {
+      StreamBuffer buffered( out );
+      bOk = mod->save( &buffered ) && buffered.flush();
+      size = buffered.tell();
+      buffered.close();
+   }
+   else
+      delete out;
+
+   // another process may have stored the same entry meanwhile; that's fine.
+   if ( bOk && ! Sys::fal_move( temp, entryPath( key ), fsError ) )
+   {
+      FileStat fs;
+      bOk = Sys::fal_stats( entryPath( key ), fs );
+   }
+
+   if ( ! bOk )
+      Sys::fal_unlink( temp, fsError );
+
+   m_mtx.lock();
+   bool bTrim = false;
+   if ( bOk )
+   {
+      ++m_stats.m_stores;
+      if ( m_size >= 0 )
+         m_size += size;
+      bTrim = m_size < 0 || m_size > m_maxSize;
+   }
+   else
+      ++m_stats.m_errors;
+   m_mtx.unlock();
+
+   if ( bTrim )
+      trim();
+
+   return bOk;
+}
+
+
+void CompileCache::discard( const String &key )
+{
+   int32 fsError;
+   Sys::fal_unlink( entryPath( key ), fsError );
+
+   m_mtx.lock();
+   ++m_stats.m_errors;
+   m_mtx.unlock();
+}
+
+
+namespace {
+class TrimEntry: public BaseAlloc
+{
+public:
+   String m_name;
+   int64 m_size;
+};
+}
+
+
+void CompileCache::trim()
+{
+   int32 fsError;
+   DirEntry *dir = Sys::fal_openDir( m_path, fsError );
+   if ( dir == 0 )
+      return;
+
+   // entries ordered by modification time (and name, to keep them unique).
+   Map entries( &traits::t_string(), &traits::t_voidp() );
+   int64 total = 0;
+   String fname;
+   while( dir->read( fname ) )
+   {
+      FileStat fs;
+      if ( ! fname.endsWith( CACHE_ENTRY_EXT ) || ! Sys::fal_stats( m_path + "/" + fname, fs )
+            || fs.m_mtime == 0 )
+         continue;
+
+      TrimEntry *entry = new TrimEntry;
+      entry->m_name = fname;
+      entry->m_size = fs.m_size;
+      total += fs.m_size;
+
+      String order;
+      fs.m_mtime->toString( order );
+      order += " " + fname;
+      entries.insert( &order, entry );
+   }
+   Sys::fal_closeDir( dir );
+
+   uint32 evicted = 0;
+   MapIterator iter = entries.begin();
+   while( iter.hasCurrent() )
+   {
+      TrimEntry *entry = *(TrimEntry **) iter.currentValue();
+      if ( total > m_maxSize && Sys::fal_unlink( m_path + "/" + entry->m_name, fsError ) )
+      {
+         total -= entry->m_size;
+         ++evicted;
+      }
+      delete entry;
+      iter.next();
+   }
+
+   m_mtx.lock();
+   m_size = total;
+   m_stats.m_evictions += evicted;
+   m_mtx.unlock();
+}
+
+
+void CompileCache::stats( Stats &target ) const
+{
+   m_mtx.lock();
+   target = m_stats;
+   m_mtx.unlock();
+}
+
+
+void CompileCache::describe( String &target ) const
+{
+   Stats st;
+   stats( st );
+
+   char buffer[256];
+   sprintf( buffer, "compile cache hits=%lu misses=%lu stores=%lu evictions=%lu errors=%lu",
+         (unsigned long) st.m_hits, (unsigned long) st.m_misses, (unsigned long) st.m_stores,
+         (unsigned long) st.m_evictions, (unsigned long) st.m_errors );
+   target = buffer;
+   target.bufferize();
+}
+
+}
+
+/* end of compilecache.cpp */
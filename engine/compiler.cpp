@@ -15,6 +15,7 @@
 
 #include <falcon/compiler.h>
 #include <falcon/syntree.h>
+#include <falcon/optimizer.h>
 #include <falcon/src_lexer.h>
 #include <falcon/error.h>
 #include <falcon/stdstreams.h>
@@ -216,6 +217,66 @@ void Compiler::clear()
 }
 
 
+void Compiler::describeSettings( String &target ) const
+{
+   target = "strict=";
+   target.writeNumber( (int64) ( m_strict ? 1 : 0 ) );
+   target += ";lang=" + m_language + ";version=";
+   target.writeNumber( m_modVersion );
+   target += ";opt=";
+   target.writeNumber( (int64) m_optLevel );
+   target += ";ctx=";
+   target.writeNumber( (int64) ( m_defContext ? 1 : 0 ) );
+
+   // constants are immediate values, ordered by name.
+   MapIterator iter = m_constants.begin();
+   while( iter.hasCurrent() )
+   {
+      const Value *val = *(Value **) iter.currentValue();
+      target += ";" + *(String *) iter.currentKey() + "=";
+      switch( val->type() )
+      {
+         case Value::t_imm_bool: target += val->asBool() ? "true" : "false"; break;
+         case Value::t_imm_integer: target.writeNumber( val->asInteger() ); break;
+         case Value::t_imm_num: target.writeNumber( val->asNumeric(), "%.17g" ); break;
+         case Value::t_imm_string:
+            target += "\"";
+            target.writeNumber( (int64) val->asString()->length() );
+            target += ":" + *val->asString();
+            break;
+         default: target += "nil";
+      }
+      iter.next();
+   }
+}
+
+
+void Compiler::copySettings( const Compiler &other )
+{
+   m_strict = other.m_strict;
+   m_language = other.m_language;
+   m_modVersion = other.m_modVersion;
+   m_optLevel = other.m_optLevel;
+   m_defContext = other.m_defContext;
+
+   MapIterator iter = other.m_constants.begin();
+   while( iter.hasCurrent() )
+   {
+      const String *name = (String *) iter.currentKey();
+      Value *val = (*(Value **) iter.currentValue())->clone();
+      Value **old = (Value **) m_constants.find( name );
+      if ( old != 0 )
+      {
+         delete *old;
+         *old = val;
+      }
+      else
+         m_constants.insert( name, val );
+      iter.next();
+   }
+}
+
+
 bool Compiler::compile( Module *mod, Stream *in )
 {
    if ( m_module != 0 )
@@ -280,6 +341,12 @@ bool Compiler::compile()
          m_module->symbolTable().exportUndefined();
       }
 
+      if ( m_optLevel > 0 )
+      {
+         Optimizer opt;
+         opt.optimize( m_root );
+      }
+
       return true;
    }
 
@@ -140,8 +140,15 @@ void Continuation::suspend( const Item& retval )
    frame->prev(0);
    m_bottom = frame;
    m_top = m_vm->currentFrame();
+
+   // the frames leave the item stack of the context.
+   for( frame = m_top; frame != 0; frame = frame->prev() )
+      frame->stack().detach();
+   for( frame = m_top; frame != m_bottom; frame = frame->prev() )
+      frame->prepareParams( frame->prev(), frame->m_param_count );
+
    // and remove the parameters
-   m_callingFrame->pop( frame->m_param_count );
+   m_callingFrame->pop( m_bottom->m_param_count );
    m_context->setFrames( m_callingFrame );
 
    // prepare the resume values
@@ -32,6 +32,7 @@
 #include <falcon/coretable.h>
 #include <falcon/vm.h>
 #include <falcon/eng_messages.h>
+#include <falcon/memory.h>
 
 
 #include <string.h>
@@ -650,6 +651,7 @@ FALCON_FUNC  mth_arrayFill ( ::Falcon::VMachine *vm )
       else
          (*array)[i] = *i_item;
    }
+   array->changed();
 
    vm->retval( array );
 }
@@ -932,6 +934,7 @@ FALCON_FUNC mth_arrayCopy( ::Falcon::VMachine *vm )
       throw new AccessError( ErrorParam( e_arracc, __LINE__ )
          .origin( e_orig_runtime ) );
    }
+   dest->changed();
 }
 
 /*#
@@ -1231,11 +1234,11 @@ FALCON_FUNC  mth_arrayScan ( ::Falcon::VMachine *vm )
 
    const ItemArray& elements = array->items();
    // fetching as we're going to change the stack
-   Item func = *func_x;
+   PreparedCall func( *func_x, 1 );
    for( int32 i = pos_start; i < pos_end; i++ )
    {
       vm->pushParam( elements[i] );
-      vm->callItemAtomic( func, 1 );
+      vm->callItemAtomic( func );
       if ( vm->regA().isTrue() ) {
          vm->retval( i );
          return;
@@ -1247,149 +1250,372 @@ FALCON_FUNC  mth_arrayScan ( ::Falcon::VMachine *vm )
 
 
 
-#define MINMAL_QUICKSORT_THRESHOLD     4
-inline void arraySort_swap( Item *a, int i, int j)
-{
-   Item T = a[i];
-   a[i] = a[j];
-   a[j] = T;
-}
+//==============================================================
+// Stable natural merge sort used by arraySort and arraySortBy.
+//
+// Ascending and strictly descending runs already present in the data
+// are detected and kept (descending ones are reversed); short runs are
+// extended to ARRAYSORT_MINRUN elements through binary insertion, and
+// then adjacent runs are merged until just one is left.
+//
+// The sorter is applied either directly to native values (integers and
+// numbers) or to the positions of the items in the array; in this way,
+// items never leave their array while script code (comparers, key
+// functions or compare() methods) is being called.
+//
+
+#define ARRAYSORT_MINRUN     32
 
-static void arraySort_quickSort( Item *array, int32 l, int32 r )
+template <class _T, class _Less>
+class ArraySorter
 {
-   int32 i;
-   int32 j;
-   Item v;
-
-   if ( ( r-l ) > MINMAL_QUICKSORT_THRESHOLD )
-   {
-      i = ( r + l ) / 2;
-      if ( array[l] > array[i] ) arraySort_swap( array, l , i );
-      if ( array[l] > array[r] ) arraySort_swap( array , l, r );
-      if ( array[i] > array[r] ) arraySort_swap( array, i, r );
-
-      j = r - 1;
-      arraySort_swap( array , i, j );
-      i = l;
-      v = array[j];
-      for(;;)
+public:
+   ArraySorter( _T *data, int32 size, _Less &less ):
+      m_data( data ),
+      m_size( size ),
+      m_less( less ),
+      m_temp( 0 ),
+      m_runs( 0 )
+   {}
+
+   ~ArraySorter()
+   {
+      if ( m_temp != 0 )
+         memFree( m_temp );
+      if ( m_runs != 0 )
+         memFree( m_runs );
+   }
+
+   void sort()
+   {
+      if ( m_size < 2 )
+         return;
+
+      // each run but the last one is at least ARRAYSORT_MINRUN long.
+      m_runs = (int32 *) memAlloc( sizeof( int32 ) * ( m_size / ARRAYSORT_MINRUN + 2 ) );
+      int32 count = 0;
+      int32 pos = 0;
+      while( pos < m_size )
       {
-            while( array[++i] < v );
-            while( array[--j] > v );
-            if ( j < i ) break;
-            arraySort_swap ( array , i , j );
+         int32 run = countRun( pos );
+         if ( run < ARRAYSORT_MINRUN )
+         {
+            int32 forced = m_size - pos < ARRAYSORT_MINRUN ? m_size - pos : ARRAYSORT_MINRUN;
+            insertion( pos, pos + run, pos + forced );
+            run = forced;
+         }
+
+         m_runs[count++] = pos;
+         pos += run;
+      }
+      m_runs[count] = m_size;
+
+      if ( count == 1 )
+         return;
+
+      m_temp = (_T *) memAlloc( sizeof( _T ) * m_size );
+      while( count > 1 )
+      {
+         int32 merged = 0;
+         int32 i;
+         for ( i = 0; i + 1 < count; i += 2 )
+         {
+            merge( m_runs[i], m_runs[i+1], m_runs[i+2] );
+            m_runs[merged++] = m_runs[i];
+         }
+
+         if ( i < count )
+            m_runs[merged++] = m_runs[i];
+
+         m_runs[merged] = m_size;
+         count = merged;
       }
-      arraySort_swap( array , i, r - 1 );
-      arraySort_quickSort( array, l , j );
-      arraySort_quickSort( array, i + 1 , r );
    }
-}
 
+private:
+   _T *m_data;
+   int32 m_size;
+   _Less &m_less;
+   _T *m_temp;
+   int32 *m_runs;
 
-static void arraySort_insertionSort( VMachine *vm, Item *array, int lo0, int hi0)
-{
-   int32 i;
-   int32 j;
-   Item v;
+   int32 countRun( int32 lo )
+   {
+      int32 hi = lo + 1;
+      if ( hi == m_size )
+         return 1;
+
+      if ( m_less( m_data[hi], m_data[lo] ) )
+      {
+         // strictly descending; can be reversed without breaking stability.
+         ++hi;
+         while( hi < m_size && m_less( m_data[hi], m_data[hi-1] ) )
+            ++hi;
+
+         int32 l = lo;
+         int32 r = hi - 1;
+         while( l < r )
+         {
+            _T temp = m_data[l];
+            m_data[l++] = m_data[r];
+            m_data[r--] = temp;
+         }
+      }
+      else
+      {
+         ++hi;
+         while( hi < m_size && ! m_less( m_data[hi], m_data[hi-1] ) )
+            ++hi;
+      }
 
+      return hi - lo;
+   }
 
-   for ( i = lo0 + 1 ; i <= hi0 ; i++ )
+   // data[lo, start) is sorted; inserts data[start, hi) in it.
+   void insertion( int32 lo, int32 start, int32 hi )
    {
-      v = array[i];
-      j = i;
-      while ( ( j > lo0 ) && ( array[j-1] > v ) )
+      for ( int32 i = start; i < hi; ++i )
       {
-         array[j] = array[j-1];
-         j--;
+         _T pivot = m_data[i];
+         int32 l = lo;
+         int32 r = i;
+         while( l < r )
+         {
+            int32 m = ( l + r ) / 2;
+            if ( m_less( pivot, m_data[m] ) )
+               r = m;
+            else
+               l = m + 1;
+         }
+
+         for ( int32 j = i; j > l; --j )
+            m_data[j] = m_data[j-1];
+         m_data[l] = pivot;
       }
-      array[j] = v;
    }
-}
 
-static void arraySort_quickSort_flex( VMachine *vm, Item *comparer, Item *array, int32 l, int32 r )
+   void merge( int32 lo, int32 mid, int32 hi )
+   {
+      // already in place?
+      if ( ! m_less( m_data[mid], m_data[mid-1] ) )
+         return;
+
+      int32 size = mid - lo;
+      memcpy( m_temp, m_data + lo, sizeof( _T ) * size );
+
+      int32 i = 0;
+      int32 j = mid;
+      int32 k = lo;
+      while( i < size && j < hi )
+      {
+         if ( m_less( m_data[j], m_temp[i] ) )
+            m_data[k++] = m_data[j++];
+         else
+            m_data[k++] = m_temp[i++];
+      }
+
+      while( i < size )
+         m_data[k++] = m_temp[i++];
+   }
+};
+
+
+template <class _T>
+class arraySort_valueLess
+{
+public:
+   bool operator()( _T a, _T b ) const { return a < b; }
+};
+
+class arraySort_itemLess
+{
+   const Item *m_items;
+public:
+   arraySort_itemLess( const Item *items ): m_items( items ) {}
+   bool operator()( int32 a, int32 b ) const { return m_items[a].compare( m_items[b] ) < 0; }
+};
+
+class arraySort_intLess
+{
+   const Item *m_items;
+public:
+   arraySort_intLess( const Item *items ): m_items( items ) {}
+   bool operator()( int32 a, int32 b ) const { return m_items[a].asInteger() < m_items[b].asInteger(); }
+};
+
+class arraySort_numLess
 {
-   int32 i;
-   int32 j;
-   Item v;
+   const Item *m_items;
+public:
+   arraySort_numLess( const Item *items ): m_items( items ) {}
+   bool operator()( int32 a, int32 b ) const { return m_items[a].asNumeric() < m_items[b].asNumeric(); }
+};
 
-   if ( ( r-l ) > MINMAL_QUICKSORT_THRESHOLD )
+class arraySort_stringLess
+{
+   const Item *m_items;
+public:
+   arraySort_stringLess( const Item *items ): m_items( items ) {}
+   bool operator()( int32 a, int32 b ) const
+   {
+      return m_items[a].asString()->compare( *m_items[b].asString() ) < 0;
+   }
+};
+
+class arraySort_flexLess
+{
+   VMachine *m_vm;
+   PreparedCall m_comparer;
+   const Item *m_items;
+public:
+   arraySort_flexLess( VMachine *vm, const Item &comparer, const Item *items ):
+      m_vm( vm ),
+      m_comparer( comparer, 2 ),
+      m_items( items )
+   {}
+
+   bool operator()( int32 a, int32 b ) const
+   {
+      m_vm->pushParam( m_items[a] );
+      m_vm->pushParam( m_items[b] );
+      m_vm->callItemAtomic( m_comparer );
+      return m_vm->regA().asInteger() < 0;
+   }
+};
+
+
+/** Returns the type shared by all the items, or FLC_ITEM_INVALID. */
+static byte arraySort_commonType( const Item *items, int32 size )
+{
+   byte type = items[0].type();
+   for( int32 i = 1; i < size; ++i )
    {
-      i = ( r + l ) / 2;
+      if ( items[i].type() != type )
+         return FLC_ITEM_INVALID;
+   }
+   return type;
+}
 
-      vm->pushParam( array[l] );
-      vm->pushParam( array[i] );
-      vm->callItemAtomic( *comparer, 2 );
 
-      if ( vm->regA().asInteger() > 0 ) arraySort_swap( array, l , i );
+static inline void arraySort_load( const Item &item, int64 &value ) { value = item.asInteger(); }
+static inline void arraySort_load( const Item &item, numeric &value ) { value = item.asNumeric(); }
+static inline void arraySort_store( Item &item, int64 value ) { item.setInteger( value ); }
+static inline void arraySort_store( Item &item, numeric value ) { item.setNumeric( value ); }
 
-      vm->pushParam( array[l] );
-      vm->pushParam( array[r] );
-      vm->callItemAtomic( *comparer, 2 );
+/** Sorts an array of integers or of numbers. */
+template <class _T>
+static void arraySort_values( Item *vector, int32 size )
+{
+   _T *values = (_T *) memAlloc( sizeof( _T ) * size );
+   for( int32 i = 0; i < size; ++i )
+      arraySort_load( vector[i], values[i] );
 
-      if ( vm->regA().asInteger() > 0 ) arraySort_swap( array , l, r );
+   arraySort_valueLess<_T> less;
+   ArraySorter<_T, arraySort_valueLess<_T> > sorter( values, size, less );
+   sorter.sort();
 
-      vm->pushParam( array[i] );
-      vm->pushParam( array[r] );
-      vm->callItemAtomic( *comparer, 2 );
-      if ( vm->regA().asInteger() > 0 ) arraySort_swap( array, i, r );
+   for( int32 i = 0; i < size; ++i )
+      arraySort_store( vector[i], values[i] );
 
-      j = r - 1;
-      arraySort_swap( array, i, j );
-      i = l;
-      v = array[j];
-      for(;;)
-      {
-            do {
-               vm->pushParam( array[++i] );
-               vm->pushParam( v );
-               vm->callItemAtomic( *comparer, 2 );
-            }
-            while( vm->regA().asInteger() < 0 );
-
-            do {
-               vm->pushParam( array[--j] );
-               vm->pushParam( v );
-               vm->callItemAtomic( *comparer, 2 );
-            }
-            while( vm->regA().asInteger() > 0 );
-
-            if ( j < i ) break;
-            arraySort_swap ( array , i , j );
-      }
-      arraySort_swap( array , i, r - 1 );
-      arraySort_quickSort( array, l , j );
-      arraySort_quickSort( array, i + 1 , r );
+   memFree( values );
+}
+
+
+/** Sorts the positions in order according to keys, and then places
+    the items of source in target following that order. */
+template <class _Less>
+static void arraySort_positions( CoreArray *target, const CoreArray *source, int32 size, _Less &less )
+{
+   int32 *order = (int32 *) memAlloc( sizeof( int32 ) * size );
+   for( int32 i = 0; i < size; ++i )
+      order[i] = i;
+
+   try
+   {
+      ArraySorter<int32, _Less> sorter( order, size, less );
+      sorter.sort();
    }
+   catch( ... )
+   {
+      memFree( order );
+      throw;
+   }
+
+   // the array may have been changed by the called functions.
+   if ( target->length() != (uint32) size )
+      target->resize( size );
+
+   Item *vector = target->items().elements();
+   const Item *items = source->items().elements();
+   for( int32 i = 0; i < size; ++i )
+      vector[i] = items[ order[i] ];
+   target->changed();
+
+   memFree( order );
 }
 
 
-static void arraySort_insertionSort_flex( VMachine *vm, Item *comparer, Item *array, int lo0, int hi0)
+/** Sorts the positions of the array by their keys.
+    Homogeneous keys are compared natively, unless a comparer is given. */
+static void arraySort_byKeys( VMachine *vm, CoreArray *array, const CoreArray *source,
+      const CoreArray *keys, const Item *sorter )
 {
-   int32 i;
-   int32 j;
-   Item v;
+   int32 size = (int32) source->length();
+   const Item *kitems = keys->items().elements();
 
-   for ( i = lo0 + 1 ; i <= hi0 ; i++ )
+   if ( sorter != 0 )
    {
-      v = array[i];
-      j = i;
-      while ( j > lo0 )
+      arraySort_flexLess less( vm, *sorter, kitems );
+      arraySort_positions( array, source, size, less );
+      return;
+   }
+
+   switch( arraySort_commonType( kitems, size ) )
+   {
+      case FLC_ITEM_INT:
       {
-         vm->pushParam( array[j-1] );
-         vm->pushParam( v );
-         vm->callItemAtomic( *comparer, 2 );
+         arraySort_intLess less( kitems );
+         arraySort_positions( array, source, size, less );
+      }
+      break;
 
-         if ( vm->regA().asInteger() <= 0 )
-            break;
+      case FLC_ITEM_NUM:
+      {
+         arraySort_numLess less( kitems );
+         arraySort_positions( array, source, size, less );
+      }
+      break;
+
+      case FLC_ITEM_STRING:
+      {
+         arraySort_stringLess less( kitems );
+         arraySort_positions( array, source, size, less );
+      }
+      break;
 
-         array[j] = array[j-1];
-         j--;
+      default:
+      {
+         arraySort_itemLess less( kitems );
+         arraySort_positions( array, source, size, less );
       }
-      array[j] = v;
    }
 }
 
 
+/** Creates a GC-protected shallow copy of the array contents. */
+static CoreArray *arraySort_snapshot( VMachine *vm, CoreArray *array, int localId )
+{
+   uint32 size = array->length();
+   CoreArray *copy = new CoreArray( size );
+   const Item *vector = array->items().elements();
+   for( uint32 i = 0; i < size; ++i )
+      copy->append( vector[i] );
+
+   *vm->local( localId ) = copy;
+   return copy;
+}
+
+
 /*#
    @function arraySort
    @brief Sorts an array, possibly using an arbitrary ordering criterion.
@@ -1404,6 +1630,12 @@ static void arraySort_insertionSort_flex( VMachine *vm, Item *comparer, Item *ar
    if the first parameter is be considered greater than the second, 0 if they
    are equal and 1 if the second parameter is to be considered greater.
 
+   The sort is stable: items considered equal keep their relative order.
+   Arrays made only of integers, only of numbers or only of strings are
+   sorted natively when no sortFunc is given. To sort items on a value
+   extracted from them, @a arraySortBy is usually much faster than
+   a sortFunc.
+
    Sort function is called in atomic mode. The called function cannot be
    interrupted by external kind requests, and it cannot sleep or yield the
    execution to other coroutines.
@@ -1433,29 +1665,132 @@ FALCON_FUNC  mth_arraySort( ::Falcon::VMachine *vm )
    }
 
    if ( array_itm == 0 || ! array_itm->isArray()
-        || (sorter_itm != 0 && ! sorter_itm->isCallable())
+        || (sorter_itm != 0 && ! sorter_itm->isNil() && ! sorter_itm->isCallable())
       )
    {
       throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
          origin( e_orig_runtime ).
-         extra( vm->self().isMethodic() ? "C" : "A,C" ) );
+         extra( vm->self().isMethodic() ? "[C]" : "A,[C]" ) );
    }
 
    CoreArray *array = array_itm->asArray();
-   Item *vector = array->items().elements();
+   int32 size = (int32) array->length();
+   if ( size < 2 )
+      return;
 
-   if ( sorter_itm == 0 )
+   // fetching as we're going to change the stack
+   Item sorter;
+   bool bFlex = sorter_itm != 0 && ! sorter_itm->isNil();
+   if ( bFlex )
+      sorter = *sorter_itm;
+   else
    {
-      arraySort_quickSort( vector, 0, array->length() - 1 );
-      arraySort_insertionSort( vm, vector, 0, array->length() -1 );
+      Item *vector = array->items().elements();
+      switch( arraySort_commonType( vector, size ) )
+      {
+         case FLC_ITEM_INT: arraySort_values<int64>( vector, size ); array->changed(); return;
+         case FLC_ITEM_NUM: arraySort_values<numeric>( vector, size ); array->changed(); return;
+         default: break;
+      }
+   }
+
+   // the items are compared through a private copy, so that they are kept
+   // alive even if the called functions modify the array.
+   vm->addLocals( 1 );
+   CoreArray *source = arraySort_snapshot( vm, array, 0 );
+   arraySort_byKeys( vm, array, source, source, bFlex ? &sorter : 0 );
+}
+
+
+/*#
+   @function arraySortBy
+   @brief Sorts an array on keys extracted from its items.
+   @param array The array to be sorted.
+   @param keyFunc A function returning the sort key of the item it receives.
+   @optparam sortingFunc A function used to compare two keys.
+
+   The @b keyFunc is called exactly once for each element of the array; the
+   array is then sorted so that the items appear in the order of their keys.
+   The sort is stable, so items with equal keys keep their relative order,
+   and multiple passes can be used to sort on more fields.
+
+   When all the keys are integers, numbers or strings, they are compared
+   natively; otherwise they are compared as the ordinary Falcon relational
+   operators would do, or through @b sortingFunc if it's given (with the
+   same convention used by @a arraySort).
+
+   For example, to sort a list of records on their second field:
+   @code
+      records = [ ["b", 2], ["a", 3], ["c", 1] ]
+      arraySortBy( records, { r => r[1] } )
+      // or records.sortBy( { r => r[1] } )
+   @endcode
+
+   The functions are called in atomic mode.
+*/
+
+/*#
+   @method sortBy Array
+   @brief Sorts an array on keys extracted from its items.
+   @param keyFunc A function returning the sort key of the item it receives.
+   @optparam sortingFunc A function used to compare two keys.
+
+   @see arraySortBy
+*/
+FALCON_FUNC  mth_arraySortBy( ::Falcon::VMachine *vm )
+{
+   Item *array_itm;
+   Item *key_itm;
+   Item *sorter_itm;
+
+   if( vm->self().isMethodic() )
+   {
+      array_itm = &vm->self();
+      key_itm = vm->param( 0 );
+      sorter_itm = vm->param( 1 );
+   }
+   else
+   {
+      array_itm = vm->param( 0 );
+      key_itm = vm->param( 1 );
+      sorter_itm = vm->param( 2 );
+   }
+
+   if ( array_itm == 0 || ! array_itm->isArray()
+        || key_itm == 0 || ! key_itm->isCallable()
+        || (sorter_itm != 0 && ! sorter_itm->isNil() && ! sorter_itm->isCallable())
+      )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         origin( e_orig_runtime ).
+         extra( vm->self().isMethodic() ? "C,[C]" : "A,C,[C]" ) );
    }
-   else {
-      // fetching as we're going to change the stack
-      Item sorter = *sorter_itm;
 
-      arraySort_quickSort_flex( vm, &sorter, vector, 0, array->length() - 1 );
-      arraySort_insertionSort_flex( vm, &sorter, vector, 0, array->length() -1 );
+   CoreArray *array = array_itm->asArray();
+   int32 size = (int32) array->length();
+   if ( size < 2 )
+      return;
+
+   // fetching as we're going to change the stack
+   PreparedCall keyFunc( *key_itm, 1 );
+   Item sorter;
+   bool bFlex = sorter_itm != 0 && ! sorter_itm->isNil();
+   if ( bFlex )
+      sorter = *sorter_itm;
+
+   vm->addLocals( 2 );
+   CoreArray *source = arraySort_snapshot( vm, array, 0 );
+   CoreArray *keys = new CoreArray( size );
+   *vm->local( 1 ) = keys;
+
+   for( int32 i = 0; i < size; ++i )
+   {
+      vm->pushParam( source->items()[i] );
+      vm->callItemAtomic( keyFunc );
+      keys->append( vm->regA() );
    }
+
+   arraySort_byKeys( vm, array, source, keys, bFlex ? &sorter : 0 );
 }
 
 /*#
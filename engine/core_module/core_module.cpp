@@ -678,6 +678,8 @@ Module* core_module_init()
       addParam("func")->addParam("start")->addParam("end");
    self->addClassMethod( array_meta, "sort", &Falcon::core::mth_arraySort ).asSymbol()->
       addParam("sortingFunc");
+   self->addClassMethod( array_meta, "sortBy", &Falcon::core::mth_arraySortBy ).asSymbol()->
+      addParam("keyFunc")->addParam("sortingFunc");
    self->addClassMethod( array_meta, "remove", &Falcon::core::mth_arrayRemove ).asSymbol()->
       addParam("itemPos")->addParam("lastItemPos");
    self->addClassMethod( array_meta, "merge", &Falcon::core::mth_arrayMerge ).asSymbol()->
@@ -1145,6 +1147,15 @@ Module* core_module_init()
       addParam("wcoll");
    self->addClassMethod( gc_cls, "adjust", &Falcon::core::GC_adjust ).setReadOnly(true).asSymbol()->
       addParam("mode");
+   self->addClassMethod( gc_cls, "stats", &Falcon::core::GC_stats ).setReadOnly(true);
+   self->addClassMethod( gc_cls, "resetStats", &Falcon::core::GC_resetStats ).setReadOnly(true);
+   self->addClassMethod( gc_cls, "heapStart", &Falcon::core::GC_heapStart ).setReadOnly(true).asSymbol()->
+      addParam("interval");
+   self->addClassMethod( gc_cls, "heapStop", &Falcon::core::GC_heapStop ).setReadOnly(true);
+   self->addClassMethod( gc_cls, "heapReset", &Falcon::core::GC_heapReset ).setReadOnly(true);
+   self->addClassMethod( gc_cls, "heapData", &Falcon::core::GC_heapData ).setReadOnly(true);
+   self->addClassMethod( gc_cls, "heapWrite", &Falcon::core::GC_heapWrite ).setReadOnly(true).asSymbol()->
+      addParam("stream");
    self->addClassProperty( gc_cls, "ADJ_NONE" ).setInteger(RAMP_MODE_OFF).setReadOnly(true);
    self->addClassProperty( gc_cls, "ADJ_STRICT" ).setInteger(RAMP_MODE_STRICT_ID).setReadOnly(true);
    self->addClassProperty( gc_cls, "ADJ_LOOSE" ).setInteger(RAMP_MODE_LOOSE_ID).setReadOnly(true);
@@ -1163,6 +1174,16 @@ Module* core_module_init()
    self->addExtFunc( "vmModuleLine", &Falcon::core::vmModuleLine );
    self->addExtFunc( "vmModulePath", &Falcon::core::vmModulePath );
    self->addExtFunc( "vmRelativePath", &Falcon::core::vmRelativePath );
+   self->addExtFunc( "vmProfileStart", &Falcon::core::vmProfileStart )->
+      addParam("rate");
+   self->addExtFunc( "vmProfileStop", &Falcon::core::vmProfileStop );
+   self->addExtFunc( "vmProfileWrite", &Falcon::core::vmProfileWrite )->
+      addParam("stream")->addParam("table");
+   self->addExtFunc( "vmCountersStart", &Falcon::core::vmCountersStart );
+   self->addExtFunc( "vmCountersStop", &Falcon::core::vmCountersStop );
+   self->addExtFunc( "vmCountersData", &Falcon::core::vmCountersData );
+   self->addExtFunc( "vmCountersWrite", &Falcon::core::vmCountersWrite )->
+      addParam("stream");
 
    // Format
    Symbol *format_class = self->addClass( "Format", &Falcon::core::Format_init );
@@ -1439,6 +1460,8 @@ Module* core_module_init()
       addParam("array")->addParam("item")->addParam("start")->addParam("end");
    self->addExtFunc( "arraySort", &Falcon::core::mth_arraySort )->
       addParam("array")->addParam("sortingFunc");
+   self->addExtFunc( "arraySortBy", &Falcon::core::mth_arraySortBy )->
+      addParam("array")->addParam("keyFunc")->addParam("sortingFunc");
    self->addExtFunc( "arrayRemove", &Falcon::core::mth_arrayRemove )->
       addParam("array")->addParam("itemPos")->addParam("lastItemPos");
    self->addExtFunc( "arrayMerge", &Falcon::core::mth_arrayMerge )->
@@ -1612,6 +1635,10 @@ Module* core_module_init()
       addParam("fileName")->addParam("createMode")->addParam("shareMode");
    self->addExtFunc( "IOStream", &Falcon::core::IOStream_creator )->
       addParam("fileName")->addParam("createMode")->addParam("shareMode");
+   self->addExtFunc( "MapStream", &Falcon::core::MapStream_creator )->
+      addParam("fileName")->addParam("writable");
+   self->addExtFunc( "fileMap", &Falcon::core::fileMap )->
+      addParam("fileName")->addParam("writable")->addParam("offset")->addParam("size");
 
    self->addExtFunc( "readURI", &Falcon::core::readURI )->
       addParam("uri")->addParam("encoding");
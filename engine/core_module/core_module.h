@@ -228,6 +228,13 @@ CoreObject* GC_Factory( const CoreClass *cls, void *user_data, bool );
 FALCON_FUNC  GC_adjust( ::Falcon::VMachine *vm );
 FALCON_FUNC  GC_enable( ::Falcon::VMachine *vm );
 FALCON_FUNC  GC_perform( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_stats( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_resetStats( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_heapStart( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_heapStop( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_heapReset( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_heapData( ::Falcon::VMachine *vm );
+FALCON_FUNC  GC_heapWrite( ::Falcon::VMachine *vm );
 
 FALCON_FUNC  gcEnable( ::Falcon::VMachine *vm );
 FALCON_FUNC  gcSetThreshold( ::Falcon::VMachine *vm );
@@ -246,6 +253,13 @@ FALCON_FUNC  vmModuleName( ::Falcon::VMachine *vm );
 FALCON_FUNC  vmModuleLine( ::Falcon::VMachine *vm );
 FALCON_FUNC  vmModulePath( ::Falcon::VMachine *vm );
 FALCON_FUNC  vmRelativePath( ::Falcon::VMachine *vm );
+FALCON_FUNC  vmProfileStart( ::Falcon::VMachine *vm );
+FALCON_FUNC  vmProfileStop( ::Falcon::VMachine *vm );
+FALCON_FUNC  vmProfileWrite( ::Falcon::VMachine *vm );
+FALCON_FUNC  vmCountersStart( ::Falcon::VMachine *vm );
+FALCON_FUNC  vmCountersStop( ::Falcon::VMachine *vm );
+FALCON_FUNC  vmCountersData( ::Falcon::VMachine *vm );
+FALCON_FUNC  vmCountersWrite( ::Falcon::VMachine *vm );
 
 FALCON_FUNC  print ( ::Falcon::VMachine *vm );
 FALCON_FUNC  printl ( ::Falcon::VMachine *vm );
@@ -261,6 +275,8 @@ FALCON_FUNC  falcon_getEnviron( ::Falcon::VMachine *vm );
 FALCON_FUNC  InputStream_creator ( ::Falcon::VMachine *vm );
 FALCON_FUNC  OutputStream_creator ( ::Falcon::VMachine *vm );
 FALCON_FUNC  IOStream_creator ( ::Falcon::VMachine *vm );
+FALCON_FUNC  MapStream_creator ( ::Falcon::VMachine *vm );
+FALCON_FUNC  fileMap ( ::Falcon::VMachine *vm );
 FALCON_FUNC  systemErrorDescription ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_close ( ::Falcon::VMachine *vm );
 FALCON_FUNC  Stream_flush ( ::Falcon::VMachine *vm );
@@ -353,6 +369,7 @@ FALCON_FUNC  mth_arrayResize ( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayFind ( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayScan ( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arraySort( ::Falcon::VMachine *vm );
+FALCON_FUNC  mth_arraySortBy( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayRemove( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayMerge( ::Falcon::VMachine *vm );
 FALCON_FUNC  mth_arrayHead ( ::Falcon::VMachine *vm );
@@ -36,6 +36,8 @@
 #include <falcon/uri.h>
 #include <falcon/vfsprovider.h>
 #include <falcon/transcoding.h>
+#include <falcon/filemap.h>
+#include <falcon/mapstream.h>
 
 #include "core_module.h"
 
@@ -60,6 +62,17 @@ static void s_breakage( Stream *file )
 
 }
 
+// Lines read from files having data ready won't wait for long; reading them
+// without giving the VM to the garbage collector saves a thread switch per line.
+static bool s_lineMayBlock( Stream *file )
+{
+   Stream *base = file;
+   while( base->isTranscoder() )
+      base = static_cast<Transcoder *>( base )->underlying();
+
+   return base->type() != Stream::t_file || file->readAvailable( 0 ) <= 0;
+}
+
 /*#
    @class Stream
    @brief Stream oriented I/O class.
@@ -533,42 +546,19 @@ FALCON_FUNC  Stream_readLine ( ::Falcon::VMachine *vm )
    }
 
    // we're idling while using VM memory, but we know we're keeping the data structure constant.
-   vm->idle();
-
-   uint32 c = 0, c1 = 0;
-   int pos = 0;
-   bool getOk = file->get( c );
-   while( getOk && pos < size )
-   {
-      if ( c == (uint32)'\r' ) {
-         c1 = c;
-         getOk = file->get( c );
-         continue;
-      }
-      else if ( c == (uint32)'\n' ) {
-         break;
-      }
-      else if ( c1 != 0 ) {
-         c1 = 0;
-         str->append( c1 );
-         ++pos;
-      }
-
-      str->append( c );
-      ++pos;
-      getOk = file->get( c );
-   }
+   bool bIdle = s_lineMayBlock( file );
+   if ( bIdle ) vm->idle();
+   bool complete = file->readLine( *str, size );
+   if ( bIdle ) vm->unidle();
 
-   vm->unidle();
-
-   if ( ! getOk && ! file->eof() )
+   if ( ! complete && ! file->eof() )
    {
       s_breakage( file );
    }
 
    // even if we read an empty line AND then we hit eof, we must return true,
    // so the program knows that the last line is empty.
-   vm->regA().setBoolean( getOk || pos > 0 );
+   vm->regA().setBoolean( complete || str->size() > 0 );
 }
 
 /*#
@@ -653,41 +643,19 @@ FALCON_FUNC  Stream_grabLine ( ::Falcon::VMachine *vm )
    if ( size > 0 )
       str->reserve( size );
 
-   vm->idle();
-   uint32 c = 0, c1 = 0;
-   int pos = 0;
-   bool getOk = file->get( c );
-   while( getOk && (size < 0 || pos < size) )
-   {
-      if ( c == (uint32)'\r' ) {
-         c1 = c;
-         getOk = file->get( c );
-         continue;
-      }
-      else if ( c == (uint32)'\n' ) {
-         break;
-      }
-      else if ( c1 != 0 ) {
-         c1 = 0;
-         str->append( c1 );
-         ++pos;
-      }
-
-      str->append( c );
-      ++pos;
-      getOk = file->get( c );
-   }
-
-   vm->unidle();
+   bool bIdle = s_lineMayBlock( file );
+   if ( bIdle ) vm->idle();
+   bool complete = file->readLine( *str, size < 0 ? csh::npos : (uint32) size );
+   if ( bIdle ) vm->unidle();
 
-   if ( ! getOk )
+   if ( ! complete )
    {
       if ( ! file->eof() )
       {
          s_breakage( file );
       }
       // a last line with some data?
-      else if( pos == 0 )
+      else if( str->size() == 0 )
       {
          // no? -- consider it null
          vm->retval( (int64) 0 );
@@ -1563,6 +1531,155 @@ FALCON_FUNC  IOStream_creator ( ::Falcon::VMachine *vm )
    vm->retval( co );
 }
 
+// maps the file named by the given URI, or raises the VFS error.
+static FileMap *s_mapFile( VMachine *vm, const String &fileName, bool bWritable )
+{
+   URI furi( fileName );
+
+   if ( !furi.isValid() )
+   {
+      throw new ParamError( ErrorParam( e_malformed_uri, __LINE__ )
+            .origin( e_orig_runtime )
+            .extra( fileName ) );
+   }
+
+   // find the appropriate provider.
+   VFSProvider* vfs = Engine::getVFS( furi.scheme() );
+   if ( vfs == 0 )
+   {
+      throw new ParamError( ErrorParam( e_unknown_vfs, __LINE__ )
+            .origin( e_orig_runtime )
+            .extra( fileName ) );
+   }
+
+   VFSProvider::OParams params;
+   if ( bWritable )
+      params.rdwr();
+   else
+      params.rdOnly();
+
+   vm->idle();
+   FileMap *fmap = vfs->map( furi, params );
+   vm->unidle();
+
+   if ( fmap == 0 )
+   {
+      ::Falcon::Error *error = vfs->getLastError();
+      if ( error == 0 )
+         throw new IoError( ErrorParam( e_io_unsup, __LINE__ )
+               .origin( e_orig_runtime )
+               .extra( fileName ) );
+      throw error;
+   }
+
+   return fmap;
+}
+
+/*#
+   @function MapStream
+   @brief Creates a stream over a file mapped in memory.
+   @ingroup core_syssupport
+   @param fileName A relative or absolute path to the file to be mapped.
+   @optparam writable If true, the stream can write on the file.
+   @return A new valid @a Stream instance on success.
+   @raise IoError if the file can't be mapped.
+
+   The file is mapped in memory as a whole; read and write operations
+   work directly on the mapped memory, without system calls nor intermediate
+   buffers. This is convenient to scan large files, or to access them randomly
+   through @a Stream.seek.
+
+   The size of the file can't be changed through the returned stream: writes
+   past the end of the file are truncated, and @a Stream.truncate is not supported.
+   Writes are allowed only if @b writable is true.
+
+   @see fileMap
+*/
+FALCON_FUNC  MapStream_creator ( ::Falcon::VMachine *vm )
+{
+   Item *fileName = vm->param(0);
+   Item *i_writable = vm->param(1);
+
+   if ( fileName == 0 || ! fileName->isString() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .origin( e_orig_runtime )
+         .extra( "S,[B]" ) );
+   }
+
+   FileMap *fmap = s_mapFile( vm, *fileName->asString(), i_writable != 0 && i_writable->isTrue() );
+   Stream *stream = new MapStream( fmap );
+   fmap->decref();
+
+   Item *stream_class = vm->findWKI( "Stream" );
+   //if we wrote the std module, can't be zero.
+   fassert( stream_class != 0 );
+   ::Falcon::CoreObject *co = stream_class->asClass()->createInstance( stream );
+   vm->retval( co );
+}
+
+/*#
+   @function fileMap
+   @brief Maps a file in memory and returns a MemBuf accessing it.
+   @ingroup core_syssupport
+   @param fileName A relative or absolute path to the file to be mapped.
+   @optparam writable If true, changes to the memory buffer are written to the file.
+   @optparam offset Position in the file where the memory buffer starts (defaults to 0).
+   @optparam size Size of the memory buffer (defaults to the rest of the file).
+   @return A memory buffer with word size 1.
+   @raise IoError if the file can't be mapped.
+   @raise ParamError if offset and size exceed the file size, or if
+      the size is larger than the maximum size of a memory buffer (4GB).
+
+   The file contents are not read in memory; the system loads the parts
+   of the file that are actually accessed. Different buffers can view
+   different parts of the same file.
+
+   If @b writable is not true, the memory buffer can still be changed,
+   but the changes are private to the running process and are not written
+   to the file. Changes to writable buffers are visible in the file as soon as
+   they are performed, and are written to the disk at the latest when the
+   memory buffer is reclaimed by the garbage collector.
+
+   The size of the file can't be changed through the memory buffer.
+
+   @see MapStream
+*/
+FALCON_FUNC  fileMap ( ::Falcon::VMachine *vm )
+{
+   Item *fileName = vm->param(0);
+   Item *i_writable = vm->param(1);
+   Item *i_offset = vm->param(2);
+   Item *i_size = vm->param(3);
+
+   if ( fileName == 0 || ! fileName->isString()
+      || ( i_offset != 0 && ! i_offset->isNil() && ! i_offset->isOrdinal() )
+      || ( i_size != 0 && ! i_size->isNil() && ! i_size->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .origin( e_orig_runtime )
+         .extra( "S,[B],[N],[N]" ) );
+   }
+
+   FileMap *fmap = s_mapFile( vm, *fileName->asString(), i_writable != 0 && i_writable->isTrue() );
+
+   int64 offset = i_offset == 0 || i_offset->isNil() ? 0 : i_offset->forceInteger();
+   int64 size = i_size == 0 || i_size->isNil() ?
+         (int64) fmap->size() - offset : i_size->forceInteger();
+
+   if ( offset < 0 || size < 0 || (uint64) (offset + size) > fmap->size()
+      || size >= (int64) MemBuf::MAX_LEN )
+   {
+      fmap->decref();
+      throw new ParamError( ErrorParam( e_param_range, __LINE__ )
+         .origin( e_orig_runtime ) );
+   }
+
+   MemBuf *mb = new MappedMemBuf( fmap, (uint64) offset, (uint32) size );
+   fmap->decref();
+   vm->retval( mb );
+}
+
 static CoreObject *internal_make_stream( VMachine *vm, FalconData *clone, int userMode )
 {
    // The clone stream may be zero if the embedding application doesn't want
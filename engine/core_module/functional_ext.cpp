@@ -22,6 +22,12 @@
 namespace Falcon {
 namespace core {
 
+// the call prepared in a local variable of a return frame handler.
+static inline PreparedCall *preparedCall( VMachine *vm, uint32 id )
+{
+   return static_cast<PreparedCall*>( vm->local( id )->asGCPointer() );
+}
+
 /*#
    @funset functional_support Functional programming support
    @brief ETA functions and functional constructs.
@@ -638,7 +644,7 @@ static bool core_map_next( ::Falcon::VMachine *vm )
    {
       *vm->local(0) = (int64) count + 1;
       vm->pushParameter( origin->at(count) );
-      vm->callFrame( *vm->param(0), 1 );
+      vm->callFrame( *preparedCall( vm, 2 ) );
       return true;
    }
 
@@ -665,13 +671,14 @@ FALCON_FUNC  core_map ( ::Falcon::VMachine *vm )
    if ( origin->length() > 0 )
    {
       vm->returnHandler( &core_map_next );
-      vm->addLocals( 2 );
+      vm->addLocals( 3 );
       *vm->local(0) = (int64)1;
       *vm->local(1) = mapped;
+      // do not use pre-fetched pointer
+      vm->local(2)->setGCPointer( new PreparedCall( *vm->param(0), 1 ) );
 
       vm->pushParameter( origin->at(0) );
-      // do not use pre-fetched pointer
-      vm->callFrame( *vm->param(0), 1 );
+      vm->callFrame( *preparedCall( vm, 2 ) );
       return;
    }
 
@@ -708,7 +715,7 @@ static bool core_dolist_next ( ::Falcon::VMachine *vm )
    *vm->local(0) = (int64) count + 1;
    *vm->local(1) = (int64) 1;
    vm->pushParameter( vm->regA() );
-   vm->callFrame( *vm->param(0), 1 );
+   vm->callFrame( *preparedCall( vm, 2 ) );
    return true;
 }
 
@@ -749,12 +756,13 @@ FALCON_FUNC  core_dolist ( ::Falcon::VMachine *vm )
    if ( origin->length() != 0 )
    {
       vm->returnHandler( &core_dolist_next );
-      vm->addLocals( 2 );
+      vm->addLocals( 3 );
       // count
       *vm->local(0) = (int64) 0;
 
       //exiting from an eval or from a call frame? -- 0 eval
       *vm->local(1) = (int64) 0;
+      vm->local(2)->setGCPointer( new PreparedCall( *vm->param(0), 1 ) );
 
       if ( vm->functionalEval( origin->at(0) ) )
       {
@@ -767,7 +775,7 @@ FALCON_FUNC  core_dolist ( ::Falcon::VMachine *vm )
       //exiting from an eval or from a call frame? -- 1 callframe
       *vm->local(1) = (int64) 1;
       vm->pushParameter( vm->regA() );
-      vm->callFrame( *vm->param(0), 1 );
+      vm->callFrame( *preparedCall( vm, 2 ) );
    }
 }
 
@@ -1132,7 +1140,7 @@ static bool core_xmap_next( ::Falcon::VMachine *vm )
 
       *vm->local(2) = (int64) 1;
       vm->pushParameter( vm->regA() );
-      vm->callFrame( *vm->param(0), 1 );
+      vm->callFrame( *preparedCall( vm, 3 ) );
       return true;
    }
    else {
@@ -1191,10 +1199,11 @@ FALCON_FUNC  core_xmap ( ::Falcon::VMachine *vm )
    if ( origin->length() > 0 )
    {
       vm->returnHandler( &core_xmap_next );
-      vm->addLocals( 3 );
+      vm->addLocals( 4 );
       *vm->local(0) = (int64)1;
       *vm->local(1) = mapped;
       *vm->local(2) = (int64) 0;
+      vm->local(3)->setGCPointer( new PreparedCall( *vm->param(0), 1 ) );
 
       if ( vm->functionalEval( origin->at(0) ) )
       {
@@ -1203,7 +1212,7 @@ FALCON_FUNC  core_xmap ( ::Falcon::VMachine *vm )
 
       *vm->local(2) = (int64) 1;
       vm->pushParameter( vm->regA() );
-      vm->callFrame( *vm->param(0), 1 );
+      vm->callFrame( *preparedCall( vm, 3 ) );
       return;
    }
 
@@ -1227,7 +1236,7 @@ static bool core_filter_next ( ::Falcon::VMachine *vm )
 
    *vm->local(1) = (int64) count+1;
    vm->pushParameter( origin->at(count) );
-   vm->callFrame( *vm->param(0), 1 );
+   vm->callFrame( *preparedCall( vm, 2 ) );
    return true;
 }
 
@@ -1265,11 +1274,12 @@ FALCON_FUNC  core_filter ( ::Falcon::VMachine *vm )
    if( origin->length() > 0 )
    {
       vm->returnHandler( &core_filter_next );
-      vm->addLocals(2);
+      vm->addLocals(3);
       *vm->local(0) = mapped;
       *vm->local(1) = (int64) 1;
+      vm->local(2)->setGCPointer( new PreparedCall( *vm->param(0), 1 ) );
       vm->pushParameter( origin->at(0) );
-      vm->callFrame( *vm->param(0), 1 );
+      vm->callFrame( *preparedCall( vm, 2 ) );
       return;
    }
 
@@ -1294,7 +1304,7 @@ static bool core_reduce_next ( ::Falcon::VMachine *vm )
    // call next item
    vm->pushParameter( vm->regA() ); // last returned value
    vm->pushParameter( origin->at(count) ); // next element
-   vm->callFrame( *vm->param(0), 2 );
+   vm->callFrame( *preparedCall( vm, 1 ) );
    return true;
 }
 
@@ -1341,8 +1351,8 @@ FALCON_FUNC  core_reduce ( ::Falcon::VMachine *vm )
    }
 
    CoreArray *origin = i_origin->asArray();
-   vm->addLocals(1);
-   // local 0: array position
+   vm->addLocals(2);
+   // local 0: array position; local 1: the prepared reductor.
 
    if ( init != 0 )
    {
@@ -1353,12 +1363,13 @@ FALCON_FUNC  core_reduce ( ::Falcon::VMachine *vm )
       }
 
       vm->returnHandler( &core_reduce_next );
+      vm->local(1)->setGCPointer( new PreparedCall( *vm->param(0), 2 ) );
       vm->pushParameter( *init );
       vm->pushParameter( origin->at(0) );
       *vm->local(0) = (int64) 1;
 
       //WARNING: never use pre-cached item pointers after stack changes.
-      vm->callFrame( *vm->param(0), 2 );
+      vm->callFrame( *preparedCall( vm, 1 ) );
       return;
    }
 
@@ -1371,13 +1382,14 @@ FALCON_FUNC  core_reduce ( ::Falcon::VMachine *vm )
    {
       vm->returnHandler( core_reduce_next );
       *vm->local(0) = (int64) 2; // we'll start from 2
+      vm->local(1)->setGCPointer( new PreparedCall( *vm->param(0), 2 ) );
 
       // the first call is between the first and the second elements in the array.
       vm->pushParameter( origin->at(0) );
       vm->pushParameter( origin->at(1) );
 
       //WARNING: never use pre-cached item pointers after stack changes.
-      vm->callFrame( *vm->param(0), 2 );
+      vm->callFrame( *preparedCall( vm, 1 ) );
    }
 }
 
@@ -15,6 +15,10 @@
 
 #include "core_module.h"
 #include <falcon/memory.h>
+#include <falcon/gcstats.h>
+#include <falcon/sys.h>
+#include <falcon/lineardict.h>
+#include <falcon/heapprofiler.h>
 
 /*#
    @beginmodule core
@@ -160,6 +164,235 @@ FALCON_FUNC  GC_adjust( ::Falcon::VMachine *vm )
    }
 }
 
+static CoreDict* s_histogram( const GCStats::Histogram& hist )
+{
+   CoreArray* buckets = new CoreArray( GCStats::hist_size );
+   CoreArray* limits = new CoreArray( GCStats::hist_size - 1 );
+   for ( uint32 i = 0; i < GCStats::hist_size; ++i )
+   {
+      buckets->append( (int64) hist.m_count[i] );
+      if ( i < GCStats::hist_size - 1 )
+         limits->append( GCStats::Histogram::limit( i ) );
+   }
+
+   LinearDict* dict = new LinearDict( 6 );
+   dict->put( new CoreString( "samples" ), (int64) hist.m_samples );
+   dict->put( new CoreString( "total" ), hist.m_total );
+   dict->put( new CoreString( "avg" ), hist.average() );
+   dict->put( new CoreString( "max" ), hist.m_max );
+   dict->put( new CoreString( "buckets" ), buckets );
+   dict->put( new CoreString( "limits" ), limits );
+   return new CoreDict( dict );
+}
+
+/*#
+   @method stats GC
+   @brief Returns the statistics collected by the garbage collector.
+   @return A dictionary with the collected statistics.
+
+   The statistics are collected since the program start or since the
+   last call to @a GC.resetStats. Times are in seconds, memory in bytes.
+   The returned dictionary contains the following entries:
+   - uptime: time since the statistics were started.
+   - sweeps: number of complete collection loops.
+   - marks: number of VM mark loops.
+   - markTime, sweepTime: histograms of the durations of marks and sweeps.
+     Each is a dictionary with samples, total, avg and max, the count of
+     durations in each bucket ("buckets") and the upper limit of each bucket
+     but the last ("limits").
+   - freedItems, freedMem: items and memory reclaimed by the sweeps.
+   - lastFreedItems, lastFreedMem: items and memory reclaimed by the last sweep.
+   - usedMem, items: memory and items currently alive.
+   - allocated: memory allocated since the program start, including the released one.
+   - allocRate: bytes allocated per second between the last two sweeps.
+   - blockedTime: time the VMs spent blocked by the collector to be marked.
+   - waitTime: time the VMs spent waiting for the collections they requested.
+   - th_normal, th_active: current collection thresholds.
+   - rampChanges: number of threshold (or adjust mode) changes.
+   - ramp: the most recent threshold changes, latest first, each
+     a dictionary with time, mode, normal and active.
+   - vm: statistics of the calling virtual machine: blockedTime,
+     waitTime and liveItems (the items found alive by the last sweep and
+     last marked from this VM).
+*/
+
+FALCON_FUNC  GC_stats( ::Falcon::VMachine *vm )
+{
+   GCStats stats;
+   memPool->stats( stats );
+
+   CoreArray* ramp = new CoreArray;
+   const GCStats::RampChange* change;
+   for ( uint32 i = 0; ( change = stats.rampChangeAt( i ) ) != 0; ++i )
+   {
+      LinearDict* chd = new LinearDict( 4 );
+      chd->put( new CoreString( "time" ), change->m_time );
+      chd->put( new CoreString( "mode" ), (int64) change->m_mode );
+      chd->put( new CoreString( "normal" ), (int64) change->m_normal );
+      chd->put( new CoreString( "active" ), (int64) change->m_active );
+      ramp->append( new CoreDict( chd ) );
+   }
+
+   LinearDict* vmd = new LinearDict( 3 );
+   vmd->put( new CoreString( "blockedTime" ), vm->gcBlockedTime() );
+   vmd->put( new CoreString( "waitTime" ), vm->gcWaitTime() );
+   vmd->put( new CoreString( "liveItems" ), (int64) vm->gcLiveItems() );
+
+   LinearDict* dict = new LinearDict( 22 );
+   dict->put( new CoreString( "uptime" ), Sys::_seconds() - stats.m_started );
+   dict->put( new CoreString( "sweeps" ), (int64) stats.m_sweeps );
+   dict->put( new CoreString( "marks" ), (int64) stats.m_marks );
+   dict->put( new CoreString( "markTime" ), s_histogram( stats.m_markTime ) );
+   dict->put( new CoreString( "sweepTime" ), s_histogram( stats.m_sweepTime ) );
+   dict->put( new CoreString( "freedItems" ), (int64) stats.m_freedItems );
+   dict->put( new CoreString( "freedMem" ), (int64) stats.m_freedMem );
+   dict->put( new CoreString( "lastFreedItems" ), (int64) stats.m_lastFreedItems );
+   dict->put( new CoreString( "lastFreedMem" ), (int64) stats.m_lastFreedMem );
+   dict->put( new CoreString( "usedMem" ), (int64) stats.m_liveMem );
+   dict->put( new CoreString( "items" ), (int64) stats.m_liveItems );
+   dict->put( new CoreString( "allocated" ), (int64) stats.m_allocated );
+   dict->put( new CoreString( "allocRate" ), stats.m_allocRate );
+   dict->put( new CoreString( "blockedTime" ), stats.m_blockedTime );
+   dict->put( new CoreString( "waitTime" ), stats.m_waitTime );
+   dict->put( new CoreString( "th_normal" ), (int64) stats.m_thresholdNormal );
+   dict->put( new CoreString( "th_active" ), (int64) stats.m_thresholdActive );
+   dict->put( new CoreString( "rampChanges" ), (int64) stats.m_rampChanges );
+   dict->put( new CoreString( "ramp" ), ramp );
+   dict->put( new CoreString( "vm" ), new CoreDict( vmd ) );
+   vm->retval( new CoreDict( dict ) );
+}
+
+/*#
+   @method resetStats GC
+   @brief Clears the statistics collected by the garbage collector.
+   @see GC.stats
+*/
+
+FALCON_FUNC  GC_resetStats( ::Falcon::VMachine *vm )
+{
+   memPool->resetStats();
+}
+
+/*#
+   @method heapStart GC
+   @brief Starts the allocation-site heap profiler.
+   @optparam interval Bytes allocated between two samples (defaults to 131072,
+      or to the last interval set).
+
+   From now on, one allocation every @b interval bytes is sampled and
+   recorded along with the script function and line performing it. After
+   each collection loop, the live objects are also counted by type.
+   The profile can be read through @a GC.heapData and written through
+   @a GC.heapWrite.
+
+   The profiler is shared by all the virtual machines in the process.
+   The data collected up to now is kept; use @a GC.heapReset to discard it.
+*/
+
+FALCON_FUNC  GC_heapStart( ::Falcon::VMachine *vm )
+{
+   Item *i_interval = vm->param(0);
+   if ( i_interval != 0 && ! i_interval->isNil() &&
+      ( ! i_interval->isOrdinal() || i_interval->forceInteger() <= 0 ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .origin( e_orig_runtime )
+         .extra( "[N>0]" ) );
+   }
+
+   HeapProfiler::install()->start( i_interval == 0 || i_interval->isNil() ?
+         0 : (uint32) i_interval->forceInteger() );
+}
+
+/*#
+   @method heapStop GC
+   @brief Stops sampling allocations.
+
+   The blocks sampled up to now are still accounted: the sites keep
+   being updated as the blocks are freed.
+*/
+
+FALCON_FUNC  GC_heapStop( ::Falcon::VMachine *vm )
+{
+   if ( heapProfiler != 0 )
+      heapProfiler->stop();
+}
+
+/*#
+   @method heapReset GC
+   @brief Discards the data collected by the heap profiler.
+*/
+
+FALCON_FUNC  GC_heapReset( ::Falcon::VMachine *vm )
+{
+   if ( heapProfiler != 0 )
+      heapProfiler->reset();
+}
+
+/*#
+   @method heapData GC
+   @brief Returns the data collected by the heap profiler.
+   @return A dictionary with the heap profile, or nil if the profiler was never started.
+
+   The returned dictionary has two entries:
+   - "sites": for each allocation site ("module.function:line", followed
+     by the native function called from there, if any), an array with
+     the estimated live bytes, the estimated live blocks and the estimated
+     bytes allocated since the profiler was started.
+   - "types": for each type of object (CoreString, CoreArray, CoreDict,
+     CoreObject, MemBuf and other), an array with the count of live
+     objects and the estimated bytes they hold, as found after the
+     last collection loop.
+*/
+
+FALCON_FUNC  GC_heapData( ::Falcon::VMachine *vm )
+{
+   if ( heapProfiler == 0 )
+      vm->retnil();
+   else
+      vm->retval( heapProfiler->toDict() );
+}
+
+/*#
+   @method heapWrite GC
+   @brief Writes a snapshot of the heap profile.
+   @param stream The stream where to write the snapshot.
+   @return false if the profiler was never started, true otherwise.
+   @raise IoError on stream error.
+
+   The snapshot lists a site per line, in alphabetical order, with the
+   estimated live bytes, live blocks and allocated bytes separated by
+   tabs; then the live objects and bytes of each type. Two snapshots
+   can be compared with a plain diff to find the sites that grew.
+*/
+
+FALCON_FUNC  GC_heapWrite( ::Falcon::VMachine *vm )
+{
+   Item *i_stream = vm->param(0);
+   if( i_stream == 0 || ! i_stream->isObject() || ! i_stream->asObjectSafe()->derivedFrom( "Stream" ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .origin( e_orig_runtime )
+         .extra( "Stream" ) );
+   }
+
+   if ( heapProfiler == 0 )
+   {
+      vm->regA().setBoolean( false );
+      return;
+   }
+
+   Stream *stream = (Stream *) i_stream->asObject()->getUserData();
+   if ( ! heapProfiler->writeSnapshot( stream ) )
+   {
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+         .origin( e_orig_runtime )
+         .sysError( (uint32) stream->lastError() ) );
+   }
+
+   vm->regA().setBoolean( true );
+}
+
 // Reflective path method
 void GC_usedMem_rfrom(CoreObject *instance, void *user_data, Item &property, const PropEntry& )
 {
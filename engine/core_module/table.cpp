@@ -486,6 +486,7 @@ FALCON_FUNC  Table_set ( ::Falcon::VMachine *vm )
 
    page->at(pos) = element;
    element->table( vm->self().asObject() );
+   table->changed();
    vm->retval( element );
 }
 
@@ -591,7 +592,6 @@ FALCON_FUNC  Table_find ( ::Falcon::VMachine *vm )
    }
 
    CoreArray* page = table->currentPage();
-   uint32 pos = CoreTable::noitem;
 
    // the easy way
    // must be a future binding. find it.
@@ -603,14 +603,7 @@ FALCON_FUNC  Table_find ( ::Falcon::VMachine *vm )
    }
 
    Item value = *i_value; // cache the item, as we may loose the stack
-   for ( uint32 i = 0; i < page->length(); i++ )
-   {
-      if( page->at(i).asArray()->at(col) == value )
-      {
-         pos = i;
-         break;
-      }
-   }
+   uint32 pos = table->findRow( col, value );
 
    if ( pos == CoreTable::noitem )
    {
@@ -696,6 +689,7 @@ FALCON_FUNC  Table_insert ( ::Falcon::VMachine *vm )
 
    page->insert( Item(element), pos );
    element->table( vm->self().asObject() );
+   table->changed();
 }
 
 
@@ -734,6 +728,7 @@ FALCON_FUNC  Table_append ( ::Falcon::VMachine *vm )
 
    page->insert( Item(element), page->length() );
    element->table( vm->self().asObject() );
+   table->changed();
 }
 
 /*#
@@ -775,6 +770,7 @@ FALCON_FUNC  Table_remove ( ::Falcon::VMachine *vm )
    CoreArray *rem = (*page)[pos].asArray();
    //rem->table(0);
    page->remove( pos );
+   table->changed();
    vm->retval(rem);
 }
 
@@ -920,6 +916,13 @@ FALCON_FUNC  Table_removeColumn ( ::Falcon::VMachine *vm )
    table->removeColumn( colpos );
 }
 
+static void table_choice_select( VMachine *vm, CoreTable *table, uint32 row )
+{
+   CoreArray *winner = table->currentPage()->at( row ).asArray();
+   winner->tablePos( row );
+   internal_get_item( table, winner, vm, vm->local(3) );
+}
+
 static bool table_choice_next( Falcon::VMachine *vm )
 {
    CoreTable *table = static_cast<CoreTable *>( vm->self().asObject()->getUserData() );
@@ -928,117 +931,112 @@ static bool table_choice_next( Falcon::VMachine *vm )
    uint32 row = (uint32) vm->local(1)->forceInteger();
    uint32 end = (uint32) vm->local(2)->forceInteger();
 
-   // has the evaluation function just asked us to stop?
-   if( vm->regA().isOob() )
+   // a bit paranoid, but users may really screw up the table.
+   if ( end > page.length() || end - start > table->biddingsSize() ) {
+      throw new AccessError( ErrorParam( e_continue_out, __LINE__ )
+      .origin( e_orig_runtime )
+      .extra( Engine::getMessage( rtl_broken_table ) ) );
+   }
+
+   numeric *biddings = table->biddings();
+
+   // are we returning from an evaluation call?
+   if ( vm->local(5)->isTrue() )
    {
-      // in case of just row end, A can't be nil as the function has
-      if( vm->regA().isNil() )
+      vm->local(5)->setBoolean( false );
+
+      // has the evaluation function just asked us to stop?
+      if( vm->regA().isOob() )
       {
-         vm->regA().setOob(false);
-      }
-      else {
-         // get the winner
-         CoreArray *winner = page[row-1].asArray();
-         winner->tablePos( row-1 );
-         internal_get_item( table, winner, vm, vm->local(3) );
+         if( vm->regA().isNil() )
+            vm->regA().setOob( false );
+         else
+            table_choice_select( vm, table, row - 1 );
+
+         // we're done, don't call us anymore
+         return false;
       }
 
-      // we're done, don't call us anymore
-      return false;
+      biddings[row - 1 - start] = vm->regA().forceNumeric();
    }
-   else if ( start != row ) {
-      // we have a bidding
-      uint32 pos = row - start;
 
-      // a bit paranoid, but users may really screw up the table.
-      if ( pos > table->biddingsSize() ) {
-         throw new AccessError( ErrorParam( e_continue_out, __LINE__ )
-         .origin( e_orig_runtime )
-         .extra( Engine::getMessage( rtl_broken_table ) ) );
-      }
+   // do we have to call a function or an item in the row?
+   Item calling = *vm->local(4);
+
+   while( row < end )
+   {
+      CoreArray *rowArr = page[row].asArray();
+      rowArr->tablePos( row ); // save the position, in case is needed by our evaluator
 
-      numeric *biddings = table->biddings();
-      biddings[pos-1] = vm->regA().forceNumeric();
+      if( calling.isInteger() )
+      {
+         // column in the table.
+         Item ret = rowArr->at( (uint32) calling.asInteger() );
 
-      // is the bidding step over?
-      if( pos == end - start) {
-         uint32 maxrow = CoreTable::noitem;
+         if ( ret.isNil() && ! ret.isOob() )
+            ret = *table->getHeaderData((uint32) calling.asInteger());
 
-         // our threshold is 0. If no item meets the requirement, we return nil
-         numeric maxval = 0.0;
-         // but take also the first row in the loop, to update maxval
-         for ( pos = 0; pos < end - start; pos ++ )
+         // numbers are final values, and nil excludes the row; no need to call.
+         if ( ret.isOrdinal() )
          {
-            if( biddings[pos] > maxval )
-            {
-               maxrow = pos + start;
-               maxval = biddings[pos];
-            }
+            biddings[row++ - start] = ret.forceNumeric();
+            continue;
          }
 
-         // no winner?
-         if ( maxrow == CoreTable::noitem )
+         if ( ret.isNil() )
          {
-            vm->retnil();
+            biddings[row++ - start] = -1.0;
+            continue;
          }
-         else {
-            // we have a winner.
-            CoreArray *winner = page[row-1].asArray();
-            winner->tablePos( row-1 );
-            internal_get_item( table, page[maxrow].asArray(), vm, vm->local(3) );
+
+         // eventually methodize.
+         if ( ret.isFunction() )
+         {
+            ret.setMethod( rowArr, ret.asFunction() );
+            vm->local(1)->setInteger( row + 1 );
+            vm->local(5)->setBoolean( true );
+            vm->callFrame( ret, 0 );
+            return true;
          }
 
-         // we're done, don't call us anymore
-         return false;
-      }
-   }
+         if ( ! ret.isCallable() )
+         {
+            throw new AccessError( ErrorParam( e_non_callable, __LINE__ )
+               .origin( e_orig_runtime )
+               .extra( Engine::getMessage( rtl_uncallable_col ) ) );
+         }
 
-   // nothing special to do: just call the desired function with our row.
-   Item &rowItem = page[row];
-   rowItem.asArray()->tablePos(row); // save the position, in case is needed by our evaluator
+         calling = ret;
+      }
 
-   // update counter for next loop
-   vm->local(1)->setInteger( row + 1 );
+      // call the evaluator with our row, and come back when the frame is done.
+      vm->local(1)->setInteger( row + 1 );
+      vm->local(5)->setBoolean( true );
+      vm->pushParameter( rowArr );
+      vm->callFrame( calling, 1 );
+      return true;
+   }
 
-   // do we have to call a function or an item in the row?
-   Item &calling = *vm->local(4);
-   if( calling.isInteger() )
+   // all the rows are evaluated; our threshold is 0.
+   // If no item meets the requirement, we return nil
+   uint32 maxrow = CoreTable::noitem;
+   numeric maxval = 0.0;
+   for ( uint32 pos = 0; pos < end - start; pos ++ )
    {
-      // colunn in the table.
-      Item ret = page[row].asArray()->at( (uint32) calling.asInteger() );
-
-      if ( ret.isNil() && ! ret.isOob() )
-         ret = *table->getHeaderData((uint32) calling.asInteger());
-
-      // eventually methodize.
-      if ( ret.isFunction() )
-      {
-         ret.setMethod( page[row].asArray(), ret.asFunction() );
-         vm->callFrame( ret, 0 );
-         return true;
-      }
-
-      if ( ret.isCallable() )
+      if( biddings[pos] > maxval )
       {
-         vm->pushParameter( page[row] );
-         vm->callFrame( ret, 1 );
-         return true;
+         maxrow = pos + start;
+         maxval = biddings[pos];
       }
-
-      // else, the item is not callable! Raise an error.
-      // (it's ok also if we pushed the parameter; stack is unwinded).
-      throw new AccessError( ErrorParam( e_non_callable, __LINE__ )
-         .origin( e_orig_runtime )
-         .extra( Engine::getMessage( rtl_uncallable_col ) ) );
-   }
-   else {
-      // function provided externally
-      vm->pushParameter( page[row] );
-      vm->callFrame( calling, 1 );
    }
 
-   // call us again when the frame is done.
-   return true;
+   if ( maxrow == CoreTable::noitem )
+      vm->retnil();
+   else
+      table_choice_select( vm, table, maxrow );
+
+   // we're done, don't call us anymore
+   return false;
 }
 
 static void internal_bind_or_choice( VMachine *vm )
@@ -1097,6 +1095,7 @@ static void internal_bind_or_choice( VMachine *vm )
    vm->local(1)->setInteger( (int64) start );
    vm->local(2)->setInteger( (int64) end );
    vm->local(3)->setInteger( (int64) colpos );
+   vm->local(5)->setBoolean( false );
 
    table->reserveBiddings( end - start + 1);
 
@@ -1159,7 +1158,7 @@ FALCON_FUNC  Table_choice ( ::Falcon::VMachine *vm )
    }
 
    // prepare local stack and function pointer
-   vm->addLocals(5);
+   vm->addLocals(6);
    *vm->local(4) = *vm->param(0);
 
    internal_bind_or_choice( vm );
@@ -1215,7 +1214,7 @@ FALCON_FUNC  Table_bidding ( ::Falcon::VMachine *vm )
       return;
 
    // prepare local stack and data pointer
-   vm->addLocals(5);
+   vm->addLocals(6);
    vm->local(4)->setInteger( colpos );
 
    internal_bind_or_choice( vm );
@@ -1446,6 +1445,7 @@ FALCON_FUNC  Table_resetColumn ( ::Falcon::VMachine *vm )
    {
       page[i].asArray()->at(colpos) = *i_value;
    }
+   table->changed();
 
    if ( i_row == 0 )
       return;
@@ -1497,6 +1497,7 @@ FALCON_FUNC  Table_resetColumn ( ::Falcon::VMachine *vm )
       page[start].asArray()->at(colpos) = *i_resVal;
       start += step;
    }
+   table->changed();
 }
 
 
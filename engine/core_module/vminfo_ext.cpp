@@ -15,6 +15,8 @@
 #include "core_module.h"
 #include <falcon/stackframe.h>
 #include <falcon/sys.h>
+#include <falcon/profiler.h>
+#include <falcon/vmcounters.h>
 
 /*#
    @beginmodule core
@@ -286,6 +288,219 @@ FALCON_FUNC vmRelativePath( ::Falcon::VMachine *vm )
    vm->retval( ret );
 }
 
+/*#
+   @function vmProfileStart
+   @inset vminfo
+   @brief Starts the sampling profiler.
+   @optparam rate Samples taken per second (defaults to 100).
+
+   The virtual machine records the stack of the running coroutine at
+   the given rate, discarding the data collected by previous profiling
+   sessions. The stack is checked every few thousands of VM operations,
+   so very short functions may be under-represented, and a long native
+   call is accounted to the script line calling it.
+
+   The collected data can be retreived through @a vmProfileWrite.
+*/
+FALCON_FUNC vmProfileStart( ::Falcon::VMachine *vm )
+{
+   Item *i_rate = vm->param(0);
+   if( i_rate != 0 && ! i_rate->isNil() && ( ! i_rate->isOrdinal() || i_rate->forceInteger() <= 0 ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .origin( e_orig_runtime )
+         .extra( "[N>0]" ) );
+   }
+
+   uint32 rate = i_rate == 0 || i_rate->isNil() ? 100 : (uint32) i_rate->forceInteger();
+   Profiler* prof = vm->profiler();
+   if ( prof == 0 )
+      vm->profiler( new Profiler( rate ) );
+   else
+   {
+      prof->reset();
+      prof->start( rate );
+   }
+}
+
+/*#
+   @function vmProfileStop
+   @inset vminfo
+   @brief Stops the sampling profiler.
+   @return Number of samples collected since the profiler was started.
+
+   The collected data is kept, and can be written through @a vmProfileWrite.
+*/
+FALCON_FUNC vmProfileStop( ::Falcon::VMachine *vm )
+{
+   Profiler* prof = vm->profiler();
+   if ( prof == 0 )
+   {
+      vm->retval( (int64) 0 );
+      return;
+   }
+
+   prof->stop();
+   vm->retval( (int64) prof->samples() );
+}
+
+/*#
+   @function vmProfileWrite
+   @inset vminfo
+   @brief Writes the data collected by the sampling profiler.
+   @param stream The stream where to write the data.
+   @optparam table If true, write a per-function table instead of collapsed stacks.
+   @return True if profiling data was available, false otherwise.
+   @raise IoError on error writing the stream.
+
+   By default, the stacks are written in collapsed format: one line for
+   each distinct stack, listing the frames from the outermost, separated
+   by semicolons, and the samples it received, as in
+   @code
+      main.__main__:20;main.fib:3;main.fib:3 112
+   @endcode
+   Each frame is indicated by its module, function and line. This format
+   can be turned into a flame graph by the common flame graph tools.
+
+   If @b table is true, the stream receives a table of the samples taken
+   in each function (self) and of those where each function appears
+   anywhere in the stack (total), most expensive functions first.
+*/
+FALCON_FUNC vmProfileWrite( ::Falcon::VMachine *vm )
+{
+   Item *i_stream = vm->param(0);
+   Item *i_table = vm->param(1);
+   if( i_stream == 0 || ! i_stream->isObject() || ! i_stream->asObjectSafe()->derivedFrom( "Stream" ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .origin( e_orig_runtime )
+         .extra( "Stream,[B]" ) );
+   }
+
+   Profiler* prof = vm->profiler();
+   if ( prof == 0 )
+   {
+      vm->regA().setBoolean( false );
+      return;
+   }
+
+   Stream *stream = (Stream *) i_stream->asObject()->getUserData();
+   bool bOk = i_table != 0 && i_table->isTrue() ?
+         prof->writeTable( stream ) : prof->writeCollapsed( stream );
+   if ( ! bOk )
+   {
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+         .origin( e_orig_runtime )
+         .sysError( (uint32) stream->lastError() ) );
+   }
+
+   vm->regA().setBoolean( true );
+}
+
+/*#
+   @function vmCountersStart
+   @inset vminfo
+   @brief Starts counting the operations performed by the virtual machine.
+
+   From now on, the virtual machine counts the executed opcodes and the
+   calls to each function, along with the time spent in each function,
+   the calls issued from each line and towards each other function.
+   If the counters are already active, the data collected so far is
+   discarded.
+
+   Counting slows down function calls; the collected data can be read
+   through @a vmCountersData or written through @a vmCountersWrite.
+*/
+FALCON_FUNC vmCountersStart( ::Falcon::VMachine *vm )
+{
+   if ( vm->counters() == 0 )
+      vm->counters( new VMCounters );
+   else
+      vm->counters()->reset();
+}
+
+/*#
+   @function vmCountersStop
+   @inset vminfo
+   @brief Stops counting the operations performed by the virtual machine.
+   @return The collected data, as returned by @a vmCountersData, or nil if
+      the counters were not active.
+*/
+FALCON_FUNC vmCountersStop( ::Falcon::VMachine *vm )
+{
+   VMCounters* cnt = vm->counters();
+   if ( cnt == 0 )
+   {
+      vm->retnil();
+      return;
+   }
+
+   vm->retval( cnt->toDict() );
+   vm->counters( 0 );
+}
+
+/*#
+   @function vmCountersData
+   @inset vminfo
+   @brief Returns the data collected by the VM counters.
+   @return A dictionary with the collected data, or nil if the counters are not active.
+
+   The returned dictionary has two entries:
+   - "ops": the number of executions of each opcode, by mnemonic;
+   - "functions": a dictionary of the called functions, by module and
+     function name (as "main.func"). Each entry is a dictionary with
+     "calls" (number of calls), "time" (inclusive time in seconds),
+     "sites" (calls performed from each line of the function) and
+     "callees" (calls performed towards each other function).
+*/
+FALCON_FUNC vmCountersData( ::Falcon::VMachine *vm )
+{
+   VMCounters* cnt = vm->counters();
+   if ( cnt == 0 )
+      vm->retnil();
+   else
+      vm->retval( cnt->toDict() );
+}
+
+/*#
+   @function vmCountersWrite
+   @inset vminfo
+   @brief Writes the data collected by the VM counters as JSON.
+   @param stream The stream where to write the data.
+   @return True if the counters are active, false otherwise.
+   @raise IoError on error writing the stream.
+
+   The JSON document has the same layout of the dictionary returned by
+   @a vmCountersData.
+*/
+FALCON_FUNC vmCountersWrite( ::Falcon::VMachine *vm )
+{
+   Item *i_stream = vm->param(0);
+   if( i_stream == 0 || ! i_stream->isObject() || ! i_stream->asObjectSafe()->derivedFrom( "Stream" ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .origin( e_orig_runtime )
+         .extra( "Stream" ) );
+   }
+
+   VMCounters* cnt = vm->counters();
+   if ( cnt == 0 )
+   {
+      vm->regA().setBoolean( false );
+      return;
+   }
+
+   Stream *stream = (Stream *) i_stream->asObject()->getUserData();
+   if ( ! cnt->writeJSON( stream ) )
+   {
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+         .origin( e_orig_runtime )
+         .sysError( (uint32) stream->lastError() ) );
+   }
+
+   vm->regA().setBoolean( true );
+}
+
 }
 }
 
@@ -146,6 +146,7 @@ void CoreArray::setProperty( const String &name, const Item &data )
       if ( pos != CoreTable::noitem )
       {
          *(*this)[pos].dereference() = data;
+         table->changed();
          return;
       }
    }
@@ -309,8 +310,18 @@ CoreArray *CoreArray::clone() const
 }
 
 
+void CoreArray::changed()
+{
+   if ( m_table != 0 )
+      reinterpret_cast<CoreTable *>( m_table->getFalconData() )->changed();
+}
+
+
 void CoreArray::writeIndex( const Item &index, const Item &target )
 {
+   // table rows must invalidate the table indexes.
+   changed();
+
   switch ( index.type() )
    {
       case FLC_ITEM_INT:
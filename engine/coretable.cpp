@@ -19,8 +19,178 @@
 #include <falcon/itemtraits.h>
 #include <falcon/vm.h>
 
+#include <stdlib.h>
+
+// Pages smaller than this are always searched linearly.
+#define CORETABLE_INDEX_THRESHOLD  64
+
 namespace Falcon {
 
+//===============================================================
+// Column index
+//
+
+typedef struct tag_CoreTableIntEntry
+{
+   int64 key;
+   uint32 row;
+} CoreTableIntEntry;
+
+extern "C" {
+   static int coretable_intEntryCmp( const void *a, const void *b )
+   {
+      const CoreTableIntEntry *ea = (const CoreTableIntEntry *) a;
+      const CoreTableIntEntry *eb = (const CoreTableIntEntry *) b;
+
+      if ( ea->key != eb->key )
+         return ea->key < eb->key ? -1 : 1;
+      return ea->row < eb->row ? -1 : ( ea->row > eb->row ? 1 : 0 );
+   }
+}
+
+/** Index of a column in the current page of a table.
+
+   Integer columns are indexed through a vector of key/row pairs sorted
+   by key and row, so that a binary search finds the first row having a
+   given value; string columns are indexed through a map of the first
+   row where each string appears.
+
+   Columns having other types, or mixed types, are marked as not
+   indexable until the table changes again.
+*/
+class CoreTableIndex: public BaseAlloc
+{
+public:
+   /** Version of the table this index refers to. */
+   uint32 m_version;
+   /** True when the column has already been searched at this version. */
+   bool m_searched;
+   /** FLC_ITEM_INT or FLC_ITEM_STRING when built, FLC_ITEM_NIL when not built yet
+       and FLC_ITEM_INVALID if the column can't be indexed. */
+   byte m_type;
+
+   CoreTableIntEntry *m_ints;
+   uint32 m_count;
+   Map *m_strings;
+
+   CoreTableIndex( uint32 version ):
+      m_version( version ),
+      m_searched( false ),
+      m_type( FLC_ITEM_NIL ),
+      m_ints( 0 ),
+      m_count( 0 ),
+      m_strings( 0 )
+   {}
+
+   ~CoreTableIndex() { reset( 0 ); }
+
+   void reset( uint32 version );
+   void build( CoreArray *page, uint32 col );
+   uint32 find( const Item &value ) const;
+};
+
+
+void CoreTableIndex::reset( uint32 version )
+{
+   if ( m_ints != 0 )
+   {
+      memFree( m_ints );
+      m_ints = 0;
+   }
+
+   delete m_strings;
+   m_strings = 0;
+
+   m_count = 0;
+   m_type = FLC_ITEM_NIL;
+   m_searched = false;
+   m_version = version;
+}
+
+
+void CoreTableIndex::build( CoreArray *page, uint32 col )
+{
+   uint32 len = page->length();
+   m_type = FLC_ITEM_INVALID;
+
+   // check that the column has an uniform, indexable type.
+   byte type = FLC_ITEM_NIL;
+   for( uint32 i = 0; i < len; i++ )
+   {
+      const Item &row = page->at( i );
+      if ( ! row.isArray() || row.asArray()->length() <= col )
+         return;
+
+      const Item &cell = row.asArray()->at( col );
+      if ( i == 0 )
+         type = cell.type();
+
+      if ( cell.type() != type || ( type != FLC_ITEM_INT && type != FLC_ITEM_STRING ) )
+         return;
+   }
+
+   if ( type == FLC_ITEM_INT )
+   {
+      m_ints = (CoreTableIntEntry *) memAlloc( len * sizeof( CoreTableIntEntry ) );
+      for( uint32 i = 0; i < len; i++ )
+      {
+         m_ints[i].key = page->at( i ).asArray()->at( col ).asInteger();
+         m_ints[i].row = i;
+      }
+
+      qsort( m_ints, len, sizeof( CoreTableIntEntry ), coretable_intEntryCmp );
+      m_count = len;
+   }
+   else
+   {
+      m_strings = new Map( &traits::t_string(), &traits::t_int() );
+      for( uint32 i = 0; i < len; i++ )
+      {
+         String *str = page->at( i ).asArray()->at( col ).asString();
+         // keep only the first row where the string appears.
+         if ( m_strings->find( str ) == 0 )
+         {
+            int32 row = (int32) i;
+            m_strings->insert( str, &row );
+         }
+      }
+   }
+
+   m_type = type;
+}
+
+
+uint32 CoreTableIndex::find( const Item &value ) const
+{
+   if ( m_type == FLC_ITEM_INT )
+   {
+      int64 key = value.asInteger();
+      uint32 lo = 0;
+      uint32 hi = m_count;
+
+      while( lo < hi )
+      {
+         uint32 mid = lo + ( hi - lo ) / 2;
+         if ( m_ints[mid].key < key )
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+
+      if ( lo < m_count && m_ints[lo].key == key )
+         return m_ints[lo].row;
+   }
+   else
+   {
+      int32 *row = (int32 *) m_strings->find( value.asString() );
+      if ( row != 0 )
+         return (uint32) *row;
+   }
+
+   return CoreTable::noitem;
+}
+
+
 //===============================================================
 
 
@@ -32,7 +202,9 @@ CoreTable::CoreTable():
    m_currentPageId(noitem),
    m_order(noitem),
    m_biddingVals(0),
-   m_biddingSize(0)
+   m_biddingSize(0),
+   m_indexes(&traits::t_voidp()),
+   m_version(0)
 {
 }
 
@@ -44,12 +216,16 @@ CoreTable::CoreTable( const CoreTable& other ):
    m_currentPageId( other.m_currentPageId ),
    m_order( other.m_order ),
    m_biddingVals(0),
-   m_biddingSize(0)
+   m_biddingSize(0),
+   m_indexes(&traits::t_voidp()),
+   m_version(0)
 {
 }
 
 CoreTable::~CoreTable()
 {
+   dropIndexes();
+
    if ( m_biddingVals != 0 ) {
       memFree( m_biddingVals );
       m_biddingVals = 0;
@@ -96,6 +272,7 @@ bool CoreTable::setHeader( const ItemArray& header )
    }
 
    m_order = len;
+   changed();
    return true;
 }
 
@@ -123,6 +300,7 @@ bool CoreTable::insertRow(  CoreArray *ca, uint32 pos, uint32 page )
    else
       tgt->append( ca );
 
+   changed();
    return true;
 }
 
@@ -146,6 +324,7 @@ bool CoreTable::removeRow( uint32 pos, uint32 page )
    if ( pos >= tgt->length() )
       return false;
    tgt->remove( pos );
+   changed();
    return true;
 }
 
@@ -211,6 +390,7 @@ bool CoreTable::insertPage( CoreObject *self, CoreArray *data, uint32 pos )
    if ( m_currentPageId >= pos )
       m_currentPageId++;
 
+   changed();
    return true;
 }
 
@@ -240,6 +420,7 @@ bool CoreTable::removePage( uint32 pos )
    if( m_currentPageId > pos )
       m_currentPageId--;
 
+   changed();
    return true;
 }
 
@@ -288,6 +469,73 @@ const Item &CoreTable::back() const
 
 
 
+uint32 CoreTable::findRow( uint32 col, const Item &value )
+{
+   CoreArray *pg = currentPage();
+   if ( pg == 0 || col >= m_order )
+      return noitem;
+
+   if ( pg->length() >= CORETABLE_INDEX_THRESHOLD && ( value.isInteger() || value.isString() ) )
+   {
+      // columns may have been added or removed.
+      if ( m_indexes.size() != m_order )
+      {
+         dropIndexes();
+         for( uint32 i = 0; i < m_order; i++ )
+            m_indexes.push( 0 );
+      }
+
+      CoreTableIndex *idx = *(CoreTableIndex **) m_indexes.at( col );
+      if ( idx == 0 )
+      {
+         idx = new CoreTableIndex( m_version );
+         m_indexes.set( idx, col );
+      }
+      else if ( idx->m_version != m_version )
+         idx->reset( m_version );
+
+      // Build the index only for columns searched more than once.
+      if ( idx->m_type == FLC_ITEM_NIL && idx->m_searched )
+         idx->build( pg, col );
+      idx->m_searched = true;
+
+      if ( idx->m_type == value.type() )
+      {
+         uint32 pos = idx->find( value );
+         if ( pos == noitem )
+            return noitem;
+
+         // a row changed without notifying the table falls back to the scan.
+         if ( pos < pg->length() )
+         {
+            const Item &row = pg->at( pos );
+            if ( row.isArray() && row.asArray()->length() > col
+                 && row.asArray()->at( col ) == value )
+               return pos;
+         }
+
+         idx->m_type = FLC_ITEM_INVALID;
+      }
+   }
+
+   for ( uint32 i = 0; i < pg->length(); i++ )
+   {
+      if ( pg->at(i).asArray()->at(col) == value )
+         return i;
+   }
+
+   return noitem;
+}
+
+
+void CoreTable::dropIndexes()
+{
+   for( uint32 i = 0; i < m_indexes.size(); i++ )
+      delete *(CoreTableIndex **) m_indexes.at( i );
+   m_indexes.resize( 0 );
+}
+
+
 CoreTable *CoreTable::clone() const
 {
    return new CoreTable( *this );
@@ -298,6 +546,7 @@ void CoreTable::clear()
 {
    if ( m_currentPage != 0 )
       m_currentPage->resize(0);
+   changed();
 }
 
 
@@ -375,6 +624,7 @@ void CoreTable::insertColumn( uint32 pos, const String &name, const Item &data,
    }
 
    m_order++;
+   changed();
    // add the column data.
    m_headerData.insert( (void *) &data, pos );
 
@@ -425,6 +675,7 @@ bool CoreTable::removeColumn( uint32 pos )
    // add the column data.
    m_headerData.remove( pos );
    m_order--;
+   changed();
 
    // now, for each page, for each row, insert the default item.
    for( uint32 pid = 0; pid < m_pages.size(); pid++ )
@@ -47,7 +47,7 @@ namespace Falcon
       return m_watches;
    }
 
-   const ItemArray& DebugVMachine::stackTrace() const
+   const StackWindow& DebugVMachine::stackTrace() const
    {
       return stack();
    }
@@ -31,6 +31,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <utime.h>
 #include <errno.h>
 #include <cstring>
 #include <stdio.h>
@@ -259,6 +260,12 @@ bool fal_chmod( const String &fname, uint32 mode )
    return ret;
 }
 
+bool fal_touch( const String &fname )
+{
+   AutoCString filename( fname );
+   return ::utime( filename.c_str(), 0 ) == 0;
+}
+
 bool fal_chown( const String &fname, int32 owner )
 {
    AutoCString filename( fname );
@@ -389,6 +389,27 @@ bool fal_chmod( const String &fname, uint32 mode )
    return false;
 }
 
+bool fal_touch( const String &filename )
+{
+   String fname = filename;
+   Path::uriToWin( fname );
+
+   AutoWString wBuffer( fname );
+   HANDLE hFile = CreateFileW( wBuffer.w_str(), FILE_WRITE_ATTRIBUTES,
+         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+   if ( hFile == INVALID_HANDLE_VALUE )
+      return false;
+
+   SYSTEMTIME st;
+   FILETIME ft;
+   GetSystemTime( &st );
+   SystemTimeToFileTime( &st, &ft );
+   BOOL res = SetFileTime( hFile, NULL, NULL, &ft );
+   CloseHandle( hFile );
+   return res == TRUE;
+}
+
 bool fal_chown( const String &fname, int32 owner )
 {
    return false;
@@ -0,0 +1,65 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: filemap.cpp
+
+   Files mapped in memory.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:39:22 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/filemap.h>
+#include <falcon/mt.h>
+
+namespace Falcon {
+
+FileMap::FileMap( byte *data, uint64 size, bool bWritable, void *sysData ):
+   m_data( data ),
+   m_size( size ),
+   m_bWritable( bWritable ),
+   m_refCount( 1 ),
+   m_sysData( sysData )
+{
+}
+
+FileMap::~FileMap()
+{
+   unmap();
+}
+
+void FileMap::incref()
+{
+   atomicInc( m_refCount );
+}
+
+void FileMap::decref()
+{
+   if ( atomicDec( m_refCount ) == 0 )
+      delete this;
+}
+
+//=============================================================
+// Mapped memory buffer.
+//
+
+MappedMemBuf::MappedMemBuf( FileMap *map, uint64 offset, uint32 length ):
+   MemBuf( 1, map->data() + offset, length, 0 ),
+   MemBuf_1( map->data() + offset, length, 0 ),
+   m_map( map )
+{
+   m_map->incref();
+}
+
+MappedMemBuf::~MappedMemBuf()
+{
+   m_map->decref();
+}
+
+}
+
+/* end of filemap.cpp */
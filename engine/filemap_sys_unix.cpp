@@ -0,0 +1,90 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: filemap_sys_unix.cpp
+
+   Files mapped in memory - POSIX specific part.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:39:22 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/filemap.h>
+#include <falcon/autocstring.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace Falcon {
+
+FileMap *FileMap::map( const String &path, bool bWritable, int64 &fsError )
+{
+   AutoCString cfilename( path );
+
+   errno = 0;
+   int handle = ::open( cfilename.c_str(), bWritable ? O_RDWR : O_RDONLY );
+   if ( handle < 0 )
+   {
+      fsError = errno;
+      return 0;
+   }
+
+   struct stat st;
+   if ( ::fstat( handle, &st ) != 0 )
+   {
+      fsError = errno;
+      ::close( handle );
+      return 0;
+   }
+
+   // empty files can't be mapped, but they are perfectly valid.
+   void *data = 0;
+   if ( st.st_size > 0 )
+   {
+      data = ::mmap( 0, (size_t) st.st_size, PROT_READ | PROT_WRITE,
+            bWritable ? MAP_SHARED : MAP_PRIVATE, handle, 0 );
+
+      if ( data == MAP_FAILED )
+      {
+         fsError = errno;
+         ::close( handle );
+         return 0;
+      }
+   }
+
+   // the mapping stays valid after the file is closed.
+   ::close( handle );
+   fsError = 0;
+   return new FileMap( (byte *) data, (uint64) st.st_size, bWritable, 0 );
+}
+
+
+void FileMap::unmap()
+{
+   if ( m_data != 0 )
+   {
+      ::munmap( m_data, (size_t) m_size );
+      m_data = 0;
+   }
+}
+
+
+bool FileMap::sync()
+{
+   if ( m_data == 0 || ! m_bWritable )
+      return true;
+
+   return ::msync( m_data, (size_t) m_size, MS_SYNC ) == 0;
+}
+
+}
+
+/* end of filemap_sys_unix.cpp */
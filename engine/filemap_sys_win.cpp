@@ -0,0 +1,100 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: filemap_sys_win.cpp
+
+   Files mapped in memory - MS-Windows specific part.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:39:22 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/filemap.h>
+#include <falcon/path.h>
+#include <falcon/autowstring.h>
+
+#include <windows.h>
+
+namespace Falcon {
+
+FileMap *FileMap::map( const String &path, bool bWritable, int64 &fsError )
+{
+   String fname = path;
+   Path::uriToWin( fname );
+   AutoWString wstr( fname );
+
+   HANDLE hFile = CreateFileW( wstr.w_str(),
+         bWritable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+         FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+         FILE_ATTRIBUTE_NORMAL, NULL );
+
+   if ( hFile == INVALID_HANDLE_VALUE )
+   {
+      fsError = GetLastError();
+      return 0;
+   }
+
+   LARGE_INTEGER size;
+   if ( ! GetFileSizeEx( hFile, &size ) )
+   {
+      fsError = GetLastError();
+      CloseHandle( hFile );
+      return 0;
+   }
+
+   // empty files can't be mapped, but they are perfectly valid.
+   void *data = 0;
+   if ( size.QuadPart > 0 )
+   {
+      HANDLE hMap = CreateFileMapping( hFile, NULL,
+            bWritable ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, NULL );
+      if ( hMap == NULL )
+      {
+         fsError = GetLastError();
+         CloseHandle( hFile );
+         return 0;
+      }
+
+      data = MapViewOfFile( hMap, bWritable ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, 0 );
+      // the view keeps the mapping object alive.
+      CloseHandle( hMap );
+
+      if ( data == NULL )
+      {
+         fsError = GetLastError();
+         CloseHandle( hFile );
+         return 0;
+      }
+   }
+
+   CloseHandle( hFile );
+   fsError = 0;
+   return new FileMap( (byte *) data, (uint64) size.QuadPart, bWritable, 0 );
+}
+
+
+void FileMap::unmap()
+{
+   if ( m_data != 0 )
+   {
+      UnmapViewOfFile( m_data );
+      m_data = 0;
+   }
+}
+
+
+bool FileMap::sync()
+{
+   if ( m_data == 0 || ! m_bWritable )
+      return true;
+
+   return FlushViewOfFile( m_data, 0 ) != 0;
+}
+
+}
+
+/* end of filemap_sys_win.cpp */
@@ -0,0 +1,126 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: gcstats.cpp
+
+   Garbage collector telemetry.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:08:30 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Garbage collector telemetry.
+*/
+
+#include <falcon/gcstats.h>
+#include <falcon/string.h>
+#include <falcon/sys.h>
+
+#include <stdio.h>
+
+namespace Falcon {
+
+void GCStats::Histogram::add( numeric seconds )
+{
+   uint32 bucket = 0;
+   while( bucket < hist_size - 1 && seconds >= limit( bucket ) )
+      ++bucket;
+
+   ++m_count[ bucket ];
+   ++m_samples;
+   m_total += seconds;
+   if ( seconds > m_max )
+      m_max = seconds;
+}
+
+
+void GCStats::Histogram::reset()
+{
+   for ( uint32 i = 0; i < hist_size; ++i )
+      m_count[i] = 0;
+   m_samples = 0;
+   m_total = 0.0;
+   m_max = 0.0;
+}
+
+
+numeric GCStats::Histogram::limit( uint32 bucket )
+{
+   if ( bucket >= hist_size - 1 )
+      return 0.0;
+   return 0.00001 * (numeric)( 1 << bucket );
+}
+
+
+void GCStats::reset()
+{
+   m_started = Sys::_seconds();
+   m_sweeps = 0;
+   m_marks = 0;
+   m_markTime.reset();
+   m_sweepTime.reset();
+   m_freedItems = 0;
+   m_freedMem = 0;
+   m_lastFreedItems = 0;
+   m_lastFreedMem = 0;
+   m_allocated = 0;
+   m_allocRate = 0.0;
+   m_sweepAllocated = 0;
+   m_sweepTimeStamp = 0.0;
+   m_liveMem = 0;
+   m_liveItems = 0;
+   m_blockedTime = 0.0;
+   m_waitTime = 0.0;
+   m_thresholdNormal = 0;
+   m_thresholdActive = 0;
+   m_rampChanges = 0;
+}
+
+
+void GCStats::rampChange( int32 mode, size_t normal, size_t active )
+{
+   RampChange& change = m_ramp[ m_rampChanges % ramp_history ];
+   change.m_time = Sys::_seconds() - m_started;
+   change.m_mode = mode;
+   change.m_normal = normal;
+   change.m_active = active;
+   ++m_rampChanges;
+}
+
+
+const GCStats::RampChange* GCStats::rampChangeAt( uint32 i ) const
+{
+   if ( i >= m_rampChanges || i >= ramp_history )
+      return 0;
+   return &m_ramp[ (m_rampChanges - 1 - i) % ramp_history ];
+}
+
+
+void GCStats::describe( String& target ) const
+{
+   char buffer[512];
+   sprintf( buffer,
+         "gc t=%.3f sweeps=%u marks=%u mem=%lu items=%d freed_items=%lu freed_mem=%lu"
+         " alloc=%lu alloc_rate=%.0f mark_avg=%.6f mark_max=%.6f sweep_avg=%.6f sweep_max=%.6f"
+         " blocked=%.6f wait=%.6f th_normal=%lu th_active=%lu ramp_changes=%u",
+         Sys::_seconds() - m_started, (unsigned) m_sweeps, (unsigned) m_marks,
+         (unsigned long) m_liveMem, (int) m_liveItems,
+         (unsigned long) m_freedItems, (unsigned long) m_freedMem,
+         (unsigned long) m_allocated, m_allocRate,
+         m_markTime.average(), m_markTime.m_max,
+         m_sweepTime.average(), m_sweepTime.m_max,
+         m_blockedTime, m_waitTime,
+         (unsigned long) m_thresholdNormal, (unsigned long) m_thresholdActive,
+         (unsigned) m_rampChanges );
+   target = buffer;
+   target.bufferize();
+}
+
+}
+
+/* end of gcstats.cpp */
@@ -20,6 +20,8 @@
 #include <falcon/stream.h>
 #include <falcon/fassert.h>
 #include <falcon/linemap.h>
+#include <falcon/memory.h>
+#include <string.h>
 
 namespace Falcon
 {
@@ -139,7 +141,9 @@ GenCode::GenCode( Module *mod ):
    Generator( 0 ),
    m_pc(0),
    m_outTemp( new StringStream ),
-   m_module( mod )
+   m_module( mod ),
+   m_bPeephole( false ),
+   m_lastLine( 0 )
 {}
 
 GenCode::~GenCode()
@@ -156,9 +160,12 @@ void GenCode::generate( const SourceTree *st  )
       gen_block( &st->statements() );
       gen_pcode( P_RET );
       uint32 codeSize = m_outTemp->length();
+      byte *code = m_outTemp->closeToBuffer();
+      if ( m_bPeephole )
+         peepholeCode( code, codeSize );
 
       // create the main function.
-      m_module->addFunction( "__main__", m_outTemp->closeToBuffer(), codeSize, false );
+      m_module->addFunction( "__main__", code, codeSize, false );
       m_pc += codeSize;
       delete m_outTemp;
       m_outTemp = new StringStream;
@@ -515,8 +522,12 @@ void GenCode::gen_function( const StmtFunction *func )
    }
 
    uint32 codeSize = m_outTemp->length();
+   byte *code = m_outTemp->closeToBuffer();
+   if ( m_bPeephole )
+      peepholeCode( code, codeSize );
+
    funcsym->getFuncDef()->codeSize( codeSize );
-   funcsym->getFuncDef()->code( m_outTemp->closeToBuffer() );
+   funcsym->getFuncDef()->code( code );
    funcsym->getFuncDef()->basePC( m_pc );
    m_pc += codeSize;
    delete m_outTemp;
@@ -536,12 +547,10 @@ void GenCode::gen_block( const StatementList *slist )
 
 void GenCode::gen_statement( const Statement *stmt )
 {
-   static uint32 last_line=0;
-
-   if ( stmt->line() != last_line )
+   if ( stmt->line() != m_lastLine )
    {
-      last_line = stmt->line();
-      m_module->addLineInfo( m_pc + (uint32) m_outTemp->tell(), last_line );
+      m_lastLine = stmt->line();
+      m_module->addLineInfo( m_pc + (uint32) m_outTemp->tell(), m_lastLine );
    }
 
    switch( stmt->type() )
@@ -2236,6 +2245,131 @@ void GenCode::gen_funcall( const Expression *exp, bool fork )
    }
 }
 
+
+//===============================================================
+// Peephole optimizer
+//
+
+static uint32 s_operandSize( byte type )
+{
+   switch( type )
+   {
+      case P_PARAM_NTD32:
+      case P_PARAM_INT32:
+      case P_PARAM_GLOBID:
+      case P_PARAM_LOCID:
+      case P_PARAM_PARID:
+      case P_PARAM_STRID:
+      case P_PARAM_LBIND:
+         return 4;
+
+      case P_PARAM_NUM:
+      case P_PARAM_INT64:
+      case P_PARAM_NTD64:
+         return 8;
+
+      default:
+         return 0;
+   }
+}
+
+
+void GenCode::peepholeCode( byte *code, uint32 size )
+{
+   // first, mark the beginning of each instruction.
+   byte *starts = (byte *) memAlloc( size + 1 );
+   memset( starts, 0, size + 1 );
+
+   uint32 pos = 0;
+   while( pos < size )
+   {
+      if ( pos + 4 > size )
+      {
+         // malformed code; we can't be sure of anything.
+         memFree( starts );
+         return;
+      }
+
+      starts[pos] = 1;
+      byte opcode = code[pos];
+      uint32 next = pos + 4 +
+            s_operandSize( code[pos+1] ) +
+            s_operandSize( code[pos+2] ) +
+            s_operandSize( code[pos+3] );
+
+      // switch and select are followed by their jump tables.
+      if ( ( opcode == P_SWCH || opcode == P_SELE ) && next <= size )
+      {
+         uint64 sw_count = (uint64) loadInt64( code + next - sizeof(int64) );
+         uint32 sw_int = (uint16) (sw_count >> 48);
+         uint32 sw_rng = (uint16) (sw_count >> 32);
+         uint32 sw_str = (uint16) (sw_count >> 16);
+         uint32 sw_obj = (uint16) sw_count;
+         next += sizeof( int32 ) + ( sw_int + sw_rng ) * 12 + ( sw_str + sw_obj ) * 8;
+      }
+
+      pos = next;
+   }
+
+   if ( pos != size )
+   {
+      memFree( starts );
+      return;
+   }
+
+   pos = 0;
+   while( pos < size )
+   {
+      byte opcode = code[pos];
+      uint32 next = pos + 4 +
+            s_operandSize( code[pos+1] ) +
+            s_operandSize( code[pos+2] ) +
+            s_operandSize( code[pos+3] );
+
+      if ( ( opcode == P_JMP || opcode == P_IFT || opcode == P_IFF )
+           && code[pos+1] == P_PARAM_NTD32 )
+      {
+         int32 *target = reinterpret_cast<int32 *>( code + pos + 4 );
+
+         // conditional jumps on constants are either always or never taken.
+         if ( opcode != P_JMP )
+         {
+            byte cond = code[pos+2];
+            if ( cond == P_PARAM_TRUE || cond == P_PARAM_FALSE || cond == P_PARAM_NIL )
+            {
+               bool taken = (cond == P_PARAM_TRUE) == (opcode == P_IFT);
+               code[pos] = P_JMP;
+               code[pos+2] = P_PARAM_NOTUSED;
+               opcode = P_JMP;
+               if ( ! taken )
+                  *target = (int32) next;
+            }
+         }
+
+         // thread jumps landing on other jumps.
+         int hops = 0;
+         while( *target >= 0 && (uint32) *target < size && starts[*target]
+                && code[*target] == P_JMP && code[*target+1] == P_PARAM_NTD32
+                && *target != (int32) pos && hops < 16 )
+         {
+            *target = *reinterpret_cast<int32 *>( code + *target + 4 );
+            ++hops;
+         }
+      }
+      else if ( opcode == P_SWCH || opcode == P_SELE )
+      {
+         uint64 sw_count = (uint64) loadInt64( code + next - sizeof(int64) );
+         next += sizeof( int32 ) +
+            ( (uint16) (sw_count >> 48) + (uint16) (sw_count >> 32) ) * 12 +
+            ( (uint16) (sw_count >> 16) + (uint16) sw_count ) * 8;
+      }
+
+      pos = next;
+   }
+
+   memFree( starts );
+}
+
 }
 
 /* end of gencode.cpp */
@@ -25,6 +25,9 @@
 #include <falcon/vfs_file.h>
 #include <falcon/strtable.h>
 #include <falcon/modulecache.h>
+#include <falcon/compilecache.h>
+#include <falcon/atomtable.h>
+#include <falcon/heapprofiler.h>
 
 namespace Falcon
 {
@@ -42,6 +45,7 @@ namespace Engine
    static String* s_sSrcEnc = 0;
    static String* s_searchPath = 0;
    static ModuleCache* s_moduleCache = 0;
+   static CompileCache* s_compileCache = 0;
 
 #ifdef FALCON_SYSTEM_WIN
    static bool s_bWindowsNamesConversion = true;
@@ -135,8 +139,12 @@ namespace Engine
       delete s_moduleCache;
       s_moduleCache = 0;
 
+      delete s_compileCache;
+      s_compileCache = 0;
+
       releaseLanguage();
       releaseEncodings();
+      AtomTable::clear();
 
       // clear all the service ( and VSF );
       s_mtx.lock();
@@ -155,6 +163,11 @@ namespace Engine
 
 	  //traits::releaseTraits();
 
+      // blocks freed from now on are not reported to the profiler.
+      HeapProfiler* hprof = heapProfiler;
+      heapProfiler = 0;
+      delete hprof;
+
 	  gcMemShutdown(); 
    }
 
@@ -281,6 +294,21 @@ namespace Engine
    {
       return s_moduleCache;
    }
+
+   void setCompileCache( CompileCache* cache )
+   {
+      s_mtx.lock();
+      CompileCache* old = s_compileCache;
+      s_compileCache = cache;
+      s_mtx.unlock();
+
+      delete old;
+   }
+
+   CompileCache* getCompileCache()
+   {
+      return s_compileCache;
+   }
 }
 
 }
@@ -0,0 +1,454 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: heapprofiler.cpp
+
+   Allocation-site heap profiler.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:15:53 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Allocation-site heap profiler.
+*/
+
+#include <falcon/heapprofiler.h>
+#include <falcon/memory.h>
+#include <falcon/garbageable.h>
+#include <falcon/vm.h>
+#include <falcon/vmcontext.h>
+#include <falcon/stackframe.h>
+#include <falcon/symbol.h>
+#include <falcon/module.h>
+#include <falcon/stream.h>
+#include <falcon/traits.h>
+#include <falcon/carray.h>
+#include <falcon/coredict.h>
+#include <falcon/coreobject.h>
+#include <falcon/membuf.h>
+#include <falcon/lineardict.h>
+#include <falcon/mempool.h>
+
+#include <typeinfo>
+
+namespace Falcon {
+
+HeapProfiler* heapProfiler = 0;
+
+static Mutex s_mtxInstall;
+
+/** Set while a thread works inside the profiler, as the allocations
+    made by the profiler itself can't be recorded. */
+static ThreadSpecific s_inside;
+
+
+class HeapProfiler::SiteStat: public BaseAlloc
+{
+public:
+   String m_name;
+   int64 m_bytes;
+   int64 m_blocks;
+   int64 m_allocated;
+
+   SiteStat( const String& name ):
+      m_name( name ),
+      m_bytes( 0 ),
+      m_blocks( 0 ),
+      m_allocated( 0 )
+   {}
+};
+
+
+class BlockRec: public BaseAlloc
+{
+public:
+   void* m_site;
+   int64 m_bytes;
+   int64 m_blocks;
+};
+
+
+HeapProfiler* HeapProfiler::install()
+{
+   s_mtxInstall.lock();
+   if ( heapProfiler == 0 )
+      heapProfiler = new HeapProfiler;
+   s_mtxInstall.unlock();
+
+   return heapProfiler;
+}
+
+
+HeapProfiler::HeapProfiler():
+   m_bActive( false ),
+   m_interval( default_interval ),
+   m_blocks( &traits::t_voidp(), &traits::t_voidp() ),
+   m_sites( &traits::t_string(), &traits::t_voidp() ),
+   m_censuses( 0 )
+{
+   for ( uint32 i = 0; i < type_count; ++i )
+   {
+      m_typeObjects[i] = 0;
+      m_typeBytes[i] = 0;
+   }
+}
+
+
+HeapProfiler::~HeapProfiler()
+{
+   gcMemSampling( 0 );
+   clear();
+}
+
+
+void HeapProfiler::start( uint32 interval )
+{
+   if ( interval != 0 )
+      m_interval = interval;
+
+   m_bActive = true;
+   gcMemSampling( m_interval );
+}
+
+
+void HeapProfiler::stop()
+{
+   m_bActive = false;
+   gcMemSampling( 0 );
+}
+
+
+void HeapProfiler::reset()
+{
+   s_inside.set( this );
+   m_mtx.lock();
+   clear();
+   m_mtx.unlock();
+   s_inside.set( 0 );
+}
+
+
+void HeapProfiler::clear()
+{
+   MapIterator iter = m_blocks.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(BlockRec**) iter.currentValue();
+      iter.next();
+   }
+   m_blocks.clear();
+
+   iter = m_sites.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(SiteStat**) iter.currentValue();
+      iter.next();
+   }
+   m_sites.clear();
+
+   m_censuses = 0;
+   for ( uint32 i = 0; i < type_count; ++i )
+   {
+      m_typeObjects[i] = 0;
+      m_typeBytes[i] = 0;
+   }
+}
+
+
+void HeapProfiler::siteName( String& name ) const
+{
+   VMachine* vm = VMachine::getCurrent();
+   const VMContext* ctx = vm == 0 ? 0 : vm->currentContext();
+   if ( ctx == 0 || ctx->symbol() == 0 )
+   {
+      name = "<native>";
+      return;
+   }
+
+   const Symbol* sym = ctx->symbol();
+   uint32 pc = ctx->pc();
+   const Symbol* native = 0;
+
+   // report native functions along with the script line calling them.
+   if ( sym->isExtFunc() )
+   {
+      native = sym;
+      StackFrame* frame = ctx->currentFrame();
+      sym = frame == 0 ? 0 : frame->m_symbol;
+      pc = frame == 0 ? 0 : frame->m_call_pc;
+   }
+
+   if ( sym != 0 )
+   {
+      name = sym->module()->name();
+      name += ".";
+      name += sym->name();
+      name += ":";
+      name.writeNumber( (int64) ( sym->isFunction() && pc < VMachine::i_pc_call_request ?
+            sym->module()->getLineAt( sym->getFuncDef()->basePC() + pc ) : 0 ) );
+   }
+   else
+      name = "<native>";
+
+   if ( native != 0 )
+   {
+      name += " (";
+      name += native->module()->name();
+      name += ".";
+      name += native->name();
+      name += ")";
+   }
+}
+
+
+HeapProfiler::SiteStat* HeapProfiler::site( const String& name )
+{
+   SiteStat** pstat = (SiteStat**) m_sites.find( &name );
+   if ( pstat != 0 )
+      return *pstat;
+
+   SiteStat* stat = new SiteStat( name );
+   m_sites.insert( &name, stat );
+   return stat;
+}
+
+
+bool HeapProfiler::allocated( void* mem, size_t size )
+{
+   if ( s_inside.get() != 0 || size == 0 )
+      return false;
+
+   s_inside.set( this );
+   String name;
+   siteName( name );
+
+   BlockRec* rec = new BlockRec;
+   // the block stands for all the bytes allocated since the previous sample.
+   rec->m_bytes = size > m_interval ? size : m_interval;
+   rec->m_blocks = rec->m_bytes / size;
+
+   m_mtx.lock();
+   // a block whose release couldn't be accounted may be reused.
+   BlockRec** pold = (BlockRec**) m_blocks.find( mem );
+   if ( pold != 0 )
+   {
+      SiteStat* old = (SiteStat*) (*pold)->m_site;
+      old->m_bytes -= (*pold)->m_bytes;
+      old->m_blocks -= (*pold)->m_blocks;
+      delete *pold;
+      m_blocks.erase( mem );
+   }
+
+   SiteStat* stat = site( name );
+   rec->m_site = stat;
+   stat->m_bytes += rec->m_bytes;
+   stat->m_blocks += rec->m_blocks;
+   stat->m_allocated += rec->m_bytes;
+   m_blocks.insert( mem, rec );
+   m_mtx.unlock();
+
+   s_inside.set( 0 );
+   return true;
+}
+
+
+void HeapProfiler::released( void* mem )
+{
+   // A block freed while working in the profiler can't be accounted.
+   if ( s_inside.get() != 0 )
+      return;
+
+   s_inside.set( this );
+   m_mtx.lock();
+   BlockRec** prec = (BlockRec**) m_blocks.find( mem );
+   BlockRec* rec = 0;
+   if ( prec != 0 )
+   {
+      rec = *prec;
+      SiteStat* stat = (SiteStat*) rec->m_site;
+      stat->m_bytes -= rec->m_bytes;
+      stat->m_blocks -= rec->m_blocks;
+      m_blocks.erase( mem );
+   }
+   m_mtx.unlock();
+
+   delete rec;
+   s_inside.set( 0 );
+}
+
+
+void HeapProfiler::censusBlock( uint32 type, const void* mem )
+{
+   if ( mem == 0 )
+      return;
+
+   BlockRec** prec = (BlockRec**) m_blocks.find( mem );
+   if ( prec != 0 )
+      m_typeBytes[ type ] += (*prec)->m_bytes;
+}
+
+
+void HeapProfiler::census( GarbageableBase* ringRoot )
+{
+   s_inside.set( this );
+   m_mtx.lock();
+
+   for ( uint32 i = 0; i < type_count; ++i )
+   {
+      m_typeObjects[i] = 0;
+      m_typeBytes[i] = 0;
+   }
+
+   GarbageableBase* obj = ringRoot->nextGarbage();
+   while( obj != ringRoot )
+   {
+      // objects never marked may still be under construction.
+      if ( obj->mark() != MemPool::MAX_GENERATION )
+      {
+         if ( typeid( *obj ) == typeid( StringGarbage ) )
+         {
+            CoreString* str = static_cast<StringGarbage*>( obj )->str();
+            ++m_typeObjects[ t_string ];
+            censusBlock( t_string, str );
+            if ( str->allocated() != 0 )
+               censusBlock( t_string, str->getRawStorage() );
+         }
+         else if ( CoreArray* arr = dynamic_cast<CoreArray*>( obj ) )
+         {
+            ++m_typeObjects[ t_array ];
+            censusBlock( t_array, dynamic_cast<void*>( arr ) );
+            censusBlock( t_array, arr->items().elements() );
+         }
+         else if ( CoreDict* dict = dynamic_cast<CoreDict*>( obj ) )
+         {
+            ++m_typeObjects[ t_dict ];
+            censusBlock( t_dict, dynamic_cast<void*>( dict ) );
+         }
+         else if ( CoreObject* cobj = dynamic_cast<CoreObject*>( obj ) )
+         {
+            ++m_typeObjects[ t_object ];
+            censusBlock( t_object, dynamic_cast<void*>( cobj ) );
+         }
+         else if ( MemBuf* mb = dynamic_cast<MemBuf*>( obj ) )
+         {
+            ++m_typeObjects[ t_membuf ];
+            censusBlock( t_membuf, dynamic_cast<void*>( mb ) );
+            censusBlock( t_membuf, mb->data() );
+         }
+         else
+         {
+            ++m_typeObjects[ t_other ];
+            censusBlock( t_other, dynamic_cast<void*>( obj ) );
+         }
+      }
+
+      obj = obj->nextGarbage();
+   }
+
+   ++m_censuses;
+   m_mtx.unlock();
+   s_inside.set( 0 );
+}
+
+
+const char* HeapProfiler::typeName( uint32 type )
+{
+   static const char* names[] = {
+      "CoreString", "CoreArray", "CoreDict", "CoreObject", "MemBuf", "other"
+   };
+   return type < type_count ? names[ type ] : 0;
+}
+
+
+bool HeapProfiler::writeSnapshot( Stream* out ) const
+{
+   s_inside.set( (void*) this );
+   m_mtx.lock();
+
+   // the maps are ordered by name, so snapshots can be compared line by line.
+   String text = "# sites: live bytes, live blocks, allocated bytes (interval ";
+   text.writeNumber( (int64) m_interval );
+   text += ")\n";
+
+   MapIterator iter = m_sites.begin();
+   while( iter.hasCurrent() )
+   {
+      const SiteStat* stat = *(SiteStat**) iter.currentValue();
+      if ( stat->m_bytes != 0 || stat->m_allocated != 0 )
+      {
+         text += stat->m_name;
+         text += "\t";
+         text.writeNumber( stat->m_bytes );
+         text += "\t";
+         text.writeNumber( stat->m_blocks );
+         text += "\t";
+         text.writeNumber( stat->m_allocated );
+         text += "\n";
+      }
+      iter.next();
+   }
+
+   text += "# types: objects, bytes (census ";
+   text.writeNumber( (int64) m_censuses );
+   text += ")\n";
+   for ( uint32 i = 0; i < type_count; ++i )
+   {
+      text += typeName( i );
+      text += "\t";
+      text.writeNumber( m_typeObjects[i] );
+      text += "\t";
+      text.writeNumber( m_typeBytes[i] );
+      text += "\n";
+   }
+
+   m_mtx.unlock();
+   s_inside.set( 0 );
+
+   return out->writeString( text );
+}
+
+
+CoreDict* HeapProfiler::toDict() const
+{
+   s_inside.set( (void*) this );
+   m_mtx.lock();
+
+   LinearDict* sites = new LinearDict( m_sites.size() );
+   MapIterator iter = m_sites.begin();
+   while( iter.hasCurrent() )
+   {
+      const SiteStat* stat = *(SiteStat**) iter.currentValue();
+      CoreArray* data = new CoreArray( 3 );
+      data->append( stat->m_bytes );
+      data->append( stat->m_blocks );
+      data->append( stat->m_allocated );
+      sites->put( new CoreString( stat->m_name ), data );
+      iter.next();
+   }
+
+   LinearDict* types = new LinearDict( type_count );
+   for ( uint32 i = 0; i < type_count; ++i )
+   {
+      CoreArray* data = new CoreArray( 2 );
+      data->append( m_typeObjects[i] );
+      data->append( m_typeBytes[i] );
+      types->put( new CoreString( typeName( i ) ), data );
+   }
+
+   m_mtx.unlock();
+   s_inside.set( 0 );
+
+   LinearDict* result = new LinearDict( 2 );
+   result->put( new CoreString( "sites" ), new CoreDict( sites ) );
+   result->put( new CoreString( "types" ), new CoreDict( types ) );
+   return new CoreDict( result );
+}
+
+}
+
+/* end of heapprofiler.cpp */
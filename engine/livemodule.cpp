@@ -21,6 +21,8 @@
 #include <falcon/memory.h>
 #include <falcon/fassert.h>
 #include <falcon/mempool.h>
+#include <falcon/strtemplate.h>
+#include <falcon/atomtable.h>
 
 #include <string.h>
 
@@ -34,6 +36,10 @@ namespace Falcon {
 LiveModule::LiveModule( Module *mod, bool bPrivate ):
    Garbageable(),
    m_module( mod ),
+   m_templates( 0 ),
+   m_tplCount( 0 ),
+   m_atoms( 0 ),
+   m_atomCount( 0 ),
    m_aacc( 0 ),
    m_iacc( 0 ),
    m_bPrivate( bPrivate ),
@@ -47,6 +53,9 @@ LiveModule::LiveModule( Module *mod, bool bPrivate ):
    {
       m_strings = static_cast<CoreString**>( memAlloc( sizeof(CoreString*) * m_strCount ) );
       memset( m_strings, 0, sizeof(CoreString*) * m_strCount );
+      m_atomCount = m_strCount;
+      m_atoms = static_cast<const String**>( memAlloc( sizeof(String*) * m_atomCount ) );
+      memset( m_atoms, 0, sizeof(String*) * m_atomCount );
    }
    else {
       m_strings = 0;
@@ -61,6 +70,16 @@ LiveModule::~LiveModule()
    if ( m_strings != 0 )
       memFree( m_strings );
 
+   if ( m_templates != 0 )
+   {
+      for( uint32 i = 0; i < m_tplCount; ++i )
+         delete m_templates[i];
+      memFree( m_templates );
+   }
+
+   if ( m_atoms != 0 )
+      memFree( m_atoms );
+
    m_module->decref();
    memPool->accountItems( m_iacc );
    gcMemAccount( m_aacc );
@@ -151,6 +170,42 @@ String* LiveModule::getString( uint32 stringId ) const
 }
 
 
+const StringTemplate* LiveModule::getStringTemplate( uint32 stringId ) const
+{
+   fassert( stringId < (uint32) m_module->stringTable().size() );
+
+   if( stringId >= m_tplCount )
+   {
+      m_templates = static_cast<StringTemplate**>(memRealloc( m_templates, sizeof( StringTemplate* ) * (stringId+1) ));
+      memset( m_templates + m_tplCount, 0, sizeof( StringTemplate* ) * ( stringId - m_tplCount +1) );
+      m_tplCount = stringId+1;
+   }
+
+   if( m_templates[stringId] == 0 )
+      m_templates[stringId] = new StringTemplate( *m_module->stringTable().get( stringId ) );
+
+   return m_templates[stringId];
+}
+
+
+const String* LiveModule::getAtom( uint32 stringId ) const
+{
+   fassert( stringId < (uint32) m_module->stringTable().size() );
+
+   if( stringId >= m_atomCount )
+   {
+      m_atoms = static_cast<const String**>(memRealloc( m_atoms, sizeof( String* ) * (stringId+1) ));
+      memset( m_atoms + m_atomCount, 0, sizeof( String* ) * ( stringId - m_atomCount +1) );
+      m_atomCount = stringId+1;
+   }
+
+   if( m_atoms[stringId] == 0 )
+      m_atoms[stringId] = AtomTable::intern( *m_module->stringTable().get( stringId ) );
+
+   return m_atoms[stringId];
+}
+
+
 //=================================================================================
 // Live module related traits
 //=================================================================================
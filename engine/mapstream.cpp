@@ -0,0 +1,221 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: mapstream.cpp
+
+   Stream over a file mapped in memory.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:39:22 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/mapstream.h>
+#include <falcon/filemap.h>
+
+#include <string.h>
+
+// windows handed out at once; keeps the byte counts in int32.
+#define MAPSTREAM_MAX_WINDOW  0x40000000
+
+namespace Falcon {
+
+MapStream::MapStream( FileMap *map ):
+   Stream( t_file ),
+   m_map( map ),
+   m_base( 0 ),
+   m_size( map->size() ),
+   m_pos( 0 )
+{
+   m_map->incref();
+   m_status = t_open;
+}
+
+MapStream::MapStream( FileMap *map, uint64 offset, uint64 size ):
+   Stream( t_file ),
+   m_map( map ),
+   m_base( offset ),
+   m_size( size ),
+   m_pos( 0 )
+{
+   m_map->incref();
+   m_status = t_open;
+}
+
+MapStream::MapStream( const MapStream &other ):
+   Stream( other ),
+   m_map( other.m_map ),
+   m_base( other.m_base ),
+   m_size( other.m_size ),
+   m_pos( other.m_pos )
+{
+   m_map->incref();
+}
+
+MapStream::~MapStream()
+{
+   m_map->decref();
+}
+
+MapStream *MapStream::clone() const
+{
+   return new MapStream( *this );
+}
+
+int32 MapStream::available() const
+{
+   if ( m_pos >= m_size )
+      return 0;
+
+   uint64 avail = m_size - m_pos;
+   return avail > MAPSTREAM_MAX_WINDOW ? MAPSTREAM_MAX_WINDOW : (int32) avail;
+}
+
+bool MapStream::close()
+{
+   if ( ! open() )
+      return true;
+
+   bool bOk = m_map->sync();
+   m_status = m_status & (~ t_open);
+   return bOk;
+}
+
+int32 MapStream::read( void *buffer, int32 size )
+{
+   if ( ! open() )
+   {
+      m_status = m_status | t_error;
+      return -1;
+   }
+
+   int32 avail = available();
+   if ( avail == 0 )
+   {
+      m_status = m_status | t_eof;
+      m_lastMoved = 0;
+      return 0;
+   }
+
+   if ( size > avail )
+      size = avail;
+
+   memcpy( buffer, m_map->data() + m_base + m_pos, size );
+   m_pos += size;
+   m_lastMoved = size;
+   return size;
+}
+
+int32 MapStream::write( const void *buffer, int32 size )
+{
+   if ( ! open() )
+   {
+      m_status = m_status | t_error;
+      return -1;
+   }
+
+   // the size of the mapping can't change.
+   if ( ! m_map->writable() || ( size > 0 && available() == 0 ) )
+   {
+      m_status = m_status | t_unsupported;
+      return -1;
+   }
+
+   int32 avail = available();
+   if ( size > avail )
+      size = avail;
+
+   memcpy( m_map->data() + m_base + m_pos, buffer, size );
+   m_pos += size;
+   m_lastMoved = size;
+   return size;
+}
+
+bool MapStream::get( uint32 &chr )
+{
+   if ( popBuffer( chr ) )
+      return true;
+
+   if ( ! open() || m_pos >= m_size )
+   {
+      m_status = m_status | ( open() ? t_eof : t_error );
+      return false;
+   }
+
+   chr = m_map->data()[ m_base + m_pos++ ];
+   return true;
+}
+
+bool MapStream::put( uint32 chr )
+{
+   byte b = (byte) chr;
+   return write( &b, 1 ) == 1;
+}
+
+int32 MapStream::readAvailable( int32, const Sys::SystemData * )
+{
+   return available();
+}
+
+int32 MapStream::writeAvailable( int32, const Sys::SystemData * )
+{
+   return m_map->writable() ? available() : 0;
+}
+
+int64 MapStream::tell()
+{
+   return (int64) m_pos;
+}
+
+bool MapStream::truncate( int64 )
+{
+   m_status = m_status | t_unsupported;
+   return false;
+}
+
+bool MapStream::flush()
+{
+   return m_map->sync();
+}
+
+const byte *MapStream::readWindow( int32 &avail )
+{
+   avail = available();
+   if ( avail == 0 )
+   {
+      if ( open() )
+         m_status = m_status | t_eof;
+      return 0;
+   }
+
+   return m_map->data() + m_base + m_pos;
+}
+
+int64 MapStream::seek( int64 pos, e_whence whence )
+{
+   switch( whence )
+   {
+      case ew_begin: break;
+      case ew_cur: pos += (int64) m_pos; break;
+      case ew_end: pos += (int64) m_size; break;
+   }
+
+   if ( pos < 0 )
+      pos = 0;
+
+   m_status = m_status & (~ t_eof);
+   if ( (uint64) pos >= m_size )
+   {
+      pos = (int64) m_size;
+   }
+
+   m_pos = (uint64) pos;
+   return pos;
+}
+
+}
+
+/* end of mapstream.cpp */
@@ -15,6 +15,7 @@
 
 
 #include <falcon/memory.h>
+#include <falcon/heapprofiler.h>
 #if defined(__SUNPRO_CC)
    #include <stdio.h>
 #elif defined(__BORLANDC__)
@@ -31,7 +32,13 @@
 #include <falcon/mt_posix.h>
 #endif
 
+/** Marks the size header of blocks sampled by the heap profiler. */
+#define FALCON_MEM_SAMPLED   (((size_t)1) << (sizeof(size_t)*8-1))
+
 namespace Falcon {
+
+static bool s_accountAlloc( size_t mem );
+
 /*
 #ifdef _MSC_VER
 const builder_t Builder;
@@ -76,8 +83,9 @@ void * DflAccountMemAlloc( size_t amount )
       exit(1);
    }
 
-   gcMemAccount( amount );
    *ret = amount;
+   if ( s_accountAlloc( amount ) && heapProfiler != 0 && heapProfiler->allocated( ret+1, amount ) )
+      *ret |= FALCON_MEM_SAMPLED;
    return ret+1;
 }
 
@@ -87,7 +95,14 @@ void DflAccountMemFree( void *mem )
    if ( mem != 0 )
    {
       size_t *smem = (size_t*) mem;
-      gcMemUnaccount( smem[-1] );
+      size_t size = smem[-1];
+      if ( (size & FALCON_MEM_SAMPLED) != 0 )
+      {
+         size &= ~FALCON_MEM_SAMPLED;
+         if ( heapProfiler != 0 )
+            heapProfiler->released( mem );
+      }
+      gcMemUnaccount( size );
       free( smem-1 );
    }
 }
@@ -107,6 +122,14 @@ void * DflAccountMemRealloc( void *mem, size_t amount )
    size_t *smem = (size_t*) mem;
    smem--;
    size_t oldalloc = *smem;
+   // a sampled block stays sampled at its new place.
+   bool bSample = (oldalloc & FALCON_MEM_SAMPLED) != 0;
+   if ( bSample )
+   {
+      oldalloc &= ~FALCON_MEM_SAMPLED;
+      if ( heapProfiler != 0 )
+         heapProfiler->released( mem );
+   }
 
    size_t *nsmem = (size_t*) realloc( smem, amount + sizeof( size_t ) );
 
@@ -117,10 +140,16 @@ void * DflAccountMemRealloc( void *mem, size_t amount )
 
    *nsmem = amount;
    if( amount > oldalloc )
-      gcMemAccount( amount - oldalloc );
+   {
+      if ( s_accountAlloc( amount - oldalloc ) )
+         bSample = true;
+   }
    else
       gcMemUnaccount( oldalloc - amount );
 
+   if ( bSample && heapProfiler != 0 && heapProfiler->allocated( nsmem+1, amount ) )
+      *nsmem |= FALCON_MEM_SAMPLED;
+
    return nsmem+1;
 }
 
@@ -130,6 +159,34 @@ void * DflAccountMemRealloc( void *mem, size_t amount )
 //
 static Mutex *s_gcMutex = 0;
 static size_t s_allocatedMem  = 0;
+static uint64 s_totalMem = 0;
+static size_t s_sampleInterval = 0;
+static size_t s_sampleCountdown = 0;
+
+/** Accounts an allocation; returns true if the heap profiler should sample it. */
+static bool s_accountAlloc( size_t mem )
+{
+   if( s_gcMutex == 0 )
+      s_gcMutex = new Mutex;
+
+   bool bSample = false;
+   s_gcMutex->lock();
+   s_allocatedMem += mem;
+   s_totalMem += mem;
+   if ( s_sampleInterval != 0 )
+   {
+      if ( mem >= s_sampleCountdown )
+      {
+         bSample = true;
+         s_sampleCountdown = s_sampleInterval;
+      }
+      else
+         s_sampleCountdown -= mem;
+   }
+   s_gcMutex->unlock();
+
+   return bSample;
+}
 
 void gcMemAccount( size_t mem )
 {
@@ -138,6 +195,7 @@ void gcMemAccount( size_t mem )
 
    s_gcMutex->lock();
    s_allocatedMem += mem;
+   s_totalMem += mem;
    s_gcMutex->unlock();
 }
 
@@ -163,6 +221,29 @@ size_t gcMemAllocated()
    return val;
 }
 
+uint64 gcMemTotalAllocated()
+{
+   if( s_gcMutex == 0 )
+      s_gcMutex = new Mutex;
+
+   s_gcMutex->lock();
+   uint64 val = s_totalMem;
+   s_gcMutex->unlock();
+
+   return val;
+}
+
+void gcMemSampling( size_t interval )
+{
+   if( s_gcMutex == 0 )
+      s_gcMutex = new Mutex;
+
+   s_gcMutex->lock();
+   s_sampleInterval = interval;
+   s_sampleCountdown = interval;
+   s_gcMutex->unlock();
+}
+
 void gcMemShutdown()
 {
 	delete s_gcMutex;
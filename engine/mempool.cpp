@@ -30,6 +30,9 @@
 #include <falcon/membuf.h>
 #include <falcon/garbagepointer.h>
 #include <falcon/garbagelock.h>
+#include <falcon/stream.h>
+#include <falcon/sys.h>
+#include <falcon/heapprofiler.h>
 
 
 #include <string>
@@ -60,7 +63,10 @@ MemPool::MemPool():
    m_th(0),
    m_bLive(false),
    m_bRequestSweep( false ),
-   m_lockGen( 0 )
+   m_lockGen( 0 ),
+   m_statsLog( 0 ),
+   m_statsInterval( 1.0 ),
+   m_nextStatsLog( 0.0 )
 {
    m_vmRing = 0;
 
@@ -132,6 +138,10 @@ bool MemPool::rampMode( int mode )
          m_curRampID = mode;
          m_curRampMode = m_ramp[mode];
          m_curRampMode->reset();
+
+         m_mtx_stats.lock();
+         m_stats.rampChange( mode, m_thresholdNormal, m_thresholdActive );
+         m_mtx_stats.unlock();
       }
       m_mtx_ramp.unlock();
       return true;
@@ -276,7 +286,7 @@ void MemPool::electOlderVM()
 }
 
 
-void MemPool::clearRing( GarbageableBase *ringRoot )
+int32 MemPool::clearRing( GarbageableBase *ringRoot, const uint32* gens, int32* counts, uint32 genCount )
 {
    TRACE( "Entering sweep %ld, allocated %ld", (long)gcMemAllocated(), (long)m_allocatedItems );
    // delete the garbage ring.
@@ -305,6 +315,15 @@ void MemPool::clearRing( GarbageableBase *ringRoot )
             killed++;
       }
       else {
+         // attribute the survivor to the VM that marked it last.
+         for ( uint32 g = 0; g < genCount; ++g )
+         {
+            if ( ring->mark() == gens[g] )
+            {
+               ++counts[g];
+               break;
+            }
+         }
          ring = ring->nextGarbage();
       }
    }
@@ -327,6 +346,7 @@ void MemPool::clearRing( GarbageableBase *ringRoot )
    m_mtx_newitem.unlock();
 
    TRACE( "Sweeping done, allocated %ld (killed %ld)", (long)m_allocatedItems, (long)killed );
+   return killed;
 }
 
 
@@ -512,19 +532,175 @@ void MemPool::gcSweep()
 
    TRACE( "Sweeping %ld (mingen: %d, gen: %d)", (long)gcMemAllocated(), m_mingen, m_generation );
 
+   numeric start = Sys::_seconds();
+   size_t memBefore = gcMemAllocated();
+
    m_mtx_ramp.lock();
    // ramp mode may change while we do the lock...
    RampMode* rm = m_curRampMode;
    rm->onScanInit();
    m_mtx_ramp.unlock();
 
-   clearRing( m_garbageRoot );
+   // the generations of the VMs are changed only by this thread.
+   uint32 gens[max_counted_vms];
+   int32 counts[max_counted_vms];
+   uint32 genCount = 0;
+   m_mtx_vms.lock();
+   VMachine* vm = m_vmRing;
+   if ( vm != 0 )
+   {
+      do {
+         counts[genCount] = 0;
+         gens[genCount++] = vm->m_generation;
+         vm = vm->m_nextVM;
+      }
+      while( vm != m_vmRing && genCount < max_counted_vms );
+   }
+   m_mtx_vms.unlock();
+
+   int32 killed = clearRing( m_garbageRoot, gens, counts, genCount );
+
+   if ( heapProfiler != 0 && heapProfiler->active() )
+      heapProfiler->census( m_garbageRoot );
+
+   m_mtx_vms.lock();
+   vm = m_vmRing;
+   if ( vm != 0 )
+   {
+      do {
+         for ( uint32 g = 0; g < genCount; ++g )
+         {
+            if ( gens[g] == vm->m_generation )
+            {
+               vm->m_gcLiveItems = counts[g];
+               break;
+            }
+         }
+         vm = vm->m_nextVM;
+      }
+      while( vm != m_vmRing );
+   }
+   m_mtx_vms.unlock();
 
    m_mtx_ramp.lock();
    rm->onScanComplete();
+   size_t oldActive = m_thresholdActive;
+   size_t oldNormal = m_thresholdNormal;
    m_thresholdActive = rm->activeLevel();
    m_thresholdNormal = rm->normalLevel();
+
+   numeric now = Sys::_seconds();
+   size_t memAfter = gcMemAllocated();
+   uint64 allocated = gcMemTotalAllocated();
+
+   m_mtx_stats.lock();
+   if ( oldActive != m_thresholdActive || oldNormal != m_thresholdNormal )
+      m_stats.rampChange( m_curRampID, m_thresholdNormal, m_thresholdActive );
    m_mtx_ramp.unlock();
+
+   ++m_stats.m_sweeps;
+   m_stats.m_sweepTime.add( now - start );
+   m_stats.m_lastFreedItems = killed;
+   m_stats.m_lastFreedMem = memBefore > memAfter ? memBefore - memAfter : 0;
+   m_stats.m_freedItems += killed;
+   m_stats.m_freedMem += m_stats.m_lastFreedMem;
+   if ( m_stats.m_sweepTimeStamp > 0.0 && now > m_stats.m_sweepTimeStamp )
+   {
+      m_stats.m_allocRate = (allocated - m_stats.m_sweepAllocated) / (now - m_stats.m_sweepTimeStamp);
+   }
+   m_stats.m_sweepAllocated = allocated;
+   m_stats.m_sweepTimeStamp = now;
+   m_mtx_stats.unlock();
+}
+
+
+void MemPool::timedMarkVM( VMachine *vm )
+{
+   numeric start = Sys::_seconds();
+   markVM( vm );
+   numeric elapsed = Sys::_seconds() - start;
+
+   m_mtx_stats.lock();
+   ++m_stats.m_marks;
+   m_stats.m_markTime.add( elapsed );
+   m_mtx_stats.unlock();
+}
+
+
+void MemPool::stats( GCStats& target ) const
+{
+   size_t liveMem = gcMemAllocated();
+   uint64 allocated = gcMemTotalAllocated();
+   int32 liveItems = allocatedItems();
+
+   m_mtx_stats.lock();
+   target = m_stats;
+   target.m_thresholdNormal = m_thresholdNormal;
+   target.m_thresholdActive = m_thresholdActive;
+   m_mtx_stats.unlock();
+
+   target.m_liveMem = liveMem;
+   target.m_liveItems = liveItems;
+   target.m_allocated = allocated;
+}
+
+
+void MemPool::resetStats()
+{
+   m_mtx_stats.lock();
+   m_stats.reset();
+   m_mtx_stats.unlock();
+}
+
+
+void MemPool::accountBlocked( numeric seconds, bool bRequested )
+{
+   m_mtx_stats.lock();
+   if ( bRequested )
+      m_stats.m_waitTime += seconds;
+   else
+      m_stats.m_blockedTime += seconds;
+   m_mtx_stats.unlock();
+}
+
+
+void MemPool::statsLog( Stream* out, numeric interval )
+{
+   m_mtx_stats.lock();
+   m_statsLog = out;
+   m_statsInterval = interval > 0.0 ? interval : 1.0;
+   m_nextStatsLog = Sys::_seconds() + m_statsInterval;
+   m_mtx_stats.unlock();
+}
+
+
+void MemPool::checkStatsLog()
+{
+   numeric now = Sys::_seconds();
+   m_mtx_stats.lock();
+   if ( m_statsLog == 0 || now < m_nextStatsLog )
+   {
+      m_mtx_stats.unlock();
+      return;
+   }
+   m_nextStatsLog = now + m_statsInterval;
+   m_mtx_stats.unlock();
+
+   // the stream is written under the lock, so that statsLog( 0 ) returns
+   // only when the stream is not in use anymore.
+   GCStats current;
+   stats( current );
+   String line;
+   current.describe( line );
+   line += "\n";
+
+   m_mtx_stats.lock();
+   if ( m_statsLog != 0 )
+   {
+      m_statsLog->writeString( line );
+      m_statsLog->flush();
+   }
+   m_mtx_stats.unlock();
 }
 
 int32 MemPool::allocatedItems() const
@@ -742,7 +918,7 @@ void* MemPool::run()
          TRACE( "Marking idle vm %p at %d", vm, m_generation );
 
          // and then mark
-         markVM( vm );
+         timedMarkVM( vm );
          // should notify now?
          if ( bPriority )
          {
@@ -782,7 +958,7 @@ void* MemPool::run()
 
                TRACE( "Marking oldest vm %p at %d", vm, m_generation );
                // and then mark
-               markVM( vm );
+               timedMarkVM( vm );
                // the VM is now free to go.
                vm->baton().releaseNotIdle();
             }
@@ -854,6 +1030,8 @@ void* MemPool::run()
       oldGeneration = m_generation;  // spurious read is ok here (?)
       oldMingen = m_mingen;
 
+      checkStatsLog();
+
       // if we have nothing to do, we shall wait a bit.
       if( ! bMoreWork )
       {
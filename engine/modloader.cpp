@@ -33,6 +33,9 @@
 
 #include <falcon/globals.h>
 #include <falcon/modulecache.h>
+#include <falcon/compilecache.h>
+#include <falcon/rosstream.h>
+#include <falcon/mt.h>
 
 #include <memory>
 
@@ -43,6 +46,8 @@
 namespace Falcon
 {
 
+static Mutex s_binaryMtx;
+
 ModuleLoader::ModuleLoader():
    m_alwaysRecomp( false ),
    m_compMemory( true ),
@@ -86,9 +91,14 @@ ModuleLoader::ModuleLoader( const ModuleLoader &other ):
    m_delayRaise( other.m_delayRaise ),
    m_ignoreSources( other.m_ignoreSources ),
    m_saveRemote( other.m_saveRemote ),
-   m_compileErrors( other.m_compileErrors )
+   m_compileErrors( other.m_compileErrors ),
+   m_srcEncoding( other.m_srcEncoding ),
+   m_bSaveIntTemplate( other.m_bSaveIntTemplate ),
+   m_language( other.m_language )
 {
+   m_path.deletor( string_deletor );
    setSearchPath( other.getSearchPath() );
+   m_compiler.copySettings( other.m_compiler );
 }
 
 
@@ -427,14 +437,37 @@ Module *ModuleLoader::loadFile( const URI& uri, t_filetype type, bool scan )
       while ( (! bFound) && path_elem != 0 )
       {
          String *pathp = (String *) path_elem->data();
-         origUri.pathElement().setFullLocation( *pathp );
+
+         // a path entry may be served by another provider, as "pack:///_system";
+         // one letter schemes are disk names.
+         VFSProvider *pathVfs = 0;
+         if ( pathp->find( ":" ) != String::npos )
+         {
+            URI pathUri( *pathp );
+            if ( pathUri.isValid() && pathUri.scheme().length() > 1 )
+            {
+               pathVfs = Engine::getVFS( pathUri.scheme() );
+               if ( pathVfs != 0 )
+               {
+                  origUri.scheme( pathUri.scheme() );
+                  origUri.pathElement().setFullLocation( pathUri.path() );
+               }
+            }
+         }
+
+         if ( pathVfs == 0 )
+         {
+            pathVfs = vfs;
+            origUri.scheme( uri.scheme() );
+            origUri.pathElement().setFullLocation( *pathp );
+         }
          origUri.pathElement().extendLocation( oldPath  );
 
          // If we originally had an extension, we must not add it.
          if ( bHadExtension )
          {
             // if the thing exists...
-            if( ( bFound = vfs->readStats( origUri, foundStats ) ) )
+            if( ( bFound = pathVfs->readStats( origUri, foundStats ) ) )
             {
                // ... set the file type, either on our default or on the found extension.
                tf = (type == t_none || type == t_defaultSource ) ?
@@ -444,9 +477,12 @@ Module *ModuleLoader::loadFile( const URI& uri, t_filetype type, bool scan )
          else
          {
             // we must can the possible extensions in this directory
-            bFound = scanForFile( origUri, vfs, tf, foundStats );
+            bFound = scanForFile( origUri, pathVfs, tf, foundStats );
          }
 
+         if ( bFound )
+            vfs = pathVfs;
+
          path_elem = path_elem->next();
       }
    }
@@ -741,6 +777,27 @@ Module *ModuleLoader::loadBinaryModule( const String &path )
          return mod;
    }
 
+   // the initialization of binary modules is not meant to run in parallel.
+   s_binaryMtx.lock();
+   Module *mod;
+   try {
+      mod = initBinaryModule( path );
+   }
+   catch( Error* )
+   {
+      s_binaryMtx.unlock();
+      throw;
+   }
+
+   if ( mc ) mod = mc->add( path, mod );
+   s_binaryMtx.unlock();
+
+   return mod;
+}
+
+
+Module *ModuleLoader::initBinaryModule( const String &path )
+{
    DllLoader dll;
 
    if ( ! dll.open( path ) )
@@ -778,8 +835,6 @@ Module *ModuleLoader::loadBinaryModule( const String &path )
    mod->name( modName );
    mod->path( path );
 
-   if ( mc ) mod = mc->add( path, mod );
-
    // as dll instance has been emptied, the DLL won't be closed till the
    // module lifetime comes to an end.
    return mod;
@@ -872,12 +927,47 @@ Module *ModuleLoader::loadSource( const String &file )
    String modName;
    getModuleName( file, modName );
 
+   // The compile cache is keyed by the decoded text of the source.
+   CompileCache* cc = Engine::getCompileCache();
+   String cacheKey;
+   String text;
+   if ( cc != 0 )
+   {
+      String chunk;
+      while( in->readString( chunk, 4096 ) && chunk.length() != 0 )
+         text += chunk;
+      in.reset( new ROStringStream( text ) );
+
+      String settings;
+      m_compiler.describeSettings( settings );
+      settings += m_forceTemplate ? ";ftd=1" : ";ftd=0";
+      cacheKey = CompileCache::key( text.getRawStorage(), text.size(), settings );
+
+      Module *mod = m_alwaysRecomp ? 0 : loadCached( cc, cacheKey );
+      if ( mod != 0 )
+      {
+         m_forceTemplate = bOldForceFtd;
+         mod->name( modName );
+         mod->path( file );
+         if( mc != 0 )
+         {
+            mod = mc->add( file, mod );
+         }
+         return mod;
+      }
+   }
+
    Module *mod = 0;
    try {
       mod = loadSource( in.get(), file, modName );
       m_forceTemplate = bOldForceFtd;
       in->close();
 
+      if ( cc != 0 )
+      {
+         cc->store( cacheKey, mod );
+      }
+
       if( mc != 0 )
       {
          mod = mc->add( file, mod );
@@ -894,6 +984,31 @@ Module *ModuleLoader::loadSource( const String &file )
 }
 
 
+Module *ModuleLoader::loadCached( CompileCache* cc, const String &key )
+{
+   Stream *in = cc->find( key );
+   if ( in == 0 )
+      return 0;
+
+   Module *mod = 0;
+   try {
+      mod = loadModule( in );
+   }
+   catch( Error *e )
+   {
+      e->decref();
+      mod = 0;
+   }
+   delete in;
+
+   // an entry we can't read is useless.
+   if ( mod == 0 )
+      cc->discard( key );
+
+   return mod;
+}
+
+
 Module *ModuleLoader::loadSource( Stream *fin, const String &path, const String &name )
 {
    Module *module;
@@ -941,6 +1056,7 @@ Module *ModuleLoader::loadSource( Stream *fin, const String &path, const String
    }
 
    GenCode codeOut( module );
+   codeOut.peephole( m_compiler.optLevel() > 1 );
    codeOut.generate( m_compiler.sourceTree() );
 
    // import the binary stream in the module;
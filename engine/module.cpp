@@ -38,6 +38,8 @@ Module::Module():
    m_modVersion( 0 ),
    m_engineVersion( 0 ),
    m_lineInfo( 0 ),
+   m_lineData( 0 ),
+   m_lineCount( 0 ),
    m_loader(0),
    m_serviceMap( &traits::t_string(), &traits::t_voidp() ),
    m_attributes(0)
@@ -57,6 +59,8 @@ Module::~Module()
    // ... the module will take care of them.
 
    delete m_lineInfo;
+   if ( m_lineData != 0 )
+      memFree( m_lineData );
 
    delete m_attributes;
 
@@ -377,7 +381,21 @@ bool Module::save( Stream *out, bool skipCode ) const
       out->write( &iver, sizeof( iver ) );
    }
 
-   if ( m_lineInfo != 0 )
+   if ( m_lineData != 0 )
+   {
+      // same layout as LineMap::save()
+      int32 infoInd = endianInt32( 1 );
+      out->write( &infoInd, sizeof( infoInd ) );
+
+      uint32 count = endianInt32( m_lineCount );
+      out->write( &count, sizeof( count ) );
+      for ( uint32 i = 0; i < m_lineCount * 2; ++i )
+      {
+         uint32 val = endianInt32( m_lineData[i] );
+         out->write( &val, sizeof( val ) );
+      }
+   }
+   else if ( m_lineInfo != 0 )
    {
       int32 infoInd = endianInt32( 1 );
       out->write( &infoInd, sizeof( infoInd ) );
@@ -449,12 +467,42 @@ bool Module::load( Stream *is, bool skipHeader )
    infoInd = endianInt32( infoInd );
    if( infoInd != 0 )
    {
-      m_lineInfo = new LineMap;
-      if ( ! m_lineInfo->load( is ) )
+      // the line informations are needed only for error reports and
+      // debugging; they are read in a block and decoded on request.
+      uint32 count;
+      is->read( &count, sizeof( count ) );
+      count = endianInt32( count );
+      if ( count > 0x7FFFFFFF / (2 * sizeof( uint32 )) )
          return false;
+
+      if ( count > 0 )
+      {
+         // A corrupted count must not size the buffer, as not every stream
+         // can tell its size; the buffer grows as the pairs are really read.
+         uint32 size = count < 4096 ? count : 4096;
+         m_lineData = (uint32 *) memAlloc( size * 2 * sizeof( uint32 ) );
+         while( m_lineCount < count )
+         {
+            if ( m_lineCount == size )
+            {
+               size = count - size < size ? count : size * 2;
+               m_lineData = (uint32 *) memRealloc( m_lineData, size * 2 * sizeof( uint32 ) );
+            }
+
+            int32 bsize = (int32) ( (size - m_lineCount) * 2 * sizeof( uint32 ) );
+            if ( is->read( m_lineData + m_lineCount * 2, bsize ) != bsize )
+               return false;
+            m_lineCount = size;
+         }
+
+         #if FALCON_LITTLE_ENDIAN != 1
+         for ( uint32 i = 0; i < m_lineCount * 2; ++i )
+            m_lineData[i] = endianInt32( m_lineData[i] );
+         #endif
+      }
+      else
+         m_lineInfo = new LineMap;
    }
-   else
-      m_lineInfo = 0;
 
    return is->good();
 }
@@ -462,6 +510,22 @@ bool Module::load( Stream *is, bool skipHeader )
 
 uint32 Module::getLineAt( uint32 pc ) const
 {
+   if ( m_lineData != 0 )
+   {
+      // find the last entry starting at or before pc.
+      uint32 lower = 0, higher = m_lineCount;
+      while ( lower < higher )
+      {
+         uint32 point = ( lower + higher ) / 2;
+         if ( m_lineData[ point * 2 ] <= pc )
+            lower = point + 1;
+         else
+            higher = point;
+      }
+
+      return lower == 0 ? 0 : m_lineData[ (lower-1) * 2 + 1 ];
+   }
+
    if ( m_lineInfo == 0 || m_lineInfo->empty() )
       return 0;
 
@@ -478,8 +542,25 @@ uint32 Module::getLineAt( uint32 pc ) const
    }
 }
 
+void Module::decodeLineInfo()
+{
+   if ( m_lineData == 0 )
+      return;
+
+   delete m_lineInfo;
+   m_lineInfo = new LineMap;
+   for ( uint32 i = 0; i < m_lineCount; ++i )
+      m_lineInfo->addEntry( m_lineData[i*2], m_lineData[i*2+1] );
+
+   memFree( m_lineData );
+   m_lineData = 0;
+   m_lineCount = 0;
+}
+
+
 void Module::addLineInfo( uint32 pc, uint32 line )
 {
+   decodeLineInfo();
    if ( m_lineInfo == 0 )
       m_lineInfo = new LineMap;
 
@@ -489,6 +570,13 @@ void Module::addLineInfo( uint32 pc, uint32 line )
 
 void Module::setLineInfo( LineMap *infos )
 {
+   if ( m_lineData != 0 )
+   {
+      memFree( m_lineData );
+      m_lineData = 0;
+      m_lineCount = 0;
+   }
+
    delete m_lineInfo;
    m_lineInfo = infos;
 }
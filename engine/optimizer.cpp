@@ -0,0 +1,476 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: optimizer.cpp
+
+   Syntactic tree optimizer.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 15:32:40 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/optimizer.h>
+#include <falcon/syntree.h>
+#include <falcon/item.h>
+#include <falcon/error.h>
+
+namespace Falcon
+{
+
+//=========================================================
+// Helpers converting between compile time values and items
+//
+
+static bool s_valueToItem( const Value *val, Item &item )
+{
+   switch( val->type() )
+   {
+      case Value::t_nil: item.setNil(); return true;
+      case Value::t_imm_bool: item.setBoolean( val->asBool() ); return true;
+      case Value::t_imm_integer: item.setInteger( val->asInteger() ); return true;
+      case Value::t_imm_num: item.setNumeric( val->asNumeric() ); return true;
+      // the string is owned by the module; the item just peeks it.
+      case Value::t_imm_string: item.setString( val->asString() ); return true;
+      default:
+         return false;
+   }
+}
+
+static bool s_itemToValue( const Item &item, Value *val )
+{
+   switch( item.type() )
+   {
+      case FLC_ITEM_NIL: val->setNil(); return true;
+      case FLC_ITEM_BOOL: val->setBool( item.asBoolean() ); return true;
+      case FLC_ITEM_INT: val->setInteger( item.asInteger() ); return true;
+      case FLC_ITEM_NUM: val->setNumeric( item.asNumeric() ); return true;
+      default:
+         return false;
+   }
+}
+
+
+//=========================================================
+// Optimizer
+//
+
+Optimizer::Optimizer():
+   m_folded( 0 ),
+   m_pruned( 0 )
+{}
+
+
+bool Optimizer::isConstant( const Value *val )
+{
+   switch( val->type() )
+   {
+      case Value::t_nil:
+      case Value::t_imm_bool:
+      case Value::t_imm_integer:
+      case Value::t_imm_num:
+      case Value::t_imm_string:
+         return true;
+
+      default:
+         return false;
+   }
+}
+
+
+bool Optimizer::isTrue( const Value *val )
+{
+   Item item;
+   s_valueToItem( val, item );
+   return item.isTrue();
+}
+
+
+void Optimizer::splice( StatementList &source, StatementList &target )
+{
+   while( ! source.empty() )
+      target.push_back( source.pop_front() );
+}
+
+
+void Optimizer::optimize( SourceTree *st )
+{
+   optimizeBlock( st->statements() );
+
+   Statement *stmt = st->functions().front();
+   while( stmt != 0 )
+   {
+      StmtFunction *func = static_cast<StmtFunction *>( stmt );
+      optimizeBlock( func->staticBlock() );
+      optimizeBlock( func->statements() );
+      stmt = static_cast<Statement *>( stmt->next() );
+   }
+
+   stmt = st->classes().front();
+   while( stmt != 0 )
+   {
+      StmtClass *cls = static_cast<StmtClass *>( stmt );
+      optimizeArray( &cls->initExpressions() );
+      stmt = static_cast<Statement *>( stmt->next() );
+   }
+}
+
+
+void Optimizer::optimizeBlock( StatementList &block )
+{
+   // Take away all the statements, and put back the ones that survive.
+   StatementList pending;
+   splice( block, pending );
+
+   while( ! pending.empty() )
+   {
+      Statement *stmt = pending.pop_front();
+      if ( optimizeStatement( stmt, block ) )
+      {
+         ++m_pruned;
+         delete stmt;
+      }
+      else
+         block.push_back( stmt );
+   }
+}
+
+
+bool Optimizer::optimizeStatement( Statement *stmt, StatementList &target )
+{
+   switch( stmt->type() )
+   {
+      case Statement::t_autoexp:
+      case Statement::t_return:
+      case Statement::t_launch:
+      case Statement::t_raise:
+      case Statement::t_fordot:
+         foldValue( static_cast<StmtExpression *>( stmt )->value() );
+      break;
+
+      case Statement::t_self_print:
+         optimizeArray( static_cast<StmtSelfPrint *>( stmt )->toPrint() );
+      break;
+
+      case Statement::t_propdef:
+         foldValue( static_cast<StmtVarDef *>( stmt )->value() );
+      break;
+
+      case Statement::t_if:
+      {
+         bool remove = false;
+         optimizeIf( stmt, target, remove );
+         return remove;
+      }
+
+      case Statement::t_while:
+      {
+         StmtWhile *wh = static_cast<StmtWhile *>( stmt );
+         foldValue( wh->condition() );
+         if ( isConstant( wh->condition() ) && ! isTrue( wh->condition() ) )
+            return true;
+
+         optimizeBlock( wh->children() );
+      }
+      break;
+
+      case Statement::t_loop:
+      {
+         StmtLoop *loop = static_cast<StmtLoop *>( stmt );
+         foldValue( loop->condition() );
+         optimizeBlock( loop->children() );
+      }
+      break;
+
+      case Statement::t_forin:
+      {
+         StmtForin *fin = static_cast<StmtForin *>( stmt );
+         foldValue( fin->source() );
+         optimizeBlock( fin->children() );
+         optimizeBlock( fin->firstBlock() );
+         optimizeBlock( fin->middleBlock() );
+         optimizeBlock( fin->lastBlock() );
+      }
+      break;
+
+      case Statement::t_switch:
+      case Statement::t_select:
+      {
+         // case blocks are referenced by position; they are never removed.
+         StmtSwitch *sw = static_cast<StmtSwitch *>( stmt );
+         foldValue( sw->switchItem() );
+         optimizeBlock( sw->blocks() );
+         optimizeBlock( sw->defaultBlock() );
+      }
+      break;
+
+      case Statement::t_try:
+      {
+         StmtTry *tr = static_cast<StmtTry *>( stmt );
+         optimizeBlock( tr->children() );
+         optimizeBlock( tr->handlers() );
+         if ( tr->defaultHandler() != 0 )
+            optimizeBlock( tr->defaultHandler()->children() );
+      }
+      break;
+
+      case Statement::t_case:
+      case Statement::t_catch:
+         optimizeBlock( static_cast<StmtBlock *>( stmt )->children() );
+      break;
+
+      default:
+         break;
+   }
+
+   return false;
+}
+
+
+void Optimizer::optimizeIf( Statement *stmt, StatementList &target, bool &remove )
+{
+   StmtIf *stif = static_cast<StmtIf *>( stmt );
+
+   foldValue( stif->condition() );
+   optimizeBlock( stif->children() );
+
+   // process the elifs, dropping the ones that can't ever be taken.
+   StatementList &elifs = stif->elifChildren();
+   StmtElif *elif = static_cast<StmtElif *>( elifs.front() );
+   while( elif != 0 )
+   {
+      StmtElif *next = static_cast<StmtElif *>( elif->next() );
+      foldValue( elif->condition() );
+
+      if ( isConstant( elif->condition() ) )
+      {
+         elifs.remove( elif );
+         ++m_pruned;
+
+         if ( isTrue( elif->condition() ) )
+         {
+            // this elif becomes the else branch; what follows is unreachable.
+            StatementList &elseBlock = stif->elseChildren();
+            while( ! elseBlock.empty() )
+               delete elseBlock.pop_front();
+            splice( elif->children(), elseBlock );
+
+            while( next != 0 )
+            {
+               StmtElif *n = static_cast<StmtElif *>( next->next() );
+               elifs.remove( next );
+               ++m_pruned;
+               delete next;
+               next = n;
+            }
+         }
+
+         delete elif;
+      }
+      else
+         optimizeBlock( elif->children() );
+
+      elif = next;
+   }
+
+   optimizeBlock( stif->elseChildren() );
+
+   if ( isConstant( stif->condition() ) )
+   {
+      if ( isTrue( stif->condition() ) )
+      {
+         splice( stif->children(), target );
+         remove = true;
+      }
+      else if ( elifs.empty() )
+      {
+         splice( stif->elseChildren(), target );
+         remove = true;
+      }
+   }
+}
+
+
+void Optimizer::optimizeArray( ArrayDecl *arr )
+{
+   ListElement *elem = arr->begin();
+   while( elem != 0 )
+   {
+      foldValue( (Value *) elem->data() );
+      elem = elem->next();
+   }
+}
+
+
+void Optimizer::foldValue( Value *val )
+{
+   if ( val == 0 )
+      return;
+
+   switch( val->type() )
+   {
+      case Value::t_array_decl:
+         optimizeArray( val->asArray() );
+      return;
+
+      case Value::t_dict_decl:
+      {
+         ListElement *elem = val->asDict()->begin();
+         while( elem != 0 )
+         {
+            DictDecl::pair *p = (DictDecl::pair *) elem->data();
+            foldValue( p->first );
+            foldValue( p->second );
+            elem = elem->next();
+         }
+      }
+      return;
+
+      case Value::t_range_decl:
+         foldValue( val->asRange()->rangeStart() );
+         foldValue( val->asRange()->rangeEnd() );
+         foldValue( val->asRange()->rangeStep() );
+      return;
+
+      case Value::t_expression:
+      break;
+
+      default:
+         return;
+   }
+
+   Expression *expr = val->asExpr();
+   foldValue( expr->first() );
+   foldValue( expr->second() );
+   foldValue( expr->third() );
+
+   // the ternary operator can be resolved as soon as its condition is known.
+   if ( expr->type() == Expression::t_iif )
+   {
+      if ( isConstant( expr->first() ) )
+      {
+         Value *branch = isTrue( expr->first() ) ? expr->second() : expr->third();
+         val->transfer( *branch );
+         delete expr;
+         ++m_folded;
+      }
+      return;
+   }
+
+   Item first, second, result;
+   if ( expr->first() == 0 || ! s_valueToItem( expr->first(), first ) )
+      return;
+
+   bool bBinary = expr->isBinaryOperator();
+   if ( bBinary && ( expr->second() == 0 || ! s_valueToItem( expr->second(), second ) ) )
+      return;
+
+   try
+   {
+      switch( expr->type() )
+      {
+         // unary operators
+         case Expression::t_neg:
+            if ( ! first.isNumeric() && ! first.isInteger() )
+               return;
+            first.neg( result );
+         break;
+
+         case Expression::t_bin_not:
+            if ( ! first.isInteger() )
+               return;
+            result.setInteger( ~first.asInteger() );
+         break;
+
+         case Expression::t_not:
+            result.setInteger( first.isTrue() ? 0 : 1 );
+         break;
+
+         // binary bitwise operators
+         case Expression::t_bin_and:
+         case Expression::t_bin_or:
+         case Expression::t_bin_xor:
+            if ( ! first.isOrdinal() || ! second.isOrdinal() )
+               return;
+            if ( expr->type() == Expression::t_bin_and )
+               result.setInteger( first.forceInteger() & second.forceInteger() );
+            else if ( expr->type() == Expression::t_bin_or )
+               result.setInteger( first.forceInteger() | second.forceInteger() );
+            else
+               result.setInteger( first.forceInteger() ^ second.forceInteger() );
+         break;
+
+         case Expression::t_shift_left:
+         case Expression::t_shift_right:
+            if ( ! first.isInteger() || ! second.isInteger()
+                 || second.asInteger() < 0 || second.asInteger() > 63 )
+               return;
+            if ( expr->type() == Expression::t_shift_left )
+               result.setInteger( first.asInteger() << second.asInteger() );
+            else
+               result.setInteger( first.asInteger() >> second.asInteger() );
+         break;
+
+         // logic operators; only the fully constant case can be folded
+         case Expression::t_and:
+            result.setBoolean( first.isTrue() && second.isTrue() );
+         break;
+
+         case Expression::t_or:
+            result.setBoolean( first.isTrue() || second.isTrue() );
+         break;
+
+         // math operators; strings are already folded by the parser.
+         case Expression::t_plus:
+         case Expression::t_minus:
+         case Expression::t_times:
+         case Expression::t_divide:
+         case Expression::t_modulo:
+         case Expression::t_power:
+            if ( ! ( first.isInteger() || first.isNumeric() ) ||
+                 ! ( second.isInteger() || second.isNumeric() ) )
+               return;
+
+            switch( expr->type() )
+            {
+               case Expression::t_plus: first.add( second, result ); break;
+               case Expression::t_minus: first.sub( second, result ); break;
+               case Expression::t_times: first.mul( second, result ); break;
+               case Expression::t_divide: first.div( second, result ); break;
+               case Expression::t_modulo: first.mod( second, result ); break;
+               default: first.pow( second, result ); break;
+            }
+         break;
+
+         // comparisons
+         case Expression::t_gt: result.setBoolean( first > second ); break;
+         case Expression::t_ge: result.setBoolean( first >= second ); break;
+         case Expression::t_lt: result.setBoolean( first < second ); break;
+         case Expression::t_le: result.setBoolean( first <= second ); break;
+         case Expression::t_eq: result.setBoolean( first == second ); break;
+         case Expression::t_neq: result.setBoolean( first != second ); break;
+
+         default:
+            return;
+      }
+   }
+   catch( Error *e )
+   {
+      // leave the error to be raised at runtime.
+      e->decref();
+      return;
+   }
+
+   if ( s_itemToValue( result, val ) )
+   {
+      delete expr;
+      ++m_folded;
+   }
+}
+
+}
+
+/* end of optimizer.cpp */
@@ -0,0 +1,88 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: preparedcall.cpp
+
+   Callable items resolved once and called repeatedly.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 17:42:04 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Callable items resolved once and called repeatedly.
+*/
+
+#include <falcon/preparedcall.h>
+#include <falcon/corefunc.h>
+#include <falcon/mempool.h>
+
+namespace Falcon {
+
+PreparedCall::PreparedCall( const Item &callable, uint32 paramCount ):
+   m_callable( callable ),
+   m_func( 0 ),
+   m_def( 0 ),
+   m_paramCount( paramCount ),
+   m_bSelf( false )
+{
+   const Item *target = m_callable.dereference();
+
+   if ( target->isFunction() )
+   {
+      m_func = target->asFunction();
+   }
+   else if ( target->isMethod() && target->asMethodFunc()->isFunc() )
+   {
+      m_func = static_cast<CoreFunc*>( target->asMethodFunc() );
+      target->getMethodItem( m_self );
+      m_bSelf = true;
+   }
+
+   // external functions are called at the next loop in any case.
+   if ( m_func != 0 )
+   {
+      if ( m_func->symbol()->isFunction() )
+      {
+         m_def = m_func->symbol()->getFuncDef();
+      }
+      else
+      {
+         m_func = 0;
+         m_self.setNil();
+         m_bSelf = false;
+      }
+   }
+}
+
+
+PreparedCall::PreparedCall( const PreparedCall &other ):
+   m_callable( other.m_callable ),
+   m_self( other.m_self ),
+   m_func( other.m_func ),
+   m_def( other.m_def ),
+   m_paramCount( other.m_paramCount ),
+   m_bSelf( other.m_bSelf )
+{
+}
+
+
+void PreparedCall::gcMark( uint32 mark )
+{
+   memPool->markItem( m_callable );
+   memPool->markItem( m_self );
+}
+
+
+FalconData *PreparedCall::clone() const
+{
+   return new PreparedCall( *this );
+}
+
+}
+
+/* end of preparedcall.cpp */
@@ -0,0 +1,282 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: profiler.cpp
+
+   Sampling profiler for scripts.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 17:49:29 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Sampling profiler for scripts.
+*/
+
+#include <falcon/profiler.h>
+#include <falcon/vm.h>
+#include <falcon/vmcontext.h>
+#include <falcon/stackframe.h>
+#include <falcon/symbol.h>
+#include <falcon/module.h>
+#include <falcon/stream.h>
+#include <falcon/traits.h>
+#include <falcon/sys.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace Falcon {
+
+class Profiler::FuncStat: public BaseAlloc
+{
+public:
+   String m_name;
+   uint32 m_self;
+   uint32 m_total;
+   /** Last sample counted in m_total, so that recursive functions are counted once. */
+   uint32 m_stamp;
+
+   FuncStat( const String& name ):
+      m_name( name ),
+      m_self( 0 ),
+      m_total( 0 ),
+      m_stamp( 0 )
+   {}
+
+   /** Orders FuncStat pointers by self, then total samples, descending. */
+   static int compare( const void* a, const void* b )
+   {
+      const FuncStat* sa = *(const FuncStat**) a;
+      const FuncStat* sb = *(const FuncStat**) b;
+      if ( sa->m_self != sb->m_self )
+         return sa->m_self > sb->m_self ? -1 : 1;
+      if ( sa->m_total != sb->m_total )
+         return sa->m_total > sb->m_total ? -1 : 1;
+      return 0;
+   }
+};
+
+
+Profiler::Profiler( uint32 rate ):
+   m_bActive( false ),
+   m_samples( 0 ),
+   m_stacks( &traits::t_string(), &traits::t_int() ),
+   m_funcs( &traits::t_string(), &traits::t_voidp() )
+{
+   start( rate == 0 ? 100 : rate );
+}
+
+
+Profiler::~Profiler()
+{
+   reset();
+}
+
+
+void Profiler::start( uint32 rate )
+{
+   if ( rate != 0 )
+   {
+      m_rate = rate;
+      m_interval = 1.0 / rate;
+   }
+
+   m_nextSample = Sys::_seconds() + m_interval;
+   m_bActive = true;
+}
+
+
+void Profiler::reset()
+{
+   MapIterator iter = m_funcs.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(FuncStat**) iter.currentValue();
+      iter.next();
+   }
+
+   m_funcs.clear();
+   m_stacks.clear();
+   m_samples = 0;
+}
+
+
+void Profiler::check( VMContext* ctx )
+{
+   if ( ! m_bActive )
+      return;
+
+   numeric now = Sys::_seconds();
+   if ( now < m_nextSample )
+      return;
+
+   // a late check stands for all the samples we missed.
+   uint32 weight = (uint32) ((now - m_nextSample) / m_interval) + 1;
+   m_nextSample = now + m_interval;
+   sample( ctx, weight );
+}
+
+
+void Profiler::frameName( const Symbol* sym, String& name ) const
+{
+   name = sym->module()->name();
+   name += ".";
+   name += sym->name();
+}
+
+
+void Profiler::sample( VMContext* ctx, uint32 weight )
+{
+   // collect the frames from the leaf; each frame records the caller and its pc.
+   uint32 depth = 0;
+   bool bTruncated = false;
+   const Symbol* sym = ctx->symbol();
+   uint32 pc = ctx->pc();
+   StackFrame* frame = ctx->currentFrame();
+
+   while( true )
+   {
+      if ( sym != 0 )
+      {
+         if ( depth == max_depth )
+         {
+            bTruncated = true;
+            break;
+         }
+
+         m_syms[depth] = sym;
+         m_lines[depth] = sym->isFunction() && pc < VMachine::i_pc_call_request ?
+               sym->module()->getLineAt( sym->getFuncDef()->basePC() + pc ) : 0;
+         ++depth;
+      }
+
+      if ( frame == 0 )
+         break;
+
+      sym = frame->m_symbol;
+      pc = frame->m_call_pc;
+      frame = frame->prev();
+   }
+
+   if ( depth == 0 )
+      return;
+
+   m_samples += weight;
+
+   String stack( bTruncated ? "...;" : "" );
+   String name;
+   uint32 stamp = m_samples;
+
+   for ( uint32 i = depth; i > 0; )
+   {
+      --i;
+      frameName( m_syms[i], name );
+
+      FuncStat* stat;
+      void* pstat = m_funcs.find( &name );
+      if ( pstat == 0 )
+      {
+         stat = new FuncStat( name );
+         m_funcs.insert( &name, stat );
+      }
+      else
+         stat = *(FuncStat**) pstat;
+
+      if ( stat->m_stamp != stamp )
+      {
+         stat->m_stamp = stamp;
+         stat->m_total += weight;
+      }
+
+      if ( i == 0 )
+         stat->m_self += weight;
+
+      stack += name;
+      stack += ":";
+      stack.writeNumber( (int64) m_lines[i] );
+      if ( i > 0 )
+         stack += ";";
+   }
+
+   int32* count = (int32*) m_stacks.find( &stack );
+   if ( count == 0 )
+   {
+      int32 w = (int32) weight;
+      m_stacks.insert( &stack, &w );
+   }
+   else
+      *count += weight;
+}
+
+
+bool Profiler::writeCollapsed( Stream* out ) const
+{
+   String line;
+   MapIterator iter = m_stacks.begin();
+   while( iter.hasCurrent() )
+   {
+      line = *(String*) iter.currentKey();
+      line += " ";
+      line.writeNumber( (int64) *(int32*) iter.currentValue() );
+      line += "\n";
+      if ( ! out->writeString( line ) )
+         return false;
+      iter.next();
+   }
+
+   return true;
+}
+
+
+bool Profiler::writeTable( Stream* out ) const
+{
+   char buffer[64];
+   String line;
+
+   line = "Samples: ";
+   line.writeNumber( (int64) m_samples );
+   line += " (";
+   line.writeNumber( (int64) m_rate );
+   line += " per second)\n  Self%     Self  Total%    Total  Function\n";
+   if ( ! out->writeString( line ) )
+      return false;
+
+   uint32 count = m_funcs.size();
+   if ( count == 0 || m_samples == 0 )
+      return true;
+
+   FuncStat** stats = (FuncStat**) memAlloc( count * sizeof( FuncStat* ) );
+   uint32 pos = 0;
+   MapIterator iter = m_funcs.begin();
+   while( iter.hasCurrent() )
+   {
+      stats[pos++] = *(FuncStat**) iter.currentValue();
+      iter.next();
+   }
+   qsort( stats, count, sizeof( FuncStat* ), FuncStat::compare );
+
+   bool bOk = true;
+   for ( pos = 0; pos < count && bOk; ++pos )
+   {
+      const FuncStat* stat = stats[pos];
+      sprintf( buffer, "%7.2f %8u %7.2f %8u  ",
+            stat->m_self * 100.0 / m_samples, (unsigned) stat->m_self,
+            stat->m_total * 100.0 / m_samples, (unsigned) stat->m_total );
+      line = buffer;
+      line += stat->m_name;
+      line += "\n";
+      bOk = out->writeString( line );
+   }
+
+   memFree( stats );
+   return bOk;
+}
+
+}
+
+/* end of profiler.cpp */
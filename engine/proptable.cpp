@@ -26,6 +26,9 @@
 
 #include <string.h>
 
+// Tables up to this size are scanned for the atom of a property name first.
+#define PROPTABLE_ATOM_SCAN  16
+
 namespace Falcon
 {
 
@@ -78,69 +81,41 @@ void PropertyTable::checkProperties()
 
 bool PropertyTable::findKey( const String &key, uint32 &pos ) const
 {
-   uint32 lower = 0, higher, point;
-   higher = m_size;
-   const String *current;
-
-   if ( higher == 0 ) {
-      pos = 0;
-      return false;
+   // Property names are atoms, and so are the names the VM uses to access
+   // them from the modules; the access can usually be resolved by identity.
+   if ( m_added <= PROPTABLE_ATOM_SCAN )
+   {
+      for ( uint32 i = 0; i < m_added; ++i )
+      {
+         if ( m_entries[i].m_name == &key )
+         {
+            pos = i;
+            return true;
+         }
+      }
    }
-   higher --;
 
-   point = higher / 2;
+   uint32 lower = 0;
+   uint32 higher = m_added;
 
-   while ( true )
+   while ( lower < higher )
    {
-      // get the table row
-      current = m_entries[point].m_name;
+      uint32 point = ( lower + higher ) / 2;
+      int cmp = key.compare( *m_entries[point].m_name );
 
-      if( *current == key ) {
+      if ( cmp == 0 )
+      {
          pos = point;
          return true;
       }
+      else if ( cmp > 0 )
+         lower = point + 1;
       else
-      {
-         if ( lower == higher -1 )
-         {
-            // key is EVEN less than the lower one
-            if ( key < *current )
-            {
-               pos = lower;
-               return false;
-            }
-
-            // being integer math, ulPoint is rounded by defect and has
-            // already looked at the ulLower position
-            if ( key == *m_entries[higher].m_name ) {
-               pos = higher;
-               return true;
-            }
-
-            // we cannot find it
-            break;
-         }
-         else if ( lower == higher )
-         {
-            // again, can't find it.
-            break;
-         }
-
-         if ( key > *current )
-         {
-            lower = point;
-         }
-         else
-         {
-            higher = point;
-         }
-         point = ( lower + higher ) / 2;
-      }
+         higher = point;
    }
 
    // entry not found, but signal the best match anyway
-   pos =  key > *current ? higher + 1 : higher;
-
+   pos = lower;
    return false;
 }
 
@@ -18,6 +18,8 @@
 #include <falcon/traits.h>
 #include <falcon/vm.h>
 #include <falcon/path.h>
+#include <falcon/mt.h>
+#include <falcon/sys.h>
 
 namespace Falcon {
 
@@ -35,14 +37,18 @@ Runtime::Runtime():
    m_loader( 0 ),
    m_provider( 0 ),
    m_modPending( &traits::t_stringptr(), &traits::t_int() ),
-   m_hasMainModule( true )
+   m_hasMainModule( true ),
+   m_loadThreads( 1 ),
+   m_prefetched( &traits::t_string(), &traits::t_voidp() )
 {}
 
 Runtime::Runtime( ModuleLoader *loader, VMachine *prov ):
    m_loader( loader ),
    m_provider( prov ),
    m_modPending( &traits::t_stringptr(), &traits::t_int() ),
-   m_hasMainModule( true )
+   m_hasMainModule( true ),
+   m_loadThreads( 1 ),
+   m_prefetched( &traits::t_string(), &traits::t_voidp() )
 {}
 
 /** Declared here to avoid inlining of destructor. */
@@ -55,7 +61,258 @@ Runtime::~Runtime()
 }
 
 
+namespace {
+
+/** A dependency loaded ahead of linking. */
+class PrefetchJob: public BaseAlloc
+{
+public:
+   String m_key;
+   /** The file or the logical name of the module. */
+   String m_target;
+   String m_parent;
+   bool m_bFile;
+   Module *m_module;
+};
+
+
+/** Jobs of one level of the dependency graph, taken in turn by the loading threads. */
+class PrefetchQueue: public BaseAlloc
+{
+public:
+   PrefetchQueue( PrefetchJob **jobs, uint32 count ):
+      m_jobs( jobs ),
+      m_count( count ),
+      m_next( 0 )
+   {}
+
+   void work( ModuleLoader *loader )
+   {
+      for(;;)
+      {
+         m_mtx.lock();
+         uint32 pos = m_next++;
+         m_mtx.unlock();
+
+         if ( pos >= m_count )
+            break;
+
+         PrefetchJob *job = m_jobs[pos];
+         try
+         {
+            if ( job->m_bFile )
+               job->m_module = loader->loadFile( job->m_target );
+            else
+               job->m_module = loader->loadName( job->m_target, job->m_parent );
+         }
+         catch( Error *e )
+         {
+            // linking will load it again, and report the error.
+            e->decref();
+         }
+      }
+   }
+
+private:
+   PrefetchJob **m_jobs;
+   uint32 m_count;
+   Mutex m_mtx;
+   uint32 m_next;
+};
+
+
+class PrefetchWorker: public Runnable, public BaseAlloc
+{
+public:
+   PrefetchWorker( PrefetchQueue *queue, ModuleLoader *loader ):
+      m_queue( queue ),
+      m_loader( loader )
+   {}
+
+   virtual ~PrefetchWorker() { delete m_loader; }
+
+   virtual void* run()
+   {
+      m_queue->work( m_loader );
+      return 0;
+   }
+
+private:
+   PrefetchQueue *m_queue;
+   ModuleLoader *m_loader;
+};
+
+
+/** Key identifying the module requested by a dependency. */
+void s_depKey( const Module *mod, const ModuleDepData *depdata, String &target, String &key )
+{
+   const String &moduleName = depdata->moduleName();
+   if( depdata->isFile() )
+   {
+      // if the path is relative, then it's relative to the parent module path.
+      Path p(moduleName);
+      if ( !p.isAbsolute() )
+         target = Path(mod->path()).getFullLocation() + "/" + moduleName;
+      else
+         target = moduleName;
+      key = "file:" + target;
+   }
+   else
+   {
+      target = moduleName;
+      String absName;
+      Module::absoluteName( moduleName, mod->name(), absName );
+      key = "name:" + absName;
+   }
+}
+
+}
+
+
 void Runtime::addModule( Module *mod, bool isPrivate )
+{
+   if ( m_modules.find( &mod->name() ) != 0 )
+      return;  // already in..
+
+   if ( m_loader != 0 && m_loadThreads != 1 && ! mod->dependencies().empty() )
+      prefetch( mod );
+
+   try
+   {
+      addModule_rec( mod, isPrivate );
+   }
+   catch( Error* )
+   {
+      releasePrefetched();
+      throw;
+   }
+
+   releasePrefetched();
+}
+
+
+void Runtime::prefetch( Module *mod )
+{
+   uint32 threads = m_loadThreads != 0 ? m_loadThreads : Sys::_cpuCount();
+
+   GenericVector level( &traits::t_voidp() );
+   level.push( mod );
+
+   while( ! level.empty() )
+   {
+      // collect the dependencies not known yet.
+      GenericVector jobs( &traits::t_voidp() );
+      Map queued( &traits::t_string(), &traits::t_voidp() );
+
+      for ( uint32 i = 0; i < level.size(); ++i )
+      {
+         Module *parent = *(Module **) level.at( i );
+         MapIterator deps = parent->dependencies().begin();
+         while( deps.hasCurrent() )
+         {
+            const ModuleDepData *depdata = *(const ModuleDepData **) deps.currentValue();
+            const String &moduleName = depdata->moduleName();
+            deps.next();
+
+            if ( m_modules.find( &moduleName ) != 0
+                 || ( m_provider != 0 && m_provider->findModule( moduleName ) != 0 ) )
+               continue;
+
+            PrefetchJob *job = new PrefetchJob;
+            s_depKey( parent, depdata, job->m_target, job->m_key );
+            if ( m_prefetched.find( &job->m_key ) != 0 || queued.find( &job->m_key ) != 0 )
+            {
+               delete job;
+               continue;
+            }
+
+            job->m_parent = parent->name();
+            job->m_bFile = depdata->isFile();
+            job->m_module = 0;
+            queued.insert( &job->m_key, job );
+            jobs.push( job );
+         }
+      }
+
+      if ( jobs.empty() )
+         break;
+
+      // load them; this thread takes part in the work with the original loader.
+      PrefetchQueue queue( (PrefetchJob **) jobs.at( 0 ), jobs.size() );
+      GenericVector workers( &traits::t_voidp() );
+      for ( uint32 i = 1; i < threads && i < jobs.size(); ++i )
+      {
+         PrefetchWorker *worker = new PrefetchWorker( &queue, m_loader->clone() );
+         SysThread *th = new SysThread( worker );
+         if ( ! th->start() )
+         {
+            th->disengage();
+            delete worker;
+            break;
+         }
+         workers.push( th );
+         workers.push( worker );
+      }
+
+      queue.work( m_loader );
+
+      for ( uint32 i = 0; i < workers.size(); i += 2 )
+      {
+         void *dummy;
+         (*(SysThread **) workers.at( i ))->join( dummy );
+         delete *(PrefetchWorker **) workers.at( i + 1 );
+      }
+
+      // the loaded modules form the next level.
+      level.resize( 0 );
+      for ( uint32 i = 0; i < jobs.size(); ++i )
+      {
+         PrefetchJob *job = *(PrefetchJob **) jobs.at( i );
+         if ( job->m_module != 0 )
+         {
+            m_prefetched.insert( &job->m_key, job->m_module );
+            level.push( job->m_module );
+         }
+         delete job;
+      }
+   }
+}
+
+
+void Runtime::releasePrefetched()
+{
+   MapIterator iter = m_prefetched.begin();
+   while( iter.hasCurrent() )
+   {
+      (*(Module **) iter.currentValue())->decref();
+      iter.next();
+   }
+   m_prefetched.clear();
+}
+
+
+Module *Runtime::loadDependency( Module *mod, const ModuleDepData *depdata )
+{
+   String target, key;
+   s_depKey( mod, depdata, target, key );
+
+   // loaded ahead?
+   Module **prefetched = (Module **) m_prefetched.find( &key );
+   if ( prefetched != 0 )
+   {
+      Module *l = *prefetched;
+      m_prefetched.erase( &key );
+      return l;
+   }
+
+   if( depdata->isFile() )
+      return m_loader->loadFile( target );
+
+   return m_loader->loadName( target, mod->name() );
+}
+
+
+void Runtime::addModule_rec( Module *mod, bool isPrivate )
 {
    if ( m_modules.find( &mod->name() ) != 0 )
       return;  // already in..
@@ -104,23 +361,7 @@ void Runtime::addModule( Module *mod, bool isPrivate )
 
          Module *l = 0;
          try {
-            if( depdata->isFile() )
-            {
-               // if the path is relative, then it's relative to the parent module path.
-               Path p(moduleName);
-               if ( !p.isAbsolute() )
-               {
-                 l = m_loader->loadFile(  Path(mod->path()).getFullLocation() + "/" + moduleName );
-               }
-               else
-               {
-                 l = m_loader->loadFile( moduleName );
-               }
-            }
-            else
-            {
-               l = m_loader->loadName( moduleName, mod->name() );
-            }
+            l = loadDependency( mod, depdata );
          }
          catch( Error* e)
          {
@@ -142,7 +383,7 @@ void Runtime::addModule( Module *mod, bool isPrivate )
 
          try
          {
-            addModule( l, depdata->isPrivate() );
+            addModule_rec( l, depdata->isPrivate() );
          }
          catch( Error* )
          {
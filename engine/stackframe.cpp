@@ -19,10 +19,131 @@
 
 #include <falcon/stackframe.h>
 #include <falcon/mempool.h>
+#include <falcon/memory.h>
+#include <string.h>
+
+#define STACK_SEGMENT_MAX  32768
 
 namespace Falcon
 {
 
+//==================================================
+// Stack segments
+//
+
+StackSegment* StackSegment::create( uint32 size, StackSegment* prev )
+{
+   StackSegment* seg = (StackSegment*) memAlloc( sizeof( StackSegment ) + size * sizeof( Item ) );
+   seg->m_prev = prev;
+   seg->m_next = 0;
+   seg->m_size = size;
+   return seg;
+}
+
+void StackSegment::destroyChain( StackSegment* first )
+{
+   while( first != 0 )
+   {
+      StackSegment* next = first->m_next;
+      memFree( first );
+      first = next;
+   }
+}
+
+StackSegment* StackSegment::next( uint32 size )
+{
+   if ( m_next != 0 )
+   {
+      if ( m_next->m_size >= size )
+         return m_next;
+
+      destroyChain( m_next );
+   }
+
+   // segments double up to a limit, but can always hold what's required.
+   uint32 nsize = m_size >= STACK_SEGMENT_MAX/2 ? STACK_SEGMENT_MAX : m_size * 2;
+   if ( nsize < size * 2 )
+      nsize = size * 2;
+
+   m_next = create( nsize, this );
+   return m_next;
+}
+
+//==================================================
+// Stack windows
+//
+
+StackWindow::StackWindow( const StackWindow& other ):
+   m_size( other.m_size ),
+   m_alloc( other.m_size ),
+   m_segment( 0 )
+{
+   if( m_size != 0 )
+   {
+      m_data = (Item*) memAlloc( m_size * sizeof( Item ) );
+      memcpy( (void*) m_data, other.m_data, m_size * sizeof( Item ) );
+   }
+   else
+      m_data = 0;
+}
+
+StackWindow::~StackWindow()
+{
+   if ( m_segment == 0 && m_data != 0 )
+      memFree( m_data );
+}
+
+void StackWindow::place( StackSegment* seg, Item* base )
+{
+   if ( m_segment == 0 && m_data != 0 )
+      memFree( m_data );
+
+   m_segment = seg;
+   m_data = base;
+   m_size = 0;
+   m_alloc = (uint32) (seg->end() - base);
+}
+
+void StackWindow::detach()
+{
+   if ( m_segment == 0 )
+      return;
+
+   m_segment = 0;
+   m_alloc = m_size;
+
+   if( m_size != 0 )
+   {
+      Item* data = (Item*) memAlloc( m_size * sizeof( Item ) );
+      memcpy( (void*) data, m_data, m_size * sizeof( Item ) );
+      m_data = data;
+   }
+   else
+      m_data = 0;
+}
+
+void StackWindow::grow( uint32 size )
+{
+   if ( m_segment != 0 )
+   {
+      // only the topmost frame grows; it moves to the next segment.
+      StackSegment* seg = m_segment->next( size );
+      memcpy( (void*) seg->items(), m_data, m_size * sizeof( Item ) );
+      m_segment = seg;
+      m_data = seg->items();
+      m_alloc = seg->size();
+   }
+   else
+   {
+      m_alloc = size + m_size / 2 + 8;
+      m_data = (Item*) memRealloc( m_data, m_alloc * sizeof( Item ) );
+   }
+}
+
+//==================================================
+// Stack frames
+//
+
 StackFrame::StackFrame( const StackFrame& other ):
    m_break( other.m_break ),
    m_ret_pc( other.m_ret_pc ),
@@ -36,6 +157,7 @@ StackFrame::StackFrame( const StackFrame& other ):
    m_self( other.m_self ),
    m_binding( other.m_binding ),
    m_params( other.m_params ),
+   m_enterTime( other.m_enterTime ),
    m_prev(0),
    m_stack(other.m_stack)
 {
@@ -155,6 +155,111 @@ bool Stream::readString( String &target, uint32 size )
    return true;
 }
 
+bool Stream::readLine( String &target, uint32 maxChars )
+{
+   uint32 chr;
+   uint32 count = 0;
+
+   // characters pushed back must be read through get()
+   if ( bufferEmpty() && hasReadWindow() )
+   {
+      while( count < maxChars )
+      {
+         int32 avail;
+         const byte *window = readWindow( avail );
+         if ( window == 0 )
+            return false;
+
+         if ( (uint32) avail > maxChars - count )
+            avail = (int32) (maxChars - count);
+
+         const byte *eol = (const byte *) memchr( window, '\n', avail );
+         int32 len = eol == 0 ? avail : (int32) (eol - window);
+
+         if ( len > 0 )
+         {
+            // append the run through a static view on the window.
+            String run;
+            run.adopt( (char *) window, len, 0 );
+            target.append( run );
+            count += len;
+         }
+
+         if ( eol != 0 )
+         {
+            consumeWindow( len + 1 );
+            removeLineCR( target, count );
+            return true;
+         }
+
+         consumeWindow( len );
+      }
+
+      return true;
+   }
+
+   while( count < maxChars )
+   {
+      if ( ! get( chr ) )
+         return false;
+
+      if ( chr == (uint32) '\n' )
+      {
+         removeLineCR( target, count );
+         return true;
+      }
+
+      target.append( chr );
+      ++count;
+   }
+
+   return true;
+}
+
+int32 Stream::readChars( uint32 *target, int32 count )
+{
+   int32 done = 0;
+   while( done < count && popBuffer( target[done] ) )
+      ++done;
+
+   if ( done > 0 || count <= 0 )
+      return done;
+
+   if ( hasReadWindow() )
+   {
+      int32 avail;
+      const byte *window = readWindow( avail );
+      if ( window == 0 )
+         return 0;
+
+      if ( avail > count )
+         avail = count;
+
+      for( ; done < avail; ++done )
+         target[done] = window[done];
+      consumeWindow( avail );
+      return done;
+   }
+
+   return get( target[0] ) ? 1 : 0;
+}
+
+const byte *Stream::readWindow( int32 &avail )
+{
+   avail = 0;
+   return 0;
+}
+
+void Stream::consumeWindow( int32 )
+{
+}
+
+void Stream::removeLineCR( String &target, uint32 count )
+{
+   if ( count > 0 && target.getCharAt( target.length() - 1 ) == (uint32) '\r' )
+      target.size( target.size() - target.manipulator()->charSize() );
+}
+
 bool Stream::writeString( const String &source, uint32 begin, uint32 end )
 {
    uint32 pos = begin;
@@ -364,6 +364,18 @@ bool StreamBuffer::get( uint32 &chr )
    return true;
 }
 
+const byte *StreamBuffer::readWindow( int32 &avail )
+{
+   if ( m_bufPos == m_bufLen )
+   {
+      if( ! m_stream->good() || ! refill() || m_bufLen == 0 )
+         return 0;
+   }
+
+   avail = m_bufLen - m_bufPos;
+   return m_buffer + m_bufPos;
+}
+
 bool StreamBuffer::put( uint32 chr )
 {
    if ( m_bufPos == m_bufSize )
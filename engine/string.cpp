@@ -604,7 +604,7 @@ void Static16::setCharAt( String *str, uint32 pos, uint32 chr ) const
    {
       uint32 *buf32 =  (uint32 *) memAlloc( size * 2 );
       uint16 *buf16 = (uint16 *) str->getRawStorage();
-      for ( int i = 0; i < size; i ++ )
+      for ( int i = 0; i < size / 2; i ++ )
          buf32[ i ] = (uint32) buf16[ i ];
 
       buf32[ pos ] = chr;
@@ -688,7 +688,7 @@ void Buffer16::setCharAt( String *str, uint32 pos, uint32 chr ) const
       int32 size = str->size();
       uint32 *buf32 =  (uint32 *) memAlloc( size * 2 );
       uint16 *buf16 = (uint16 *) str->getRawStorage();
-      for ( int i = 0; i < size; i ++ )
+      for ( int i = 0; i < size / 2; i ++ )
          buf32[ i ] = (uint32) buf16[ i ];
 
       buf32[ pos ] = chr;
@@ -1208,8 +1208,42 @@ int String::compareIgnoreCase( const wchar_t *other ) const
    return 0;
 }
 
+template< class _T >
+inline int s_compareChars( const _T *s1, uint32 len1, const _T *s2, uint32 len2 )
+{
+   uint32 len = len1 > len2 ? len2 : len1;
+   for ( uint32 pos = 0; pos < len; ++pos )
+   {
+      if ( s1[pos] != s2[pos] )
+         return s1[pos] < s2[pos] ? -1 : 1;
+   }
+
+   if ( len1 == len2 )
+      return 0;
+   return len1 < len2 ? -1 : 1;
+}
+
+
 int String::compare( const String &other ) const
 {
+   if ( this == &other )
+      return 0;
+
+   // strings stored with the same character size are compared in place.
+   uint32 cs = m_class->charSize();
+   if ( cs == other.m_class->charSize() )
+   {
+      switch( cs )
+      {
+         case 1:
+            return s_compareChars( m_storage, m_size, other.m_storage, other.m_size );
+         case 2:
+            return s_compareChars( (uint16 *) m_storage, m_size / 2, (uint16 *) other.m_storage, other.m_size / 2 );
+         case 4:
+            return s_compareChars( (uint32 *) m_storage, m_size / 4, (uint32 *) other.m_storage, other.m_size / 4 );
+      }
+   }
+
    uint32 len1 = length();
    uint32 len2 = other.length();
    uint32 len = len1 > len2 ? len2 : len1;
@@ -32,7 +32,8 @@ StringTable::StringTable():
    m_map( &traits::t_stringptr(), &traits::t_int() ),
    m_intMap( &traits::t_stringptr(), &traits::t_int() ),
    m_tableStorage(0),
-   m_internatCount(0)
+   m_internatCount(0),
+   m_indexed(0)
 {}
 
 StringTable::StringTable( const StringTable &other ):
@@ -40,7 +41,8 @@ StringTable::StringTable( const StringTable &other ):
    m_map( &traits::t_stringptr(), &traits::t_int() ),
    m_intMap( &traits::t_stringptr(), &traits::t_int() ),
    m_tableStorage(0),
-   m_internatCount(0)
+   m_internatCount(0),
+   m_indexed(0)
 {
    for( uint32 i = 0; i < other.m_vector.size(); i ++ )
    {
@@ -56,9 +58,24 @@ StringTable::~StringTable()
       memFree( m_tableStorage );
 }
 
+void StringTable::buildIndex() const
+{
+   while( m_indexed < m_vector.size() )
+   {
+      String *str = *(String **) m_vector.at( m_indexed );
+      if ( str->exported() )
+         m_intMap.insert( str, &m_indexed );
+      else
+         m_map.insert( str, &m_indexed );
+      ++m_indexed;
+   }
+}
+
+
 int32 StringTable::add( String *str )
 {
    fassert(str);
+   buildIndex();
    
    if ( str->exported() )
    {
@@ -77,6 +94,7 @@ int32 StringTable::add( String *str )
       m_vector.push( str );
       m_intMap.insert( str, &id );
       m_internatCount++;
+      m_indexed++;
       return id;
    }
    else
@@ -95,6 +113,7 @@ int32 StringTable::add( String *str )
       int32 id = m_vector.size();
       m_vector.push( str );
       m_map.insert( str, &id );
+      m_indexed++;
       return id;
    }
 }
@@ -102,32 +121,43 @@ int32 StringTable::add( String *str )
 String *StringTable::find( const String &source ) const
 {
    MapIterator pos;
+   String *found = 0;
+
+   m_mtx.lock();
+   buildIndex();
    if ( source.exported() )
    {
       if ( m_intMap.find( &source, pos ) )
-         return *(String **) pos.currentKey();
+         found = *(String **) pos.currentKey();
    }
    else {
       if ( m_map.find( &source, pos ) )
-         return *(String **) pos.currentKey();
+         found = *(String **) pos.currentKey();
    }
-   return 0;
+   m_mtx.unlock();
+
+   return found;
 }
 
 int32 StringTable::findId( const String &source ) const
 {
    MapIterator pos;
+   int32 id = -1;
+
+   m_mtx.lock();
+   buildIndex();
    if ( source.exported() )
    {
       if ( m_intMap.find( &source, pos ) )
-         return *(int32 *) pos.currentValue();
+         id = *(int32 *) pos.currentValue();
    }
    else {
       if ( m_map.find( &source, pos ) )
-         return *(int32 *) pos.currentValue();
+         id = *(int32 *) pos.currentValue();
    }
+   m_mtx.unlock();
 
-   return -1;
+   return id;
 }
 
 bool StringTable::save( Stream *out ) const
@@ -172,18 +202,22 @@ bool StringTable::load( Stream *in )
    in->read( &size, sizeof( size ) );
    size = endianInt32( size );
 
+   // Saved tables have no duplicates, so the strings are just appended;
+   // the lookup maps are built if the table is ever searched.
+   buildIndex();
+   m_vector.reserve( m_vector.size() + size );
+
    for( int i = 0; i < size; i ++ )
    {
       String *str = new String();
-      // deserialize and create self-destroying static strings.
       if ( ! str->deserialize( in, false ) ) {
          delete str;
          return false;
       }
 
-      // consider the strings in the string table static.
-      // the destructor will destroy the data anyhow, as we have an allocated data
-      add( str );
+      if ( str->exported() )
+         m_internatCount++;
+      m_vector.push( str );
    }
 
    while( in->tell() %4 != 0 )
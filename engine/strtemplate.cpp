@@ -0,0 +1,240 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: strtemplate.cpp
+
+   Pre-parsed string expansion templates.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 15:52:23 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+#include <falcon/strtemplate.h>
+#include <falcon/format.h>
+#include <falcon/traits.h>
+
+namespace Falcon {
+
+StringTemplate::Segment::~Segment()
+{
+   delete m_format;
+}
+
+
+StringTemplate::StringTemplate( const String &src ):
+   m_segments( &traits::t_voidp() ),
+   m_textSize( 0 )
+{
+   // This follows the scan performed by the VM in the expansion
+   // of the strings since its first versions.
+   String text;
+   uint32 pos0 = 0;
+   uint32 pos1 = src.find( "$" );
+   uint32 len = src.length();
+
+   while( pos1 != String::npos )
+   {
+      text.append( src.subString( pos0, pos1 ) );
+      pos1++;
+      if( pos1 == len )
+      {
+         addText( text );
+         addSegment( new Segment( t_fail ) );
+         return;
+      }
+
+      typedef enum {
+         none,
+         token,
+         open,
+         singleQuote,
+         doubleQuote,
+         escapeSingle,
+         escapeDouble,
+         complete,
+         complete1,
+         noAction,
+         fail
+      }
+      t_state;
+
+      t_state state = none;
+
+      pos0 = pos1;
+      uint32 chr = 0;
+      while( pos1 < len && state != fail && state != complete && state != complete1 && state != noAction )
+      {
+         chr = src.getCharAt( pos1 );
+         switch( state )
+         {
+            case none:
+               if( chr == '$' )
+               {
+                  text.append( '$' );
+                  state = noAction;
+                  break;
+               }
+               else if ( chr == '(' )
+               {
+                  // scan for balanced ')'
+                  pos0 = pos1+1;
+                  state = open;
+               }
+               else if ( chr < '@' )
+               {
+                  state = fail;
+               }
+               else {
+                  state = token;
+               }
+            break;
+
+            case token:
+               // allow also ':' and '|'
+               if( (( chr < '0' && chr != '.' && chr != '%' ) || ( chr > ':' && chr <= '@' ))
+                  && chr != '|' && chr != '[' && chr != ']' )
+               {
+                  state = complete;
+                  pos1--;
+               }
+            break;
+
+            case open:
+               if( chr == ')' )
+                  state = complete1;
+               else if ( chr == '\'' )
+                  state = singleQuote;
+               else if ( chr == '\"' )
+                  state = doubleQuote;
+            break;
+
+            case singleQuote:
+               if( chr == '\'' )
+                  state = open;
+               else if ( chr == '\\' )
+                  state = escapeSingle;
+            break;
+
+            case doubleQuote:
+               if( chr == '\"' )
+                  state = open;
+               else if ( chr == '\\' )
+                  state = escapeDouble;
+            break;
+
+            case escapeSingle:
+               state = singleQuote;
+            break;
+
+            case escapeDouble:
+               state = escapeDouble;
+            break;
+
+            default: // compiler warning no-op
+               break;
+         }
+
+         ++pos1;
+      }
+
+      switch( state )
+      {
+         case token:
+         case complete:
+         case complete1:
+         {
+            uint32 pos2 = pos1;
+            if( state == complete1 )
+               pos2--;
+
+            uint32 posColon = src.find( ":", pos0, pos2 );
+            uint32 posPipe = src.find( "|", pos0, pos2 );
+            uint32 posEnd;
+            Segment *seg;
+
+            if( posColon != String::npos )
+            {
+               posEnd = posColon;
+               seg = new Segment( t_format );
+               seg->m_format = new Format( src.subString( posColon+1, pos2 ) );
+            }
+            else if( posPipe != String::npos )
+            {
+               posEnd = posPipe;
+               seg = new Segment( t_pipe );
+               seg->m_spec = src.subString( posPipe+1, pos2 );
+            }
+            else {
+               posEnd = pos2;
+               seg = new Segment( t_value );
+            }
+
+            seg->m_text = src.subString( pos0, posEnd );
+            seg->m_text.bufferize();
+
+            // plain names can be resolved directly in the symbol tables.
+            uint32 nlen = seg->m_text.length();
+            seg->m_bSymbol = nlen > 0 && seg->m_text.getCharAt( 0 ) >= 'A';
+            for( uint32 i = 0; i < nlen && seg->m_bSymbol; ++i )
+            {
+               uint32 nc = seg->m_text.getCharAt( i );
+               seg->m_bSymbol = nc != '[' &&
+                  ( nc >= 'A' || (nc >= '0' && nc <= '9') || nc == '_' );
+            }
+
+            addText( text );
+            addSegment( seg );
+         }
+         break;
+
+         case noAction:
+         break;
+
+         default:
+            addText( text );
+            addSegment( new Segment( t_fail ) );
+            return;
+      }
+
+      pos0 = pos1;
+      pos1 = src.find( "$", pos1 );
+   }
+
+   text.append( src.subString( pos0 ) );
+   addText( text );
+}
+
+
+StringTemplate::~StringTemplate()
+{
+   for( uint32 i = 0; i < m_segments.size(); ++i )
+      delete *(Segment **) m_segments.at( i );
+}
+
+
+void StringTemplate::addText( String &text )
+{
+   if ( text.size() == 0 )
+      return;
+
+   Segment *seg = new Segment( t_text );
+   seg->m_text = text;
+   seg->m_text.bufferize();
+   m_textSize += text.length();
+   addSegment( seg );
+   text.size( 0 );
+}
+
+
+void StringTemplate::addSegment( Segment *seg )
+{
+   m_segments.push( seg );
+}
+
+}
+
+/* end of strtemplate.cpp */
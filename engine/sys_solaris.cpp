@@ -216,6 +216,11 @@ int64 _getpid() {
    return (int64) getpid();
 }
 
+uint32 _cpuCount() {
+   long count = sysconf( _SC_NPROCESSORS_ONLN );
+   return count > 0 ? (uint32) count : 1;
+}
+
 }
 }
 
@@ -354,6 +354,12 @@ int64 _getpid() {
    return (int64) GetCurrentProcessId();
 }
 
+uint32 _cpuCount() {
+   SYSTEM_INFO si;
+   GetSystemInfo( &si );
+   return si.dwNumberOfProcessors > 0 ? (uint32) si.dwNumberOfProcessors : 1;
+}
+
 }
 }
 
@@ -600,6 +600,27 @@ bool TranscoderByte::get( uint32 &chr )
    return false;
 }
 
+bool TranscoderByte::readLine( String &target, uint32 maxChars )
+{
+   m_parseStatus = true;
+
+   // bytes are characters; the underlying stream can split the lines by itself.
+   if ( bufferEmpty() && m_stream->hasReadWindow() )
+      return m_stream->readLine( target, maxChars );
+
+   return Stream::readLine( target, maxChars );
+}
+
+int32 TranscoderByte::readChars( uint32 *target, int32 count )
+{
+   m_parseStatus = true;
+
+   if ( bufferEmpty() && m_stream->hasReadWindow() )
+      return m_stream->readChars( target, count );
+
+   return Stream::readChars( target, count );
+}
+
 bool TranscoderByte::put( uint32 chr )
 {
    m_parseStatus = true;
@@ -752,6 +773,221 @@ bool TranscoderUTF8::get( uint32 &chr )
    return true;
 }
 
+bool TranscoderUTF8::readLine( String &target, uint32 maxChars )
+{
+   m_parseStatus = true;
+
+   if ( ! bufferEmpty() || ! m_stream->hasReadWindow() )
+      return Stream::readLine( target, maxChars );
+
+   // '\n' can't be part of a multibyte sequence, so we can decode
+   // the read window of the underlying stream up to the line terminator.
+   Stream *src = m_stream;
+   uint32 count = 0;
+
+   while( count < maxChars )
+   {
+      int32 avail;
+      const byte *window = src->readWindow( avail );
+      if ( window == 0 )
+         return false;
+
+      const byte *eol = (const byte *) memchr( window, '\n', avail );
+      int32 end = eol == 0 ? avail : (int32) (eol - window);
+      int32 pos = 0;
+      bool bSplit = false;
+
+      while( pos < end && count < maxChars )
+      {
+         // append runs of ASCII characters as they are.
+         int32 run = pos;
+         while( run < end && window[run] < 0x80 && count < maxChars )
+         {
+            ++run;
+            ++count;
+         }
+
+         if ( run > pos )
+         {
+            String ascii;
+            ascii.adopt( (char *) window + pos, run - pos, 0 );
+            target.append( ascii );
+            pos = run;
+            continue;
+         }
+
+         byte in = window[pos];
+         int32 len;
+         uint32 chr;
+         if ( (in & 0xF8) == 0xF0 )
+         {
+            chr = in & 0x7;
+            len = 4;
+         }
+         else if ( (in & 0xF0) == 0xE0 )
+         {
+            chr = in & 0xF;
+            len = 3;
+         }
+         else if ( (in & 0xE0) == 0xC0 )
+         {
+            chr = in & 0x1F;
+            len = 2;
+         }
+         else {
+            // invalid pattern
+            src->consumeWindow( pos + 1 );
+            m_parseStatus = false;
+            return false;
+         }
+
+         if ( pos + len > end )
+         {
+            // a sequence broken by the line terminator is invalid
+            if ( eol != 0 )
+            {
+               src->consumeWindow( end );
+               m_parseStatus = false;
+               return false;
+            }
+
+            // otherwise, the rest is in the next buffer; let get() read it.
+            src->consumeWindow( pos );
+            if ( ! get( chr ) )
+               return false;
+
+            target.append( chr );
+            ++count;
+            bSplit = true;
+            break;
+         }
+
+         for( int32 i = 1; i < len; ++i )
+         {
+            in = window[pos + i];
+            if ( (in & 0xC0) != 0x80 )
+            {
+               src->consumeWindow( pos + i + 1 );
+               m_parseStatus = false;
+               return false;
+            }
+            chr = (chr << 6) | (in & 0x3f);
+         }
+
+         target.append( chr );
+         ++count;
+         pos += len;
+      }
+
+      // get() has moved the window
+      if ( bSplit )
+         continue;
+
+      if ( pos == end && eol != 0 && count < maxChars )
+      {
+         src->consumeWindow( pos + 1 );
+         removeLineCR( target, count );
+         return true;
+      }
+
+      src->consumeWindow( pos );
+   }
+
+   return true;
+}
+
+int32 TranscoderUTF8::readChars( uint32 *target, int32 count )
+{
+   m_parseStatus = true;
+
+   if ( ! bufferEmpty() || ! m_stream->hasReadWindow() )
+      return Stream::readChars( target, count );
+
+   Stream *src = m_stream;
+   int32 avail;
+   const byte *window = src->readWindow( avail );
+   if ( window == 0 || count <= 0 )
+      return 0;
+
+   int32 pos = 0;
+   int32 done = 0;
+   while( pos < avail && done < count )
+   {
+      byte in = window[pos];
+      if ( in < 0x80 )
+      {
+         target[done++] = in;
+         ++pos;
+         continue;
+      }
+
+      int32 len;
+      uint32 chr;
+      if ( (in & 0xF8) == 0xF0 )
+      {
+         chr = in & 0x7;
+         len = 4;
+      }
+      else if ( (in & 0xF0) == 0xE0 )
+      {
+         chr = in & 0xF;
+         len = 3;
+      }
+      else if ( (in & 0xE0) == 0xC0 )
+      {
+         chr = in & 0x1F;
+         len = 2;
+      }
+      else
+      {
+         chr = 0;
+         len = 0;
+      }
+
+      // report the characters decoded up to here before the invalid or split one.
+      if ( done > 0 && ( len == 0 || pos + len > avail ) )
+         break;
+
+      if ( len == 0 )
+      {
+         src->consumeWindow( pos + 1 );
+         m_parseStatus = false;
+         return 0;
+      }
+
+      if ( pos + len > avail )
+      {
+         // the rest of the sequence is in the next buffer; let get() read it.
+         src->consumeWindow( pos );
+         return get( target[0] ) ? 1 : 0;
+      }
+
+      for( int32 i = 1; i < len; ++i )
+      {
+         in = window[pos + i];
+         if ( (in & 0xC0) != 0x80 )
+         {
+            if ( done > 0 )
+            {
+               src->consumeWindow( pos );
+               return done;
+            }
+
+            src->consumeWindow( pos + i + 1 );
+            m_parseStatus = false;
+            return 0;
+         }
+         chr = (chr << 6) | (in & 0x3f);
+      }
+
+      target[done++] = chr;
+      pos += len;
+   }
+
+   src->consumeWindow( pos );
+   return done;
+}
+
 bool TranscoderUTF8::put( uint32 chr )
 {
    m_parseStatus = true;
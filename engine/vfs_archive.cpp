@@ -0,0 +1,552 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: vfs_archive.cpp
+
+   VFS provider serving the files stored in a packed archive.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:29:04 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   VFS provider serving the files stored in a packed archive.
+*/
+
+#include <falcon/vfs_archive.h>
+#include <falcon/filemap.h>
+#include <falcon/mapstream.h>
+#include <falcon/timestamp.h>
+#include <falcon/autocstring.h>
+#include <falcon/traits.h>
+#include <falcon/common.h>
+#include <falcon/error.h>
+#include <falcon/mt.h>
+#include <falcon/sys.h>
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#define FPK_SIGNATURE     "FPK1"
+#define FPK_HEADER_SIZE   16
+#define FPK_COPY_BUFFER   32768
+
+namespace Falcon {
+
+/** Last error of the archive operations, per thread. */
+static ThreadSpecific s_lastError;
+
+
+class VFSArchive::Entry: public BaseAlloc
+{
+public:
+   bool m_bDir;
+   uint64 m_offset;
+   uint64 m_size;
+
+   Entry( bool bDir, uint64 offset, uint64 size ):
+      m_bDir( bDir ),
+      m_offset( offset ),
+      m_size( size )
+   {}
+};
+
+
+/** Lists the entries directly under a directory of the archive. */
+class VFSArchive::ArchiveDir: public DirEntry
+{
+public:
+   ArchiveDir( const String& path, const Map& entries, const String& prefix ):
+      DirEntry( path ),
+      m_prefix( prefix ),
+      m_bFirst( true )
+   {
+      // start from the directory itself, or from the first name after it.
+      entries.find( &m_prefix, m_iter );
+      m_bValid = m_iter.hasCurrent();
+   }
+
+   virtual bool read( String &fname )
+   {
+      while( m_bValid )
+      {
+         if ( ! m_bFirst )
+            m_iter.next();
+         m_bFirst = false;
+
+         if ( ! m_iter.hasCurrent() )
+            break;
+
+         const String& name = *(String*) m_iter.currentKey();
+         if ( ! name.startsWith( m_prefix ) )
+            break;
+
+         // skip the directory itself and the entries in its subdirectories.
+         if ( name.length() > m_prefix.length()
+               && name.find( "/", m_prefix.length() ) == String::npos )
+         {
+            fname = name.subString( m_prefix.length() );
+            return true;
+         }
+      }
+
+      m_bValid = false;
+      return false;
+   }
+
+   virtual void close()
+   {
+      m_bValid = false;
+   }
+
+private:
+   String m_prefix;
+   MapIterator m_iter;
+   bool m_bValid;
+   bool m_bFirst;
+};
+
+
+static bool s_readName( const byte* data, uint64 size, uint64& pos, String& name )
+{
+   uint32 len;
+   if ( pos + 4 > size )
+      return false;
+   memcpy( &len, data + pos, 4 );
+   len = endianInt32( len );
+   pos += 4;
+
+   if ( pos + len > size )
+      return false;
+   name.fromUTF8( (const char*) data + pos, (int32) len );
+   pos += len;
+   return true;
+}
+
+
+static bool s_readInt64( const byte* data, uint64 size, uint64& pos, uint64& value )
+{
+   if ( pos + 8 > size )
+      return false;
+   memcpy( &value, data + pos, 8 );
+   value = endianInt64( value );
+   pos += 8;
+   return true;
+}
+
+
+/** Converts the path of an URI into an entry name. */
+static String s_entryName( const URI& uri )
+{
+   const String& path = uri.path();
+   uint32 begin = 0;
+   uint32 end = path.length();
+
+   while( begin < end && path.getCharAt( begin ) == '/' )
+      ++begin;
+   while( end > begin && path.getCharAt( end - 1 ) == '/' )
+      --end;
+
+   return path.subString( begin, end );
+}
+
+
+VFSArchive* VFSArchive::load( const String& path, const String& protocol, int64& fsError )
+{
+   FileStat fs;
+   if ( ! Sys::fal_stats( path, fs ) )
+   {
+      fsError = ENOENT;
+      return 0;
+   }
+
+   FileMap* fmap = FileMap::map( path, false, fsError );
+   if ( fmap == 0 )
+      return 0;
+
+   VFSArchive* archive = new VFSArchive( protocol, fmap );
+   if ( ! archive->readIndex() )
+   {
+      delete archive;
+      fsError = 0;
+      return 0;
+   }
+
+   if ( fs.m_mtime != 0 )
+      archive->m_mtime = (TimeStamp*) fs.m_mtime->clone();
+
+   return archive;
+}
+
+
+VFSArchive::VFSArchive( const String& protocol, FileMap* map ):
+   VFSProvider( protocol ),
+   m_map( map ),
+   m_mtime( 0 ),
+   m_fileCount( 0 ),
+   m_entries( &traits::t_string(), &traits::t_voidp() )
+{
+}
+
+
+VFSArchive::~VFSArchive()
+{
+   MapIterator iter = m_entries.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(Entry**) iter.currentValue();
+      iter.next();
+   }
+
+   delete m_mtime;
+   m_map->decref();
+}
+
+
+bool VFSArchive::readIndex()
+{
+   const byte* data = m_map->data();
+   uint64 size = m_map->size();
+
+   if ( size < FPK_HEADER_SIZE || memcmp( data, FPK_SIGNATURE, 4 ) != 0 )
+      return false;
+
+   uint32 count;
+   memcpy( &count, data + 4, 4 );
+   count = endianInt32( count );
+
+   uint64 pos = 8;
+   uint64 indexPos;
+   if ( ! s_readInt64( data, size, pos, indexPos ) || indexPos < FPK_HEADER_SIZE )
+      return false;
+
+   pos = indexPos;
+   if ( ! s_readName( data, size, pos, m_mainModule ) )
+      return false;
+
+   // the root directory.
+   addEntry( "", true, 0, 0 );
+
+   String name;
+   for ( uint32 i = 0; i < count; ++i )
+   {
+      uint64 offset, fsize;
+      if ( ! s_readName( data, size, pos, name )
+            || ! s_readInt64( data, size, pos, offset )
+            || ! s_readInt64( data, size, pos, fsize )
+            || offset < FPK_HEADER_SIZE || offset > indexPos || fsize > indexPos - offset )
+      {
+         return false;
+      }
+
+      addEntry( name, false, offset, fsize );
+   }
+
+   m_fileCount = count;
+   return true;
+}
+
+
+void VFSArchive::addEntry( const String& name, bool bDir, uint64 offset, uint64 size )
+{
+   if ( m_entries.find( &name ) != 0 )
+      return;
+
+   m_entries.insert( &name, new Entry( bDir, offset, size ) );
+
+   // add the directories leading to this entry.
+   uint32 pos = name.rfind( "/" );
+   if ( pos != String::npos )
+      addEntry( name.subString( 0, pos ), true, 0, 0 );
+   else if ( name.length() != 0 )
+      addEntry( "", true, 0, 0 );
+}
+
+
+bool VFSArchive::fail( int64 error )
+{
+   s_lastError.set( (void*) (ptrdiff_t) error );
+   return false;
+}
+
+
+const VFSArchive::Entry* VFSArchive::entry( const URI& uri )
+{
+   String name = s_entryName( uri );
+   Entry** pentry = (Entry**) m_entries.find( &name );
+   if ( pentry == 0 )
+   {
+      fail( ENOENT );
+      return 0;
+   }
+
+   s_lastError.set( 0 );
+   return *pentry;
+}
+
+
+Stream *VFSArchive::open( const URI& uri, const OParams &p )
+{
+   if ( p.isWrOnly() || p.isAppend() || p.isTruncate() )
+   {
+      fail( EROFS );
+      return 0;
+   }
+
+   const Entry* ent = entry( uri );
+   if ( ent == 0 )
+      return 0;
+
+   if ( ent->m_bDir )
+   {
+      fail( EISDIR );
+      return 0;
+   }
+
+   return new MapStream( m_map, ent->m_offset, ent->m_size );
+}
+
+
+Stream *VFSArchive::create( const URI&, const CParams &, bool &bSuccess )
+{
+   bSuccess = false;
+   fail( EROFS );
+   return 0;
+}
+
+
+DirEntry* VFSArchive::openDir( const URI& uri )
+{
+   const Entry* ent = entry( uri );
+   if ( ent == 0 )
+      return 0;
+
+   if ( ! ent->m_bDir )
+   {
+      fail( ENOTDIR );
+      return 0;
+   }
+
+   String prefix = s_entryName( uri );
+   if ( prefix.length() != 0 )
+      prefix += "/";
+
+   return new ArchiveDir( uri.path(), m_entries, prefix );
+}
+
+
+bool VFSArchive::readStats( const URI& uri, FileStat &s )
+{
+   const Entry* ent = entry( uri );
+   if ( ent == 0 )
+      return false;
+
+   s.m_type = ent->m_bDir ? FileStat::t_dir : FileStat::t_normal;
+   s.m_size = (int64) ent->m_size;
+   s.m_owner = 0;
+   s.m_group = 0;
+   s.m_access = ent->m_bDir ? 0555 : 0444;
+   s.m_attribs = 0;
+
+   if ( m_mtime != 0 )
+   {
+      if ( s.m_mtime == 0 )
+         s.m_mtime = new TimeStamp();
+      s.m_mtime->copy( *m_mtime );
+
+      if ( s.m_ctime == 0 )
+         s.m_ctime = new TimeStamp();
+      s.m_ctime->copy( *m_mtime );
+
+      if ( s.m_atime == 0 )
+         s.m_atime = new TimeStamp();
+      s.m_atime->copy( *m_mtime );
+   }
+
+   return true;
+}
+
+
+bool VFSArchive::writeStats( const URI&, const FileStat& )
+{
+   return fail( EROFS );
+}
+
+
+bool VFSArchive::chown( const URI&, int, int )
+{
+   return fail( EROFS );
+}
+
+
+bool VFSArchive::chmod( const URI&, int )
+{
+   return fail( EROFS );
+}
+
+
+bool VFSArchive::link( const URI&, const URI&, bool )
+{
+   return fail( EROFS );
+}
+
+
+bool VFSArchive::unlink( const URI& )
+{
+   return fail( EROFS );
+}
+
+
+bool VFSArchive::mkdir( const URI&, uint32 )
+{
+   return fail( EROFS );
+}
+
+
+bool VFSArchive::rmdir( const URI& )
+{
+   return fail( EROFS );
+}
+
+
+bool VFSArchive::move( const URI&, const URI& )
+{
+   return fail( EROFS );
+}
+
+
+int64 VFSArchive::getLastFsError()
+{
+   return (int64) (ptrdiff_t) s_lastError.get();
+}
+
+
+Error *VFSArchive::getLastError()
+{
+   int64 error = getLastFsError();
+   if ( error == 0 )
+      return 0;
+
+   IoError *e = new IoError( error == ENOENT ? e_nofile : e_io_error );
+   e->systemError( (uint32) error );
+   return e;
+}
+
+//=======================================================
+// Archive writer
+//
+
+class ArchiveFileRec: public BaseAlloc
+{
+public:
+   uint64 m_offset;
+   uint64 m_size;
+};
+
+
+ArchiveWriter::ArchiveWriter( Stream* out ):
+   m_out( out ),
+   m_pos( FPK_HEADER_SIZE ),
+   m_files( &traits::t_string(), &traits::t_voidp() )
+{
+}
+
+
+ArchiveWriter::~ArchiveWriter()
+{
+   MapIterator iter = m_files.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(ArchiveFileRec**) iter.currentValue();
+      iter.next();
+   }
+}
+
+
+bool ArchiveWriter::add( const String& name, Stream* in )
+{
+   if ( m_files.find( &name ) != 0 )
+      return false;
+
+   // the header is written by close().
+   if ( m_out->seekBegin( (int64) m_pos ) != (int64) m_pos )
+      return false;
+
+   byte buffer[ FPK_COPY_BUFFER ];
+   uint64 size = 0;
+   int32 count;
+   while( ( count = in->read( buffer, FPK_COPY_BUFFER ) ) > 0 )
+   {
+      if ( m_out->write( buffer, count ) != count )
+         return false;
+      size += count;
+   }
+
+   if ( count < 0 )
+      return false;
+
+   ArchiveFileRec* rec = new ArchiveFileRec;
+   rec->m_offset = m_pos;
+   rec->m_size = size;
+   m_files.insert( &name, rec );
+   m_pos += size;
+   return true;
+}
+
+
+bool ArchiveWriter::writeName( const String& name )
+{
+   AutoCString cname( name );
+   uint32 len = endianInt32( cname.length() );
+   if ( m_out->write( &len, 4 ) != 4 )
+      return false;
+
+   m_pos += 4 + cname.length();
+   return m_out->write( cname.c_str(), cname.length() ) == (int32) cname.length();
+}
+
+
+bool ArchiveWriter::close( const String& mainModule )
+{
+   uint64 indexPos = m_pos;
+   if ( m_out->seekBegin( (int64) m_pos ) != (int64) m_pos
+         || ! writeName( mainModule ) )
+   {
+      return false;
+   }
+
+   MapIterator iter = m_files.begin();
+   while( iter.hasCurrent() )
+   {
+      const ArchiveFileRec* rec = *(ArchiveFileRec**) iter.currentValue();
+      uint64 offset = endianInt64( rec->m_offset );
+      uint64 size = endianInt64( rec->m_size );
+
+      if ( ! writeName( *(String*) iter.currentKey() )
+            || m_out->write( &offset, 8 ) != 8
+            || m_out->write( &size, 8 ) != 8 )
+      {
+         return false;
+      }
+
+      m_pos += 16;
+      iter.next();
+   }
+
+   uint32 count = endianInt32( m_files.size() );
+   indexPos = endianInt64( indexPos );
+   return m_out->seekBegin( 0 ) == 0
+         && m_out->write( FPK_SIGNATURE, 4 ) == 4
+         && m_out->write( &count, 4 ) == 4
+         && m_out->write( &indexPos, 8 ) == 8
+         && m_out->flush();
+}
+
+}
+
+/* end of vfs_archive.cpp */
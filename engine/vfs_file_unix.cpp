@@ -20,6 +20,8 @@
 #include <falcon/sys.h>
 #include <falcon/autocstring.h>
 #include <falcon/streambuffer.h>
+#include <falcon/filemap.h>
+#include <falcon/mapstream.h>
 
 #include <sys/types.h>
 #include <dirent.h>
@@ -46,6 +48,17 @@ VFSFile::~VFSFile()
 
 Stream *VFSFile::open( const URI& uri, const OParams &p )
 {
+   if ( p.isMapped() )
+   {
+      FileMap *fmap = map( uri, p );
+      if ( fmap == 0 )
+         return 0;
+
+      Stream *ms = new MapStream( fmap );
+      fmap->decref();
+      return ms;
+   }
+
    int omode = paramsToMode( p );
 
    // todo: do something about share mode
@@ -63,6 +76,16 @@ Stream *VFSFile::open( const URI& uri, const OParams &p )
 }
 
 
+FileMap *VFSFile::map( const URI& uri, const OParams &p )
+{
+   int64 fsError;
+   FileMap *fmap = FileMap::map( uri.path(), p.isWrOnly(), fsError );
+   // getLastFsError() reads errno
+   errno = (int) fsError;
+   return fmap;
+}
+
+
 Stream *VFSFile::create( const URI& uri, const CParams &p, bool &bSuccess )
 {
    int omode = paramsToMode( p );
@@ -22,6 +22,8 @@
 #include <falcon/autowstring.h>
 #include <windows.h>
 #include <falcon/streambuffer.h>
+#include <falcon/filemap.h>
+#include <falcon/mapstream.h>
 
 namespace Falcon 
 {
@@ -71,6 +73,17 @@ VFSFile::~VFSFile()
 
 Stream *VFSFile::open( const URI& uri, const OParams &p )
 {
+   if ( p.isMapped() )
+   {
+      FileMap *fmap = map( uri, p );
+      if ( fmap == 0 )
+         return 0;
+
+      Stream *ms = new MapStream( fmap );
+      fmap->decref();
+      return ms;
+   }
+
    DWORD omode = win_paramsToMode( p );
    DWORD oshare = win_paramsToShare( p );
 
@@ -112,6 +125,16 @@ Stream *VFSFile::open( const URI& uri, const OParams &p )
 }
 
 
+FileMap *VFSFile::map( const URI& uri, const OParams &p )
+{
+   int64 fsError;
+   FileMap *fmap = FileMap::map( uri.path(), p.isWrOnly(), fsError );
+   // getLastFsError() reads GetLastError()
+   SetLastError( (DWORD) fsError );
+   return fmap;
+}
+
+
 Stream *VFSFile::create( const URI& uri, const CParams &p, bool &bSuccess )
 {
    DWORD omode = win_paramsToMode( p );
@@ -20,6 +20,11 @@ VFSProvider::~VFSProvider()
 {
 }
 
+FileMap* VFSProvider::map( const URI &, const OParams & )
+{
+   return 0;
+}
+
 }
 
 /* end of vsfprovider.cpp */
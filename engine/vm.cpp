@@ -38,6 +38,10 @@
 #include <falcon/livemodule.h>
 #include <falcon/vmevent.h>
 #include <falcon/lineardict.h>
+#include <falcon/strtemplate.h>
+#include <falcon/atomtable.h>
+#include <falcon/profiler.h>
+#include <falcon/vmcounters.h>
 
 #include <string.h>
 
@@ -119,6 +123,8 @@ void VMachine::internal_construct()
    m_opLimit = 0;
    m_generation = 0;
    m_bSingleStep = false;
+   m_profiler = 0;
+   m_counters = 0;
    m_stdIn = 0;
    m_stdOut = 0;
    m_stdErr = 0;
@@ -126,6 +132,12 @@ void VMachine::internal_construct()
    m_bGcEnabled = true;
    m_bWaitForCollect = false;
    m_bPirorityGC = false;
+   m_gcWaitTime = 0.0;
+   m_gcLiveItems = 0;
+   m_accSlot = 0;
+   m_accString = 0;
+   m_tmpSlot = 0;
+   m_tmpString = 0;
 
 
    resetCounters();
@@ -133,6 +145,7 @@ void VMachine::internal_construct()
    // this initialization must be performed by all vms.
    m_mainModule = 0;
    m_allowYield = true;
+   m_fdWaiters = 0;
 
    m_opCount = 0;
 
@@ -314,10 +327,17 @@ void VMachine::finalize()
 
 VMachine::~VMachine()
 {
+   // don't leave a dangling current VM to this thread.
+   if ( getCurrent() == this )
+      s_currentVM.set( 0 );
+
    // Free generic tables (quite safe)
    memFree( m_opHandlers );
    memFree( m_metaClasses );
 
+   delete m_profiler;
+   delete m_counters;
+
    // and finally, the streams.
    delete m_stdErr;
    delete m_stdIn;
@@ -1041,7 +1061,8 @@ PropertyTable *VMachine::createClassTemplate( LiveModule *lmod, const Map &pt )
       VarDefMod *vdmod = *(VarDefMod **) iter.currentValue();
       VarDef *vd = vdmod->vd;
 
-      String *key = *(String **) iter.currentKey();
+      // property names are shared as atoms; see PropertyTable::findKey
+      const String *key = AtomTable::intern( **(String **) iter.currentKey() );
       PropEntry &e = table->appendSafe( key );
 
       e.m_bReadOnly = vd->isReadOnly();
@@ -1416,6 +1437,10 @@ void VMachine::reset()
    // clear the accounting of sleeping contexts.
    m_sleepingContexts.clear();
 
+   // the contexts waiting on descriptors are going to be destroyed.
+   m_systemData.dropDescriptors();
+   m_fdWaiters = 0;
+
    if ( m_contexts.size() > 1 )
    {
       // clear the contexts
@@ -1553,6 +1578,65 @@ void VMachine::yield( numeric secs )
 }
 
 
+bool VMachine::waitDescriptor( int32 fd, bool bWrite, numeric secs )
+{
+   if ( m_currentContext->atomicMode() )
+      return false;
+
+   if ( ! m_systemData.watchDescriptor( fd, bWrite, m_currentContext ) )
+      return false;
+
+   m_currentContext->waitOnDescriptor( fd, secs );
+   ++m_fdWaiters;
+
+   rotateContext();
+   return true;
+}
+
+
+void VMachine::descriptorClosed( int32 fd )
+{
+   void* waiters[2];
+
+   int32 count = m_systemData.dropDescriptor( fd, waiters );
+   for( int32 i = 0; i < count; ++i )
+   {
+      VMContext* ctx = (VMContext*) waiters[i];
+      ctx->descriptorDone( false );
+      --m_fdWaiters;
+      reschedule( ctx );
+   }
+}
+
+
+int32 VMachine::pollDescriptors( numeric seconds, VMContext* elected )
+{
+   void* ready[64];
+
+   int32 count = m_systemData.waitDescriptors( seconds, ready, 64 );
+   for( int32 i = 0; i < count; ++i )
+   {
+      VMContext* ctx = (VMContext*) ready[i];
+      ctx->descriptorDone( true );
+      --m_fdWaiters;
+
+      // the elected context is about to be put at sleep by our caller.
+      if ( ctx != elected )
+         reschedule( ctx );
+   }
+
+   return count;
+}
+
+
+void VMachine::descriptorTimeout( VMContext *ctx )
+{
+   m_systemData.unwatchDescriptor( ctx->waitingDescriptor(), ctx );
+   ctx->descriptorDone( false );
+   --m_fdWaiters;
+}
+
+
 void VMachine::putAtSleep( VMContext *ctx )
 {
    // consider the special case of a context not willing to be awaken
@@ -1641,6 +1725,10 @@ void VMachine::rotateContext()
 
 void VMachine::electContext()
 {
+   // wake contexts whose descriptors got ready while we were running.
+   if ( m_fdWaiters > 0 )
+      pollDescriptors( 0.0 );
+
    // if there is some sleeping context...
    if ( ! m_sleepingContexts.empty() )
    {
@@ -1689,7 +1777,10 @@ void VMachine::electContext()
          }
 
          // tell the context that it is not waiting anymore, if it was.
-         m_currentContext->wakeup( false );
+         if ( m_currentContext->waitingDescriptor() >= 0 )
+            descriptorTimeout( m_currentContext );
+         else
+            m_currentContext->wakeup( false );
 
          m_opCount = 0;
 
@@ -1705,6 +1796,10 @@ void VMachine::terminateCurrentContext()
    // inspectors outside this VM may want to check it.
    if ( ! m_contexts.empty() && m_contexts.begin()->next() != 0 )
    {
+      // the reactor must not report a destroyed context.
+      if ( m_currentContext->waitingDescriptor() >= 0 )
+         descriptorTimeout( m_currentContext );
+
       // scan the contexts and remove the current one.
       ListElement *iter = m_contexts.begin();
       while( iter != 0 ) {
@@ -2133,12 +2228,32 @@ inline bool vmIsTokenChr( uint32 chr )
 
 Item *VMachine::findLocalSymbolItem( const String &symName ) const
 {
+   // the caller may keep the item.
+   m_accSlot = 0;
+
    // parse self and sender
    if( symName == "self" )
    {
       return const_cast<Item *>(&self());
    }
 
+   const Symbol *sym = findLocalSymbol( symName );
+
+   // still zero? Let's try the global symbol table.
+   if( sym == 0 )
+   {
+      Item *itm = findGlobalItem( symName );
+      if ( itm != 0 )
+         return itm->dereference();
+      return 0;
+   }
+
+   return symbolItem( sym );
+}
+
+
+const Symbol *VMachine::findLocalSymbol( const String &symName ) const
+{
    // find the symbol
    const Symbol *sym = currentSymbol();
    if ( sym != 0 )
@@ -2171,35 +2286,21 @@ Item *VMachine::findLocalSymbolItem( const String &symName ) const
 
    // -- not a local symbol? -- try the global module table.
    if( sym == 0 )
-   {
       sym = currentModule()->findGlobalSymbol( symName );
-      // still zero? Let's try the global symbol table.
-      if( sym == 0 )
-      {
-         Item *itm = findGlobalItem( symName );
-         if ( itm != 0 )
-            return itm->dereference();
-      }
-   }
 
-   Item *itm = 0;
-   if ( sym != 0 )
-   {
-      if ( sym->isLocal() )
-      {
-         itm = const_cast<VMachine *>(this)->local( sym->getItemId() )->dereference();
-      }
-      else if ( sym->isParam() )
-      {
-         itm = const_cast<VMachine *>(this)->param( sym->getItemId() )->dereference();
-      }
-      else {
-         itm = const_cast<VMachine *>(this)->moduleItem( sym->getItemId() ).dereference();
-      }
-   }
+   return sym;
+}
+
+
+Item *VMachine::symbolItem( const Symbol *sym ) const
+{
+   if ( sym->isLocal() )
+      return const_cast<VMachine *>(this)->local( sym->getItemId() )->dereference();
 
-   // if the item is zero, we didn't found it
-   return itm;
+   if ( sym->isParam() )
+      return const_cast<VMachine *>(this)->param( sym->getItemId() )->dereference();
+
+   return const_cast<VMachine *>(this)->moduleItem( sym->getItemId() ).dereference();
 }
 
 
@@ -2619,196 +2720,86 @@ Item *VMachine::parseSquareAccessor( const Item &accessed, String &accessor ) co
 
 VMachine::returnCode  VMachine::expandString( const String &src, String &target )
 {
-   uint32 pos0 = 0;
-   uint32 pos1 = src.find( "$" );
-   uint32 len = src.length();
-   while( pos1 != String::npos )
-   {
-      target.append( src.subString( pos0, pos1 ) );
-      pos1++;
-      if( pos1 == len )
-      {
-         return return_error_string;
-      }
-
-      typedef enum {
-         none,
-         token,
-         open,
-         singleQuote,
-         doubleQuote,
-         escapeSingle,
-         escapeDouble,
-         complete,
-         complete1,
-         noAction,
-         fail
-      }
-      t_state;
-
-      t_state state = none;
-
-      pos0 = pos1;
-      uint32 chr = 0;
-      while( pos1 < len && state != fail && state != complete && state != complete1 && state != noAction )
-      {
-         chr = src.getCharAt( pos1 );
-         switch( state )
-         {
-            case none:
-               if( chr == '$' )
-               {
-                  target.append( '$' );
-                  state = noAction;
-                  break;
-               }
-               else if ( chr == '(' )
-               {
-                  // scan for balanced ')'
-                  pos0 = pos1+1;
-                  state = open;
-               }
-               else if ( chr < '@' )
-               {
-                  state = fail;
-               }
-               else {
-                  state = token;
-               }
-            break;
+   StringTemplate tpl( src );
+   return expandString( tpl, target );
+}
 
-            case token:
-               // allow also ':' and '|'
-               if( (( chr < '0' && chr != '.' && chr != '%' ) || ( chr > ':' && chr <= '@' ))
-                  && chr != '|' && chr != '[' && chr != ']' )
-               {
-                  state = complete;
-                  pos1--;
-                  // else we do this below.
-               }
-            break;
 
-            case open:
-               if( chr == ')' )
-                  state = complete1;
-               else if ( chr == '\'' )
-                  state = singleQuote;
-               else if ( chr == '\"' )
-                  state = doubleQuote;
-               // else just continue
-            break;
+VMachine::returnCode  VMachine::expandString( const StringTemplate &tpl, String &target )
+{
+   // presize for the literal text, plus a bit for each expanded value.
+   target.reserve( target.size() + tpl.textSize() + tpl.size() * 8 );
 
-            case singleQuote:
-               if( chr == '\'' )
-                  state = open;
-               else if ( chr == '\\' )
-                  state = escapeSingle;
-               // else just continue
-            break;
+   String temp;
+   for( uint32 i = 0; i < tpl.size(); ++i )
+   {
+      const StringTemplate::Segment &seg = tpl.segment( i );
 
-            case doubleQuote:
-               if( chr == '\"' )
-                  state = open;
-               else if ( chr == '\\' )
-                  state = escapeDouble;
-               // else just continue
-            break;
+      switch( seg.m_type )
+      {
+         case StringTemplate::t_text:
+            target.append( seg.m_text );
+            continue;
 
-            case escapeSingle:
-               state = singleQuote;
-            break;
+         case StringTemplate::t_fail:
+            return return_error_string;
 
-            case escapeDouble:
-               state = escapeDouble;
+         default:
             break;
-
-            default: // compiler warning no-op
-               break;
-         }
-
-         ++pos1;
       }
 
-      // parse the result in to the target.
-      switch( state )
+      Item itm;
+      if ( seg.m_bSymbol )
       {
-         case token:
-         case complete:
-         case complete1:
-         {
-            uint32 pos2 = pos1;
-            if( state == complete1 )
-            {
-               pos2--;
-            }
-
-            // todo: record this while scanning
-            uint32 posColon = src.find( ":", pos0, pos2 );
-            uint32 posPipe = src.find( "|", pos0, pos2 );
-            uint32 posEnd;
-            Item itm;
+         Item *lsi;
+         const Symbol *owner = currentSymbol();
 
-            if( posColon != String::npos ) {
-               posEnd = posColon;
-            }
-            else if( posPipe != String::npos )
-            {
-               posEnd = posPipe;
-            }
-            else {
-               posEnd = pos2;
-            }
-
-            if ( ! findLocalVariable( src.subString( pos0, posEnd ), itm )  )
-            {
-               return return_error_parse;
-            }
-
-            String temp;
-            // do we have a format?
-            if( posColon != String::npos )
-            {
-               Format fmt( src.subString( posColon+1, pos2 ) );
-               if( ! fmt.isValid() )
-               {
-                  return return_error_parse_fmt;
-               }
-
-               if( ! fmt.format( this, *itm.dereference(), temp ) ) {
-                  return return_error_parse_fmt;
-               }
-            }
-            // do we have a toString parameter?
-            else if( posPipe != String::npos )
+         // the symbol table lookup is done once per function.
+         if ( owner != 0 && seg.m_owner == owner && seg.m_symbol != 0 )
+            lsi = symbolItem( seg.m_symbol );
+         else if ( seg.m_text == "self" )
+            lsi = &self();
+         else {
+            const Symbol *sym = findLocalSymbol( seg.m_text );
+            if ( sym != 0 )
             {
-               itemToString( temp, &itm, src.subString( posPipe+1, pos2 ) );
+               seg.m_owner = owner;
+               seg.m_symbol = sym;
+               lsi = symbolItem( sym );
             }
             else {
-               // otherwise, add the toString version (todo format)
-               // append to target.
-               itemToString( temp, &itm );
+               lsi = findGlobalItem( seg.m_text );
+               if ( lsi != 0 )
+                  lsi = lsi->dereference();
             }
-
-            target.append( temp );
          }
-         break;
 
-         case noAction:
-         break;
+         if ( lsi == 0 )
+            return return_error_parse;
+         itm = *lsi;
+      }
+      else if ( ! findLocalVariable( seg.m_text, itm ) )
+      {
+         return return_error_parse;
+      }
 
-         default:
-            return return_error_string;
+      temp.size( 0 );
+      if( seg.m_type == StringTemplate::t_format )
+      {
+         if( ! seg.m_format->isValid() || ! seg.m_format->format( this, *itm.dereference(), temp ) )
+            return return_error_parse_fmt;
+      }
+      else if( seg.m_type == StringTemplate::t_pipe )
+      {
+         itemToString( temp, &itm, seg.m_spec );
+      }
+      else {
+         itemToString( temp, &itm );
       }
 
-      pos0 = pos1;
-      pos1 = src.find( "$", pos1 );
+      target.append( temp );
    }
 
-   // add the last segment
-   if( pos0 != pos1 )
-   {
-      target.append( src.subString( pos0, pos1 ) );
-   }
    return return_ok;
 }
 
@@ -3018,6 +3009,9 @@ bool VMachine::functionalEval( const Item &itm, uint32 paramCount, bool retArray
 
 Item *VMachine::findGlobalItem( const String &name ) const
 {
+   // the caller may keep the item.
+   m_accSlot = 0;
+
    const SymModule *sm = findGlobalSymbol( name );
    if ( sm == 0 ) return 0;
    return sm->item()->dereference();
@@ -3360,8 +3354,13 @@ void VMachine::processMessage( VMMessage *msg )
 void VMachine::performGC( bool bWaitForCollect )
 {
    m_bWaitForCollect = bWaitForCollect;
+   numeric start = Sys::_seconds();
    memPool->idleVM( this, true );
    m_eGCPerformed.wait();
+
+   numeric elapsed = Sys::_seconds() - start;
+   m_gcWaitTime += elapsed;
+   memPool->accountBlocked( elapsed, true );
 }
 
 
@@ -3432,33 +3431,7 @@ void VMachine::prepareFrame( CoreFunc* target, uint32 paramCount )
    // ensure against optional parameters.
    if( target->symbol()->isFunction() )
    {
-      FuncDef *tg_def = target->symbol()->getFuncDef();
-
-      if( paramCount < tg_def->params() )
-      {
-         this->stack().resize( this->stack().length() + tg_def->params() - paramCount );
-         paramCount = tg_def->params();
-      }
-
-      this->createFrame( paramCount );
-
-      // space for locals
-      if ( tg_def->locals() > 0 )
-      {
-         this->currentFrame()->resizeStack( tg_def->locals() );
-
-         // are part of this locals closed?
-         if( target->closure() != 0 ) {
-            fassert( target->closure()->length() <= tg_def->locals() );
-            this->stack().copyOnto( 0, *target->closure() );
-         }
-      }
-
-      this->m_currentContext->lmodule( target->liveModule() );
-      this->m_currentContext->symbol( target->symbol() );
-
-      //jump
-      this->m_currentContext->pc_next() = 0;
+      prepareFrame( target, target->symbol()->getFuncDef(), paramCount );
    }
    else
    {
@@ -3468,10 +3441,74 @@ void VMachine::prepareFrame( CoreFunc* target, uint32 paramCount )
       this->m_currentContext->lmodule( target->liveModule() );
       this->m_currentContext->symbol( target->symbol() );
 
+      if ( m_counters != 0 )
+         m_counters->enter( m_currentContext );
+
       this->m_currentContext->pc_next() = VMachine::i_pc_call_external;
    }
 }
 
+void VMachine::prepareFrame( CoreFunc* target, FuncDef* tg_def, uint32 paramCount )
+{
+   if( paramCount < tg_def->params() )
+   {
+      this->stack().resize( this->stack().length() + tg_def->params() - paramCount );
+      paramCount = tg_def->params();
+   }
+
+   this->createFrame( paramCount );
+
+   // space for locals
+   if ( tg_def->locals() > 0 )
+   {
+      this->currentFrame()->resizeStack( tg_def->locals() );
+
+      // are part of this locals closed?
+      if( target->closure() != 0 ) {
+         fassert( target->closure()->length() <= tg_def->locals() );
+         const ItemArray &closure = *target->closure();
+         for ( uint32 i = 0; i < closure.length(); ++i )
+            this->stack()[i] = closure[i];
+      }
+   }
+
+   this->m_currentContext->lmodule( target->liveModule() );
+   this->m_currentContext->symbol( target->symbol() );
+
+   if ( m_counters != 0 )
+      m_counters->enter( m_currentContext );
+
+   //jump
+   this->m_currentContext->pc_next() = 0;
+}
+
+
+void VMachine::callFrame( const PreparedCall& call )
+{
+   // named parameters are resolved by the complete path.
+   if ( call.m_func == 0 || regBind().flags() == 0xF0 )
+   {
+      call.m_callable.readyFrame( this, call.m_paramCount );
+      return;
+   }
+
+   prepareFrame( call.m_func, call.m_def, call.m_paramCount );
+   m_currentContext->fself() = call.m_func;
+   if ( call.m_bSelf )
+      self() = call.m_self;
+}
+
+
+void VMachine::callItemAtomic( const PreparedCall& call )
+{
+   bool oldAtomic = m_currentContext->atomicMode();
+   m_currentContext->atomicMode( true );
+   callFrame( call );
+   execFrame();
+   m_currentContext->atomicMode( oldAtomic );
+}
+
+
 void VMachine::prepareFrame( CoreArray* arr, uint32 paramCount )
 {
    fassert( arr->length() > 0 && arr->at(0).isCallable() );
@@ -3593,6 +3630,23 @@ void VMachine::onIdleTime( numeric seconds )
 
 bool VMachine::replaceMe_onIdleTime( numeric seconds )
 {
+   // someone may still wake us up through a descriptor.
+   if ( m_fdWaiters > 0 )
+   {
+      idle();
+      int32 count = pollDescriptors( seconds, m_currentContext );
+      unidle();
+
+      if ( count < 0 )
+      {
+         m_systemData.resetInterrupt();
+         return true;
+      }
+
+      // some context is ready; let the caller elect again.
+      return count > 0;
+   }
+
    if ( seconds < 0.0 )
    {
       throw new CodeError(
@@ -3645,11 +3699,16 @@ void VMachine::handleRaisedItem( Item& value )
       throw err;
    }
 
+   m_accSlot = 0;
+   m_tmpSlot = 0;
+
    // Enter the stack frame that should handle the error (or raise to the top if uncaught)
    while( currentFrame()->m_try_base == i_noTryFrame )
    {
       // neutralize post-processors
       // currentFrame()->m_endFrameFunc = 0;  -- done by currentContext()->callReturn();
+      if ( m_counters != 0 )
+         countReturn();
       m_break = currentContext()->callReturn();
       // let the VM deal with returns
       if ( m_break )
@@ -3674,11 +3733,16 @@ void VMachine::handleRaisedError( Error* err )
    // catch it if possible
    if( err->catchable() && currentContext()->tryFrame() != 0 )
    {
+      m_accSlot = 0;
+      m_tmpSlot = 0;
+
       // Enter the stack frame that should handle the error (or raise to the top if uncaught)
       while( currentFrame() != currentContext()->tryFrame() )
       {
          // neutralize post-processors
          // currentFrame()->m_endFrameFunc = 0;  -- done by currentFrame()->callReturn();
+         if ( m_counters != 0 )
+            countReturn();
          m_break = currentContext()->callReturn();
          // let the VM deal with returns
          if ( m_break )
@@ -3720,7 +3784,13 @@ void VMachine::periodicChecks()
 {
    // pulse VM idle
    if( m_bGcEnabled )
+   {
       m_baton.checkBlock();
+      m_baton.endBlock();
+   }
+
+   if ( m_profiler != 0 )
+      m_profiler->check( m_currentContext );
 
    if ( m_opLimit > 0 )
    {
@@ -3764,6 +3834,32 @@ void VMachine::periodicChecks()
 }
 
 
+void VMachine::profiler( Profiler* prof )
+{
+   if ( prof != m_profiler )
+   {
+      delete m_profiler;
+      m_profiler = prof;
+   }
+}
+
+
+void VMachine::counters( VMCounters* cnt )
+{
+   if ( cnt != m_counters )
+   {
+      delete m_counters;
+      m_counters = cnt;
+   }
+}
+
+
+void VMachine::countReturn()
+{
+   m_counters->leave( m_currentContext );
+}
+
+
 void VMachine::processPendingMessages()
 {
    m_mtx_mesasges.lock();
@@ -3973,10 +4069,22 @@ void VMBaton::releaseNotIdle()
 
 void VMBaton::onBlockedAcquire()
 {
+   m_blockStart = Sys::_seconds();
    // See if the memPool has anything interesting for us.
    memPool->idleVM( m_owner );
 }
 
+void VMBaton::endBlock()
+{
+   if ( m_blockStart != 0.0 )
+   {
+      numeric elapsed = Sys::_seconds() - m_blockStart;
+      m_blockStart = 0.0;
+      m_blockedTime += elapsed;
+      memPool->accountBlocked( elapsed, false );
+   }
+}
+
 }
 
 /* end of vm.cpp */
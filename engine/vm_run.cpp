@@ -20,6 +20,7 @@
 */
 
 #include <falcon/vm.h>
+#include <falcon/vmcounters.h>
 #include <falcon/pcodes.h>
 #include <falcon/vmcontext.h>
 #include <falcon/sys.h>
@@ -68,7 +69,8 @@ Item *VMachine::getOpcodeParam( register uint32 bc_pos )
 
       case P_PARAM_STRID:
          {
-            String *temp = currentLiveModule()->getString( *reinterpret_cast<int32 *>( m_currentContext->code() + m_currentContext->pc_next() ) );
+            m_immStrId[bc_pos] = *reinterpret_cast<int32 *>( m_currentContext->code() + m_currentContext->pc_next() );
+            String *temp = currentLiveModule()->getString( m_immStrId[bc_pos] );
             //m_imm[bc_pos].setString( temp, const_cast<LiveModule*>(currentLiveModule()) );
             m_imm[bc_pos].setString( temp );
             m_currentContext->pc_next() += sizeof( int32 );
@@ -98,18 +100,25 @@ Item *VMachine::getOpcodeParam( register uint32 bc_pos )
       {
          register int32 id = *reinterpret_cast< int32 * >( m_currentContext->code() + m_currentContext->pc_next() );
          m_currentContext->pc_next()+=sizeof( int32 );
-         return &moduleItem( id );
+         ret = &moduleItem( id );
+         // the opcode may share the item; see m_accSlot
+         if ( ret == m_accSlot )
+            m_accSlot = 0;
       }
-      break;
+      return ret;
 
       case P_PARAM_LOCID:
          ret = local( *reinterpret_cast< int32 * >( m_currentContext->code() + m_currentContext->pc_next() ) );
          m_currentContext->pc_next()+=sizeof(int32);
+         if ( ret == m_accSlot )
+            m_accSlot = 0;
       return ret;
 
       case P_PARAM_PARID:
          ret = param( *reinterpret_cast< int32 * >( m_currentContext->code() + m_currentContext->pc_next() ) );
          m_currentContext->pc_next()+=sizeof(int32);
+         if ( ret == m_accSlot )
+            m_accSlot = 0;
       return ret;
 
       case P_PARAM_TRUE:
@@ -122,7 +131,12 @@ Item *VMachine::getOpcodeParam( register uint32 bc_pos )
 
       case P_PARAM_NTD32: m_currentContext->pc_next() += sizeof(int32); return 0;
       case P_PARAM_NTD64: m_currentContext->pc_next() += sizeof(int64); return 0;
-      case P_PARAM_REGA: return &regA();
+      case P_PARAM_REGA:
+         // A may hold the string of the accumulator after +=
+         if ( m_accSlot != 0 && regA().isString() && regA().asString() == m_accString )
+            m_accSlot = 0;
+         m_tmpSlot = 0;
+      return &regA();
       case P_PARAM_REGB: return &regB();
       case P_PARAM_REGS1: return &self();
       case P_PARAM_REGL1: return &latch();
@@ -136,6 +150,16 @@ Item *VMachine::getOpcodeParam( register uint32 bc_pos )
 }
 
 
+const String &VMachine::operandName( uint32 bc_pos, const Item *operand ) const
+{
+   // immediate strings come from the string table of the current module.
+   if ( operand == m_imm + bc_pos && operand->isString() )
+      return *currentLiveModule()->getAtom( m_immStrId[bc_pos] );
+
+   return *operand->asString();
+}
+
+
 void VMachine::run()
 {
    tOpcodeHandler *ops = m_opHandlers;
@@ -176,7 +200,10 @@ void VMachine::run()
          }
          else
          {
-            ops[ m_currentContext->code()[ m_currentContext->pc() ] ]( this );
+            byte opcode = m_currentContext->code()[ m_currentContext->pc() ];
+            if ( m_counters != 0 )
+               m_counters->countOp( opcode );
+            ops[ opcode ]( this );
          }
 
          m_opCount ++;
@@ -302,7 +329,10 @@ void opcodeHandler_GENA( register VMachine *vm )
    // copy the m-topmost items in the stack into the array
    if( size > 0 )
    {
-      array->items().copyOnto( vm->stack(), vm->stack().length() - size,  size );
+      array->items().resize( size );
+      const Item *src = vm->stack().elements() + vm->stack().length() - size;
+      for ( uint32 i = 0; i < size; ++i )
+         array->items()[i] = src[i];
       vm->currentFrame()->pop( size );
    }
 }
@@ -528,9 +558,18 @@ void opcodeHandler_FORK( register VMachine *vm )
 // 1E
 void opcodeHandler_LD( register VMachine *vm )
 {
-   Item *operand1 =  vm->getOpcodeParam( 1 )->dereference();
+   Item *accSlot = vm->m_accSlot;
+   Item *tmpSlot = vm->m_tmpSlot;
+   Item *target = vm->getOpcodeParam( 1 );
+   Item *operand1 = target->dereference();
    Item *operand2 =  vm->getOpcodeParam( 2 )->dereference();
 
+   // strings are copied; reading the accumulators here doesn't share them.
+   if ( target != accSlot )
+      vm->m_accSlot = accSlot;
+   if ( target != tmpSlot )
+      vm->m_tmpSlot = tmpSlot;
+
    /*
    if( operand1->isLBind() && operand1->asLBind()->getCharAt(0) != '.' )
    {
@@ -596,14 +635,61 @@ void opcodeHandler_LDRF( register VMachine *vm )
 }
 
 // 20
+/** Appends an operand to a string that only the VM references.
+   Returns false if the operand can't be added without calling back the VM.
+*/
+static bool vm_appendInPlace( VMachine *vm, CoreString *str, Item *operand )
+{
+   Item *op2 = operand->dereference();
+   if ( op2->isString() )
+   {
+      const String *add = op2->asString();
+      // the string is a VM accumulator; make it grow geometrically.
+      uint32 needed = str->size() + add->size() * str->manipulator()->charSize();
+      if ( needed > str->allocated() )
+         str->reserve( needed * 2 );
+      str->append( *add );
+      return true;
+   }
+
+   if ( op2->isOrdinal() )
+   {
+      String temp;
+      vm->itemToString( temp, op2 );
+      str->append( temp );
+      return true;
+   }
+
+   return false;
+}
+
 void opcodeHandler_ADD( register VMachine *vm )
 {
+   Item *accSlot = vm->m_accSlot;
+   Item *tmpSlot = vm->m_tmpSlot;
    Item *operand1 = vm->getOpcodeParam( 1 );
+   // the result is a new item; reading the first operand doesn't share it.
+   vm->m_accSlot = accSlot;
+   vm->m_tmpSlot = tmpSlot;
    Item *operand2 = vm->getOpcodeParam( 2 );
 
+   // a + b + c: extend the string created by the previous addition.
+   if ( operand1 == vm->m_tmpSlot && operand1 == &vm->regA()
+        && operand1->isString() && operand1->asString() == vm->m_tmpString
+        && vm_appendInPlace( vm, vm->m_tmpString, operand2 ) )
+   {
+      return;
+   }
+
    Item target; // neutralize auto-ops
    operand1->add( *operand2, target );
    vm->regA() = target;
+
+   if ( target.isString() && operand1->dereference()->isString() )
+   {
+      vm->m_tmpSlot = &vm->regA();
+      vm->m_tmpString = target.asCoreString();
+   }
 }
 
 // 21
@@ -653,12 +739,32 @@ void opcodeHandler_POW( register VMachine *vm )
 // 26
 void opcodeHandler_ADDS( register VMachine *vm )
 {
-   Item *operand1 = vm->getOpcodeParam( 1 )->dereference();
+   Item *accSlot = vm->m_accSlot;
+   Item *slot = vm->getOpcodeParam( 1 );
+   vm->m_accSlot = accSlot;
    Item *operand2 = vm->getOpcodeParam( 2 );
 
+   // s += x: extend the string that only this variable references.
+   if ( slot == vm->m_accSlot && slot->isString()
+        && slot->asString() == vm->m_accString
+        && vm_appendInPlace( vm, vm->m_accString, operand2 ) )
+   {
+      vm->regA() = *slot;
+      return;
+   }
+
    // TODO: S-operators
+   Item *operand1 = slot->dereference();
+   bool bString = operand1->isString();
    operand1->add( *operand2, *operand1 );
    vm->regA() = *operand1;
+
+   // references are shared, so only plain variables can own the result.
+   if ( bString && operand1 == slot && operand1->isString() )
+   {
+      vm->m_accSlot = slot;
+      vm->m_accString = operand1->asCoreString();
+   }
 }
 
 //27
@@ -968,8 +1074,7 @@ void opcodeHandler_LDP( register VMachine *vm )
 
    if( operand2->isString() )
    {
-      String *property = operand2->asString();
-      operand1->getProperty( *property, vm->regA() );
+      operand1->getProperty( vm->operandName( 2, operand2 ), vm->regA() );
    }
    else
       throw
@@ -1251,7 +1356,7 @@ void opcodeHandler_STPS( register VMachine *vm )
 
    if ( method->isString() )
    {
-      target->setProperty( *method->asString(), vm->stack()[vm->stack().length() - 1] );
+      target->setProperty( vm->operandName( 2, method ), vm->stack()[vm->stack().length() - 1] );
       vm->regA() = vm->stack()[vm->stack().length() - 1];
       vm->stack().resize( vm->stack().length() - 1 );
    }
@@ -1305,7 +1410,7 @@ void opcodeHandler_STP( register VMachine *vm )
 
    if ( method->isString() )
    {
-      target->setProperty( *method->asString(), *source );
+      target->setProperty( vm->operandName( 2, method ), *source );
 
       // when B is the source, the right value is already in A.
       if( sourcend != &vm->regB() )
@@ -1373,8 +1478,8 @@ void opcodeHandler_LDPT( register VMachine *vm )
 
    if( operand2->isString() )
    {
-      String *property = operand2->asString();
-      operand1->getProperty( *property, *vm->getOpcodeParam( 3 ) );
+      const String &property = vm->operandName( 2, operand2 );
+      operand1->getProperty( property, *vm->getOpcodeParam( 3 ) );
    }
    else
       throw
@@ -1416,7 +1521,7 @@ void opcodeHandler_STPR( register VMachine *vm )
 
    if ( method->isString() )
    {
-      target->setProperty( *method->asString(), *source );
+      target->setProperty( vm->operandName( 2, method ), *source );
       return;
    }
 
@@ -1794,9 +1899,16 @@ void opcodeHandler_STEX( register VMachine *vm )
    }
 
    CoreString *target = new CoreString;
-   String *src = operand1->asString();
+   VMachine::returnCode retval;
 
-   VMachine::returnCode retval = vm->expandString( *src, *target );
+   // Constant templates are parsed once per module.
+   if ( vm->m_currentContext->code()[ vm->m_currentContext->pc() + 1 ] == P_PARAM_STRID )
+   {
+      int32 id = *reinterpret_cast<int32 *>( vm->m_currentContext->code() + vm->m_currentContext->pc() + sizeof( int32 ) );
+      retval = vm->expandString( *vm->currentLiveModule()->getStringTemplate( id ), *target );
+   }
+   else
+      retval = vm->expandString( *operand1->asString(), *target );
    switch( retval )
    {
       case VMachine::return_ok:
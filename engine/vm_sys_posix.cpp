@@ -18,6 +18,8 @@
 #include <falcon/vm_sys_posix.h>
 #include <falcon/memory.h>
 #include <falcon/signals.h>
+#include <falcon/genericmap.h>
+#include <falcon/traits.h>
 #include <unistd.h>
 #include <poll.h>
 #include <stdio.h>
@@ -28,6 +30,11 @@
 #endif
 #include <errno.h>
 
+#ifdef __linux__
+   #include <sys/epoll.h>
+   #define FALCON_VM_EPOLL_BATCH 64
+#endif
+
 namespace Falcon {
 namespace Sys {
 
@@ -37,6 +44,8 @@ SystemData::SystemData(VMachine *vm)
 
    m_vm = vm;
    m_sysData->isSignalTarget = false;
+   m_sysData->reactor = -1;
+   m_sysData->watches = 0;
 
    // create the dup'd suspend pipe.
    if( pipe( m_sysData->interruptPipe ) != 0 )
@@ -53,6 +62,20 @@ SystemData::~SystemData()
    close( m_sysData->interruptPipe[0] );
    close( m_sysData->interruptPipe[1] );
 
+   if( m_sysData->reactor != -1 )
+      close( m_sysData->reactor );
+
+   if( m_sysData->watches != 0 )
+   {
+      MapIterator iter = m_sysData->watches->begin();
+      while( iter.hasCurrent() )
+      {
+         memFree( *(void**) iter.currentValue() );
+         iter.next();
+      }
+      delete m_sysData->watches;
+   }
+
    // delete the structure
    memFree( m_sysData );
 }
@@ -121,6 +144,247 @@ bool SystemData::sleep( numeric seconds ) const
 }
 
 
+#ifdef __linux__
+
+/** Who is waiting on a watched descriptor. */
+struct FD_WATCH
+{
+   int32 fd;
+   void* reader;
+   void* writer;
+};
+
+/** Arms the descriptor for the directions still waited, or removes it. */
+static bool s_armWatch( int reactor, Map* watches, FD_WATCH* watch )
+{
+   struct epoll_event evt;
+   evt.events = EPOLLONESHOT;
+   if( watch->reader != 0 )
+      evt.events |= EPOLLIN;
+   if( watch->writer != 0 )
+      evt.events |= EPOLLOUT;
+   evt.data.ptr = watch;
+
+   if( watch->reader == 0 && watch->writer == 0 )
+   {
+      // pre 2.6.9 kernels want a non-null event even on delete.
+      epoll_ctl( reactor, EPOLL_CTL_DEL, watch->fd, &evt );
+      watches->erase( &watch->fd );
+      memFree( watch );
+      return true;
+   }
+
+   // one-shot descriptors stay in the set after firing; just re-arm them.
+   if( epoll_ctl( reactor, EPOLL_CTL_MOD, watch->fd, &evt ) != 0 )
+   {
+      if( errno != ENOENT
+         || epoll_ctl( reactor, EPOLL_CTL_ADD, watch->fd, &evt ) != 0 )
+         return false;
+   }
+
+   return true;
+}
+
+
+bool SystemData::watchDescriptor( int32 fd, bool bWrite, void* data )
+{
+   // create the reactor on first need; the interrupt pipe is always watched.
+   if( m_sysData->reactor == -1 )
+   {
+      int reactor = epoll_create( FALCON_VM_EPOLL_BATCH );
+      if( reactor == -1 )
+         return false;
+
+      struct epoll_event evt;
+      evt.events = EPOLLIN;
+      evt.data.ptr = 0;
+      if( epoll_ctl( reactor, EPOLL_CTL_ADD, m_sysData->interruptPipe[0], &evt ) != 0 )
+      {
+         close( reactor );
+         return false;
+      }
+
+      m_sysData->reactor = reactor;
+      m_sysData->watches = new Map( &traits::t_int(), &traits::t_voidp() );
+   }
+
+   // epoll takes one registration per descriptor, shared by readers and writers.
+   FD_WATCH* watch;
+   FD_WATCH** pwatch = (FD_WATCH**) m_sysData->watches->find( &fd );
+   if( pwatch != 0 )
+      watch = *pwatch;
+   else
+   {
+      watch = (FD_WATCH*) memAlloc( sizeof( FD_WATCH ) );
+      watch->fd = fd;
+      watch->reader = 0;
+      watch->writer = 0;
+      m_sysData->watches->insert( &fd, watch );
+   }
+
+   void*& slot = bWrite ? watch->writer : watch->reader;
+   if( slot != 0 && slot != data )
+      return false;
+
+   slot = data;
+   if( ! s_armWatch( m_sysData->reactor, m_sysData->watches, watch ) )
+   {
+      slot = 0;
+      s_armWatch( m_sysData->reactor, m_sysData->watches, watch );
+      return false;
+   }
+
+   return true;
+}
+
+
+void SystemData::unwatchDescriptor( int32 fd, void* data )
+{
+   if( m_sysData->watches == 0 )
+      return;
+
+   FD_WATCH** pwatch = (FD_WATCH**) m_sysData->watches->find( &fd );
+   if( pwatch == 0 )
+      return;
+
+   FD_WATCH* watch = *pwatch;
+   if( watch->reader == data )
+      watch->reader = 0;
+   if( watch->writer == data )
+      watch->writer = 0;
+
+   s_armWatch( m_sysData->reactor, m_sysData->watches, watch );
+}
+
+
+int32 SystemData::dropDescriptor( int32 fd, void** waiters )
+{
+   if( m_sysData->watches == 0 )
+      return 0;
+
+   FD_WATCH** pwatch = (FD_WATCH**) m_sysData->watches->find( &fd );
+   if( pwatch == 0 )
+      return 0;
+
+   FD_WATCH* watch = *pwatch;
+   int32 count = 0;
+   if( watch->reader != 0 )
+      waiters[count++] = watch->reader;
+   if( watch->writer != 0 )
+      waiters[count++] = watch->writer;
+
+   watch->reader = 0;
+   watch->writer = 0;
+   s_armWatch( m_sysData->reactor, m_sysData->watches, watch );
+   return count;
+}
+
+
+void SystemData::dropDescriptors()
+{
+   if( m_sysData->watches == 0 )
+      return;
+
+   MapIterator iter = m_sysData->watches->begin();
+   while( iter.hasCurrent() )
+   {
+      FD_WATCH* watch = *(FD_WATCH**) iter.currentValue();
+      struct epoll_event evt;
+      evt.events = 0;
+      evt.data.ptr = 0;
+      epoll_ctl( m_sysData->reactor, EPOLL_CTL_DEL, watch->fd, &evt );
+      memFree( watch );
+      iter.next();
+   }
+
+   m_sysData->watches->clear();
+}
+
+
+int32 SystemData::waitDescriptors( numeric seconds, void** ready, int32 size ) const
+{
+   if( m_sysData->reactor == -1 )
+      return sleep( seconds ) ? 0 : -1;
+
+   // each event may wake up a reader and a writer.
+   struct epoll_event evts[FALCON_VM_EPOLL_BATCH];
+   int ms = seconds < 0.0 ? -1 : (int) (seconds * 1000.0);
+   int32 maxEvents = size / 2;
+   if( maxEvents > FALCON_VM_EPOLL_BATCH )
+      maxEvents = FALCON_VM_EPOLL_BATCH;
+
+   int res;
+   while( ( res = epoll_wait( m_sysData->reactor, evts, maxEvents, ms ) ) == -1 && errno == EINTR );
+
+   int32 count = 0;
+   bool bInterrupted = false;
+   for( int i = 0; i < res; ++i )
+   {
+      // the interrupt pipe is the only descriptor without data.
+      FD_WATCH* watch = (FD_WATCH*) evts[i].data.ptr;
+      if( watch == 0 )
+      {
+         bInterrupted = true;
+         continue;
+      }
+
+      // errors and hangups are reported to both sides.
+      uint32 events = evts[i].events;
+      if( watch->reader != 0 && (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0 )
+      {
+         ready[count++] = watch->reader;
+         watch->reader = 0;
+      }
+
+      if( watch->writer != 0 && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0 )
+      {
+         ready[count++] = watch->writer;
+         watch->writer = 0;
+      }
+
+      // the side still waiting must be armed again.
+      s_armWatch( m_sysData->reactor, m_sysData->watches, watch );
+   }
+
+   // leave the interrupt pending if we have something else to report.
+   if( count == 0 && bInterrupted )
+      return -1;
+
+   return count;
+}
+
+#else
+
+bool SystemData::watchDescriptor( int32, bool, void* )
+{
+   return false;
+}
+
+
+void SystemData::unwatchDescriptor( int32, void* )
+{
+}
+
+
+int32 SystemData::dropDescriptor( int32, void** )
+{
+   return 0;
+}
+
+
+void SystemData::dropDescriptors()
+{
+}
+
+
+int32 SystemData::waitDescriptors( numeric seconds, void**, int32 ) const
+{
+   return sleep( seconds ) ? 0 : -1;
+}
+
+#endif
+
+
 const char *SystemData::getSystemType()
 {
    return "POSIX";
@@ -63,6 +63,35 @@ bool SystemData::sleep( numeric seconds ) const
 }
 
 
+bool SystemData::watchDescriptor( int32, bool, void* )
+{
+   // not supported yet; callers fall back to blocking waits.
+   return false;
+}
+
+
+void SystemData::unwatchDescriptor( int32, void* )
+{
+}
+
+
+int32 SystemData::dropDescriptor( int32, void** )
+{
+   return 0;
+}
+
+
+void SystemData::dropDescriptors()
+{
+}
+
+
+int32 SystemData::waitDescriptors( numeric seconds, void**, int32 ) const
+{
+   return sleep( seconds ) ? 0 : -1;
+}
+
+
 const char *SystemData::getSystemType()
 {
    return "WIN";
@@ -25,6 +25,8 @@
 #include <falcon/sys.h>
 
 #define VM_STACK_MEMORY_THRESHOLD 128
+#define VM_STACK_FIRST_SEGMENT    256
+#define VM_STACK_FRAME_MIN        8
 
 
 namespace Falcon {
@@ -34,9 +36,12 @@ namespace Falcon {
 
 VMContext::VMContext():
    m_frames(0),
-   m_spareFrames(0)
+   m_spareFrames(0),
+   m_stackBase( StackSegment::create( VM_STACK_FIRST_SEGMENT ) )
 {
    m_sleepingOn = 0;
+   m_waitingFd = -1;
+   m_fdReady = false;
 
    m_schedule = 0.0;
    m_priority = 0;
@@ -51,6 +56,7 @@ VMContext::VMContext():
    m_lmodule = 0;
 
    m_frames = allocFrame();
+   placeFrame( m_frames );
    // reset stuff for the first frame,
    // as allocFrame doesn't clear everything for performance reasons.
    m_frames->m_param_count = 0;
@@ -59,9 +65,12 @@ VMContext::VMContext():
 
 VMContext::VMContext( const VMContext& other ):
    m_frames(0),
-   m_spareFrames(0)
+   m_spareFrames(0),
+   m_stackBase( StackSegment::create( VM_STACK_FIRST_SEGMENT ) )
 {
    m_sleepingOn = 0;
+   m_waitingFd = -1;
+   m_fdReady = false;
 
    m_schedule = 0.0;
    m_priority = 0;
@@ -76,6 +85,7 @@ VMContext::VMContext( const VMContext& other ):
    m_lmodule = other.m_lmodule;
 
    m_frames = allocFrame();
+   placeFrame( m_frames );
    // reset stuff for the first frame,
    // as allocFrame doesn't clear everything for performance reasons.
    m_frames->m_param_count = 0;
@@ -102,6 +112,7 @@ VMContext::~VMContext()
    }
 
    m_frames = m_spareFrames = 0;
+   StackSegment::destroyChain( m_stackBase );
 }
 
 
@@ -121,6 +132,24 @@ void VMContext::waitOn( VMSemaphore* sem, numeric secs )
    m_sleepingOn = sem;
 }
 
+void VMContext::waitOnDescriptor( int32 fd, numeric secs )
+{
+   if( secs < 0.0 )
+      m_schedule = -1.0;
+   else
+      m_schedule =  Sys::_seconds() + secs;
+
+   m_waitingFd = fd;
+   m_fdReady = false;
+}
+
+void VMContext::descriptorDone( bool ready )
+{
+   m_waitingFd = -1;
+   m_fdReady = ready;
+   m_schedule = 0.0;  // immediately runnable
+}
+
 void VMContext::wakeup( bool signaled )
 {
    if ( m_sleepingOn != 0 )  // overkill, but...
@@ -162,6 +191,7 @@ StackFrame* VMContext::createFrame( uint32 paramCount, ext_func_frame_t frameEnd
    frame->m_prevTryFrame = m_tryFrame;
 
    frame->m_try_base = VMachine::i_noTryFrame;
+   frame->m_enterTime = 0.0;
 
    // parameter count.
    frame->m_param_count = paramCount;
@@ -241,10 +271,51 @@ bool VMContext::getTraceStep( uint32 level, const Symbol* &sym, uint32& line, ui
 }
 
 
+void VMContext::placeFrame( StackFrame* frame )
+{
+   // frames with their own buffers are not in the stack.
+   StackFrame* below = frame->prev();
+   while( below != 0 && below->stack().segment() == 0 )
+      below = below->prev();
+
+   StackSegment* seg;
+   Item* base;
+   if ( below != 0 )
+   {
+      below->stack().freeze();
+      seg = below->stack().segment();
+      base = below->stack().elements() + below->stack().length();
+   }
+   else
+   {
+      seg = m_stackBase;
+      base = seg->items();
+   }
+
+   if ( seg->end() - base < VM_STACK_FRAME_MIN )
+   {
+      seg = seg->next( VM_STACK_FRAME_MIN );
+      base = seg->items();
+   }
+
+   frame->stack().place( seg, base );
+}
+
+void VMContext::thawFrames()
+{
+   StackFrame* top = m_frames;
+   while( top != 0 && top->stack().segment() == 0 )
+      top = top->prev();
+
+   if ( top != 0 )
+      top->stack().thaw();
+}
+
 void VMContext::addFrame( StackFrame* frame )
 {
    frame->prev( m_frames );
    m_frames = frame;
+   placeFrame( frame );
 }
 
 StackFrame* VMContext::popFrame()
@@ -255,6 +326,7 @@ StackFrame* VMContext::popFrame()
    StackFrame *ret = m_frames;
    m_frames = m_frames->prev();
    ret->prev(0);
+   thawFrames();
    return ret;
 }
 
@@ -264,7 +336,6 @@ StackFrame* VMContext::allocFrame()
    {
       StackFrame* ret = m_spareFrames;
       m_spareFrames = m_spareFrames->prev();
-      ret->resizeStack(0);
 
       ret->prev(0);
       ret->m_try_base = VMachine::i_noTryFrame;
@@ -296,12 +367,13 @@ void VMContext::resetFrames()
    if( m_frames == 0 )
    {
       m_frames = allocFrame();
+      placeFrame( m_frames );
    }
    else
    {
       StackFrame* top = m_frames->prev();
       m_frames->prev( 0 );
-      m_frames->resizeStack(0);
+      placeFrame( m_frames );
 
       if ( top != 0 )
       {
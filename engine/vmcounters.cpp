@@ -0,0 +1,338 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: vmcounters.cpp
+
+   Execution counters of the virtual machine.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:03:41 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Execution counters of the virtual machine.
+*/
+
+#include <falcon/vmcounters.h>
+#include <falcon/vm.h>
+#include <falcon/vmcontext.h>
+#include <falcon/stackframe.h>
+#include <falcon/symbol.h>
+#include <falcon/module.h>
+#include <falcon/stream.h>
+#include <falcon/traits.h>
+#include <falcon/coredict.h>
+#include <falcon/lineardict.h>
+#include <falcon/sys.h>
+
+#include <string.h>
+
+namespace Falcon {
+
+static const char* s_opNames[ FLC_PCODE_COUNT ] = {
+   "END", "NOP", "PSHN", "RET", "RETA", "LNIL", "PTRY", "RETV",
+   "BOOL", "JMP", "GENA", "GEND", "PUSH", "PSHR", "POP", "INC",
+   "DEC", "NEG", "NOT", "TRAL", "IPOP", "XPOP", "GEOR", "TRY",
+   "JTRY", "RIS", "BNOT", "NOTS", "PEEK", "FORK", "LD", "LDRF",
+   "ADD", "SUB", "MUL", "DIV", "MOD", "POW", "ADDS", "SUBS",
+   "MULS", "DIVS", "MODS", "BAND", "BOR", "BXOR", "ANDS", "ORS",
+   "XORS", "GENR", "EQ", "NEQ", "GT", "GE", "LT", "LE",
+   "IFT", "IFF", "CALL", "INST", "ONCE", "LDV", "LDP", "TRAN",
+   "LDAS", "SWCH", 0, 0, 0, 0, "IN", "NOIN",
+   "PROV", "STVS", "STPS", "AND", "OR", 0, 0, "STV",
+   "STP", "LDVT", "LDPT", "STVR", "STPR", "TRAV", "INCP", "DECP",
+   "SHL", "SHR", "SHLS", "SHRS", "CLOS", "PSHL", "POWS", "LSB",
+   "EVAL", "SELE", "INDI", "STEX", "TRAC", "WRT", "STO", "FORB",
+   "OOB", "TRDN", 0, 0, 0, 0, 0, 0,
+   "EXEQ"
+};
+
+
+class VMCounters::FuncCounter: public BaseAlloc
+{
+public:
+   String m_name;
+   uint64 m_calls;
+   /** Inclusive time, in seconds. */
+   numeric m_time;
+   /** Activations currently on some stack. */
+   uint32 m_active;
+
+   /** Line (int32) -> uint64* calls from that line. */
+   Map m_sites;
+   /** FuncCounter* -> uint64* calls to that function. */
+   Map m_callees;
+
+   FuncCounter( const String& name ):
+      m_name( name ),
+      m_calls( 0 ),
+      m_time( 0.0 ),
+      m_active( 0 ),
+      m_sites( &traits::t_int(), &traits::t_voidp() ),
+      m_callees( &traits::t_voidp(), &traits::t_voidp() )
+   {}
+
+   ~FuncCounter()
+   {
+      clearCounts( m_sites );
+      clearCounts( m_callees );
+   }
+
+   static void count( Map& map, const void* key )
+   {
+      uint64** value = (uint64**) map.find( key );
+      if ( value != 0 )
+         ++ **value;
+      else
+      {
+         uint64* counter = (uint64*) memAlloc( sizeof( uint64 ) );
+         *counter = 1;
+         map.insert( key, counter );
+      }
+   }
+
+   static void clearCounts( Map& map )
+   {
+      MapIterator iter = map.begin();
+      while( iter.hasCurrent() )
+      {
+         memFree( *(uint64**) iter.currentValue() );
+         iter.next();
+      }
+      map.clear();
+   }
+};
+
+
+VMCounters::VMCounters():
+   m_funcs( &traits::t_voidp(), &traits::t_voidp() )
+{
+   memset( m_ops, 0, sizeof( m_ops ) );
+}
+
+
+VMCounters::~VMCounters()
+{
+   reset();
+}
+
+
+void VMCounters::reset()
+{
+   memset( m_ops, 0, sizeof( m_ops ) );
+
+   MapIterator iter = m_funcs.begin();
+   while( iter.hasCurrent() )
+   {
+      delete *(FuncCounter**) iter.currentValue();
+      iter.next();
+   }
+   m_funcs.clear();
+}
+
+
+const char* VMCounters::opName( byte opcode )
+{
+   return opcode < FLC_PCODE_COUNT ? s_opNames[ opcode ] : 0;
+}
+
+
+VMCounters::FuncCounter* VMCounters::function( const Symbol* sym )
+{
+   FuncCounter** pfc = (FuncCounter**) m_funcs.find( sym );
+   if ( pfc != 0 )
+      return *pfc;
+
+   FuncCounter* fc = new FuncCounter( sym->module()->name() + "." + sym->name() );
+   m_funcs.insert( sym, fc );
+   return fc;
+}
+
+
+void VMCounters::enter( VMContext* ctx )
+{
+   StackFrame* frame = ctx->currentFrame();
+   FuncCounter* callee = function( ctx->symbol() );
+   ++callee->m_calls;
+
+   // the frame records the caller and the point of the call.
+   const Symbol* csym = frame->m_symbol;
+   if ( csym != 0 )
+   {
+      FuncCounter* caller = function( csym );
+      int32 line = csym->isFunction() && frame->m_call_pc < VMachine::i_pc_call_request ?
+            (int32) csym->module()->getLineAt( csym->getFuncDef()->basePC() + frame->m_call_pc ) : 0;
+      FuncCounter::count( caller->m_sites, &line );
+      FuncCounter::count( caller->m_callees, callee );
+   }
+
+   // only the outermost activation is timed.
+   frame->m_enterTime = callee->m_active++ == 0 ? Sys::_seconds() : -1.0;
+}
+
+
+void VMCounters::leave( VMContext* ctx )
+{
+   StackFrame* frame = ctx->currentFrame();
+   if ( frame->m_enterTime == 0.0 || ctx->symbol() == 0 )
+      return;
+
+   FuncCounter* fc = function( ctx->symbol() );
+   if ( fc->m_active > 0 )
+      --fc->m_active;
+
+   if ( frame->m_enterTime > 0.0 )
+      fc->m_time += Sys::_seconds() - frame->m_enterTime;
+   frame->m_enterTime = 0.0;
+}
+
+
+static void s_jsonString( String& target, const String& str )
+{
+   target += '"';
+   for ( uint32 i = 0; i < str.length(); ++i )
+   {
+      uint32 chr = str.getCharAt( i );
+      switch( chr )
+      {
+         case '"': target += "\\\""; break;
+         case '\\': target += "\\\\"; break;
+         case '\n': target += "\\n"; break;
+         case '\r': target += "\\r"; break;
+         case '\t': target += "\\t"; break;
+         default:
+            if ( chr < 0x20 )
+            {
+               target += "\\u00";
+               target.writeNumberHex( chr, false, 2 );
+            }
+            else
+               target += chr;
+      }
+   }
+   target += '"';
+}
+
+
+bool VMCounters::writeJSON( Stream* out ) const
+{
+   String text = "{\n  \"ops\": {";
+   bool bFirst = true;
+   for ( uint32 op = 0; op < FLC_PCODE_COUNT; ++op )
+   {
+      if ( m_ops[op] == 0 || s_opNames[op] == 0 )
+         continue;
+
+      text += bFirst ? "\n    \"" : ",\n    \"";
+      text += s_opNames[op];
+      text += "\": ";
+      text.writeNumber( (int64) m_ops[op] );
+      bFirst = false;
+   }
+   text += "\n  },\n  \"functions\": {";
+
+   if ( ! out->writeString( text ) )
+      return false;
+
+   bFirst = true;
+   MapIterator iter = m_funcs.begin();
+   while( iter.hasCurrent() )
+   {
+      const FuncCounter* fc = *(FuncCounter**) iter.currentValue();
+
+      text = bFirst ? "\n    " : ",\n    ";
+      s_jsonString( text, fc->m_name );
+      text += ": { \"calls\": ";
+      text.writeNumber( (int64) fc->m_calls );
+      text += ", \"time\": ";
+      text.writeNumber( fc->m_time, "%.6f" );
+
+      text += ", \"sites\": {";
+      MapIterator si = fc->m_sites.begin();
+      while( si.hasCurrent() )
+      {
+         text += si.equal( fc->m_sites.begin() ) ? " \"" : ", \"";
+         text.writeNumber( (int64) *(int32*) si.currentKey() );
+         text += "\": ";
+         text.writeNumber( (int64) **(uint64**) si.currentValue() );
+         si.next();
+      }
+
+      text += " }, \"callees\": {";
+      MapIterator ci = fc->m_callees.begin();
+      while( ci.hasCurrent() )
+      {
+         text += ci.equal( fc->m_callees.begin() ) ? " " : ", ";
+         s_jsonString( text, (*(FuncCounter**) ci.currentKey())->m_name );
+         text += ": ";
+         text.writeNumber( (int64) **(uint64**) ci.currentValue() );
+         ci.next();
+      }
+      text += " } }";
+
+      if ( ! out->writeString( text ) )
+         return false;
+
+      bFirst = false;
+      iter.next();
+   }
+
+   return out->writeString( "\n  }\n}\n" );
+}
+
+
+CoreDict* VMCounters::toDict() const
+{
+   LinearDict* ops = new LinearDict;
+   for ( uint32 op = 0; op < FLC_PCODE_COUNT; ++op )
+   {
+      if ( m_ops[op] != 0 && s_opNames[op] != 0 )
+         ops->put( new CoreString( s_opNames[op] ), (int64) m_ops[op] );
+   }
+
+   LinearDict* funcs = new LinearDict( m_funcs.size() );
+   MapIterator iter = m_funcs.begin();
+   while( iter.hasCurrent() )
+   {
+      const FuncCounter* fc = *(FuncCounter**) iter.currentValue();
+
+      LinearDict* sites = new LinearDict( fc->m_sites.size() );
+      MapIterator si = fc->m_sites.begin();
+      while( si.hasCurrent() )
+      {
+         sites->put( (int64) *(int32*) si.currentKey(), (int64) **(uint64**) si.currentValue() );
+         si.next();
+      }
+
+      LinearDict* callees = new LinearDict( fc->m_callees.size() );
+      MapIterator ci = fc->m_callees.begin();
+      while( ci.hasCurrent() )
+      {
+         callees->put( new CoreString( (*(FuncCounter**) ci.currentKey())->m_name ),
+               (int64) **(uint64**) ci.currentValue() );
+         ci.next();
+      }
+
+      LinearDict* func = new LinearDict( 4 );
+      func->put( new CoreString( "calls" ), (int64) fc->m_calls );
+      func->put( new CoreString( "time" ), fc->m_time );
+      func->put( new CoreString( "sites" ), new CoreDict( sites ) );
+      func->put( new CoreString( "callees" ), new CoreDict( callees ) );
+      funcs->put( new CoreString( fc->m_name ), new CoreDict( func ) );
+
+      iter.next();
+   }
+
+   LinearDict* result = new LinearDict( 2 );
+   result->put( new CoreString( "ops" ), new CoreDict( ops ) );
+   result->put( new CoreString( "functions" ), new CoreDict( funcs ) );
+   return new CoreDict( result );
+}
+
+}
+
+/* end of vmcounters.cpp */
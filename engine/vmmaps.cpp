@@ -19,8 +19,12 @@
 
 #include <falcon/vmmaps.h>
 #include <falcon/livemodule.h>
+#include <falcon/atomtable.h>
+#include <falcon/memory.h>
 #include <string.h>
 
+#define SYMMODULEMAP_INITIAL_BUCKETS  64
+
 namespace Falcon {
 
 
@@ -63,11 +67,149 @@ namespace traits
    SymModuleTraits &t_symmodule() { static SymModuleTraits dt; return dt; }
 }
 
+//==================================================================
+// Symbol map
+//
+
+class SymModuleMap::Entry: public BaseAlloc
+{
+public:
+   const String *m_name;
+   uint32 m_hash;
+   SymModule m_data;
+   Entry *m_next;
+
+   Entry( const String *name, uint32 hash, const SymModule &data ):
+      m_name( name ),
+      m_hash( hash ),
+      m_data( data ),
+      m_next( 0 )
+   {}
+};
+
+
 SymModuleMap::SymModuleMap():
-   Map( &traits::t_stringptr(), &traits::t_symmodule() )
+   m_buckets( 0 ),
+   m_bucketCount( 0 ),
+   m_size( 0 )
 {}
 
 
+SymModuleMap::~SymModuleMap()
+{
+   for ( uint32 i = 0; i < m_bucketCount; ++i )
+   {
+      Entry *e = m_buckets[i];
+      while( e != 0 )
+      {
+         Entry *next = e->m_next;
+         delete e;
+         e = next;
+      }
+   }
+
+   if ( m_buckets != 0 )
+      memFree( m_buckets );
+}
+
+
+SymModuleMap::Entry *SymModuleMap::findEntry( const String *name, uint32 hash ) const
+{
+   if ( m_bucketCount == 0 )
+      return 0;
+
+   Entry *e = m_buckets[ hash & (m_bucketCount-1) ];
+   while( e != 0 )
+   {
+      if ( e->m_hash == hash && ( e->m_name == name || *e->m_name == *name ) )
+         return e;
+      e = e->m_next;
+   }
+
+   return 0;
+}
+
+
+void SymModuleMap::grow()
+{
+   uint32 newCount = m_bucketCount == 0 ? SYMMODULEMAP_INITIAL_BUCKETS : m_bucketCount * 2;
+   Entry **newBuckets = (Entry **) memAlloc( sizeof( Entry* ) * newCount );
+   memset( newBuckets, 0, sizeof( Entry* ) * newCount );
+
+   for ( uint32 i = 0; i < m_bucketCount; ++i )
+   {
+      Entry *e = m_buckets[i];
+      while( e != 0 )
+      {
+         Entry *next = e->m_next;
+         Entry *&head = newBuckets[ e->m_hash & (newCount-1) ];
+         e->m_next = head;
+         head = e;
+         e = next;
+      }
+   }
+
+   if ( m_buckets != 0 )
+      memFree( m_buckets );
+   m_buckets = newBuckets;
+   m_bucketCount = newCount;
+}
+
+
+SymModule *SymModuleMap::find( const String *name ) const
+{
+   Entry *e = findEntry( name, AtomTable::hash( *name ) );
+   return e == 0 ? 0 : &e->m_data;
+}
+
+
+void SymModuleMap::insert( const String *name, const SymModule *sm )
+{
+   uint32 hash = AtomTable::hash( *name );
+   Entry *e = findEntry( name, hash );
+   if ( e != 0 )
+   {
+      // like in the maps, the key is updated with the data.
+      e->m_name = name;
+      e->m_data = *sm;
+      return;
+   }
+
+   if ( m_size >= m_bucketCount )
+      grow();
+
+   e = new Entry( name, hash, *sm );
+   Entry *&head = m_buckets[ hash & (m_bucketCount-1) ];
+   e->m_next = head;
+   head = e;
+   ++m_size;
+}
+
+
+bool SymModuleMap::erase( const String *name )
+{
+   if ( m_bucketCount == 0 )
+      return false;
+
+   uint32 hash = AtomTable::hash( *name );
+   Entry **pos = &m_buckets[ hash & (m_bucketCount-1) ];
+   while( *pos != 0 )
+   {
+      Entry *e = *pos;
+      if ( e->m_hash == hash && ( e->m_name == name || *e->m_name == *name ) )
+      {
+         *pos = e->m_next;
+         delete e;
+         --m_size;
+         return true;
+      }
+      pos = &e->m_next;
+   }
+
+   return false;
+}
+
+
 SymModule::SymModule( LiveModule *mod, const Symbol *sym ):
    m_item( &mod->globals()[ sym->itemId() ] ),
    m_symbol( sym ),
@@ -0,0 +1,77 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: atomtable.h
+
+   Process-wide table of interned strings.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:08:27 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Process-wide table of interned strings.
+*/
+
+#ifndef FALCON_ATOMTABLE_H
+#define FALCON_ATOMTABLE_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+
+namespace Falcon {
+
+class String;
+
+/** Process-wide table of interned strings (atoms).
+
+   An atom is the canonical instance of a string value: interning two
+   strings with the same contents returns the same pointer, so that atoms
+   can be compared by identity. Each atom also stores its hash value,
+   computed once when it enters the table.
+
+   The engine interns the names of the properties of the classes it links,
+   and the names used by the modules to access them; the property tables can
+   then resolve the accesses performed by the scripts with pointer
+   comparisons (see PropertyTable::findKey).
+
+   The table is shared by all the virtual machines and is thread safe. Atoms
+   are never removed; they stay valid until Engine::Shutdown().
+*/
+class FALCON_DYN_CLASS AtomTable
+{
+public:
+   /** Returns the atom having the same contents as the given string.
+      The atom is created if it doesn't exist yet.
+   */
+   static const String *intern( const String &str );
+
+   /** Returns the atom having the same contents as the given string, or 0. */
+   static const String *find( const String &str );
+
+   /** Returns the hash value stored in an atom.
+      \param atom A string returned by intern() or find().
+   */
+   static uint32 atomHash( const String *atom );
+
+   /** Computes the hash value of a string.
+      The hash depends only on the characters, not on the way they are stored.
+   */
+   static uint32 hash( const String &str );
+
+   /** Count of the atoms currently in the table. */
+   static uint32 count();
+
+   /** Destroys all the atoms; called by Engine::Shutdown(). */
+   static void clear();
+};
+
+}
+
+#endif
+
+/* end of atomtable.h */
@@ -215,6 +215,12 @@ public:
    CoreObject *table() const { return m_table; }
    void table( CoreObject *t ) { m_table = t; }
 
+   /** Signals that the items of this array have been changed in place.
+      If the array is a row of a table, this invalidates the table indexes;
+      native code writing directly in the items must call it.
+   */
+   void changed();
+
    uint32 tablePos() const { return m_tablePos; }
    void tablePos( uint32 tp ) { m_tablePos = tp; }
 
@@ -0,0 +1,135 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: compilecache.h
+
+   Persistent cache of compiled modules.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:37:44 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Persistent cache of compiled modules.
+*/
+
+#ifndef FALCON_COMPILECACHE_H
+#define FALCON_COMPILECACHE_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+#include <falcon/string.h>
+#include <falcon/mt.h>
+
+namespace Falcon {
+
+class Module;
+class Stream;
+
+/** Persistent cache of compiled modules.
+
+   The cache is a directory holding the compiled form (the same of .fam
+   files) of the sources that the module loaders compile. Entries are
+   addressed by a key derived from the text of the source, from the
+   compiler settings (see Compiler::describeSettings) and from the engine
+   version, so the same source compiled in different places, or in read
+   only deployments, is compiled only once.
+
+   The cache can be shared by concurrent processes: entries are written
+   in a temporary file and renamed to their final name, so readers see
+   either a complete entry or none. Reading an entry refreshes its
+   modification time; when the entries grow past the size limit, the
+   least recently used ones are removed.
+
+   The ModuleLoader instances use the cache set with Engine::setCompileCache().
+*/
+class FALCON_DYN_CLASS CompileCache: public BaseAlloc
+{
+public:
+   enum {
+      /** Default size limit, in bytes. */
+      default_size = 64*1024*1024
+   };
+
+   /** Counters of the cache activity since its creation. */
+   class Stats
+   {
+   public:
+      uint64 m_hits;
+      uint64 m_misses;
+      uint64 m_stores;
+      uint64 m_evictions;
+      /** Entries that couldn't be written or read back. */
+      uint64 m_errors;
+
+      Stats():
+         m_hits( 0 ),
+         m_misses( 0 ),
+         m_stores( 0 ),
+         m_evictions( 0 ),
+         m_errors( 0 )
+      {}
+   };
+
+   /** Creates a cache stored in the given directory.
+      The directory is created if necessary when the first entry is stored.
+      \param path The cache directory, in Falcon format.
+      \param maxSize Size limit of the cache, in bytes.
+   */
+   CompileCache( const String &path, int64 maxSize = default_size );
+
+   const String &path() const { return m_path; }
+   int64 maxSize() const { return m_maxSize; }
+
+   /** Computes the key of a source.
+      \param source The text of the source, as read from its file.
+      \param size Size of the source, in bytes.
+      \param settings Description of how the source is compiled.
+   */
+   static String key( const byte *source, uint32 size, const String &settings );
+
+   /** Opens the entry stored under a key.
+      \return A stream reading the compiled module, or 0 on miss.
+   */
+   Stream *find( const String &key );
+
+   /** Stores a compiled module under a key.
+      \return false if the module couldn't be stored.
+   */
+   bool store( const String &key, const Module *mod );
+
+   /** Removes an entry that couldn't be read back. */
+   void discard( const String &key );
+
+   /** Removes the least recently used entries until the cache fits its limit. */
+   void trim();
+
+   /** Copies the activity counters. */
+   void stats( Stats &target ) const;
+
+   /** Writes a one-line summary of the activity. */
+   void describe( String &target ) const;
+
+private:
+   String entryPath( const String &key ) const;
+
+   String m_path;
+   int64 m_maxSize;
+
+   mutable Mutex m_mtx;
+   Stats m_stats;
+   /** Estimated size of the entries; -1 until the directory is scanned. */
+   int64 m_size;
+   uint32 m_tempId;
+};
+
+}
+
+#endif
+
+/* end of compilecache.h */
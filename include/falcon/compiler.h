@@ -442,6 +442,16 @@ public:
    void strictMode( bool breq ) { m_strict = breq; }
    bool strictMode() const { return m_strict; }
 
+   /** Sets the optimization level.
+      - 0: no optimization (the default).
+      - 1: the syntactic tree is optimized (constant folding and dead branch
+           elimination) at the end of a successful compilation.
+      - 2 or more: as 1; code generators are also expected to run their
+           peephole optimizer on the generated code (see GenCode::peephole).
+   */
+   void optLevel( int level ) { m_optLevel = level; }
+   int optLevel() const { return m_optLevel; }
+
    /** Are we parsing a normal file or an escaped template file? */
    bool parsingFtd() const;
    void parsingFtd( bool b );
@@ -473,6 +483,20 @@ public:
    void defContext( bool ctx ) { m_defContext = ctx; }
    bool defContext() const { return m_defContext; }
 
+   /** Describes the settings affecting the generated code.
+      Writes the directives, the optimization level and the constants
+      currently defined, so that two compilations of the same source with
+      the same description produce the same module.
+   */
+   void describeSettings( String &target ) const;
+
+   /** Copies the settings of another compiler.
+      Copies the directives, the optimization level and the constants
+      of the other compiler, so that both produce the same module out
+      of the same source.
+   */
+   void copySettings( const Compiler &other );
+
    /** Closes the currently worked on closure */
    Value *closeClosure();
    void incClosureContext() { m_closureContexts++; }
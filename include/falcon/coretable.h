@@ -27,6 +27,7 @@
 namespace Falcon {
 
 class CoreTable;
+class CoreTableIndex;
 
 //=========================================================
 //
@@ -44,6 +45,13 @@ class CoreTable: public Sequence
    numeric *m_biddingVals;
    uint32 m_biddingSize;
 
+   /** Column indexes of the current page (CoreTableIndex*), built on demand. */
+   GenericVector m_indexes;
+   /** Increased each time the table contents are changed. */
+   uint32 m_version;
+
+   void dropIndexes();
+
 public:
    enum {
       noitem = 0xFFFFFFFF
@@ -122,6 +130,8 @@ public:
    {
       if ( num < m_pages.size() )
       {
+         if ( num != m_currentPageId )
+            changed();
          m_currentPageId = num;
          m_currentPage = *reinterpret_cast<CoreArray **>(m_pages.at( num ));
          return true;
@@ -187,6 +197,28 @@ public:
    */
    bool removePage( uint32 pos );
 
+   /** Finds the first row in the current page having a given value in a column.
+      Rows are compared with the == operator semantic. Integer and string
+      columns are indexed on demand: an index is built when the same column
+      is searched twice without changes in the table, and it's used until the
+      table is changed again.
+
+      \param col The column where to search the value.
+      \param value The value to be searched.
+      \return The position of the row in the current page, or noitem if not found.
+   */
+   uint32 findRow( uint32 col, const Item &value );
+
+   /** Signals that the contents of the table have been changed.
+      This invalidates the column indexes; it is called by the table itself and by
+      the rows of the table when they are modified, but must be called also by
+      code directly changing the pages or the rows.
+   */
+   void changed() { ++m_version; }
+
+   /** Modification counter of the table. */
+   uint32 version() const { return m_version; }
+
    //========================================
    //===== Sequence interface ===============
    //
@@ -43,7 +43,7 @@ namespace Falcon
       void removeWatch(String name);
       const Map& watches() const;
 
-      const ItemArray& stackTrace() const;
+      const StackWindow& stackTrace() const;
 
 
 
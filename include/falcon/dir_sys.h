@@ -71,6 +71,8 @@ bool FALCON_DYN_SYM fal_chdir( const String &filename, int32 &fsStatus );
 bool FALCON_DYN_SYM fal_move( const String &filename, const String &dest, int32 &fsStatus );
 bool FALCON_DYN_SYM fal_getcwd( String &fname, int32 &fsError );
 bool FALCON_DYN_SYM fal_chmod( const String &fname, uint32 mode );
+/** Sets the modification time of a file to the current time. */
+bool FALCON_DYN_SYM fal_touch( const String &fname );
 bool FALCON_DYN_SYM fal_chown( const String &fname, int32 owner );
 bool FALCON_DYN_SYM fal_chgrp( const String &fname, int32 grp );
 bool FALCON_DYN_SYM fal_readlink( const String &fname, String &link );
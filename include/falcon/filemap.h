@@ -0,0 +1,105 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: filemap.h
+
+   Files mapped in memory.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:39:22 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Files mapped in memory.
+*/
+
+#ifndef FALCON_FILEMAP_H
+#define FALCON_FILEMAP_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+#include <falcon/membuf.h>
+
+namespace Falcon {
+
+class String;
+
+/** A whole file mapped in memory.
+
+   The mapping is shared by the objects giving access to it (MapStream
+   and MappedMemBuf instances); each of them holds a reference, and the
+   file is unmapped when the last one is destroyed. As those objects are
+   disposed by the garbage collector only when they can't be reached
+   anymore, the mapped memory is never accessed after being unmapped.
+
+   Writable mappings write through to the file. Read only mappings are
+   private: their pages can still be changed in memory (the VM doesn't
+   distinguish read only memory buffers), but the changes never reach the file.
+
+   The implementation is system specific (see filemap_sys_*.cpp).
+*/
+class FALCON_DYN_CLASS FileMap: public BaseAlloc
+{
+public:
+   /** Maps a file.
+      \param path the file to be mapped, in the host system format.
+      \param bWritable true to write the changes back to the file.
+      \param fsError on failure, the system error code.
+      \return a new mapping with one reference, or 0 on error.
+   */
+   static FileMap *map( const String &path, bool bWritable, int64 &fsError );
+
+   byte *data() const { return m_data; }
+   uint64 size() const { return m_size; }
+   bool writable() const { return m_bWritable; }
+
+   void incref();
+   void decref();
+
+   /** Writes the changed pages back to the file.
+      \return false on error.
+   */
+   bool sync();
+
+private:
+   byte *m_data;
+   uint64 m_size;
+   bool m_bWritable;
+   volatile int32 m_refCount;
+   void *m_sysData;
+
+   FileMap( byte *data, uint64 size, bool bWritable, void *sysData );
+   ~FileMap();
+
+   void unmap();
+};
+
+
+/** Memory buffer viewing (part of) a mapped file.
+   The memory is not copied; the buffer keeps the mapping alive.
+*/
+class FALCON_DYN_CLASS MappedMemBuf: public MemBuf_1
+{
+public:
+   /** Creates a view on the given mapping.
+      The caller must ensure that the range is inside the mapped data.
+   */
+   MappedMemBuf( FileMap *map, uint64 offset, uint32 length );
+   virtual ~MappedMemBuf();
+
+   FileMap *fileMap() const { return m_map; }
+
+private:
+   FileMap *m_map;
+};
+
+}
+
+#endif
+
+/* end of filemap.h */
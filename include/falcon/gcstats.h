@@ -0,0 +1,142 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: gcstats.h
+
+   Garbage collector telemetry.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:08:30 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Garbage collector telemetry.
+*/
+
+#ifndef FALCON_GCSTATS_H
+#define FALCON_GCSTATS_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+
+namespace Falcon {
+
+class String;
+
+/** Statistics collected by the garbage collector.
+
+   The memory pool keeps an instance of this class up to date while the
+   collector works; MemPool::stats() copies it for the embedding
+   application, and the GC.stats() method returns it to scripts.
+
+   Times are in seconds; the histograms count mark and sweep durations
+   in buckets whose limits double from 10 microseconds onwards.
+*/
+class FALCON_DYN_CLASS GCStats: public BaseAlloc
+{
+public:
+   enum {
+      /** Buckets of the duration histograms. */
+      hist_size = 16,
+      /** Threshold changes kept in the ramp history. */
+      ramp_history = 8
+   };
+
+   /** Histogram of durations. */
+   class FALCON_DYN_CLASS Histogram
+   {
+   public:
+      uint32 m_count[ hist_size ];
+      uint32 m_samples;
+      numeric m_total;
+      numeric m_max;
+
+      Histogram() { reset(); }
+
+      void add( numeric seconds );
+      void reset();
+
+      numeric average() const { return m_samples == 0 ? 0.0 : m_total / m_samples; }
+
+      /** Upper limit of a bucket in seconds; the last bucket has no limit and returns 0. */
+      static numeric limit( uint32 bucket );
+   };
+
+   /** A change of the collection thresholds, or of the ramp mode setting them. */
+   class RampChange
+   {
+   public:
+      /** Seconds since the statistics were started. */
+      numeric m_time;
+      int32 m_mode;
+      size_t m_normal;
+      size_t m_active;
+   };
+
+   GCStats() { reset(); }
+
+   /** Clears the collected data and restarts the clock. */
+   void reset();
+
+   /** Records a threshold change. */
+   void rampChange( int32 mode, size_t normal, size_t active );
+
+   /** Returns the i-th most recent threshold change (0 is the latest).
+      \return 0 if there isn't such a change in the history.
+   */
+   const RampChange* rampChangeAt( uint32 i ) const;
+
+   /** Writes a one-line summary, as written in the periodic logs. */
+   void describe( String& target ) const;
+
+   /** When the statistics were started or reset (Sys::_seconds()). */
+   numeric m_started;
+
+   /** Complete collection loops (sweeps). */
+   uint32 m_sweeps;
+   /** VM mark loops. */
+   uint32 m_marks;
+
+   Histogram m_markTime;
+   Histogram m_sweepTime;
+
+   uint64 m_freedItems;
+   uint64 m_freedMem;
+   uint32 m_lastFreedItems;
+   /** Memory released by the last sweep; net of what the VMs allocated meanwhile. */
+   size_t m_lastFreedMem;
+
+   /** Memory allocated through the GC allocators since the program start. */
+   uint64 m_allocated;
+   /** Bytes allocated per second between the last two sweeps. */
+   numeric m_allocRate;
+   /** Value of m_allocated at the last sweep. */
+   uint64 m_sweepAllocated;
+   /** Time of the last sweep. */
+   numeric m_sweepTimeStamp;
+
+   /** Memory and items live at the moment of the copy. */
+   size_t m_liveMem;
+   int32 m_liveItems;
+
+   /** Time the VMs spent blocked by the collector while it marked them. */
+   numeric m_blockedTime;
+   /** Time the VMs spent waiting for collections they requested (performGC). */
+   numeric m_waitTime;
+
+   size_t m_thresholdNormal;
+   size_t m_thresholdActive;
+   uint32 m_rampChanges;
+   RampChange m_ramp[ ramp_history ];
+};
+
+}
+
+#endif
+
+/* end of gcstats.h */
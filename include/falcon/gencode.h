@@ -355,12 +355,29 @@ class FALCON_DYN_CLASS GenCode: public Generator
    uint32 m_pc;
    StringStream *m_outTemp;
    Module *m_module;
+   bool m_bPeephole;
+   /** Line of the last statement recorded in the line map. */
+   uint32 m_lastLine;
+
+   /** Runs the peephole optimizer on a complete function body.
+      The code is rewritten in place and its size is never changed, so
+      that addresses, line maps and try tables stay valid.
+   */
+   void peepholeCode( byte *code, uint32 size );
 
 public:
    GenCode( Module *mod );
    virtual ~GenCode();
 
    virtual void generate( const SourceTree *st );
+
+   /** Activates the peephole optimizer on the generated code.
+      When active, jumps to jumps are threaded to their final target
+      and conditional jumps on constant operands are turned into
+      unconditional ones.
+   */
+   void peephole( bool mode ) { m_bPeephole = mode; }
+   bool peephole() const { return m_bPeephole; }
 };
 
 }
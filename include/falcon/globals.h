@@ -27,6 +27,7 @@ class StringTable;
 class VFSProvider;
 class String;
 class ModuleCache;
+class CompileCache;
 
 FALCON_DYN_SYM extern void * (*memAlloc) ( size_t );
 FALCON_DYN_SYM extern void (*memFree) ( void * );
@@ -102,6 +103,15 @@ namespace Engine
    /** Public module cache. */
    FALCON_DYN_SYM ModuleCache* getModuleCache();
 
+   /** Sets the persistent cache of compiled modules used by the module loaders.
+      The engine takes ownership of the cache, and destroys the previous one.
+      \param cache The new cache, or 0 to stop caching compiled modules.
+   */
+   FALCON_DYN_SYM void setCompileCache( CompileCache* cache );
+
+   /** Persistent cache of compiled modules (0 if not set). */
+   FALCON_DYN_SYM CompileCache* getCompileCache();
+
    class AutoInit {
    public:
       AutoInit() { Init(); }
@@ -0,0 +1,170 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: heapprofiler.h
+
+   Allocation-site heap profiler.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:15:53 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Allocation-site heap profiler.
+*/
+
+#ifndef FALCON_HEAPPROFILER_H
+#define FALCON_HEAPPROFILER_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+#include <falcon/genericmap.h>
+#include <falcon/string.h>
+#include <falcon/mt.h>
+
+namespace Falcon {
+
+class GarbageableBase;
+class Stream;
+class CoreDict;
+
+/** Allocation-site heap profiler.
+
+   While the profiler is active, the default GC allocators (gcAlloc,
+   memAlloc and their realloc counterparts) sample one allocation every
+   interval() bytes. A sampled block is recorded along with its allocation
+   site: the script function and line running on the allocating thread,
+   followed by the native function being called from there, if any, as in
+   @code
+      main.load:12 (falcon.core.strReplicate)
+   @endcode
+   Each sampled block stands for interval() bytes (or for its size, if
+   larger), so that the live bytes of each site are an estimate of the
+   memory it holds; freeing a sampled block removes it from its site.
+
+   After each sweep, the garbage collector asks the profiler for a
+   census of the surviving objects: the objects are counted by type
+   (CoreString, CoreArray, CoreDict, CoreObject, MemBuf and other
+   garbageable objects), and the sampled blocks holding them (the object
+   and the buffer of strings, arrays and membufs) are added to the bytes
+   of their type.
+
+   The profile can be written as a text snapshot, with the sites in
+   alphabetical order, so that two snapshots can be compared with a
+   plain diff, or read as a dictionary.
+
+   There is one profiler per process, created by install(); it stays
+   alive until the engine is shut down.
+*/
+class FALCON_DYN_CLASS HeapProfiler: public BaseAlloc
+{
+public:
+   enum {
+      /** Default sampling interval, in bytes. */
+      default_interval = 128*1024
+   };
+
+   /** Types of objects accounted by the census. */
+   typedef enum {
+      t_string,
+      t_array,
+      t_dict,
+      t_object,
+      t_membuf,
+      t_other,
+      type_count
+   } t_type;
+
+   /** Returns the process heap profiler, creating it if necessary. */
+   static HeapProfiler* install();
+
+   /** Destroys the profiler.
+      Called by the engine shutdown; reset() the data to release memory before that.
+   */
+   ~HeapProfiler();
+
+   /** Starts or restarts sampling.
+      \param interval Bytes between samples; 0 to keep the current interval.
+   */
+   void start( uint32 interval = 0 );
+
+   /** Stops sampling; the blocks already sampled are still accounted. */
+   void stop();
+
+   bool active() const { return m_bActive; }
+   uint32 interval() const { return m_interval; }
+
+   /** Discards the collected data. */
+   void reset();
+
+   /** Records a block sampled by the allocator.
+      \return false if the block can't be recorded (i.e. if the
+         allocation has been made by the profiler itself).
+   */
+   bool allocated( void* mem, size_t size );
+
+   /** Forgets a sampled block being freed. */
+   void released( void* mem );
+
+   /** Counts the objects in a GC ring after a sweep.
+      \param ringRoot The root of the ring of the surviving objects.
+   */
+   void census( GarbageableBase* ringRoot );
+
+   /** Number of censuses taken since the last reset. */
+   uint32 censuses() const { return m_censuses; }
+
+   /** Writes a snapshot of the profile.
+      \return false on stream error.
+   */
+   bool writeSnapshot( Stream* out ) const;
+
+   /** Creates a dictionary with the profile.
+      The dictionary has two entries: "sites", mapping each allocation
+      site to an array [live bytes, live blocks, allocated bytes], and
+      "types", mapping each type name to an array [objects, bytes].
+   */
+   CoreDict* toDict() const;
+
+   /** Returns the name of a census type. */
+   static const char* typeName( uint32 type );
+
+private:
+   class SiteStat;
+
+   HeapProfiler();
+
+   void siteName( String& name ) const;
+   SiteStat* site( const String& name );
+   void censusBlock( uint32 type, const void* mem );
+   void clear();
+
+   bool m_bActive;
+   uint32 m_interval;
+
+   /** Guards the data below. */
+   mutable Mutex m_mtx;
+
+   /** Sampled block (void*) -> BlockRec* */
+   Map m_blocks;
+   /** Site name -> SiteStat* */
+   Map m_sites;
+
+   uint32 m_censuses;
+   int64 m_typeObjects[ type_count ];
+   int64 m_typeBytes[ type_count ];
+};
+
+/** The process heap profiler, or 0 if it was never installed. */
+extern FALCON_DYN_SYM HeapProfiler* heapProfiler;
+
+}
+
+#endif
+
+/* end of heapprofiler.h */
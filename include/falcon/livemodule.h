@@ -33,6 +33,8 @@
 namespace Falcon
 {
 
+class StringTemplate;
+
 /** Instance of a live module entity.
 
    The VM sees modules as a closed, read-only entity. Mutable data in a module is actually
@@ -70,6 +72,10 @@ class FALCON_DYN_CLASS LiveModule: public Garbageable
    Module *m_module;
    mutable CoreString** m_strings;
    mutable uint32 m_strCount;
+   mutable StringTemplate** m_templates;
+   mutable uint32 m_tplCount;
+   mutable const String** m_atoms;
+   mutable uint32 m_atomCount;
    mutable uint32 m_aacc;
    mutable int32 m_iacc;
    ItemArray m_globals;
@@ -145,6 +151,17 @@ public:
    /** Return the string in the module with the given ID.
    */
    String* getString( uint32 stringId ) const;
+
+   /** Return the expansion template of the string in the module with the given ID.
+      The template is parsed the first time it is requested, and then kept
+      as long as this live module.
+   */
+   const StringTemplate* getStringTemplate( uint32 stringId ) const;
+
+   /** Return the atom of the string in the module with the given ID.
+      \see AtomTable
+   */
+   const String* getAtom( uint32 stringId ) const;
    
    /** True if this module requires a second link step. */
    bool needsCompleteLink() const { return m_needsCompleteLink; }
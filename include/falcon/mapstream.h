@@ -0,0 +1,89 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: mapstream.h
+
+   Stream over a file mapped in memory.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 16:39:22 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Stream over a file mapped in memory.
+*/
+
+#ifndef FALCON_MAPSTREAM_H
+#define FALCON_MAPSTREAM_H
+
+#include <falcon/stream.h>
+
+namespace Falcon {
+
+class FileMap;
+
+/** Stream over a file mapped in memory.
+
+   Reads and writes are served directly from the mapped memory; there is
+   no intermediate buffer, and the read window (see Stream::readWindow) is
+   the whole unread part of the file, so that lines are read without copies.
+
+   The size of the file is fixed at mapping time; writes past the end of
+   the mapping are truncated, and truncate() is not supported.
+*/
+class FALCON_DYN_CLASS MapStream: public Stream
+{
+public:
+   /** Creates a stream over a mapping.
+      The stream holds a reference to the mapping.
+   */
+   MapStream( FileMap *map );
+
+   /** Creates a stream over a part of a mapping.
+      The stream sees only the given range as its whole content.
+      The caller must ensure that the range is inside the mapped data.
+   */
+   MapStream( FileMap *map, uint64 offset, uint64 size );
+   MapStream( const MapStream &other );
+   virtual ~MapStream();
+
+   FileMap *fileMap() const { return m_map; }
+
+   virtual bool close();
+   virtual int32 read( void *buffer, int32 size );
+   virtual int32 write( const void *buffer, int32 size );
+   virtual bool get( uint32 &chr );
+   virtual bool put( uint32 chr );
+   virtual int32 readAvailable( int32 msecs_timeout, const Sys::SystemData *sysData = 0 );
+   virtual int32 writeAvailable( int32 msecs_timeout, const Sys::SystemData *sysData = 0 );
+   virtual int64 tell();
+   virtual bool truncate( int64 pos=-1 );
+   virtual bool flush();
+
+   virtual bool hasReadWindow() const { return true; }
+   virtual const byte *readWindow( int32 &avail );
+   virtual void consumeWindow( int32 count ) { m_pos += count; }
+
+   virtual MapStream *clone() const;
+
+protected:
+   virtual int64 seek( int64 pos, e_whence whence );
+
+private:
+   FileMap *m_map;
+   uint64 m_base;
+   uint64 m_size;
+   uint64 m_pos;
+
+   int32 available() const;
+};
+
+}
+
+#endif
+
+/* end of mapstream.h */
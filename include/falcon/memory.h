@@ -64,6 +64,16 @@ FALCON_DYN_SYM  void gcMemShutdown();
 
 /** Return the total memory allocated by the GC system. */
 FALCON_DYN_SYM  size_t gcMemAllocated();
+
+/** Return the memory allocated by the GC system since the start, including the released one. */
+FALCON_DYN_SYM  uint64 gcMemTotalAllocated();
+
+/** Sets the sampling interval of the heap profiler.
+   The default GC allocators sample an allocation every \b interval bytes
+   and pass it to the heap profiler; 0 turns sampling off.
+   \see HeapProfiler
+*/
+FALCON_DYN_SYM  void gcMemSampling( size_t interval );
    
 FALCON_DYN_SYM void * DflMemAlloc( size_t amount );
 FALCON_DYN_SYM void DflMemFree( void *mem );
@@ -25,12 +25,14 @@
 #include <falcon/basealloc.h>
 #include <falcon/mt.h>
 #include <falcon/rampmode.h>
+#include <falcon/gcstats.h>
 
 namespace Falcon {
 
 class Garbageable;
 class GarbageableBase;
 class GarbageLock;
+class Stream;
 
 /** Storage pit for garbageable data.
    Garbage items can be removed acting directly on them.
@@ -164,12 +166,21 @@ protected:
     */
    uint32 m_lockGen;
 
+   /** Guard for the telemetry. */
+   mutable Mutex m_mtx_stats;
+   GCStats m_stats;
+   Stream* m_statsLog;
+   numeric m_statsInterval;
+   numeric m_nextStatsLog;
+
    //==================================================
    // Private functions
    //==================================================
 
    bool markVM( VMachine *vm );
+   void timedMarkVM( VMachine *vm );
    void gcSweep();
+   void checkStatsLog();
 
    /*
    To reimplement this, we need to have anti-recursion checks on item, which are
@@ -187,7 +198,18 @@ protected:
    void removeFromGarbageDeep( const Item &item );
    */
 
-   void clearRing( GarbageableBase *ringRoot );
+   enum {
+      /** VMs whose live items can be counted during a sweep. */
+      max_counted_vms = 16
+   };
+
+   /** Kills the items not marked since the minimal generation.
+      \param gens If given, the generations of the VMs whose surviving items must be counted.
+      \param counts Counters of the surviving items, one per generation.
+      \param genCount Number of generations in gens.
+      \return Number of killed items.
+   */
+   int32 clearRing( GarbageableBase *ringRoot, const uint32* gens = 0, int32* counts = 0, uint32 genCount = 0 );
    void rollover();
    void remark(uint32 mark);
    void electOlderVM(); // to be called with m_mtx_vms locked
@@ -327,6 +349,32 @@ public:
    void accountItems( int itemCount );
 
    void performGC();
+
+   /** Copies the collector statistics.
+      Live memory and items are read at the moment of the copy.
+   */
+   void stats( GCStats& target ) const;
+
+   /** Clears the collector statistics. */
+   void resetStats();
+
+   /** Accounts for time spent by a VM waiting for the collector.
+      \param seconds Duration of the wait.
+      \param bRequested true if the VM requested the collection (performGC),
+         false if it was blocked by the collector to be marked.
+   */
+   void accountBlocked( numeric seconds, bool bRequested );
+
+   /** Periodically writes the collector statistics on a stream.
+
+      The collector thread writes a line as produced by GCStats::describe()
+      every given interval. The stream must stay valid until the log is
+      turned off by calling this method with a 0 stream.
+
+      \param out The stream, or 0 to stop writing.
+      \param interval Seconds between two lines.
+   */
+   void statsLog( Stream* out, numeric interval = 1.0 );
 };
 
 
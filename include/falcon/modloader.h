@@ -29,6 +29,7 @@ class Stream;
 class URI;
 class FileStat;
 class VFSProvider;
+class CompileCache;
 
 /** Module Loader support.
 
@@ -91,6 +92,12 @@ protected:
 
    Module *loadModule_select_ver( Stream *in );
 
+   /** Loads a module from the compile cache; returns 0 on miss. */
+   Module *loadCached( CompileCache* cc, const String &key );
+
+   /** Opens and initializes a binary module; called with binary loads serialized. */
+   Module *initBinaryModule( const String &path );
+
    /** Discovers the module name given a complete file path.
       \param path the path to a possible falcon module
       \param modNmae the possible falcon module name
@@ -549,6 +556,14 @@ public:
    void compileTemplate( bool bCompTemplate ) { m_forceTemplate = bCompTemplate; }
    bool compileTemplate() const { return m_forceTemplate; }
 
+   /** Sets the optimization level used when compiling source modules.
+      Level 1 activates the syntactic tree optimizer, while level 2 or more
+      also applies the peephole optimizer to the generated code.
+      \see Compiler::optLevel
+   */
+   void optLevel( int level ) { m_compiler.optLevel( level ); }
+   int optLevel() const { return m_compiler.optLevel(); }
+
    /** Tells if this modloader should save .fam on remote filesystems.
       By default, if a source file is loaded from a remote filesystem,
       the module loader doesn't try to save a .fam serialized version
@@ -81,6 +81,16 @@ protected:
    /** The line map is a pointer as it can be absent or given after the generation step. */
    LineMap *m_lineInfo;
 
+   /** Line informations as read from a module stream: (pc, line) pairs sorted by pc.
+      They are searched as they are, and turned into a LineMap only if the map
+      needs to be changed or saved.
+   */
+   uint32 *m_lineData;
+   uint32 m_lineCount;
+
+   /** Turns the loaded line data into the line map. */
+   void decodeLineInfo();
+
    /** Dynamic link loader attached with this module.
       If this module is created using a DLL, then it is necessary to close
       the DLL handle as soon as the module is disposed (or, at least,
@@ -0,0 +1,89 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: optimizer.h
+
+   Syntactic tree optimizer.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 15:32:40 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Syntactic tree optimizer.
+*/
+
+#ifndef FALCON_OPTIMIZER_H
+#define FALCON_OPTIMIZER_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+
+namespace Falcon
+{
+
+class SourceTree;
+class StatementList;
+class Statement;
+class Value;
+class ArrayDecl;
+
+/** Syntactic tree optimizer.
+
+   The optimizer walks a SourceTree produced by the compiler and simplifies
+   it before it is handed to the code generator. It performs:
+
+   - constant folding of unary, binary and ternary expressions whose operands
+     are all immediate values; the result is computed through the same Item
+     operations used by the VM, so folded code behaves exactly as the original.
+     Expressions that would raise an error at runtime (i.e. 1/0) are left
+     untouched, so that the error is still raised where the script expects it.
+   - dead branch elimination of if/elif/else and while statements having a
+     constant condition.
+
+   The optimizer is activated by the Compiler when its optimization level
+   (see Compiler::optLevel) is greater than zero.
+*/
+class FALCON_DYN_CLASS Optimizer: public BaseAlloc
+{
+   uint32 m_folded;
+   uint32 m_pruned;
+
+   void optimizeBlock( StatementList &block );
+   /** Returns true if the statement must be removed from its block.
+      Statements that should be replaced by a list of other statements
+      are spliced into the target list before returning true.
+   */
+   bool optimizeStatement( Statement *stmt, StatementList &target );
+   void optimizeIf( Statement *stmt, StatementList &target, bool &remove );
+   void optimizeArray( ArrayDecl *arr );
+   void foldValue( Value *val );
+
+   /** Moves all the statements from source to the back of target. */
+   static void splice( StatementList &source, StatementList &target );
+   static bool isConstant( const Value *val );
+   static bool isTrue( const Value *val );
+
+public:
+   Optimizer();
+
+   /** Optimizes the given source tree in place. */
+   void optimize( SourceTree *st );
+
+   /** Count of expressions that have been folded into constants. */
+   uint32 folded() const { return m_folded; }
+
+   /** Count of statements removed or flattened because of constant conditions. */
+   uint32 pruned() const { return m_pruned; }
+};
+
+}
+
+#endif
+
+/* end of optimizer.h */
@@ -0,0 +1,92 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: preparedcall.h
+
+   Callable items resolved once and called repeatedly.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 17:42:04 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Callable items resolved once and called repeatedly.
+*/
+
+#ifndef FALCON_PREPAREDCALL_H
+#define FALCON_PREPAREDCALL_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/item.h>
+#include <falcon/falcondata.h>
+
+namespace Falcon {
+
+class CoreFunc;
+class FuncDef;
+
+/** A callable item ready to be called repeatedly by extension code.
+
+   Functions calling back script code once per element of a sequence
+   (map, filter, sorts with comparers and so on) may resolve the callable
+   once, when the call is prepared, instead of at each call. Script
+   functions and methods of script functions are resolved to the
+   function to be called and its self item;
+   VMachine::callFrame( const PreparedCall& ) and
+   VMachine::callItemAtomic( const PreparedCall& ) then build the frame
+   directly. Other callable items go through the normal call path.
+
+   The parameters are pushed by the caller, as for the other call
+   functions. Named parameters are not supported on the fast path.
+
+   Return frame handlers can keep a prepared call in a local variable,
+   as a GC pointer:
+   @code
+      vm->addLocals( 1 );
+      vm->local(0)->setGCPointer( new PreparedCall( *vm->param(0), 1 ) );
+      ...
+      vm->pushParameter( item );
+      vm->callFrame( *static_cast<PreparedCall*>( vm->local(0)->asGCPointer() ) );
+   @endcode
+*/
+class FALCON_DYN_CLASS PreparedCall: public FalconData
+{
+public:
+   /** Prepares a call.
+      \param callable A callable item.
+      \param paramCount Number of parameters pushed at each call.
+   */
+   PreparedCall( const Item &callable, uint32 paramCount );
+   PreparedCall( const PreparedCall &other );
+   virtual ~PreparedCall() {}
+
+   const Item &callable() const { return m_callable; }
+   uint32 paramCount() const { return m_paramCount; }
+
+   /** The script function called directly, or 0 if the item goes through the normal call path. */
+   CoreFunc *function() const { return m_func; }
+
+   virtual void gcMark( uint32 mark );
+   virtual FalconData *clone() const;
+
+private:
+   Item m_callable;
+   Item m_self;
+   CoreFunc *m_func;
+   FuncDef *m_def;
+   uint32 m_paramCount;
+   bool m_bSelf;
+
+   friend class VMachine;
+};
+
+}
+
+#endif
+
+/* end of preparedcall.h */
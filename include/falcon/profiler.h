@@ -0,0 +1,129 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: profiler.h
+
+   Sampling profiler for scripts.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 17:49:29 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Sampling profiler for scripts.
+*/
+
+#ifndef FALCON_PROFILER_H
+#define FALCON_PROFILER_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+#include <falcon/genericmap.h>
+#include <falcon/string.h>
+
+namespace Falcon {
+
+class VMContext;
+class Symbol;
+class Stream;
+
+/** Sampling profiler.
+
+   When a profiler is given to a virtual machine through
+   VMachine::profiler( Profiler* ), the VM calls check() from its
+   periodic checks, that is, every few thousands of operations. When
+   the sampling interval has elapsed, the stack of the running context
+   is recorded, each frame being identified by its module, function and
+   current line.
+
+   A sample taken late counts as many samples as the intervals that
+   have elapsed, so that long operations between two checks are not
+   under-represented.
+
+   The collected data can be written as collapsed stacks, one line per
+   distinct stack with the root function first, as read by flame graph
+   tools:
+   @code
+      main.__main__:20;main.fib:3;main.fib:3 112
+   @endcode
+   or as a table of the samples falling in each function (self) and of
+   the samples where the function is anywhere in the stack (total).
+*/
+class FALCON_DYN_CLASS Profiler: public BaseAlloc
+{
+public:
+   enum {
+      /** Frames recorded per sample; deeper stacks are truncated at the root side. */
+      max_depth = 128
+   };
+
+   /** Creates a profiler.
+      \param rate Samples per second.
+   */
+   Profiler( uint32 rate = 100 );
+   ~Profiler();
+
+   uint32 rate() const { return m_rate; }
+
+   /** Starts or restarts sampling.
+      \param rate Samples per second; 0 to keep the current rate.
+   */
+   void start( uint32 rate = 0 );
+
+   /** Stops sampling; the collected data is kept. */
+   void stop() { m_bActive = false; }
+
+   bool active() const { return m_bActive; }
+
+   /** Discards the collected data. */
+   void reset();
+
+   /** Samples the context if the sampling interval has elapsed. */
+   void check( VMContext* ctx );
+
+   /** Records the stack of a context.
+      \param ctx The context to be sampled.
+      \param weight Number of samples the stack counts for.
+   */
+   void sample( VMContext* ctx, uint32 weight = 1 );
+
+   /** Number of samples taken since the last reset. */
+   uint32 samples() const { return m_samples; }
+
+   /** Writes the collected stacks in collapsed format. */
+   bool writeCollapsed( Stream* out ) const;
+
+   /** Writes the per-function self and total samples, most expensive first. */
+   bool writeTable( Stream* out ) const;
+
+private:
+   class FuncStat;
+
+   void frameName( const Symbol* sym, String& name ) const;
+
+   uint32 m_rate;
+   numeric m_interval;
+   numeric m_nextSample;
+   bool m_bActive;
+
+   uint32 m_samples;
+
+   /** Collapsed stack -> count. */
+   Map m_stacks;
+   /** Function name -> FuncStat*. */
+   Map m_funcs;
+
+   const Symbol* m_syms[max_depth];
+   uint32 m_lines[max_depth];
+};
+
+}
+
+#endif
+
+/* end of profiler.h */
@@ -112,6 +112,24 @@ class FALCON_DYN_CLASS Runtime: public BaseAlloc
    VMachine *m_provider;
    Map m_modPending;
    bool m_hasMainModule;
+   uint32 m_loadThreads;
+
+   /** Dependencies loaded ahead of linking: request key (String) -> Module* */
+   Map m_prefetched;
+
+   void addModule_rec( Module *mod, bool isPrivate );
+   Module *loadDependency( Module *mod, const ModuleDepData *depdata );
+
+   /** Loads the whole dependency graph of a module, in parallel.
+      The graph is explored level by level: the modules required by the
+      modules found at the previous level, and not already known, are
+      loaded concurrently by loadThreads() threads, each using its own
+      clone of the module loader. The modules are then linked in order
+      as if they were loaded serially; a dependency that fails to load
+      here is loaded again while linking, where the error is reported.
+   */
+   void prefetch( Module *mod );
+   void releasePrefetched();
 
 public:
 
@@ -272,6 +290,14 @@ public:
                VM at link time, false otherwise.
    */
    void hasMainModule( bool b ) { m_hasMainModule = b; }
+
+   /** Sets the number of threads loading the dependencies of the added modules.
+      Independent modules that must be compiled from source are compiled in
+      parallel by this many threads (the calling one included); 0 uses one
+      thread per processor. The default, 1, loads the modules serially.
+   */
+   void loadThreads( uint32 count ) { m_loadThreads = count; }
+   uint32 loadThreads() const { return m_loadThreads; }
 };
 
 
@@ -26,18 +26,148 @@
 #include <falcon/basealloc.h>
 #include <falcon/itemarray.h>
 
+#include <string.h>
+
 namespace Falcon {
 
 class Module;
 
-class StackFrame: public BaseAlloc
+/** Segment of the item stack of a context.
+
+   The frames of a context keep their items in a chain of segments owned
+   by the context; each frame uses a window on a segment, placed right
+   after the items of the frame below it. The item storage follows the
+   segment header in the same allocation.
+*/
+class FALCON_DYN_CLASS StackSegment
 {
 public:
-   enum
+   /** Creates a segment of the given size, following prev in the chain. */
+   static StackSegment* create( uint32 size, StackSegment* prev = 0 );
+
+   /** Destroys this segment and all the ones following it. */
+   static void destroyChain( StackSegment* first );
+
+   Item* items() const { return (Item*) (const_cast<StackSegment*>(this) + 1); }
+   Item* end() const { return items() + m_size; }
+   uint32 size() const { return m_size; }
+
+   StackSegment* prev() const { return m_prev; }
+
+   /** Returns the next segment, able to store at least the given items.
+      The segments following this one are not in use when a frame moves
+      forward, so they are replaced when they are too small.
+   */
+   StackSegment* next( uint32 size );
+
+private:
+   StackSegment* m_prev;
+   StackSegment* m_next;
+   uint32 m_size;
+   // keeps the items aligned on 64 bit platforms
+   uint32 m_padding;
+};
+
+
+/** Items of a stack frame.
+
+   The window is a part of a stack segment of the context, or a buffer
+   of its own for frames living outside a context (continuations).
+   While the frame is the topmost in its segment, the window can grow
+   up to the end of the segment; frames below the top are frozen at their
+   size, and if the top frame needs more space, its items are moved to
+   the next segment. This keeps the items of the frames below, and so
+   the parameters of the frames above them, in place.
+
+   The interface is the subset of ItemArray used on the VM stack.
+*/
+class FALCON_DYN_CLASS StackWindow
+{
+public:
+   StackWindow():
+      m_data(0),
+      m_size(0),
+      m_alloc(0),
+      m_segment(0)
+   {}
+
+   /** Copies the items of another window in a buffer of this window. */
+   StackWindow( const StackWindow& other );
+   ~StackWindow();
+
+   uint32 length() const { return m_size; }
+   bool empty() const { return m_size == 0; }
+   Item* elements() const { return m_data; }
+
+   Item &operator[]( int32 pos ) { return m_data[pos]; }
+   const Item &operator[]( int32 pos ) const { return m_data[pos]; }
+
+   Item &back() { return m_data[m_size-1]; }
+   const Item &back() const { return m_data[m_size-1]; }
+
+   void append( const Item &item )
+   {
+      if ( m_size == m_alloc )
+      {
+         // the item may be in this window.
+         Item copy = item;
+         grow( m_size + 1 );
+         m_data[m_size++] = copy;
+      }
+      else
+         m_data[m_size++] = item;
+   }
+
+   /** Resizes the window; new items are nil. */
+   void resize( uint32 size )
    {
-      pa_default = 8
-   } constants;
+      if ( size > m_size )
+      {
+         if ( size > m_alloc )
+            grow( size );
+         memset( (void*) (m_data + m_size), 0, (size - m_size) * sizeof(Item) );
+      }
+      m_size = size;
+   }
+
+   void reserve( uint32 size )
+   {
+      if ( size > m_alloc )
+         grow( size );
+   }
+
+   /** The segment of this window, or 0 if the window has its own buffer. */
+   StackSegment* segment() const { return m_segment; }
+
+   /** Places an empty window at a given position of a segment. */
+   void place( StackSegment* seg, Item* base );
+
+   /** Prevents the window from growing in the space after its items. */
+   void freeze() { m_alloc = m_size; }
 
+   /** Lets the window grow up to the end of its segment. */
+   void thaw()
+   {
+      if ( m_segment != 0 )
+         m_alloc = (uint32) (m_segment->end() - m_data);
+   }
+
+   /** Moves the items out of the segment, in a buffer of this window. */
+   void detach();
+
+private:
+   Item* m_data;
+   uint32 m_size;
+   uint32 m_alloc;
+   StackSegment* m_segment;
+
+   void grow( uint32 size );
+};
+
+
+class StackFrame: public BaseAlloc
+{
+public:
    bool m_break;
 
    uint32 m_ret_pc;
@@ -57,12 +187,15 @@ public:
    // points to the parameter part in the previous area.
    Item* m_params;
 
-   StackFrame( int preAlloc = pa_default ):
+   /** Entry time recorded by VMCounters; 0 if the frame is not accounted. */
+   numeric m_enterTime;
+
+   StackFrame():
       m_symbol(0),
       m_module(0),
       m_prevTryFrame(0),
-      m_prev(0),
-      m_stack( preAlloc )
+      m_enterTime(0.0),
+      m_prev(0)
    {}
 
    StackFrame( const StackFrame& other );
@@ -72,8 +205,8 @@ public:
    void prev( StackFrame* p ) { m_prev = p; }
 
    /** Returns the items in the stack. */
-   const ItemArray& stack() const { return m_stack; }
-   ItemArray& stack() { return m_stack; }
+   const StackWindow& stack() const { return m_stack; }
+   StackWindow& stack() { return m_stack; }
 
    /** Remvoves N elements from thes stack */
    void pop( uint32 size )  { m_stack.resize( m_stack.length() - size ); }
@@ -113,7 +246,7 @@ public:
 
 private:
    StackFrame* m_prev;
-   ItemArray m_stack;
+   StackWindow m_stack;
 } ;
 
 
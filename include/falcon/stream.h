@@ -72,6 +72,12 @@ protected:
    /** Returns true if the buffer is empty. */
    bool bufferEmpty() const { return m_rhBufferPos == 0; }
 
+   /** Removes the '\r' of a CRLF sequence at the end of a line read by readLine().
+      \param target the line being read.
+      \param count count of characters appended to the target by readLine().
+   */
+   static void removeLineCR( String &target, uint32 count );
+
    /** Protected constructor.
       Transcoder constructor of this class and of all subclassess
       is guaranteed not to use the stream in any way
@@ -219,6 +225,62 @@ public:
    */
    virtual bool readString( String &target, uint32 size );
 
+   /** Reads a line of text from the stream.
+      Characters are appended to the target up to the next '\n', which is
+      consumed but not stored, or until maxChars characters have been read.
+      A '\r' found right before the '\n' is removed as well.
+
+      This version scans the read window in search of the line terminator and
+      appends whole runs of characters at once, or iteratively calls get( uint32 )
+      on streams without a read window. Byte oriented transcoders scan the
+      window of their underlying stream.
+
+      \param target the string where the line is appended.
+      \param maxChars maximum count of characters to be read.
+      \return true if the line terminator or maxChars were reached, false if the stream
+         ended or failed before. In the latter case, the target may have received
+         the last, unterminated line of the stream.
+   */
+   virtual bool readLine( String &target, uint32 maxChars = csh::npos );
+
+   /** Reads a block of characters.
+      Reads the characters that are immediately available, up to count; the call
+      blocks only if there isn't any. Characters pushed back with unget() are
+      returned first.
+
+      This version converts the bytes in the read window, if the stream has one,
+      or reads a single character through get( uint32 ) otherwise. Transcoders
+      decode the read window of their underlying stream.
+
+      \param target where to store the characters.
+      \param count maximum count of characters to be read.
+      \return count of characters read; 0 on stream end, error or, for
+         transcoders, on an invalid input sequence.
+   */
+   virtual int32 readChars( uint32 *target, int32 count );
+
+   /** True if the stream gives direct access to the data it holds in memory.
+      \see readWindow
+   */
+   virtual bool hasReadWindow() const { return false; }
+
+   /** Gives direct access to the unread data the stream holds in memory.
+      Buffered streams return their buffer, refilling it if it has been completely
+      read; streams over memory return their data. The characters pushed back
+      with unget() are not considered.
+
+      This version returns 0.
+
+      \param avail on exit, the count of bytes that can be read from the returned pointer.
+      \return the first unread byte, or 0 on stream end or error.
+   */
+   virtual const byte *readWindow( int32 &avail );
+
+   /** Declares the given count of bytes of the read window as read.
+      \see readWindow
+   */
+   virtual void consumeWindow( int32 count );
+
    /** Writes a character on the stream.
       \param chr the character to write.
       \return true success, false on stream error.
@@ -77,6 +77,9 @@ public:
    virtual bool put( uint32 chr );
    virtual int32 read( void *buffer, int32 size );
    virtual int32 write( const void *buffer, int32 size );
+   virtual bool hasReadWindow() const { return true; }
+   virtual const byte *readWindow( int32 &avail );
+   virtual void consumeWindow( int32 count ) { m_bufPos += count; }
 
    virtual bool errorDescription( ::Falcon::String &description ) const {
       return m_stream->errorDescription( description );
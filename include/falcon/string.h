@@ -1301,6 +1301,9 @@ public:
 
    virtual ~StringGarbage();
    virtual bool finalize();
+
+   /** The string owning this garbage hook. */
+   CoreString* str() const { return m_str; }
 };
 
 /** Garbage storage string.
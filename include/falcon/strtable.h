@@ -25,6 +25,7 @@
 #include <falcon/genericvector.h>
 #include <falcon/genericmap.h>
 #include <falcon/basealloc.h>
+#include <falcon/mt.h>
 
 namespace Falcon {
 
@@ -34,11 +35,20 @@ class ModuleLoader;
 class FALCON_DYN_CLASS StringTable: public BaseAlloc
 {
    GenericVector m_vector;
-   Map m_map;
-   Map m_intMap;
+   mutable Map m_map;
+   mutable Map m_intMap;
    char *m_tableStorage;
    uint32 m_internatCount;
 
+   /** Count of strings in m_vector already entered in the lookup maps.
+      Loaded tables don't need to be searched unless strings are added
+      later on, so their maps are built on the first search.
+   */
+   mutable uint32 m_indexed;
+   /** Serializes the searches, that may build the maps of a shared table. */
+   mutable Mutex m_mtx;
+   void buildIndex() const;
+
    friend class ModuleLoader;
 
    // Non-const version of get is private
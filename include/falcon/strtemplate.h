@@ -0,0 +1,118 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: strtemplate.h
+
+   Pre-parsed string expansion templates.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 15:52:23 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Pre-parsed string expansion templates.
+*/
+
+#ifndef FALCON_STRTEMPLATE_H
+#define FALCON_STRTEMPLATE_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/string.h>
+#include <falcon/genericvector.h>
+#include <falcon/basealloc.h>
+
+namespace Falcon {
+
+class Format;
+class Symbol;
+
+/** Pre-parsed string expansion template.
+
+   A string expansion template (the operand of the "@" operator) is split
+   once into a sequence of segments:
+   - literal text (with "$$" already turned into "$");
+   - values, that is, "$name" or "$(name)" with an optional ":format" or
+     "|toString format" part; formats are parsed here once and for all.
+   - a failure marker, when the template is malformed past a certain point.
+
+   The VM expands the segments through VMachine::expandString(); values that are
+   plain symbol names remember the symbol they resolve to in the last function
+   where they were expanded, so that the symbol tables are not searched again.
+
+   The live modules keep a template for each module string that has been
+   expanded (see LiveModule::getStringTemplate).
+*/
+class FALCON_DYN_CLASS StringTemplate: public BaseAlloc
+{
+public:
+   typedef enum {
+      /** Literal text. */
+      t_text,
+      /** A value to be converted with its default toString. */
+      t_value,
+      /** A value with a ":format" specifier. */
+      t_format,
+      /** A value with a "|toString format" specifier. */
+      t_pipe,
+      /** Malformed template; expansion fails here. */
+      t_fail
+   } t_segmentType;
+
+   class FALCON_DYN_CLASS Segment: public BaseAlloc
+   {
+   public:
+      t_segmentType m_type;
+
+      /** Literal text, or the name (and accessors) of the value to be expanded. */
+      String m_text;
+      /** Parameter for the toString method in t_pipe segments. */
+      String m_spec;
+      /** Parsed format for t_format segments; may be invalid. */
+      Format *m_format;
+
+      /** True if m_text is a plain symbol name, without accessors. */
+      bool m_bSymbol;
+      /** Function where m_symbol has been resolved. */
+      mutable const Symbol *m_owner;
+      /** Symbol m_text resolved to in m_owner. */
+      mutable const Symbol *m_symbol;
+
+      Segment( t_segmentType type ):
+         m_type( type ),
+         m_format( 0 ),
+         m_bSymbol( false ),
+         m_owner( 0 ),
+         m_symbol( 0 )
+      {}
+
+      ~Segment();
+   };
+
+   /** Parses a string expansion template. */
+   StringTemplate( const String &src );
+   ~StringTemplate();
+
+   uint32 size() const { return m_segments.size(); }
+   const Segment &segment( uint32 pos ) const { return **(Segment **) m_segments.at( pos ); }
+
+   /** Total size of the literal text, used to presize the expanded strings. */
+   uint32 textSize() const { return m_textSize; }
+
+private:
+   GenericVector m_segments;
+   uint32 m_textSize;
+
+   void addText( String &text );
+   void addSegment( Segment *seg );
+};
+
+}
+
+#endif
+
+/* end of strtemplate.h */
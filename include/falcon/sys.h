@@ -99,6 +99,9 @@ FALCON_DYN_SYM void _enumerateEnvironment( EnvStringCallback cb, void* cbData );
 /** Returns process ID of the current process. */
 FALCON_DYN_SYM int64 _getpid();
 
+/** Returns the number of processors available to the process (at least 1). */
+FALCON_DYN_SYM uint32 _cpuCount();
+
 
 FALCON_DYN_SYM void _dummy_ctrl_c_handler();
 
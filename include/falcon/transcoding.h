@@ -236,6 +236,8 @@ public:
 
    virtual bool get( uint32 &chr );
    virtual bool put( uint32 chr );
+   virtual bool readLine( String &target, uint32 maxChars = csh::npos );
+   virtual int32 readChars( uint32 *target, int32 count );
    virtual const String encoding() const { return "byte"; }
    virtual TranscoderByte *clone() const;
 };
@@ -252,6 +254,8 @@ public:
 
    virtual bool get( uint32 &chr );
    virtual bool put( uint32 chr );
+   virtual bool readLine( String &target, uint32 maxChars = csh::npos );
+   virtual int32 readChars( uint32 *target, int32 count );
    virtual const String encoding() const { return "utf-8"; }
    virtual TranscoderUTF8 *clone() const;
 };
@@ -0,0 +1,164 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: vfs_archive.h
+
+   VFS provider serving the files stored in a packed archive.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:29:04 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   VFS provider serving the files stored in a packed archive.
+*/
+
+#ifndef FALCON_VFS_ARCHIVE_H
+#define FALCON_VFS_ARCHIVE_H
+
+#include <falcon/vfsprovider.h>
+#include <falcon/genericmap.h>
+
+namespace Falcon {
+
+class FileMap;
+class TimeStamp;
+
+/** VFS provider serving the files stored in a packed archive.
+
+   An archive is a single file holding a set of files, followed by an
+   index of their names (see ArchiveWriter). The provider maps the whole
+   archive in memory and reads the index once; after that, looking up,
+   stat-ing and opening the stored files never touches the host file
+   system, and the streams returned by open() read directly from the
+   mapped memory.
+
+   The names stored in the archive are relative paths; the provider
+   serves them as absolute paths under its protocol, so that the entry
+   "_system/json.fam" of an archive served as "pack" is reached as
+   "pack:///_system/json.fam". Directories are not stored; they are
+   inferred from the names of the files.
+
+   Archives are read only, and all the files in an archive have the
+   modification time of the archive itself.
+
+   The archive may also record the name of its main module, that the
+   program runner uses to start the packed application.
+*/
+class FALCON_DYN_CLASS VFSArchive: public VFSProvider
+{
+public:
+   /** Loads an archive.
+      The provider is not registered; the caller should pass it to
+      Engine::addVFS(), that takes its ownership.
+      \param path The archive file, in the host system format.
+      \param protocol The protocol that the provider will serve.
+      \param fsError On failure, the system error code, or 0 if the file
+             is not a valid archive.
+      \return A new provider, or 0 on error.
+   */
+   static VFSArchive* load( const String& path, const String& protocol, int64& fsError );
+
+   virtual ~VFSArchive();
+
+   /** Name of the main module recorded in the archive (may be empty). */
+   const String& mainModule() const { return m_mainModule; }
+
+   /** Number of files in the archive. */
+   uint32 fileCount() const { return m_fileCount; }
+
+   virtual Stream* open( const URI &uri, const OParams &p );
+   virtual Stream* create( const URI &uri, const CParams &p, bool &bSuccess );
+   virtual DirEntry* openDir( const URI &uri );
+   virtual bool readStats( const URI &uri, FileStat &s );
+   virtual bool writeStats( const URI &uri, const FileStat &s );
+
+   virtual bool chown( const URI &uri, int uid, int gid );
+   virtual bool chmod( const URI &uri, int mode );
+
+   virtual bool link( const URI &uri1, const URI &uri2, bool bSymbolic );
+   virtual bool unlink( const URI &uri );
+
+   virtual bool mkdir( const URI &uri, uint32 mode );
+   virtual bool rmdir( const URI &uri );
+   virtual bool move( const URI &suri, const URI &duri );
+
+   virtual int64 getLastFsError();
+   virtual Error *getLastError();
+
+private:
+   class Entry;
+   class ArchiveDir;
+
+   VFSArchive( const String& protocol, FileMap* map );
+
+   bool readIndex();
+   void addEntry( const String& name, bool bDir, uint64 offset, uint64 size );
+
+   /** Finds the entry of a path, setting the last error if there isn't any. */
+   const Entry* entry( const URI& uri );
+   bool fail( int64 error );
+
+   FileMap* m_map;
+   TimeStamp* m_mtime;
+   String m_mainModule;
+   uint32 m_fileCount;
+
+   /** Entry name (String) -> Entry*, files and directories. */
+   Map m_entries;
+};
+
+
+/** Writes a packed archive.
+
+   The files are added one at a time, under their relative name in the
+   archive; close() writes the index and completes the archive.
+
+   The archive starts with a 16 bytes header: the signature "FPK1", the
+   number of files (32 bits) and the offset of the index (64 bits).
+   The data of the files follows, and then the index: the name of the
+   main module, and for each file its name, its offset and its size.
+   Names are written as a 32 bits length followed by the UTF-8 text, and
+   all the numbers are little endian.
+*/
+class FALCON_DYN_CLASS ArchiveWriter: public BaseAlloc
+{
+public:
+   /** Prepares to write an archive.
+      The stream must be seekable; it is not owned by the writer.
+   */
+   ArchiveWriter( Stream* out );
+   ~ArchiveWriter();
+
+   /** Stores a file read from the given stream.
+      \param name The name of the file in the archive; a relative path
+             using "/" as separator.
+      \return false on read or write error, or if the name is already stored.
+   */
+   bool add( const String& name, Stream* in );
+
+   /** Writes the index and the header.
+      \param mainModule The name of the main module of the archive.
+      \return false on write error.
+   */
+   bool close( const String& mainModule = "" );
+
+private:
+   bool writeName( const String& name );
+
+   Stream* m_out;
+   uint64 m_pos;
+
+   /** File name (String) -> position of the data in the archive. */
+   Map m_files;
+};
+
+}
+
+#endif
+
+/* end of vfs_archive.h */
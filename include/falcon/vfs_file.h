@@ -60,6 +60,7 @@ public:
    virtual ~VFSFile();
 
    virtual Stream* open( const URI &uri, const OParams &p );
+   virtual FileMap* map( const URI &uri, const OParams &p );
    virtual Stream* create( const URI &uri, const CParams &p, bool &bSuccess );
    virtual DirEntry* openDir( const URI &uri );
    virtual bool readStats( const URI &uri, FileStat &s );
@@ -30,6 +30,7 @@
 namespace Falcon {
 
 class Error;
+class FileMap;
 
 /** Base class for Falcon Virtual File System Providers.
    VFS providers are singletons containing virtual
@@ -99,6 +100,14 @@ public:
       OParams& truncate() { m_oflags |= 0x8; return *this; }
       bool isTruncate() const { return (m_oflags & 0x8) == 0x8; }
 
+      /** Maps the file in memory instead of reading it through system calls.
+         The returned stream is a MapStream, and it can't change the size of the
+         file. Providers not supporting mappings ignore this flag.
+         \see VFSProvider::map
+      */
+      OParams& mapped() { m_oflags |= 0x10; return *this; }
+      bool isMapped() const { return (m_oflags & 0x10) == 0x10; }
+
       OParams& shNoRead() { m_shflags |= 0x1; return *this; }
       bool isShNoRead() const { return (m_shflags & 0x1) == 0x1; }
 
@@ -187,6 +196,17 @@ public:
       return create( uri, p, dummy );
    }
 
+   /** Maps a whole file in memory.
+      The file is mapped for writing if the parameters allow writing; otherwise,
+      changes to the mapped memory are not written to the file.
+
+      This version returns 0; providers able to map their files
+      must override it.
+
+      \return a mapping with a reference for the caller, or 0 on error.
+   */
+   virtual FileMap* map( const URI &uri, const OParams &p );
+
    virtual bool link( const URI &uri1, const URI &uri2, bool bSymbolic )=0;
    virtual bool unlink( const URI &uri )=0;
 
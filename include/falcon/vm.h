@@ -40,6 +40,7 @@
 #include <falcon/livemodule.h>
 #include <falcon/vmcontext.h>
 #include <falcon/mersennetwister.h>
+#include <falcon/preparedcall.h>
 
 #define FALCON_VM_DFAULT_CHECK_LOOPS 5000
 
@@ -52,6 +53,9 @@ class AttribHandler;
 class MemPool;
 class VMMessage;
 class GarbageLock;
+class StringTemplate;
+class Profiler;
+class VMCounters;
 
 
 typedef void (*tOpcodeHandler)( register VMachine *);
@@ -192,17 +196,27 @@ class VMachine;
 class FALCON_DYN_CLASS VMBaton: public Baton
 {
    VMachine *m_owner;
+   numeric m_blockStart;
+   numeric m_blockedTime;
 
 public:
    VMBaton( VMachine* owner ):
       Baton( true ),
-      m_owner( owner )
+      m_owner( owner ),
+      m_blockStart( 0.0 ),
+      m_blockedTime( 0.0 )
    {}
    virtual ~VMBaton() {}
 
    virtual void release();
    virtual void onBlockedAcquire();
    void releaseNotIdle();
+
+   /** Accounts the time spent blocked by the GC, if the last acquire was blocked. */
+   void endBlock();
+
+   /** Time the owner spent blocked by the GC, in seconds. */
+   numeric blockedTime() const { return m_blockedTime; }
 };
 
 /** The Falcon virtual machine.
@@ -277,6 +291,28 @@ protected:
    /** Space for immediate operands. */
    Item m_imm[4];
 
+   /** Module string IDs of the string immediate operands. */
+   uint32 m_immStrId[4];
+
+   /** Name of a property given as a string operand of the current opcode.
+      Strings coming from the module string table are turned into their atoms,
+      that the property tables can match by identity (see AtomTable).
+   */
+   const String &operandName( uint32 bc_pos, const Item *operand ) const;
+
+   /** Variable (or the A register) holding a string that only the VM references.
+      Strings created by + and += are referenced only by their target until
+      the target is read by an opcode. While this holds, further + and +=
+      operations on the same target can append to the string in place.
+   */
+   mutable Item *m_accSlot;
+   /** The string owned by m_accSlot. */
+   CoreString *m_accString;
+   /** A register holding a string created by +, referenced only by A. */
+   mutable Item *m_tmpSlot;
+   /** The string owned by m_tmpSlot. */
+   CoreString *m_tmpString;
+
    Stream *m_stdIn;
    Stream *m_stdOut;
    Stream *m_stdErr;
@@ -298,6 +334,12 @@ protected:
    /** True for single stepping */
    bool m_bSingleStep;
 
+   /** Sampling profiler, if any (owned). */
+   Profiler* m_profiler;
+
+   /** Execution counters, if any (owned). */
+   VMCounters* m_counters;
+
    uint32 m_opNextGC;
    uint32 m_opNextContext;
    uint32 m_opNextCallback;
@@ -327,6 +369,8 @@ protected:
    ContextList m_sleepingContexts;
    /** Wether or not to allow a VM hostile takeover of the current context. */
    bool m_allowYield;
+   /** Count of contexts waiting on system descriptors. */
+   int32 m_fdWaiters;
 
    /** Execute at link time? */
    bool m_launchAtLink;
@@ -361,6 +405,17 @@ protected:
    */
    void reschedule( VMContext *ctx );
 
+   /** Waits for contexts waiting on descriptors to be ready and reschedules them.
+      \param seconds Maximum wait; 0 just polls, negative waits forever.
+      \param elected A context out of the sleeping list that the caller will
+         put at sleep by itself, or 0.
+      \return Count of contexts made ready, or -1 if interrupted.
+   */
+   int32 pollDescriptors( numeric seconds, VMContext* elected = 0 );
+
+   /** Ends the descriptor wait of an elected context whose wait has timed out. */
+   void descriptorTimeout( VMContext *ctx );
+
    /** Service recursive function called by LinkClass to create a class. */
    bool linkSubClass( LiveModule *mod , const Symbol *clssym, Map &props, Map &states, ObjectFactory *factory );
 
@@ -424,6 +479,12 @@ protected:
    /** True when we want to wait for collection before being notified in priority scans. */
    bool m_bWaitForCollect;
 
+   /** Time spent in performGC(). */
+   numeric m_gcWaitTime;
+
+   /** Items found alive by the last sweep and last marked from this VM. */
+   int32 m_gcLiveItems;
+
    /** Mutex for locked items ring.
     *  -- unused; kept for binary compatibilty
     * */
@@ -540,6 +601,9 @@ protected:
    /** Performs periodic checks on the virtual machine. */
    void periodicChecks();
 
+   /** Accounts the return from the current frame in the execution counters. */
+   void countReturn();
+
    /** Creates a new stack frame in the current context
       \param paramCount number of parameters in the stack
       \param frameEndFunc Callback function to be executed at frame end
@@ -1022,10 +1086,10 @@ public:
    void fillErrorContext( Error *err, bool filltb = true );
 
    /** Returns the current stack as a reference. */
-   ItemArray &stack() { return m_currentContext->stack(); }
+   StackWindow &stack() { return m_currentContext->stack(); }
 
    /** Returns the current stack as a reference (const version). */
-   const ItemArray &stack() const { return m_currentContext->stack(); }
+   const StackWindow &stack() const { return m_currentContext->stack(); }
 
    /** Returns a reference to the nth item in the current stack. */
    Item &stackItem( uint32 pos ) { return stack()[ pos ]; }
@@ -1291,6 +1355,36 @@ public:
    void rotateContext();
    void terminateCurrentContext();
 
+   /** Suspends the current context until a system descriptor is ready.
+
+      Other coroutines are run while the current one waits; when all of them
+      are waiting, the VM idles on the descriptors being waited for.
+
+      Extension functions performing I/O should use a non-blocking operation
+      first, and if that would block, install a return handler through
+      returnHandler() and call this method. The return handler is invoked as
+      the context is resumed, and can use VMContext::descriptorReady() to tell
+      readiness from timeout, and retry the operation or wait again.
+
+      \param fd The system level file descriptor or socket.
+      \param bWrite true to wait for write readiness, false for read readiness.
+      \param secs Maximum wait in seconds; a negative value waits forever.
+      \return false if the context can't be suspended (i.e. in atomic mode, or
+         if the system doesn't support waits on descriptors). In that case,
+         the caller should wait blocking the whole VM as usual.
+   */
+   bool waitDescriptor( int32 fd, bool bWrite, numeric secs = -1.0 );
+
+   /** Stops waiting on a descriptor that is about to be closed.
+      Extension functions closing a descriptor that may be waited through
+      waitDescriptor() must call this method (before closing it, if possible).
+      The contexts waiting on the descriptor are resumed as if their wait
+      timed out, so that they don't use the closed descriptor.
+
+      \param fd The system level file descriptor or socket.
+   */
+   void descriptorClosed( int32 fd );
+
    /** Returns a well known item.
       A well known item is an item that does not phiscally resides in any module, and is
       at complete disposal of VM.
@@ -1367,6 +1461,20 @@ public:
    */
    Item *findLocalSymbolItem( const String &symName ) const;
 
+   /** Finds the symbol a name refers to in the local context.
+      The current function symbol table is searched first, and then
+      the global symbol table of the current module.
+      \param symName the symbol name to be found
+      \return the symbol, or 0 if the name is not declared in the current module.
+   */
+   const Symbol *findLocalSymbol( const String &symName ) const;
+
+   /** Returns the storage of a symbol of the current function or module.
+      \param sym A symbol returned by findLocalSymbol() in the current context.
+      \return the physical pointer to the variable storage.
+   */
+   Item *symbolItem( const Symbol *sym ) const;
+
    /** Calls an item.
       The item may contain any valid callable object:
       - An external (C/C++) function.
@@ -1438,9 +1546,22 @@ public:
       m_currentContext->returnHandler( callbackFunc );
    }
 
+   /** Calls a prepared callable item from a VM frame.
+      This is equivalent to callFrame( const Item&, int32 ) on the
+      item in the prepared call, with the parameters it was prepared for
+      already pushed; the frame for script functions is built directly.
+      \see PreparedCall
+   */
+   void callFrame( const PreparedCall& call );
+
    /** Prepare a frame for a function call */
    void prepareFrame( CoreFunc* cf, uint32 paramCount );
 
+   /** Prepare a frame for a script function call.
+      The named parameters must have been already resolved.
+   */
+   void prepareFrame( CoreFunc* cf, FuncDef* def, uint32 paramCount );
+
    /** Prepare a frame for an array call.
 
        The function oesn't check for the array to be callable because
@@ -1534,6 +1655,13 @@ public:
    */
    void callItemAtomic(const Item &callable, int32 paramCount );
 
+   /** Calls a prepared callable item in atomic mode.
+      The parameters the call was prepared for must be already pushed.
+      \see callItemAtomic( const Item&, int32 )
+      \see PreparedCall
+   */
+   void callItemAtomic( const PreparedCall& call );
+
    /** Installs a post-processing return frame handler.
       The function passed as a parmeter will receive a pointer to this VM.
 
@@ -1596,6 +1724,10 @@ public:
    */
    void callReturn()
    {
+      // the returned value may be our accumulator string.
+      m_accSlot = 0;
+      m_tmpSlot = 0;
+
       // if the stack frame requires an end handler...
       // ... but only if not unrolling a stack because of error...
       if ( currentFrame()->m_endFrameFunc != 0 )
@@ -1608,6 +1740,9 @@ public:
          }
       }
 
+      if ( m_counters != 0 )
+         countReturn();
+
       m_break = currentContext()->callReturn();
 
       // if we have nowhere to return...
@@ -1805,6 +1940,25 @@ public:
    */
    virtual void periodicCallback();
 
+   /** Sets the sampling profiler.
+      The profiler is called from the periodic checks, and it's owned by
+      the VM; a previously set profiler is destroyed. Pass 0 to remove it.
+   */
+   void profiler( Profiler* prof );
+
+   /** Returns the sampling profiler, or 0 if none is set. */
+   Profiler* profiler() const { return m_profiler; }
+
+   /** Sets the execution counters.
+      While counters are set, the VM counts the executed opcodes and
+      accounts function calls and returns. The counters are owned by the
+      VM; previously set counters are destroyed. Pass 0 to remove them.
+   */
+   void counters( VMCounters* cnt );
+
+   /** Returns the execution counters, or 0 if none are set. */
+   VMCounters* counters() const { return m_counters; }
+
    void callbackLoops( uint32 cl ) { m_loopsCallback = cl; }
    uint32 callbackLoops() const { return m_loopsCallback; }
 
@@ -1859,6 +2013,11 @@ public:
    */
    returnCode  expandString( const String &src, String &target );
 
+   /** Performs a string expansion using a pre-parsed template.
+      \return a returnCode enumeration explaining possible errors in string expansion
+   */
+   returnCode  expandString( const StringTemplate &tpl, String &target );
+
    /** Creates a reference to an item.
       The source item is turned into a reference which is passed in the
       target item. If the source is already a reference, the reference
@@ -2087,7 +2246,7 @@ public:
       \note Calls VM baton acquire (just candy grammar).
       \see baton()
    */
-   virtual void unidle() { m_baton.acquire(); }
+   virtual void unidle() { m_baton.acquire(); m_baton.endBlock(); }
 
    /** Enable the Garbage Collector requests on this VM.
 
@@ -2175,6 +2334,18 @@ public:
    */
    void performGC( bool bWaitForCollection = false );
 
+   /** Time this VM spent blocked by the GC while being marked, in seconds. */
+   numeric gcBlockedTime() const { return m_baton.blockedTime(); }
+
+   /** Time this VM spent waiting in performGC(), in seconds. */
+   numeric gcWaitTime() const { return m_gcWaitTime; }
+
+   /** Live items attributed to this VM by the last sweep.
+      Items reachable from more VMs are attributed to the VM that marked
+      them last; only the first MemPool::max_counted_vms VMs are counted.
+   */
+   int32 gcLiveItems() const { return m_gcLiveItems; }
+
    /** Increments the reference count for this VMachine. */
    void incref();
 
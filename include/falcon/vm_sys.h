@@ -77,6 +77,47 @@ public:
    */
    bool sleep( numeric seconds ) const;
 
+   /** Adds a system descriptor to the set of those watched by this VM.
+      The descriptor is watched for a single readiness event; once reported by
+      waitDescriptors(), it must be watched again to receive further events.
+
+      A descriptor can be watched at the same time for reading and for writing,
+      with different data; each is reported when its own event happens.
+
+      \param fd The file descriptor or socket to be watched.
+      \param bWrite true to wait for the descriptor to be writeable, false for readable.
+      \param data Opaque data that waitDescriptors() reports back when fd is ready.
+      \return false if the system doesn't support descriptor watching, if the
+             descriptor is already watched in the same direction, or on error.
+   */
+   bool watchDescriptor( int32 fd, bool bWrite, void* data );
+
+   /** Stops watching a descriptor on behalf of the given data.
+      The descriptor stays watched for the other direction, if any.
+   */
+   void unwatchDescriptor( int32 fd, void* data );
+
+   /** Stops watching a descriptor in both directions.
+      To be used when the descriptor is closed.
+      \param fd The descriptor.
+      \param waiters An array receiving the data of who was waiting on fd; at least 2 items.
+      \return Count of waiters that were removed.
+   */
+   int32 dropDescriptor( int32 fd, void** waiters );
+
+   /** Stops watching all the descriptors. */
+   void dropDescriptors();
+
+   /** Waits for some watched descriptor to become ready.
+      The wait is interrupted as sleep() is.
+
+      \param seconds Maximum wait; a negative value waits forever.
+      \param ready An array receiving the data of the ready descriptors.
+      \param size Size of the ready array; at least 2.
+      \return Count of ready descriptors (0 on timeout) or -1 if interrupted.
+   */
+   int32 waitDescriptors( numeric seconds, void** ready, int32 size ) const;
+
    /** Returns overall underlying system architecture type.
       It may be something as WIN or POSIX. More detailed informations about underlying systems
       can be retreived through modules.
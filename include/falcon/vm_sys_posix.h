@@ -17,12 +17,19 @@
 #define FLC_VM_SYS_POSIX_H
 
 namespace Falcon {
+
+class Map;
+
 namespace Sys {
 
 struct VM_SYS_DATA
 {
    int interruptPipe[2];
    bool isSignalTarget;
+   /** Descriptor reactor (epoll), created on first watchDescriptor(); -1 if none */
+   int reactor;
+   /** Watched descriptors: fd (int) -> their readers and writers; 0 if none. */
+   Map* watches;
 };
 
 }
@@ -48,6 +48,12 @@ class FALCON_DYN_CLASS VMContext: public BaseAlloc
 
    VMSemaphore *m_sleepingOn;
 
+   /** System descriptor this context is waiting on, or -1. */
+   int32 m_waitingFd;
+
+   /** True if the last descriptor wait was ended by readiness rather than by timeout. */
+   bool m_fdReady;
+
    /** Currently executed symbol.
       May be 0 if the startmodule has not a "__main__" symbol;
       this should be impossible when things are set up properly.
@@ -95,6 +101,15 @@ class FALCON_DYN_CLASS VMContext: public BaseAlloc
    StackFrame *m_frames;
    StackFrame *m_spareFrames;
 
+   /** First segment of the item stack used by the frames. */
+   StackSegment *m_stackBase;
+
+   /** Places the items of a frame right after the ones of the frames below. */
+   void placeFrame( StackFrame* frame );
+
+   /** Lets the topmost frame in the item stack grow again. */
+   void thawFrames();
+
 public:
    VMContext();
    VMContext( const VMContext& other );
@@ -119,13 +134,29 @@ public:
    void scheduleAfter( numeric secs );
 
    /** Return true if this is waiting forever on a semaphore signal */
-   bool isWaitingForever() const { return m_sleepingOn != 0 && m_schedule < 0; }
+   bool isWaitingForever() const { return (m_sleepingOn != 0 || m_waitingFd >= 0) && m_schedule < 0; }
 
    VMSemaphore* waitingOn() const { return m_sleepingOn; }
 
    void waitOn( VMSemaphore* sem, numeric value=-1 );
    void signaled();
 
+   /** Prepares this context to wait for a system descriptor to be ready.
+      \see VMachine::waitDescriptor
+   */
+   void waitOnDescriptor( int32 fd, numeric secs=-1 );
+
+   /** Returns the descriptor this context is waiting on, or -1 if none. */
+   int32 waitingDescriptor() const { return m_waitingFd; }
+
+   /** Ends a descriptor wait.
+      \param ready true if the descriptor became ready, false on timeout.
+   */
+   void descriptorDone( bool ready );
+
+   /** True if the last descriptor wait ended because the descriptor became ready. */
+   bool descriptorReady() const { return m_fdReady; }
+
    //===========================
    uint32& pc() { return m_pc; }
    const uint32& pc() const { return m_pc; }
@@ -176,8 +207,8 @@ public:
 
    //===========================================
 
-   const ItemArray& stack() const { return m_frames->stack(); }
-   ItemArray& stack() { return m_frames->stack(); }
+   const StackWindow& stack() const { return m_frames->stack(); }
+   StackWindow& stack() { return m_frames->stack(); }
 
    VMSemaphore *sleepingOn() const { return m_sleepingOn; }
    void sleepOn( VMSemaphore *sl ) { m_sleepingOn = sl; }
@@ -215,6 +246,7 @@ public:
    void setFrames( StackFrame* newTop )
    {
       m_frames = newTop;
+      thawFrames();
    }
 
    /** Creates a stack frame taking a certain number of parameters.
@@ -0,0 +1,102 @@
+/*
+   FALCON - The Falcon Programming Language.
+   FILE: vmcounters.h
+
+   Execution counters of the virtual machine.
+   -------------------------------------------------------------------
+   Author: agent
+   Begin: Fri, 16 Oct 2026 18:03:41 +0000
+
+   -------------------------------------------------------------------
+   (C) Copyright 2026: the FALCON developers (see list in AUTHORS file)
+
+   See LICENSE file for licensing details.
+*/
+
+/** \file
+   Execution counters of the virtual machine.
+*/
+
+#ifndef FALCON_VMCOUNTERS_H
+#define FALCON_VMCOUNTERS_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/basealloc.h>
+#include <falcon/genericmap.h>
+#include <falcon/pcodes.h>
+
+namespace Falcon {
+
+class VMContext;
+class Symbol;
+class Stream;
+class CoreDict;
+
+/** Execution counters.
+
+   When given to a virtual machine through VMachine::counters( VMCounters* ),
+   the VM counts each executed opcode and reports every function call
+   through enter() and every return through leave(). For each called
+   function, the counters record:
+   - the number of calls;
+   - the inclusive time spent in the function (the time spent in
+     recursive activations is accounted once, to the outermost one);
+   - the calls performed from each line of the function (call sites);
+   - the calls performed towards each other function (call graph edges).
+
+   Frames entered before the counters were set are not accounted.
+
+   The data can be read as a dictionary through toDict() or written as
+   a JSON document through writeJSON().
+*/
+class FALCON_DYN_CLASS VMCounters: public BaseAlloc
+{
+public:
+   VMCounters();
+   ~VMCounters();
+
+   /** Counts an executed opcode. */
+   void countOp( byte opcode ) { ++m_ops[ opcode ]; }
+
+   /** Accounts for a call; the context has just entered the called function. */
+   void enter( VMContext* ctx );
+
+   /** Accounts for a return; the context is about to leave the current function. */
+   void leave( VMContext* ctx );
+
+   /** Discards the collected data. */
+   void reset();
+
+   /** Number of times an opcode has been executed. */
+   uint64 opCount( byte opcode ) const { return m_ops[ opcode ]; }
+
+   /** Returns the mnemonic of an opcode, or 0 if the opcode is not defined. */
+   static const char* opName( byte opcode );
+
+   /** Writes the collected data as a JSON document.
+      \return false on stream error.
+   */
+   bool writeJSON( Stream* out ) const;
+
+   /** Creates a dictionary with the collected data.
+      The dictionary has the same layout of the JSON document.
+   */
+   CoreDict* toDict() const;
+
+private:
+   class FuncCounter;
+
+   FuncCounter* function( const Symbol* sym );
+
+   uint64 m_ops[ FLC_PCODE_COUNT ];
+
+   /** Symbol* -> FuncCounter* */
+   Map m_funcs;
+};
+
+}
+
+#endif
+
+/* end of vmcounters.h */
@@ -123,11 +123,46 @@ namespace traits
 
 /** Map of symbol names and module where they are located.
    (const String *, SymModule )
+
+   The map is a hash table indexed on the symbol names; the names are not
+   copied, and must stay valid as long as they are in the map (they are
+   usually the names of the symbols in the modules held by the VM).
+
+   Resolving a name costs a hash of its characters and, on average, a single
+   string comparison, independently of the count of the symbols in the map.
 */
-class FALCON_DYN_CLASS SymModuleMap: public Map
+class FALCON_DYN_CLASS SymModuleMap: public BaseAlloc
 {
+   class Entry;
+
+   Entry **m_buckets;
+   uint32 m_bucketCount;
+   uint32 m_size;
+
+   Entry *findEntry( const String *name, uint32 hash ) const;
+   void grow();
+
 public:
    SymModuleMap();
+   ~SymModuleMap();
+
+   /** Finds the SymModule associated with a symbol name.
+      \return The symbol data, or 0 if the name is not in the map.
+   */
+   SymModule *find( const String *name ) const;
+
+   /** Associates a symbol name with a SymModule.
+      If the name is already in the map, its data is replaced.
+   */
+   void insert( const String *name, const SymModule *sm );
+
+   /** Removes a name from the map.
+      \return true if the name was found.
+   */
+   bool erase( const String *name );
+
+   uint32 size() const { return m_size; }
+   bool empty() const { return m_size == 0; }
 };
 
 /** Map of active modules in this VM.
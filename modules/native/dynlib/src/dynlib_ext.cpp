@@ -783,39 +783,96 @@ FALCON_FUNC  Dyn_dummy_init( ::Falcon::VMachine *vm )
 
 
 
-/*#
-   @method call__ DynFunction
-   @brief Calls the external dynamically loaded function.
-   @optparam ...
-   @return Either nil, a Falcon item or an instance of @a DynOpaque.
+static void s_paramMismatch( ::Falcon::VMachine *vm, int count )
+{
+   String temp = FAL_STR( dyl_param_mismatch );
+   temp.A(" [n. ").N( count+1 ).A("]");
 
-   Calls the function loaded from the dynlib.
+   throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .extra( temp ));
+}
 
-   Function parameters and return type are determined by the declaration
-   passed to @a DynLib.get.
+/** Performs the call and stores the return value in A. */
+static void s_dynCall( ::Falcon::VMachine *vm, FunctionDef *fa, void** params, int* sizes )
+{
+   if( fa->retparam() == 0 )
+   {
+      byte retbuf[16];
+      *(int*)retbuf = 0;
+      Sys::dynlib_call( fa->functionPtr(), params, sizes, retbuf );
+   }
+   else
+   {
+      ParamValue pvret( fa->retparam() );
+      pvret.prepareReturn();
+      Sys::dynlib_call( fa->functionPtr(), params, sizes, pvret.buffer() );
+      pvret.toItem( vm->regA(), fa->deletorPtr() );
+   }
+}
 
-   This method overrides the base Object BOM method "call__", making
-   possible to call directly this object.
+/** Calls a function whose parameters are all numbers, converting them in a stack frame. */
+static void s_callScalar( ::Falcon::VMachine *vm, FunctionDef *fa, const CallPlan& plan )
+{
+   CallPlan::Slot slots[CallPlan::max_params];
+   void* params[CallPlan::max_params];
 
-   @see DynLib.get
-*/
-FALCON_FUNC  DynFunction_call( ::Falcon::VMachine *vm )
+   int32 count = plan.count();
+   for( int32 i = 0; i < count; ++i )
+   {
+      if ( ! plan.convert( i, *vm->param(i), slots[i] ) )
+         s_paramMismatch( vm, i );
+
+      // the call code wants the last parameter first.
+      params[count - 1 - i] = slots[i].vbuffer;
+   }
+
+   s_dynCall( vm, fa, params, plan.sizes() );
+}
+
+/** Calls a function with a fixed parameter list, keeping the values in a stack frame. */
+static void s_callFixed( ::Falcon::VMachine *vm, FunctionDef *fa, const CallPlan& plan )
 {
-   int32 paramCount = vm->paramCount();
-   FunctionDef *fa = dyncast<FunctionDef *>(vm->self().asObject()->getFalconData());
-   ParamList& params = fa->params();
+   ParamValue values[CallPlan::max_params];
+   void* params[CallPlan::max_params];
+   int sizes[CallPlan::max_params+1];
 
-   if( vm->paramCount() != params.size() )
+   bool hasByRef = false;
+   int32 count = plan.count();
+   Parameter* p = fa->params().first();
+   for( int32 i = 0; i < count; ++i, p = p->m_next )
    {
-      if( ! params.isVaradic()
-         || ( params.isVaradic() && paramCount +1 < params.size() )
-         )
+      ParamValue& pv = values[i];
+      pv.parameter( p );
+
+      Item* param = vm->param(i);
+      if ( ! pv.transform( *param ) )
+         s_paramMismatch( vm, i );
+
+      if( vm->isParamByRef( i ) && p->m_pointers > 0 )
       {
-         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
-               .extra( FAL_STR( dyl_param_count_mismatch ) ));
+         hasByRef = true;
+         pv.toReference( param );
       }
+
+      params[count - 1 - i] = pv.buffer();
+      sizes[count - 1 - i] = pv.size();
+   }
+   sizes[count] = 0;
+
+   s_dynCall( vm, fa, params, sizes );
+
+   // if there is some parameter to be turned back as a by reference, do it.
+   if( hasByRef )
+   {
+      for( int32 i = 0; i < count; ++i )
+         values[i].derefItem();
    }
+}
 
+/** Calls a varadic function, or a function with too many parameters for a stack frame. */
+static void s_callVaradic( ::Falcon::VMachine *vm, FunctionDef *fa )
+{
+   ParamList& params = fa->params();
    bool hasByRef = false;
    ParamValueList pvl;
    if( vm->paramCount() > 0 )
@@ -824,43 +881,28 @@ FALCON_FUNC  DynFunction_call( ::Falcon::VMachine *vm )
       Parameter* p = params.first();
       while( p != 0 )
       {
-         ParamValue* pv = new ParamValue( p );
-
          // have we a varadic parameter?
          if( p->m_type == Parameter::e_varpar )
          {
             // transform the rest of the vm parameters autonomously.
-            p = 0;
-
             for( int32 i = count; i < vm->paramCount(); ++ i )
             {
                ParamValue* pv = new ParamValue();
                pvl.add( pv );
 
                if ( ! pv->transform( *vm->param(i) ) )
-               {
-                  String temp = FAL_STR( dyl_param_mismatch );
-                  temp.A(" [n. ").N( count+1 ).A("]");
-
-                  throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
-                        .extra( temp ));
-               }
+                  s_paramMismatch( vm, count );
             }
 
             break;
          }
 
          // a normal parameter?
+         ParamValue* pv = new ParamValue( p );
          pvl.add( pv );
          Item* param = vm->param(count);
          if ( ! pv->transform( *param ) )
-         {
-            String temp = FAL_STR( dyl_param_mismatch );
-            temp.A(" [n. ").N( count+1 ).A("]");
-
-            throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
-                  .extra( temp ));
-         }
+            s_paramMismatch( vm, count );
 
          if( vm->isParamByRef( count ) && pv->parameter()->m_pointers > 0 )
          {
@@ -874,21 +916,7 @@ FALCON_FUNC  DynFunction_call( ::Falcon::VMachine *vm )
    }
 
    pvl.compile();
-
-   // now manage the return value
-   if( fa->retparam() == 0 )
-   {
-      byte retbuf[16];
-      *(int*)retbuf = 0;
-      Sys::dynlib_call( fa->functionPtr(), pvl.params(), pvl.sizes(), retbuf );
-   }
-   else
-   {
-      ParamValue pvret( fa->retparam() );
-      pvret.prepareReturn();
-      Sys::dynlib_call( fa->functionPtr(), pvl.params(), pvl.sizes(), pvret.buffer() );
-      pvret.toItem( vm->regA(), fa->deletorPtr() );
-   }
+   s_dynCall( vm, fa, pvl.params(), pvl.sizes() );
 
    // if there is some parameter to be turned back as a by reference, do it.
    if( hasByRef )
@@ -896,17 +924,59 @@ FALCON_FUNC  DynFunction_call( ::Falcon::VMachine *vm )
       ParamValue* pv = pvl.first();
       while( pv != 0 )
       {
-         // if it's varadic, we're done
-         if( pv->parameter()->m_type == Parameter::e_varpar )
-            break;
-
-         pv->derefItem();
+         // varadic values are not turned back.
+         if( pv->parameter() != 0 )
+            pv->derefItem();
 
          pv = pv->next();
       }
    }
 }
 
+
+/*#
+   @method call__ DynFunction
+   @brief Calls the external dynamically loaded function.
+   @optparam ...
+   @return Either nil, a Falcon item or an instance of @a DynOpaque.
+
+   Calls the function loaded from the dynlib.
+
+   Function parameters and return type are determined by the declaration
+   passed to @a DynLib.get.
+
+   This method overrides the base Object BOM method "call__", making
+   possible to call directly this object.
+
+   @see DynLib.get
+*/
+FALCON_FUNC  DynFunction_call( ::Falcon::VMachine *vm )
+{
+   int32 paramCount = vm->paramCount();
+   FunctionDef *fa = dyncast<FunctionDef *>(vm->self().asObject()->getFalconData());
+   ParamList& params = fa->params();
+
+   if( vm->paramCount() != params.size() )
+   {
+      if( ! params.isVaradic()
+         || ( params.isVaradic() && paramCount +1 < params.size() )
+         )
+      {
+         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+               .extra( FAL_STR( dyl_param_count_mismatch ) ));
+      }
+   }
+
+   // the plan knows in advance how to pass the parameters.
+   const CallPlan& plan = fa->plan();
+   if( plan.isScalar() )
+      s_callScalar( vm, fa, plan );
+   else if( plan.isFixed() )
+      s_callFixed( vm, fa, plan );
+   else
+      s_callVaradic( vm, fa );
+}
+
 /*#
    @method toString DynFunction
    @brief Returns a string representation of the function.
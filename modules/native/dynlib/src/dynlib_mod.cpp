@@ -232,7 +232,8 @@ String ParamList::toString() const
 FunctionDef::FunctionDef( const String& definition ):
       m_return(0),
       m_fAddress(0),
-      m_fDeletor(0)
+      m_fDeletor(0),
+      m_plan(0)
 {
    try {
       parse( definition );
@@ -248,7 +249,8 @@ FunctionDef::FunctionDef( const String& definition ):
 FunctionDef::FunctionDef( const String& definition, const String& deletor ):
    m_return(0),
    m_fAddress(0),
-   m_fDeletor(0)
+   m_fDeletor(0),
+   m_plan(0)
 {
    try {
       parse( definition );
@@ -275,7 +277,8 @@ FunctionDef::FunctionDef( const FunctionDef& other ):
    m_name( other.m_name ),
    m_params( other.m_params ),
    m_fAddress( other.m_fAddress ),
-   m_fDeletor( other.m_fDeletor )
+   m_fDeletor( other.m_fDeletor ),
+   m_plan(0)
 {
    if ( other.m_return != 0 )
       m_return = new Parameter( *other.m_return );
@@ -286,6 +289,15 @@ FunctionDef::FunctionDef( const FunctionDef& other ):
 FunctionDef::~FunctionDef()
 {
    delete m_return;
+   delete m_plan;
+}
+
+
+const CallPlan& FunctionDef::plan()
+{
+   if( m_plan == 0 )
+      m_plan = new CallPlan( m_params );
+   return *m_plan;
 }
 
 
@@ -1057,6 +1069,148 @@ void ParamValueList::compile()
    }
 }
 
+//===================================================
+// CallPlan
+//
+
+CallPlan::CallPlan( const ParamList& params ):
+   m_count( params.size() ),
+   m_bFixed( ! params.isVaradic() && params.size() <= max_params ),
+   m_bScalar( false ),
+   m_converters(0),
+   m_sizes(0)
+{
+   if( ! m_bFixed )
+      return;
+
+   m_converters = (t_convert*) memAlloc( sizeof(t_convert) * (m_count+1) );
+   m_sizes = (int*) memAlloc( sizeof(int) * (m_count+1) );
+
+   m_bScalar = true;
+   int count = 0;
+   Parameter* p = params.first();
+   while( p != 0 )
+   {
+      int size = 0;
+      m_converters[count] = converterOf( p, size );
+      if ( m_converters[count] == c_none )
+         m_bScalar = false;
+
+      // the call code wants the last parameter first.
+      m_sizes[m_count - 1 - count] = size;
+      ++count;
+      p = p->m_next;
+   }
+
+   m_sizes[m_count] = 0;
+}
+
+
+CallPlan::~CallPlan()
+{
+   if( m_converters != 0 )
+   {
+      memFree( m_converters );
+      memFree( m_sizes );
+   }
+}
+
+
+CallPlan::t_convert CallPlan::converterOf( const Parameter* p, int& size )
+{
+   // sizes are the same set by ParamValue::transform for the same types.
+   if( p->m_pointers != 0 || p->m_subscript != 0 || p->m_isFuncPtr )
+      return c_none;
+
+   switch( p->m_type )
+   {
+   case Parameter::e_signed_char: size = sizeof(int); return c_schar;
+   case Parameter::e_unsigned_char: size = sizeof(int); return c_uchar;
+
+   case Parameter::e_short:
+   case Parameter::e_int:
+   case Parameter::e_enum:
+      size = sizeof(int); return c_int;
+
+   case Parameter::e_unsigned_short:
+   case Parameter::e_unsigned_int:
+      size = sizeof(int); return c_uint;
+
+   case Parameter::e_long: size = sizeof(int); return c_long;
+   case Parameter::e_unsigned_long: size = sizeof(int); return c_ulong;
+
+   case Parameter::e_long_long:
+   case Parameter::e_unsigned_long_long:
+      size = sizeof(int64); return c_int64;
+
+   case Parameter::e_float: size = 0x80 | sizeof(float); return c_float;
+   case Parameter::e_double: size = 0x80 | sizeof(double); return c_double;
+   case Parameter::e_long_double: size = 0x80 | sizeof(long double); return c_ldouble;
+
+   default:
+      // strings, characters, opaque data and void go through ParamValue.
+      return c_none;
+   }
+}
+
+
+bool CallPlan::convert( int32 pos, const Item& item, Slot& slot ) const
+{
+   fassert( pos < m_count );
+
+   switch( item.type() )
+   {
+   case FLC_ITEM_BOOL:
+      // only int-sized parameters accept booleans.
+      if( m_converters[pos] != c_int && m_converters[pos] != c_uint )
+         return false;
+      slot.vint = item.isTrue() ? 1 : 0;
+      return true;
+
+   case FLC_ITEM_INT:
+      {
+         int64 value = item.asInteger();
+         switch( m_converters[pos] )
+         {
+         case c_schar: slot.vint = (int)(char) value; break;
+         case c_uchar: slot.vint = (int)(unsigned char) value; break;
+         case c_int: slot.vint = (int) value; break;
+         case c_uint: slot.vint = (int)(unsigned int) value; break;
+         case c_long: slot.vlong = (long) value; break;
+         case c_ulong: slot.vlong = (long)(unsigned long) value; break;
+         case c_int64: slot.vint64 = value; break;
+         case c_float: slot.vfloat = (float) value; break;
+         case c_double: slot.vdouble = (double) value; break;
+         case c_ldouble: slot.vld = (long double) value; break;
+         default: return false;
+         }
+      }
+      return true;
+
+   case FLC_ITEM_NUM:
+      {
+         numeric value = item.asNumeric();
+         switch( m_converters[pos] )
+         {
+         case c_schar: slot.vint = (int)(char) value; break;
+         case c_uchar: slot.vint = (int)(unsigned char) value; break;
+         case c_int: slot.vint = (int) value; break;
+         case c_uint: slot.vint = (int)(unsigned int) value; break;
+         case c_long: slot.vlong = (long) value; break;
+         case c_ulong: slot.vlong = (long)(unsigned long) value; break;
+         case c_int64: slot.vint64 = (int64) value; break;
+         case c_float: slot.vfloat = (float) value; break;
+         case c_double: slot.vdouble = (double) value; break;
+         case c_ldouble: slot.vld = (long double) value; break;
+         default: return false;
+         }
+      }
+      return true;
+   }
+
+   return false;
+}
+
 //==========================================================
 // DynOpaque
 //
@@ -33,6 +33,7 @@ namespace Falcon
 
 class Parameter;
 class Tokenizer;
+class CallPlan;
 
 class ParamList
 {
@@ -142,7 +143,8 @@ public:
    FunctionDef():
      m_return(0),
      m_fAddress(0),
-     m_fDeletor(0)
+     m_fDeletor(0),
+     m_plan(0)
      {}
 
    FunctionDef( const String& definition );
@@ -209,6 +211,11 @@ public:
 
    Parameter* retparam() const { return m_return; }
 
+   /** Returns the marshalling plan of this function.
+      The plan is compiled at first call and kept until the definition is destroyed.
+   */
+   const CallPlan& plan();
+
 private:
 
    Parameter* parseNextParam( Tokenizer& tok, bool isFuncName = false);
@@ -230,6 +237,8 @@ private:
       Pointer of the deletor used for the data created by this function.
    */
    void *m_fDeletor;
+
+   CallPlan* m_plan;
 };
 
 class ParamValueList;
@@ -351,6 +360,9 @@ public:
 
    Parameter* parameter() const { return m_param; }
 
+   /** Binds to a parameter type a value created without it (i.e. in an array). */
+   void parameter( Parameter* type ) { m_param = type; }
+
    /** Transforms this data in a reference data.
 
        After transform has operates, data is stored in the internal buffer.
@@ -470,6 +482,95 @@ private:
 };
 
 
+/** Marshalling plan of a function definition.
+ *
+ * The layout of the parameters passed to the machine level call depends
+ * only on the function signature; the plan computes it once, so that the
+ * calls don't need to build a ParamValueList.
+ *
+ * Functions with a fixed parameter list (up to max_params parameters)
+ * are called with their parameter values in a frame allocated on the
+ * stack. If all the parameters are plain numbers (integers, enums and
+ * floating point values, without indirections), each of them is also
+ * bound to a converter chosen in advance, and the call doesn't create
+ * any ParamValue nor allocate any memory.
+ *
+ * Varadic functions and functions with more than max_params parameters
+ * still go through a ParamValueList.
+ *
+ * As for ParamValueList, the sizes are stored in reverse order
+ * (last parameter first), and are terminated by a 0 marker.
+ */
+class CallPlan: public BaseAlloc
+{
+public:
+   enum {
+      /** Maximum count of parameters passed through a stack frame. */
+      max_params = 16
+   };
+
+   /** Conversion of an item into a scalar parameter. */
+   typedef enum
+   {
+      c_none,
+      c_schar,
+      c_uchar,
+      c_int,
+      c_uint,
+      c_long,
+      c_ulong,
+      c_int64,
+      c_float,
+      c_double,
+      c_ldouble
+   } t_convert;
+
+   /** Buffer of a scalar parameter; the same layout as the ParamValue buffer. */
+   union Slot
+   {
+      byte vbuffer[16];
+      void* vptr;
+      int   vint;
+      long  vlong;
+      int64 vint64;
+      float vfloat;
+      double vdouble;
+      long double vld;
+   };
+
+   CallPlan( const ParamList& params );
+   ~CallPlan();
+
+   /** True if the parameters can be passed through a stack frame. */
+   bool isFixed() const { return m_bFixed; }
+
+   /** True if all the parameters are converted through the plan converters. */
+   bool isScalar() const { return m_bScalar; }
+
+   /** Count of parameters in a fixed plan. */
+   int32 count() const { return m_count; }
+
+   /** Sizes of the parameters, as required by Sys::dynlib_call.
+      Only valid for scalar plans.
+   */
+   int* sizes() const { return m_sizes; }
+
+   /** Converts the item for the nth parameter.
+      \return false if the item can't be converted to the parameter type.
+   */
+   bool convert( int32 pos, const Item& item, Slot& slot ) const;
+
+private:
+   int32 m_count;
+   bool m_bFixed;
+   bool m_bScalar;
+   t_convert* m_converters;
+   int* m_sizes;
+
+   static t_convert converterOf( const Parameter* p, int& size );
+};
+
+
 class DynOpaque: public CoreObject
 {
 public:
@@ -205,6 +205,8 @@ FALCON_MODULE_DECL
    self->addClassMethod( c_base_compiler, "setDirective", &Falcon::Ext::BaseCompiler_setDirective).asSymbol()->
       addParam("dt")->addParam("value");
    self->addClassMethod( c_base_compiler, "addFalconPath", &Falcon::Ext::BaseCompiler_addFalconPath);
+   self->addClassMethod( c_base_compiler, "addConstant", &Falcon::Ext::BaseCompiler_addConstant).asSymbol()->
+      addParam("name")->addParam("value");
 
 
    Falcon::Symbol *c_compiler = self->addClass( "Compiler", &Falcon::Ext::Compiler_init );
@@ -260,6 +262,14 @@ FALCON_MODULE_DECL
    self->addClassMethod( c_module, "moduleVersion", &Falcon::Ext::Module_moduleVersion );
    self->addClassMethod( c_module, "attributes", &Falcon::Ext::Module_attributes );
 
+   self->addExtFunc( "packArchive", &Falcon::Ext::packArchive )->
+      addParam("path")->addParam("dir")->addParam("files")->addParam("main");
+   self->addExtFunc( "mountArchive", &Falcon::Ext::mountArchive )->
+      addParam("path")->addParam("protocol");
+   self->addExtFunc( "compileCache", &Falcon::Ext::compileCache )->
+      addParam("path")->addParam("size");
+   self->addExtFunc( "compileCacheStats", &Falcon::Ext::compileCacheStats );
+
    return self;
 }
 
@@ -24,6 +24,9 @@
 #include <falcon/attribmap.h>
 #include <falcon/lineardict.h>
 #include <falcon/pcode.h>
+#include <falcon/fstream.h>
+#include <falcon/vfs_archive.h>
+#include <falcon/compilecache.h>
 
 #include "compiler_ext.h"
 #include "compiler_mod.h"
@@ -149,6 +152,41 @@ FALCON_FUNC BaseCompiler_addFalconPath( ::Falcon::VMachine *vm )
 
 }
 
+/*#
+   @method addConstant _BaseCompiler
+   @brief Defines a constant for the scripts compiled by this compiler.
+   @param name The name of the constant.
+   @param value The value of the constant (nil, a number or a string).
+
+   The scripts compiled by this compiler see the constant as if they
+   declared it through a const statement, as the -D option of the falcon
+   command line tool does.
+*/
+
+FALCON_FUNC BaseCompiler_addConstant( ::Falcon::VMachine *vm )
+{
+   Item *i_name = vm->param( 0 );
+   Item *i_value = vm->param( 1 );
+
+   if( i_name == 0 || ! i_name->isString() ||
+       i_value == 0 || ! ( i_value->isNil() || i_value->isOrdinal() || i_value->isString() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).extra( "S,Nil|N|S" ) );
+   }
+
+   CompilerIface *iface = dyncast<CompilerIface*>( vm->self().asObject() );
+   Compiler &compiler = iface->loader().compiler();
+
+   if ( i_value->isNil() )
+      compiler.addNilConstant( *i_name->asString() );
+   else if ( i_value->isInteger() )
+      compiler.addIntConstant( *i_name->asString(), i_value->asInteger() );
+   else if ( i_value->isOrdinal() )
+      compiler.addNumConstant( *i_name->asString(), i_value->forceNumeric() );
+   else
+      compiler.addStringConstant( *i_name->asString(), *i_value->asString() );
+}
+
 
 /*#
    @class Compiler
@@ -1052,6 +1090,208 @@ FALCON_FUNC Module_attributes( ::Falcon::VMachine *vm )
 }
 
 
+
+//=========================================================
+// Packed archives
+//
+
+/*#
+   @function packArchive
+   @brief Stores a set of files in a packed archive.
+   @param path The archive file to be created.
+   @param dir The directory where the files are found.
+   @param files An array with the paths of the files, relative to @b dir.
+   @optparam main The name of the main module of the archive.
+   @raise IoError if the archive can't be written or a file can't be read.
+
+   Each file is stored in the archive under its relative path, as the
+   falpack utility does when it packs an application. The archive can then
+   be served to the compilers through @a mountArchive.
+*/
+FALCON_FUNC packArchive( ::Falcon::VMachine *vm )
+{
+   Item *i_path = vm->param( 0 );
+   Item *i_dir = vm->param( 1 );
+   Item *i_files = vm->param( 2 );
+   Item *i_main = vm->param( 3 );
+
+   if( i_path == 0 || ! i_path->isString()
+       || i_dir == 0 || ! i_dir->isString()
+       || i_files == 0 || ! i_files->isArray()
+       || ( i_main != 0 && ! i_main->isString() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "S,S,A,[S]" ) );
+   }
+
+   FileStream out;
+   if ( ! out.create( *i_path->asString(), (BaseFileStream::t_attributes) 0644 ) )
+   {
+      throw new IoError( ErrorParam( e_file_output, __LINE__ )
+            .extra( *i_path->asString() )
+            .sysError( (uint32) out.lastError() ) );
+   }
+
+   ArchiveWriter writer( &out );
+   const CoreArray &files = *i_files->asArray();
+   for ( uint32 i = 0; i < files.length(); ++i )
+   {
+      if ( ! files[i].isString() )
+      {
+         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+               .extra( "S,S,A,[S]" ) );
+      }
+
+      const String &name = *files[i].asString();
+      FileStream in;
+      if ( ! in.open( *i_dir->asString() + "/" + name, BaseFileStream::e_omReadOnly ) )
+      {
+         throw new IoError( ErrorParam( e_open_file, __LINE__ )
+               .extra( name )
+               .sysError( (uint32) in.lastError() ) );
+      }
+
+      if ( ! writer.add( name, &in ) )
+      {
+         throw new IoError( ErrorParam( e_io_error, __LINE__ )
+               .extra( name ) );
+      }
+   }
+
+   if ( ! writer.close( i_main == 0 ? String( "" ) : *i_main->asString() ) )
+   {
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+            .extra( *i_path->asString() ) );
+   }
+
+   out.close();
+}
+
+/*#
+   @function mountArchive
+   @brief Serves the files of a packed archive.
+   @param path The archive file.
+   @optparam protocol The protocol serving the archive (defaults to "pack").
+   @return The name of the main module stored in the archive, or an empty string.
+   @raise IoError if the archive can't be read, or if the protocol is already served.
+
+   After this call, the files stored in the archive are reached as
+   "protocol:///name"; in example, the compilers can load them with
+   @a Compiler.loadFile, or by name if the archive directories are in their
+   search path.
+
+   The archive stays mounted until the program terminates.
+*/
+FALCON_FUNC mountArchive( ::Falcon::VMachine *vm )
+{
+   Item *i_path = vm->param( 0 );
+   Item *i_protocol = vm->param( 1 );
+
+   if( i_path == 0 || ! i_path->isString()
+       || ( i_protocol != 0 && ! i_protocol->isString() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "S,[S]" ) );
+   }
+
+   String protocol = i_protocol == 0 ? String( "pack" ) : *i_protocol->asString();
+
+   int64 fsError;
+   VFSArchive* archive = VFSArchive::load( *i_path->asString(), protocol, fsError );
+   if ( archive == 0 )
+   {
+      throw new IoError( ErrorParam( e_open_file, __LINE__ )
+            .extra( *i_path->asString() )
+            .sysError( (uint32) fsError ) );
+   }
+
+   // the engine owns the archive once it's added.
+   CoreString *mainModule = new CoreString( archive->mainModule() );
+   if ( ! Engine::addVFS( protocol, archive ) )
+   {
+      delete archive;
+      throw new IoError( ErrorParam( e_io_error, __LINE__ )
+            .extra( protocol ) );
+   }
+
+   vm->retval( mainModule );
+}
+
+
+//=========================================================
+// Compile cache
+//
+
+/*#
+   @function compileCache
+   @brief Sets the cache where the compilers keep the compiled sources.
+   @optparam path The cache directory, or nil to stop caching.
+   @optparam size The size limit of the cache, in bytes.
+
+   Once a cache is set, the sources compiled by any @a Compiler (and by
+   the engine, when loading modules) are stored in the cache directory;
+   compiling the same source with the same settings again loads the
+   stored module instead. When the cache grows past @b size, the least
+   recently used entries are removed.
+
+   Setting a new cache resets the counters returned by @a compileCacheStats.
+*/
+FALCON_FUNC compileCache( ::Falcon::VMachine *vm )
+{
+   Item *i_path = vm->param( 0 );
+   Item *i_size = vm->param( 1 );
+
+   if( ( i_path != 0 && ! i_path->isNil() && ! i_path->isString() )
+       || ( i_size != 0 && ! i_size->isOrdinal() ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "[S],[N]" ) );
+   }
+
+   if ( i_path == 0 || i_path->isNil() )
+   {
+      Engine::setCompileCache( 0 );
+   }
+   else
+   {
+      int64 size = i_size == 0 ? (int64) CompileCache::default_size : i_size->forceInteger();
+      Engine::setCompileCache( new CompileCache( *i_path->asString(), size ) );
+   }
+}
+
+/*#
+   @function compileCacheStats
+   @brief Returns the activity counters of the compile cache.
+   @return A dictionary with the counters, or nil if no cache is set.
+
+   The dictionary has the following keys:
+   - @b hits: compilations replaced by a stored module.
+   - @b misses: sources not found in the cache.
+   - @b stores: modules stored in the cache.
+   - @b evictions: entries removed to keep the cache within its size.
+   - @b errors: entries that couldn't be written or read back.
+*/
+FALCON_FUNC compileCacheStats( ::Falcon::VMachine *vm )
+{
+   CompileCache *cc = Engine::getCompileCache();
+   if ( cc == 0 )
+   {
+      vm->retnil();
+      return;
+   }
+
+   CompileCache::Stats st;
+   cc->stats( st );
+
+   LinearDict* cd = new LinearDict( 5 );
+   cd->put( new CoreString( "hits" ), (int64) st.m_hits );
+   cd->put( new CoreString( "misses" ), (int64) st.m_misses );
+   cd->put( new CoreString( "stores" ), (int64) st.m_stores );
+   cd->put( new CoreString( "evictions" ), (int64) st.m_evictions );
+   cd->put( new CoreString( "errors" ), (int64) st.m_errors );
+   vm->retval( new CoreDict( cd ) );
+}
+
 }
 }
 
@@ -36,6 +36,7 @@ namespace Ext {
 
 FALCON_FUNC BaseCompiler_setDirective( ::Falcon::VMachine *vm );
 FALCON_FUNC BaseCompiler_addFalconPath( ::Falcon::VMachine *vm );
+FALCON_FUNC BaseCompiler_addConstant( ::Falcon::VMachine *vm );
 
 FALCON_FUNC Compiler_init( ::Falcon::VMachine *vm );
 FALCON_FUNC Compiler_compile( ::Falcon::VMachine *vm );
@@ -59,6 +60,12 @@ FALCON_FUNC Module_engineVersion( ::Falcon::VMachine *vm );
 FALCON_FUNC Module_moduleVersion( ::Falcon::VMachine *vm );
 FALCON_FUNC Module_attributes( ::Falcon::VMachine *vm );
 
+FALCON_FUNC packArchive( ::Falcon::VMachine *vm );
+FALCON_FUNC mountArchive( ::Falcon::VMachine *vm );
+
+FALCON_FUNC compileCache( ::Falcon::VMachine *vm );
+FALCON_FUNC compileCacheStats( ::Falcon::VMachine *vm );
+
 }
 }
 
@@ -41,7 +41,20 @@ class LogArea;
 class Stream;
 class FileStream;
 
-/** Abstract base class for logging channels. */
+/** Abstract base class for logging channels.
+
+   Log requests are copied into a bounded ring of preallocated messages, and
+   rendered and written by a separate thread. The strings in the ring slots
+   keep their buffers, so after a warm up the producers don't allocate memory.
+
+   The writer thread takes all the pending messages (up to the batch size)
+   at once, passes them to writeLogEntry() and then calls flushLogEntries(),
+   so that the subclasses can deliver a whole batch to their device with a
+   single write.
+
+   When the ring is full, the overflow policy decides whether new messages
+   are dropped, wait for the writer to free some slots, or are sampled.
+*/
 class LogChannel: public Runnable
 {
    volatile int m_refCount;
@@ -49,6 +62,7 @@ class LogChannel: public Runnable
 
    Mutex m_msg_mtx;
    Event m_message_incoming;
+   Event m_space_free;
    SysThread* m_thread;
 
 protected:
@@ -56,6 +70,18 @@ protected:
    TimeStamp m_ts;
    numeric m_startedAt;
 
+public:
+   /** Behavior of log() when the message ring is full. */
+   typedef enum {
+      /** The message is discarded. */
+      e_overflowDrop,
+      /** The caller waits for the writer thread to free a slot. */
+      e_overflowBlock,
+      /** When the ring is half full, only a message every sampleRate() is accepted;
+          when it's full, the messages are discarded.*/
+      e_overflowSample
+   } t_overflow;
+
 protected:
 
    class LogMessage
@@ -67,7 +93,11 @@ protected:
       int m_level;
       String m_msg;
       uint32 m_code;
-      LogMessage* m_next;
+
+      LogMessage():
+         m_level(0),
+         m_code(0)
+         {}
 
       LogMessage( const String& areaName, const String& modname, const String& caller, int level, const String& msg, uint32 code = 0 ):
          m_areaName( areaName ),
@@ -75,39 +105,83 @@ protected:
          m_caller( caller ),
          m_level( level ),
          m_msg( msg ),
-         m_code( code ),
-         m_next(0)
+         m_code( code )
          {}
    };
 
-   virtual void pushFront( LogMessage* lm );
+   /** Queues a message, waiting for room if the ring is full.
+      The message is copied in the ring and then destroyed.
+   */
    virtual void pushBack( LogMessage* lm );
 
 private:
-   LogMessage* m_msg_head;
-   LogMessage* m_msg_tail;
+   /** Operation of a compiled format segment. */
+   class FormatSegment
+   {
+   public:
+      /** The format code, or 0 for literal text. */
+      uint32 m_op;
+      String m_text;
+   };
+
+   // ring of messages; sequence numbers are masked into the slots.
+   LogMessage* m_ring;
+   uint32 m_capacity;
+   uint32 m_reqCapacity;
+   uint32 m_head;
+   uint32 m_tail;
+   uint32 m_waiters;
+   bool m_bWriterIdle;
+
+   t_overflow m_overflow;
+   uint32 m_sampleRate;
+   uint32 m_sampleCount;
+   uint32 m_dropped;
+   uint32 m_batchSize;
+
    bool m_terminate;
+   bool m_bFormatChanged;
+
+   // writer thread data.
+   FormatSegment* m_segments;
+   uint32 m_segCount;
+   bool m_bRawFormat;
    bool m_bTsReady;
+   bool m_bRfcReady;
+   String m_tsFull;
+   String m_tsRfc;
+   String m_entry;
+
+   void init();
+   void start();
+   LogMessage* claimSlot( bool bForce );
+   void resizeRing();
+   void compileFormat( const String& fmt );
+   void expandMessage( LogMessage* msg, String& target );
+
+protected:
+   uint32 m_level;
+   String m_format;
 
    void updateTS()
    {
       if( ! m_bTsReady )
       {
          m_bTsReady = true;
+         m_bRfcReady = false;
          m_ts.currentTime();
+         m_tsFull.size(0);
+         m_ts.toString( m_tsFull );
       }
    }
 
-   void start();
-   bool expandMessage( LogMessage* msg, const String& fmt, String& target );
-
-protected:
-   uint32 m_level;
-   String m_format;
-
    virtual void stop();
    /** Override this to send a pre-formatted message to the output device */
    virtual void writeLogEntry( const String& entry, LogMessage* pOrigMsg ) = 0;
+   /** Called after a batch of entries has been sent to writeLogEntry().
+      Override this to deliver the entries collected by writeLogEntry() at once.
+   */
+   virtual void flushLogEntries() {}
    virtual ~LogChannel();
 public:
 
@@ -120,6 +194,27 @@ public:
    virtual void setFormat( const String& fmt );
    virtual void getFormat( String& fmt );
 
+   /** Changes the number of messages that can be queued.
+      The size is rounded up to a power of 2; the ring is resized by the
+      writer thread as soon as it's done with the current batch.
+   */
+   void capacity( uint32 size );
+   uint32 capacity();
+
+   inline void overflow( t_overflow policy ) { m_overflow = policy; }
+   inline t_overflow overflow() const { return m_overflow; }
+
+   /** Ratio of messages accepted by e_overflowSample under pressure. */
+   inline void sampleRate( uint32 rate ) { m_sampleRate = rate == 0 ? 1 : rate; }
+   inline uint32 sampleRate() const { return m_sampleRate; }
+
+   /** Maximum number of entries written by the writer thread in a batch. */
+   inline void batchSize( uint32 size ) { m_batchSize = size == 0 ? 1 : size; }
+   inline uint32 batchSize() const { return m_batchSize; }
+
+   /** Count of messages discarded because of the overflow policy. */
+   uint32 dropped();
+
    virtual void incref();
    virtual void decref();
 
@@ -196,7 +291,9 @@ class LogChannelStream: public LogChannel
 protected:
    Stream* m_stream;
    bool m_bFlushAll;
+   String m_batch;
    virtual void writeLogEntry( const String& entry, LogMessage* pOrigMsg );
+   virtual void flushLogEntries();
    virtual ~LogChannelStream();
 
 public:
@@ -213,7 +310,10 @@ class LogChannelFiles: public LogChannel
 {
 private:
    void inner_rotate();
+   void writeBatch();
    TimeStamp m_opendate;
+   String m_batch;
+   int64 m_written;
 
 
 protected:
@@ -230,6 +330,7 @@ protected:
 
    virtual void expandPath( int32 number, String& path );
    virtual void writeLogEntry( const String& entry, LogMessage* pOrigMsg );
+   virtual void flushLogEntries();
    virtual ~LogChannelFiles();
 
 public:
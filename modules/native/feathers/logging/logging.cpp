@@ -239,6 +239,13 @@ FALCON_MODULE_DECL
       addParam("level");
    self->addClassMethod( c_logc, "format", &Falcon::Ext::LogChannel_format ).asSymbol()->
       addParam("format");
+   self->addClassMethod( c_logc, "capacity", &Falcon::Ext::LogChannel_capacity ).asSymbol()->
+      addParam("size");
+   self->addClassMethod( c_logc, "overflow", &Falcon::Ext::LogChannel_overflow ).asSymbol()->
+      addParam("policy")->addParam("rate");
+   self->addClassMethod( c_logc, "batchSize", &Falcon::Ext::LogChannel_batchSize ).asSymbol()->
+      addParam("size");
+   self->addClassMethod( c_logc, "dropped", &Falcon::Ext::LogChannel_dropped );
 
    //====================================
    // Class LogChannelStream
@@ -302,6 +309,10 @@ FALCON_MODULE_DECL
    self->addConstant( "LOGD1", (Falcon::int64) LOGLEVEL_D1 );
    self->addConstant( "LOGD2", (Falcon::int64) LOGLEVEL_D2 );
 
+   self->addConstant( "LOGQ_DROP", (Falcon::int64) Falcon::LogChannel::e_overflowDrop );
+   self->addConstant( "LOGQ_BLOCK", (Falcon::int64) Falcon::LogChannel::e_overflowBlock );
+   self->addConstant( "LOGQ_SAMPLE", (Falcon::int64) Falcon::LogChannel::e_overflowSample );
+
    //======================================
    // Subscribe the service
    //
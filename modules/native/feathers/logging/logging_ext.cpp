@@ -53,7 +53,9 @@ static void s_log( LogArea* a, uint32 lev, VMachine* vm, const String& msg, uint
 FALCON_FUNC  GeneralLog_init( ::Falcon::VMachine *vm )
 {
    CoreCarrier<LogArea>* cc = static_cast< CoreCarrier<LogArea>* >(vm->self().asObject());
-   cc->carried( new LogArea( "general" ) );
+   LogArea* area = new LogArea( "general" );
+   cc->carried( area );
+   area->decref();
 }
 
 // ==============================================
@@ -79,7 +81,9 @@ FALCON_FUNC  LogArea_init( ::Falcon::VMachine *vm )
    }
 
    CoreCarrier<LogArea>* cc = static_cast< CoreCarrier<LogArea>* >(self);
-   cc->carried( new LogArea( *i_aname->asString() ) );
+   LogArea* area = new LogArea( *i_aname->asString() );
+   cc->carried( area );
+   area->decref();
 }
 
 /*#
@@ -336,6 +340,121 @@ FALCON_FUNC  LogChannel_format( ::Falcon::VMachine *vm )
    }
 }
 
+/*#
+   @method capacity LogChannel
+   @brief Gets or set the number of log entries that can be queued.
+   @optparam size the new maximum count of pending entries.
+   @return The current capacity.
+
+   Log entries are queued in a ring of preallocated slots, and rendered
+   by the channel thread. When the channel can't keep up with the log
+   requests, the ring fills up and the @a LogChannel.overflow policy is
+   applied. The size is rounded up to a power of 2; the default is 4096.
+*/
+FALCON_FUNC  LogChannel_capacity( ::Falcon::VMachine *vm )
+{
+   Item *i_size = vm->param(0);
+   CoreCarrier<LogChannel>* cc = (CoreCarrier<LogChannel>*)(vm->self().asObject());
+
+   vm->retval( (int64) cc->carried()->capacity() );
+
+   if( i_size != 0 )
+   {
+      if (! i_size->isOrdinal() || i_size->forceInteger() <= 0 )
+      {
+         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+               .origin(e_orig_runtime)
+               .extra( "N>0" ) );
+      }
+
+      cc->carried()->capacity( (uint32) i_size->forceInteger() );
+   }
+}
+
+/*#
+   @method overflow LogChannel
+   @brief Gets or set what happens to the log entries when the channel queue is full.
+   @optparam policy One of LOGQ_BLOCK, LOGQ_DROP or LOGQ_SAMPLE.
+   @optparam rate Sampling rate for the LOGQ_SAMPLE policy.
+   @return The current policy.
+
+   - @b LOGQ_BLOCK: the thread logging the entry waits for the channel to
+     render the pending entries. This is the default, and no entry is lost.
+   - @b LOGQ_DROP: entries exceeding the @a LogChannel.capacity are discarded.
+   - @b LOGQ_SAMPLE: when the queue is half full, only one entry out of
+     @b rate (10 by default) is accepted; when it's full, entries are discarded.
+
+   Discarded entries are counted by @a LogChannel.dropped.
+*/
+FALCON_FUNC  LogChannel_overflow( ::Falcon::VMachine *vm )
+{
+   Item *i_policy = vm->param(0);
+   Item *i_rate = vm->param(1);
+   CoreCarrier<LogChannel>* cc = (CoreCarrier<LogChannel>*)(vm->self().asObject());
+
+   vm->retval( (int64) cc->carried()->overflow() );
+
+   if( i_policy != 0 )
+   {
+      if (! i_policy->isOrdinal()
+          || i_policy->forceInteger() < (int64) LogChannel::e_overflowDrop
+          || i_policy->forceInteger() > (int64) LogChannel::e_overflowSample
+          || ( i_rate != 0 && ! i_rate->isOrdinal() ) )
+      {
+         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+               .origin(e_orig_runtime)
+               .extra( "N,[N]" ) );
+      }
+
+      if( i_rate != 0 )
+         cc->carried()->sampleRate( (uint32) i_rate->forceInteger() );
+      cc->carried()->overflow( (LogChannel::t_overflow) i_policy->forceInteger() );
+   }
+}
+
+/*#
+   @method batchSize LogChannel
+   @brief Gets or set the maximum number of entries written at once.
+   @optparam size The new batch size.
+   @return The current batch size.
+
+   The channel thread takes all the pending entries, up to this size, and
+   sends them to the underlying device as a single write; streams and
+   files are flushed (if required) once per batch. A size of 1 writes
+   each entry separately. The default is 256.
+*/
+FALCON_FUNC  LogChannel_batchSize( ::Falcon::VMachine *vm )
+{
+   Item *i_size = vm->param(0);
+   CoreCarrier<LogChannel>* cc = (CoreCarrier<LogChannel>*)(vm->self().asObject());
+
+   vm->retval( (int64) cc->carried()->batchSize() );
+
+   if( i_size != 0 )
+   {
+      if (! i_size->isOrdinal() || i_size->forceInteger() <= 0 )
+      {
+         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+               .origin(e_orig_runtime)
+               .extra( "N>0" ) );
+      }
+
+      cc->carried()->batchSize( (uint32) i_size->forceInteger() );
+   }
+}
+
+/*#
+   @method dropped LogChannel
+   @brief Returns the count of entries discarded by the overflow policy.
+   @return Number of entries that this channel didn't log.
+   @see LogChannel.overflow
+*/
+FALCON_FUNC  LogChannel_dropped( ::Falcon::VMachine *vm )
+{
+   CoreCarrier<LogChannel>* cc = (CoreCarrier<LogChannel>*)(vm->self().asObject());
+   vm->retval( (int64) cc->carried()->dropped() );
+}
+
 /*#
    @class LogChannelStream
    @brief Logs on an open stream.
@@ -369,14 +488,18 @@ FALCON_FUNC  LogChannelStream_init( ::Falcon::VMachine *vm )
    Stream* s = static_cast<Stream*>(i_stream->asObjectSafe()->getFalconData());
    uint32 l = (uint32) i_level->forceInteger();
 
+   LogChannelStream* lcs;
    if( i_format == 0 )
    {
-      cc->carried( new LogChannelStream(static_cast<Stream*>(s->clone()), l) );
+      lcs = new LogChannelStream(static_cast<Stream*>(s->clone()), l);
    }
    else
    {
-      cc->carried( new LogChannelStream(static_cast<Stream*>(s->clone()), *i_format->asString(), l) );
+      lcs = new LogChannelStream(static_cast<Stream*>(s->clone()), *i_format->asString(), l);
    }
+   // the carrier holds the only reference.
+   cc->carried( lcs );
+   lcs->decref();
 }
 
 /*#
@@ -386,9 +509,9 @@ FALCON_FUNC  LogChannelStream_init( ::Falcon::VMachine *vm )
    @return The current status setting.
 
    Stream based channels are usually writing data on buffered streams.
-   The default behavior is that of flushing the buffer as soon as a log line is
-   written. For some tasks where a large amount of log is written, this may
-   be an overkill.
+   The default behavior is that of flushing the buffer as soon as a batch of
+   log lines is written (see @a LogChannel.batchSize). For some tasks where a
+   large amount of log is written, this may be an overkill.
 */
 FALCON_FUNC  LogChannelStream_flushAll( ::Falcon::VMachine *vm )
 {
@@ -458,7 +581,9 @@ FALCON_FUNC  LogChannelSyslog_init( ::Falcon::VMachine *vm )
 
    try
    {
-	   cc->carried( new LogChannelSyslog(*i_identity->asString(), f, l) );
+	   LogChannelSyslog* lcs = new LogChannelSyslog(*i_identity->asString(), f, l);
+	   cc->carried( lcs );
+	   lcs->decref();
 
        if( i_format != 0 )
 	      cc->carried()->setFormat( *i_format->asString() );
@@ -618,6 +743,7 @@ FALCON_FUNC  LogChannelFiles_init( ::Falcon::VMachine *vm )
 
    CoreCarrier<LogChannelFiles>* cc = static_cast< CoreCarrier<LogChannelFiles>* >( vm->self().asObject() );
    cc->carried( lcf );
+   lcf->decref();
 }
 
 /*#
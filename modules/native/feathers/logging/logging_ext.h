@@ -49,6 +49,10 @@ FALCON_FUNC  GeneralLog_init( ::Falcon::VMachine *vm );
 FALCON_FUNC  LogChannel_init( ::Falcon::VMachine *vm );
 FALCON_FUNC  LogChannel_level( ::Falcon::VMachine *vm );
 FALCON_FUNC  LogChannel_format( ::Falcon::VMachine *vm );
+FALCON_FUNC  LogChannel_capacity( ::Falcon::VMachine *vm );
+FALCON_FUNC  LogChannel_overflow( ::Falcon::VMachine *vm );
+FALCON_FUNC  LogChannel_batchSize( ::Falcon::VMachine *vm );
+FALCON_FUNC  LogChannel_dropped( ::Falcon::VMachine *vm );
 
 FALCON_FUNC  LogChannelStream_init( ::Falcon::VMachine *vm );
 FALCON_FUNC  LogChannelStream_flushAll( ::Falcon::VMachine *vm );
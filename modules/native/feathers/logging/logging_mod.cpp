@@ -41,7 +41,7 @@ bool LogChannelFilesCarrier::setProperty( const String &prop, const Item &value
    else if ( prop == "overwrite" )
       carried()->overwrite( value.isTrue() );
    else if ( prop == "flushAll" )
-      carried()->overwrite( value.isTrue() );
+      carried()->flushAll( value.isTrue() );
    else
       return CoreCarrier<LogChannelFiles>::setProperty( prop, value );
 
@@ -59,7 +59,7 @@ bool LogChannelFilesCarrier::getProperty( const String &prop, Item &ret ) const
    else if ( prop == "overwrite" )
      ret = carried()->overwrite();
    else if ( prop == "flushAll" )
-     ret =  carried()->overwrite();
+     ret =  carried()->flushAll();
    else if ( prop == "path" )
      ret = new CoreString(carried()->path());
    else
@@ -25,26 +25,39 @@
 
 namespace Falcon {
 
+#define LOGCHANNEL_DEFAULT_CAPACITY   4096
+#define LOGCHANNEL_DEFAULT_BATCH      256
+#define LOGCHANNEL_DEFAULT_SAMPLE     10
+
+// Copies a string reusing the buffer of the target.
+static inline void s_assign( String& target, const String& source )
+{
+   target.size(0);
+   target.append( source );
+}
+
+static uint32 s_roundCapacity( uint32 size )
+{
+   uint32 cap = 2;
+   while( cap < size && cap < 0x40000000 )
+      cap <<= 1;
+   return cap;
+}
+
 LogChannel::LogChannel( uint32 l ):
    m_refCount( 1 ),
-   m_msg_head(0),
-   m_msg_tail(0),
-   m_terminate(false),
    m_level( l )
    {
-      m_startedAt = Sys::Time::seconds();
+      init();
       start();
    }
 
 LogChannel::LogChannel( const String &format, uint32 l ):
    m_refCount( 1 ),
-   m_msg_head(0),
-   m_msg_tail(0),
-   m_terminate(false),
    m_level( l ),
    m_format(format)
    {
-      m_startedAt = Sys::Time::seconds();
+      init();
       start();
    }
 
@@ -53,12 +66,36 @@ LogChannel::~LogChannel()
 {
    stop();
 
-   while( m_msg_head !=0 )
-   {
-      LogMessage* lm = m_msg_head;
-      m_msg_head = m_msg_head->m_next;
-      delete lm;
-   }
+   delete[] m_ring;
+   delete[] m_segments;
+}
+
+void LogChannel::init()
+{
+   m_startedAt = Sys::Time::seconds();
+
+   m_capacity = LOGCHANNEL_DEFAULT_CAPACITY;
+   m_reqCapacity = 0;
+   m_ring = new LogMessage[ m_capacity ];
+   m_head = 0;
+   m_tail = 0;
+   m_waiters = 0;
+   m_bWriterIdle = false;
+
+   m_overflow = e_overflowBlock;
+   m_sampleRate = LOGCHANNEL_DEFAULT_SAMPLE;
+   m_sampleCount = 0;
+   m_dropped = 0;
+   m_batchSize = LOGCHANNEL_DEFAULT_BATCH;
+
+   m_terminate = false;
+   m_bFormatChanged = false;
+
+   m_segments = 0;
+   m_segCount = 0;
+   m_bTsReady = false;
+   m_bRfcReady = false;
+   compileFormat( m_format );
 }
 
 void LogChannel::start()
@@ -73,8 +110,9 @@ void LogChannel::stop()
    {
       m_msg_mtx.lock();
       m_terminate = true;
-      m_message_incoming.set();
       m_msg_mtx.unlock();
+      m_message_incoming.set();
+      m_space_free.set();
 
       void* res;
       m_thread->join( res );
@@ -101,111 +139,188 @@ void LogChannel::log( LogArea* area, uint32 level, const String& msg, uint32 cod
    log( area->name(), "", level, msg, code );
 }
 
+
+LogChannel::LogMessage* LogChannel::claimSlot( bool bForce )
+{
+   // to be called with m_msg_mtx locked.
+   while( ! m_terminate && m_tail - m_head >= m_capacity )
+   {
+      if( ! bForce && m_overflow != e_overflowBlock )
+      {
+         ++m_dropped;
+         return 0;
+      }
+
+      ++m_waiters;
+      m_msg_mtx.unlock();
+      m_space_free.wait(-1);
+      m_msg_mtx.lock();
+      --m_waiters;
+   }
+
+   if ( m_terminate )
+   {
+      // let the other waiters go.
+      if( m_waiters > 0 )
+         m_space_free.set();
+      return 0;
+   }
+
+   if( ! bForce && m_overflow == e_overflowSample && (m_tail - m_head) * 2 >= m_capacity )
+   {
+      if( ++m_sampleCount < m_sampleRate )
+      {
+         ++m_dropped;
+         return 0;
+      }
+      m_sampleCount = 0;
+   }
+
+   // more room for the others?
+   if( m_waiters > 0 && m_tail - m_head + 1 < m_capacity )
+      m_space_free.set();
+
+   return m_ring + (m_tail++ & (m_capacity - 1));
+}
+
+
 void LogChannel::log( const String& area, const String& mod, const String& func, uint32 l, const String& msg, uint32 code )
 {
    if ( l <= m_level )
    {
       // delegate formatting to the other thread.
-      LogMessage* lmsg = new LogMessage( area, mod, func, l, msg, code );
-
       m_msg_mtx.lock();
-      if ( m_terminate)
+      LogMessage* slot = claimSlot( false );
+      if( slot == 0 )
       {
-         delete lmsg;
          m_msg_mtx.unlock();
          return;
       }
 
-      if ( m_msg_tail == 0 )
-      {
-         m_msg_head = m_msg_tail = lmsg;
-      }
-      else
-      {
-         m_msg_tail->m_next = lmsg;
-         m_msg_tail = lmsg;
-      }
+      s_assign( slot->m_areaName, area );
+      s_assign( slot->m_modName, mod );
+      s_assign( slot->m_caller, func );
+      s_assign( slot->m_msg, msg );
+      slot->m_level = l;
+      slot->m_code = code;
+
+      bool bWake = m_bWriterIdle;
+      m_bWriterIdle = false;
       m_msg_mtx.unlock();
-      m_message_incoming.set();
+
+      if( bWake )
+         m_message_incoming.set();
    }
 }
 
 
-void LogChannel::pushFront( LogMessage* lmsg )
+void LogChannel::pushBack( LogMessage* lmsg )
 {
    m_msg_mtx.lock();
-   if ( m_msg_tail == 0 )
+   LogMessage* slot = claimSlot( true );
+   if( slot != 0 )
    {
-      m_msg_head = m_msg_tail = lmsg;
-   }
-   else
-   {
-      lmsg->m_next = m_msg_head;
-      m_msg_head = lmsg;
+      *slot = *lmsg;
    }
+   bool bWake = m_bWriterIdle;
+   m_bWriterIdle = false;
    m_msg_mtx.unlock();
-   m_message_incoming.set();
+   delete lmsg;
+
+   if( bWake )
+      m_message_incoming.set();
 }
 
 
-void LogChannel::pushBack( LogMessage* lmsg )
+void LogChannel::resizeRing()
 {
-   m_msg_mtx.lock();
-   if ( m_msg_tail == 0 )
-   {
-      m_msg_head = m_msg_tail = lmsg;
-   }
-   else
+   // to be called with m_msg_mtx locked, while the writer holds no slot.
+   uint32 pending = m_tail - m_head;
+   uint32 cap = m_reqCapacity;
+   while( cap < pending )
+      cap <<= 1;
+
+   LogMessage* ring = new LogMessage[ cap ];
+   for( uint32 i = 0; i < pending; ++i )
    {
-      m_msg_tail->m_next = lmsg;
-      m_msg_tail = lmsg;
+      ring[i] = m_ring[ (m_head + i) & (m_capacity - 1) ];
    }
-   m_msg_mtx.unlock();
-   m_message_incoming.set();
-}
 
+   delete[] m_ring;
+   m_ring = ring;
+   m_capacity = cap;
+   m_reqCapacity = 0;
+   m_head = 0;
+   m_tail = pending;
+
+   if( m_waiters > 0 )
+      m_space_free.set();
+}
 
 
 void* LogChannel::run()
 {
+   String fmt;
+
+   m_msg_mtx.lock();
    while( true )
    {
-      m_message_incoming.wait(-1);
-      m_msg_mtx.lock();
-      if( m_terminate )
+      if( m_reqCapacity != 0 )
+         resizeRing();
+
+      uint32 count = m_tail - m_head;
+      if( count == 0 )
       {
+         // flush what's left on exit
+         if( m_terminate )
+            break;
+
+         m_bWriterIdle = true;
          m_msg_mtx.unlock();
-         break;
+         m_message_incoming.wait(-1);
+         m_msg_mtx.lock();
+         continue;
       }
 
-      // copy the format for multiple usage
-      String fmt = m_format;
-      m_bTsReady = false;
-      while( m_msg_head !=0 )
+      if( count > m_batchSize )
+         count = m_batchSize;
+      uint32 first = m_head;
+
+      bool bCompile = m_bFormatChanged;
+      if( bCompile )
       {
-         LogMessage* msg = m_msg_head;
-         m_msg_head = m_msg_head->m_next;
-         if ( m_msg_head == 0 )
-            m_msg_tail = 0;
-         m_msg_mtx.unlock();
+         fmt = m_format;
+         m_bFormatChanged = false;
+      }
+      m_msg_mtx.unlock();
 
-         String target;
-         if( expandMessage( msg, fmt, target ) )
+      // the slots up to first + count are ours until we give them back.
+      if( bCompile )
+         compileFormat( fmt );
+
+      m_bTsReady = false;
+      for( uint32 i = 0; i < count; ++i )
+      {
+         LogMessage* msg = m_ring + ((first + i) & (m_capacity - 1));
+         if( m_bRawFormat )
          {
-            writeLogEntry( target, msg );
+            writeLogEntry( msg->m_msg, msg );
          }
          else
          {
-            writeLogEntry( msg->m_msg, msg );
+            expandMessage( msg, m_entry );
+            writeLogEntry( m_entry, msg );
          }
-
-         delete msg;
-         m_msg_mtx.lock();
       }
+      flushLogEntries();
 
-      m_msg_mtx.unlock();
+      m_msg_mtx.lock();
+      m_head += count;
+      if( m_waiters > 0 )
+         m_space_free.set();
    }
 
+   m_msg_mtx.unlock();
    return 0;
 }
 
@@ -214,6 +329,7 @@ void LogChannel::setFormat( const String& fmt )
 {
    m_msg_mtx.lock();
    m_format = fmt;
+   m_bFormatChanged = true;
    m_msg_mtx.unlock();
 }
 
@@ -226,123 +342,205 @@ void LogChannel::getFormat( String& fmt )
 }
 
 
-bool LogChannel::expandMessage( LogMessage* msg, const String& fmt, String& target )
+void LogChannel::capacity( uint32 size )
 {
+   m_msg_mtx.lock();
+   m_reqCapacity = s_roundCapacity( size );
+   bool bWake = m_bWriterIdle;
+   m_bWriterIdle = false;
+   m_msg_mtx.unlock();
 
-   if ( fmt == "" || fmt == "%m" )
-      return false;
+   if( bWake )
+      m_message_incoming.set();
+}
+
+
+uint32 LogChannel::capacity()
+{
+   m_msg_mtx.lock();
+   uint32 cap = m_reqCapacity != 0 ? m_reqCapacity : m_capacity;
+   m_msg_mtx.unlock();
+   return cap;
+}
+
+
+uint32 LogChannel::dropped()
+{
+   m_msg_mtx.lock();
+   uint32 dropped = m_dropped;
+   m_msg_mtx.unlock();
+   return dropped;
+}
 
-   target = fmt;
-   uint32 pos = target.find( "%" );
-   numeric distance;
 
-   while( pos != String::npos )
+void LogChannel::compileFormat( const String& fmt )
+{
+   delete[] m_segments;
+   m_segments = 0;
+   m_segCount = 0;
+
+   m_bRawFormat = fmt == "" || fmt == "%m";
+   if ( m_bRawFormat )
+      return;
+
+   // at worst, each code is a segment, and each code is preceded by some text.
+   uint32 len = fmt.length();
+   m_segments = new FormatSegment[ len + 1 ];
+   FormatSegment* text = 0;
+
+   uint32 pos = 0;
+   while( pos < len )
    {
-      String temp;
+      uint32 chr = fmt.getCharAt( pos++ );
+      if( chr == '%' )
+      {
+         if( pos == len )
+         {
+            chr = 0;
+         }
+         else
+         {
+            chr = fmt.getCharAt( pos++ );
+         }
+
+         switch( chr )
+         {
+         case 't': case 'T': case 'd': case 'R': case 'S': case 's':
+         case 'c': case 'C': case 'a': case 'M': case 'f': case 'm':
+         case 'l': case 'L':
+            m_segments[ m_segCount++ ].m_op = chr;
+            text = 0;
+            continue;
+
+         case 0:
+            if ( text == 0 )
+            {
+               text = m_segments + m_segCount++;
+               text->m_op = 0;
+            }
+            text->m_text.append( "<?>" );
+            continue;
+
+         case '%':
+            break;
 
-      if( pos + 1 == target.length() )
+         default:
+            // unknown codes are left as they are.
+            if ( text == 0 )
+            {
+               text = m_segments + m_segCount++;
+               text->m_op = 0;
+            }
+            text->m_text.append( '%' );
+            break;
+         }
+      }
+
+      if ( text == 0 )
       {
-         target.change(pos,"<?>");
-         return true;
+         text = m_segments + m_segCount++;
+         text->m_op = 0;
       }
+      text->m_text.append( chr );
+   }
+}
+
+
+void LogChannel::expandMessage( LogMessage* msg, String& target )
+{
+   numeric distance;
 
-      uint32 chr = target.getCharAt( pos + 1 );
-      switch( chr )
+   target.size(0);
+   for( uint32 i = 0; i < m_segCount; ++i )
+   {
+      const FormatSegment& seg = m_segments[i];
+      switch( seg.m_op )
       {
+      case 0:
+         target.append( seg.m_text );
+         break;
+
       case 't':
          updateTS();
-         m_ts.toString( temp );
-         target.change( pos, pos + 2, temp.subString(11) );
+         target.append( m_tsFull.subString(11) );
          break;
 
       case 'T':
          updateTS();
-         m_ts.toString( temp );
-         target.change( pos, pos + 2, temp );
+         target.append( m_tsFull );
          break;
 
       case 'd':
          updateTS();
-         m_ts.toString( temp );
-         target.change( pos, pos + 2, temp.subString(0,10) );
+         target.append( m_tsFull.subString(0,10) );
          break;
 
       case 'R':
          updateTS();
-         m_ts.toRFC2822( temp );
-         target.change( pos, pos + 2, temp );
+         if( ! m_bRfcReady )
+         {
+            m_bRfcReady = true;
+            m_tsRfc.size(0);
+            m_ts.toRFC2822( m_tsRfc );
+         }
+         target.append( m_tsRfc );
          break;
 
       case 'S':
          distance = Sys::Time::seconds() - m_startedAt;
-         temp.writeNumber( distance, "%.3f" );
-         target.change( pos, pos + 2, temp );
+         target.writeNumber( distance, "%.3f" );
          break;
 
       case 's':
          distance = Sys::Time::seconds() - m_startedAt;
-         temp.writeNumber( (int64) (distance*1000), "%d" );
-         target.change( pos, pos + 2, temp );
+         target.writeNumber( (int64) (distance*1000), "%d" );
          break;
 
       case 'c':
-       temp.writeNumber( (int64) msg->m_code );
-         target.change( pos, pos + 2, temp );
+         target.writeNumber( (int64) msg->m_code );
          break;
 
       case 'C':
-         temp.writeNumber( (int64) msg->m_code );
          {
-            for( int i = temp.length(); i < 5; i ++ )
-               temp.prepend( '0' );
+            uint32 digits = 1;
+            for( uint32 code = msg->m_code; code >= 10; code /= 10 )
+               ++digits;
+            for( ; digits < 5; ++digits )
+               target.append( '0' );
          }
-         target.change( pos, pos + 2, temp );
+         target.writeNumber( (int64) msg->m_code );
          break;
 
       case 'a':
-         target.change( pos, pos + 2, msg->m_areaName );
-         pos += msg->m_areaName.length();
+         target.append( msg->m_areaName );
          break;
 
       case 'M':
-         target.change( pos, pos + 2, msg->m_modName );
-         pos += msg->m_modName.length();
+         target.append( msg->m_modName );
          break;
 
       case 'f':
-         target.change( pos, pos + 2, msg->m_caller );
-         pos += msg->m_caller.length();
+         target.append( msg->m_caller );
          break;
 
       case 'm':
-         target.change( pos, pos + 2, msg->m_msg );
-         pos += msg->m_msg.length();
+         target.append( msg->m_msg );
          break;
 
       case 'l':
-         temp.writeNumber( (int64) msg->m_level );
-         target.change( pos, pos + 2, temp );
-         pos += temp.length();
+         target.writeNumber( (int64) msg->m_level );
          break;
 
       case 'L':
          switch( msg->m_level )
          {
-            case LOGLEVEL_FATAL: temp = "L"; break;
-            case LOGLEVEL_ERROR: temp = "E"; break;
-            case LOGLEVEL_WARN: temp = "W"; break;
-            case LOGLEVEL_INFO: temp = "I"; break;
-            case LOGLEVEL_DEBUG: temp = "D"; break;
-            default: temp = "l";
+            case LOGLEVEL_FATAL: target.append( 'L' ); break;
+            case LOGLEVEL_ERROR: target.append( 'E' ); break;
+            case LOGLEVEL_WARN: target.append( 'W' ); break;
+            case LOGLEVEL_INFO: target.append( 'I' ); break;
+            case LOGLEVEL_DEBUG: target.append( 'D' ); break;
+            default: target.append( 'l' );
          }
-
-         target.change( pos, pos + 2, temp );
-         pos += temp.length();
-         break;
-
-      case '%':
-         target.change( pos, pos + 2, "%" );
-         ++pos;
          break;
 
       /*
@@ -356,27 +554,9 @@ bool LogChannel::expandMessage( LogMessage* msg, const String& fmt, String& targ
       - %xm: current minute, 2 characters.
       - %xs: Current second, 2 characters.
       - %xS: Current millisecond, 3 characters.
-      case 'x':
-         // we have another character.
-         if( pos + 2 >= target.length() )
-         {
-            target.change( pos , "<?>" );
-            return true;
-         }
-
-         chr = target.getCharAt( pos + 2 );
-         switch( chr )
-         {
-            case 'y': updateTS(); temp.write( m_ts.m_year ); break;
-         }
-         */
+      */
       }
-
-      pos = target.find( "%", pos );
-
    }
-
-   return true;
 }
 
 //==========================================================
@@ -482,6 +662,7 @@ void LogArea::removeChannel( LogChannel* chn )
          delete cc;
          break;
       }
+      cc = cc->m_next;
    }
    m_mtx_chan.unlock();
 }
@@ -504,8 +685,14 @@ LogChannelStream::LogChannelStream( Stream* s, const String &fmt, int level ):
 
 void LogChannelStream::writeLogEntry( const String& entry, LogChannel::LogMessage* )
 {
-   m_stream->writeString(entry);
-   m_stream->writeString("\n");
+   m_batch.append( entry );
+   m_batch.append( '\n' );
+}
+
+void LogChannelStream::flushLogEntries()
+{
+   m_stream->writeString( m_batch );
+   m_batch.size(0);
 
    if( m_bFlushAll )
       m_stream->flush();
@@ -532,6 +719,7 @@ LogChannelFiles::LogChannelFiles( const String& path, int level ):
    m_maxDays( 0 ),
    m_isOpen( false )
 {
+   m_written = 0;
 
 }
 
@@ -547,6 +735,7 @@ LogChannelFiles::LogChannelFiles( const String& path, const String &fmt, int lev
    m_maxDays( 0 ),
    m_isOpen( false )
 {
+   m_written = 0;
 
 }
 
@@ -583,7 +772,10 @@ void LogChannelFiles::open()
    {
       // can we open it?
       if( m_stream->open( fname, FileStream::e_omReadWrite ) )
+      {
+         m_written = m_stream->seekEnd( 0 );
          return;
+      }
    }
 
    // ok try to create
@@ -596,6 +788,7 @@ void LogChannelFiles::open()
             .extra( fname )
             .sysError( (int32) m_stream->lastError() ) );
    }
+   m_written = 0;
 }
 
 
@@ -636,7 +829,7 @@ void LogChannelFiles::expandPath( int32 number, String& path )
 
       while( temp.length() < count )
       {
-         temp.prepend(0);
+         temp.prepend('0');
       }
    }
 
@@ -672,6 +865,8 @@ void LogChannelFiles::writeLogEntry( const String& entry, LogMessage* pOrigMsg )
    // if the source of the message is ".", then we have a special order
    if( pOrigMsg->m_caller == "." )
    {
+      writeBatch();
+
       // roll?
       if ( pOrigMsg->m_code == 1 )
       {
@@ -684,18 +879,19 @@ void LogChannelFiles::writeLogEntry( const String& entry, LogMessage* pOrigMsg )
       else
       {
          m_stream->truncate(0);
+         m_written = 0;
       }
 
       return;
    }
 
-   // for now, just write.
-   // TODO roll files.
-   m_stream->writeString( entry );
-   m_stream->writeString( "\n" );
+   // entries are collected and written at the end of the batch.
+   m_batch.append( entry );
+   m_batch.append( '\n' );
 
-   if( m_maxSize > 0 && m_stream->tell() > m_maxSize )
+   if( m_maxSize > 0 && m_written + m_batch.size() > m_maxSize )
    {
+      writeBatch();
       m_stream->flush();
       inner_rotate();
    }
@@ -703,32 +899,51 @@ void LogChannelFiles::writeLogEntry( const String& entry, LogMessage* pOrigMsg )
    {
       TimeStamp maxDate = m_opendate;
       maxDate.add( m_maxDays );
-      // are we greater than the last calculated timestamp?
-      if( maxDate.compare( m_ts ) > 0 )
+      // are we past the lifetime of this file?
+      updateTS();
+      if( maxDate.compare( m_ts ) < 0 )
       {
+         writeBatch();
          m_stream->flush();
          inner_rotate();
          m_opendate.currentTime();
       }
    }
-   else if ( m_bFlushAll )
-   {
+}
+
+
+void LogChannelFiles::flushLogEntries()
+{
+   writeBatch();
+
+   if ( m_bFlushAll )
       m_stream->flush();
+}
+
+
+void LogChannelFiles::writeBatch()
+{
+   if( m_batch.size() != 0 )
+   {
+      m_stream->writeString( m_batch );
+      m_batch.size(0);
+      m_written = m_stream->tell();
    }
 }
 
 
 void LogChannelFiles::inner_rotate()
 {
+   m_written = 0;
 
    if ( m_maxCount > 0 )
    {
       m_stream->close();
       delete m_stream;
 
-      // find the maximum file
+      // find the first free position; the oldest file is overwritten.
       int maxNum;
-      for( maxNum = 1; maxNum <= m_maxCount; maxNum++ )
+      for( maxNum = 1; maxNum < m_maxCount; maxNum++ )
       {
          FileStat::e_fileType ft;
          String fname;
@@ -741,8 +956,8 @@ void LogChannelFiles::inner_rotate()
       while( maxNum > 0 )
       {
          String from, into;
-         expandPath( maxNum, from );
-         expandPath( --maxNum, into );
+         expandPath( maxNum, into );
+         expandPath( --maxNum, from );
 
          int32 fsStatus;
          Sys::fal_move( from, into, fsStatus );
@@ -22,6 +22,7 @@
 
 #include "mxml.h"
 #include "mxml_ext.h"
+#include "mxml_mod.h"
 #include "mxml_st.h"
 
 /*#
@@ -262,6 +263,36 @@ FALCON_MODULE_DECL
    self->addClassMethod( c_node, "path", Falcon::Ext::MXMLNode_path );
    self->addClassMethod( c_node, "clone", Falcon::Ext::MXMLNode_clone );
 
+   //=================================================================
+   // Enumeration reader event.
+   //
+   Falcon::Symbol *c_event = self->addClass( "MXMLEvent" );
+   self->addClassProperty( c_event, "start" ).setInteger( Falcon::Ext::ReaderCarrier::evStart ).setReadOnly( true );
+   self->addClassProperty( c_event, "close" ).setInteger( Falcon::Ext::ReaderCarrier::evClose ).setReadOnly( true );
+   self->addClassProperty( c_event, "data" ).setInteger( Falcon::Ext::ReaderCarrier::evData ).setReadOnly( true );
+   self->addClassProperty( c_event, "CDATA" ).setInteger( Falcon::Ext::ReaderCarrier::evCDATA ).setReadOnly( true );
+   self->addClassProperty( c_event, "comment" ).setInteger( Falcon::Ext::ReaderCarrier::evComment ).setReadOnly( true );
+   self->addClassProperty( c_event, "PI" ).setInteger( Falcon::Ext::ReaderCarrier::evPI ).setReadOnly( true );
+   self->addClassProperty( c_event, "directive" ).setInteger( Falcon::Ext::ReaderCarrier::evDirective ).setReadOnly( true );
+   self->addClassProperty( c_event, "decl" ).setInteger( Falcon::Ext::ReaderCarrier::evDecl ).setReadOnly( true );
+
+   //=================================================================
+   // Class reader
+   //
+   Falcon::Symbol *c_reader = self->addClass( "MXMLReader", Falcon::Ext::MXMLReader_init );
+   self->addClassMethod( c_reader, "next", Falcon::Ext::MXMLReader_next );
+   self->addClassMethod( c_reader, "name", Falcon::Ext::MXMLReader_name );
+   self->addClassMethod( c_reader, "data", Falcon::Ext::MXMLReader_data );
+   self->addClassMethod( c_reader, "getAttribute", Falcon::Ext::MXMLReader_getAttribute ).asSymbol()->
+      addParam("attribute");
+   self->addClassMethod( c_reader, "getAttribs", Falcon::Ext::MXMLReader_getAttribs );
+   self->addClassMethod( c_reader, "path", Falcon::Ext::MXMLReader_path );
+   self->addClassMethod( c_reader, "depth", Falcon::Ext::MXMLReader_depth );
+   self->addClassMethod( c_reader, "line", Falcon::Ext::MXMLReader_line );
+   self->addClassMethod( c_reader, "subtree", Falcon::Ext::MXMLReader_subtree );
+   self->addClassMethod( c_reader, "find", Falcon::Ext::MXMLReader_find ).asSymbol()->
+      addParam("path");
+
    //============================================================
    // MXML Error class
    Falcon::Symbol *error_class = self->addExternalRef( "Error" ); // it's external
@@ -0,0 +1,356 @@
+/*
+   Mini XML lib PLUS for C++
+
+   Arena class
+
+   Author: agent
+*/
+
+#include <mxml_arena.h>
+#include <mxml_element.h>
+
+#include <falcon/memory.h>
+#include <falcon/mt.h>
+
+#include <string.h>
+
+// size of the blocks where the elements are allocated; the first blocks
+// are smaller, so that small trees don't take much memory.
+#define ARENA_BLOCK_SIZE      65536
+#define ARENA_FIRST_BLOCK     2048
+// bigger allocations get a block of their own
+#define ARENA_BIG_ALLOC       (ARENA_BLOCK_SIZE/4)
+#define ARENA_ALIGN           8
+#define ARENA_NAMES_SIZE      64
+
+namespace MXML {
+
+class Arena::Block
+{
+public:
+   Block *m_next;
+   // 64 bits, to keep the memory following the block header aligned.
+   Falcon::int64 m_size;
+};
+
+class Arena::Name
+{
+public:
+   Falcon::byte *m_data;
+   Falcon::uint32 m_hash;
+   Falcon::uint32 m_count;
+   Falcon::uint32 m_charSize;
+};
+
+/** Header placed before the memory of the elements.
+   It records the arena the element has been allocated in, or 0.
+*/
+union ElementHeader
+{
+   Arena *m_arena;
+   Falcon::int64 m_align;
+};
+
+
+Arena::Arena():
+   m_blocks( 0 ),
+   m_free( 0 ),
+   m_avail( 0 ),
+   m_blockSize( ARENA_FIRST_BLOCK ),
+   m_names( 0 ),
+   m_namesSize( 0 ),
+   m_namesCount( 0 ),
+   m_refCount( 1 ),
+   m_bTouched( false )
+{
+}
+
+Arena::~Arena()
+{
+   Block *block = m_blocks;
+   while( block != 0 )
+   {
+      Block *next = block->m_next;
+      freeBlock( block );
+      block = next;
+   }
+
+   if ( m_names != 0 )
+      Falcon::memFree( m_names );
+}
+
+Arena::Block *Arena::allocBlock( Falcon::uint32 size )
+{
+   // the garbage collector must know how much memory is held by the nodes.
+   Falcon::gcMemAccount( sizeof( Block ) + size );
+   Block *block = (Block *) Falcon::memAlloc( sizeof( Block ) + size );
+   block->m_size = size;
+   return block;
+}
+
+void Arena::freeBlock( Block *block )
+{
+   Falcon::gcMemUnaccount( sizeof( Block ) + (Falcon::uint32) block->m_size );
+   Falcon::memFree( block );
+}
+
+void Arena::incref()
+{
+   Falcon::atomicInc( m_refCount );
+}
+
+void Arena::decref()
+{
+   if ( Falcon::atomicDec( m_refCount ) == 0 )
+      delete this;
+}
+
+
+void *Arena::alloc( Falcon::uint32 size )
+{
+   size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+   if ( size > m_avail )
+   {
+      if ( size > ARENA_BIG_ALLOC )
+      {
+         // link it after the current block, which is still in use.
+         Block *big = allocBlock( size );
+         if ( m_blocks == 0 )
+         {
+            big->m_next = 0;
+            m_blocks = big;
+         }
+         else {
+            big->m_next = m_blocks->m_next;
+            m_blocks->m_next = big;
+         }
+         return big + 1;
+      }
+
+      Falcon::uint32 blockSize = m_blockSize;
+      while( blockSize < size )
+         blockSize *= 2;
+      if ( m_blockSize < ARENA_BLOCK_SIZE )
+         m_blockSize *= 2;
+
+      Block *block = allocBlock( blockSize );
+      block->m_next = m_blocks;
+      m_blocks = block;
+      m_free = (Falcon::byte *) (block + 1);
+      m_avail = blockSize;
+   }
+
+   void *mem = m_free;
+   m_free += size;
+   m_avail -= size;
+   return mem;
+}
+
+
+void Arena::reset()
+{
+   // the current block is the first in the list, unless only big blocks were allocated.
+   Block *keep = m_free != 0 ? m_blocks : 0;
+   Block *block = m_blocks;
+   while( block != 0 )
+   {
+      Block *next = block->m_next;
+      if ( block != keep )
+         freeBlock( block );
+      block = next;
+   }
+
+   m_blocks = keep;
+   if ( keep != 0 )
+   {
+      keep->m_next = 0;
+      m_free = (Falcon::byte *) (keep + 1);
+      m_avail = (Falcon::uint32) keep->m_size;
+   }
+
+   if ( m_names != 0 )
+   {
+      memset( m_names, 0, m_namesSize * sizeof( Name ) );
+      m_namesCount = 0;
+   }
+}
+
+
+Falcon::byte *Arena::encode( const Falcon::uint32 *chars, Falcon::uint32 count, Falcon::uint32 &charSize )
+{
+   Falcon::uint32 maxChr = 0;
+   for( Falcon::uint32 i = 0; i < count; ++i )
+   {
+      if ( chars[i] > maxChr )
+         maxChr = chars[i];
+   }
+
+   charSize = maxChr <= 0xFF ? 1 : ( maxChr <= 0xFFFF ? 2 : 4 );
+   Falcon::byte *data = (Falcon::byte *) alloc( count * charSize );
+
+   switch( charSize )
+   {
+      case 1:
+         for( Falcon::uint32 i = 0; i < count; ++i )
+            data[i] = (Falcon::byte) chars[i];
+      break;
+
+      case 2:
+         for( Falcon::uint32 i = 0; i < count; ++i )
+            ((Falcon::uint16 *) data)[i] = (Falcon::uint16) chars[i];
+      break;
+
+      default:
+         memcpy( data, chars, count * 4 );
+   }
+
+   return data;
+}
+
+
+void Arena::view( Falcon::byte *data, Falcon::uint32 count, Falcon::uint32 charSize, Falcon::String &target )
+{
+   switch( charSize )
+   {
+      case 1: target.manipulator( Falcon::csh::f_handler_static() ); break;
+      case 2: target.manipulator( Falcon::csh::f_handler_static16() ); break;
+      default: target.manipulator( Falcon::csh::f_handler_static32() ); break;
+   }
+
+   target.setRawStorage( data );
+   target.size( count * charSize );
+}
+
+
+void Arena::store( const Falcon::uint32 *chars, Falcon::uint32 count, Falcon::String &target )
+{
+   if ( count == 0 )
+   {
+      target = "";
+      return;
+   }
+
+   Falcon::uint32 charSize;
+   Falcon::byte *data = encode( chars, count, charSize );
+   view( data, count, charSize, target );
+}
+
+
+void Arena::intern( const Falcon::uint32 *chars, Falcon::uint32 count, Falcon::String &target )
+{
+   if ( count == 0 )
+   {
+      target = "";
+      return;
+   }
+
+   // FNV-1a on the character values.
+   Falcon::uint32 hash = 2166136261u;
+   for( Falcon::uint32 i = 0; i < count; ++i )
+   {
+      hash ^= chars[i];
+      hash *= 16777619u;
+   }
+
+   if ( m_namesCount * 4 >= m_namesSize * 3 )
+      growNames();
+
+   Falcon::uint32 mask = m_namesSize - 1;
+   Falcon::uint32 pos = hash & mask;
+   while( m_names[pos].m_data != 0 )
+   {
+      Name &name = m_names[pos];
+      if ( name.m_hash == hash && name.m_count == count )
+      {
+         Falcon::uint32 i = 0;
+         switch( name.m_charSize )
+         {
+            case 1:
+               while( i < count && name.m_data[i] == chars[i] ) ++i;
+            break;
+
+            case 2:
+               while( i < count && ((Falcon::uint16 *) name.m_data)[i] == chars[i] ) ++i;
+            break;
+
+            default:
+               while( i < count && ((Falcon::uint32 *) name.m_data)[i] == chars[i] ) ++i;
+         }
+
+         if ( i == count )
+         {
+            view( name.m_data, count, name.m_charSize, target );
+            return;
+         }
+      }
+
+      pos = (pos + 1) & mask;
+   }
+
+   Name &name = m_names[pos];
+   name.m_data = encode( chars, count, name.m_charSize );
+   name.m_hash = hash;
+   name.m_count = count;
+   ++m_namesCount;
+   view( name.m_data, count, name.m_charSize, target );
+}
+
+
+void Arena::growNames()
+{
+   Falcon::uint32 size = m_namesSize == 0 ? ARENA_NAMES_SIZE : m_namesSize * 2;
+   Name *names = (Name *) Falcon::memAlloc( size * sizeof( Name ) );
+   memset( names, 0, size * sizeof( Name ) );
+
+   for( Falcon::uint32 i = 0; i < m_namesSize; ++i )
+   {
+      if ( m_names[i].m_data != 0 )
+      {
+         Falcon::uint32 pos = m_names[i].m_hash & (size - 1);
+         while( names[pos].m_data != 0 )
+            pos = (pos + 1) & (size - 1);
+         names[pos] = m_names[i];
+      }
+   }
+
+   if ( m_names != 0 )
+      Falcon::memFree( m_names );
+   m_names = names;
+   m_namesSize = size;
+}
+
+
+//===============================================================
+// Element allocation
+//
+
+void *Element::operator new( size_t size )
+{
+   ElementHeader *header = (ElementHeader *) Falcon::memAlloc( sizeof( ElementHeader ) + size );
+   header->m_arena = 0;
+   return header + 1;
+}
+
+void *Element::operator new( size_t size, Arena *arena )
+{
+   ElementHeader *header = (ElementHeader *) arena->alloc( sizeof( ElementHeader ) + size );
+   header->m_arena = arena;
+   return header + 1;
+}
+
+void Element::operator delete( void *mem )
+{
+   ElementHeader *header = ((ElementHeader *) mem) - 1;
+   // memory in arenas is released with the arena.
+   if ( header->m_arena == 0 )
+      Falcon::memFree( header );
+}
+
+void Element::operator delete( void *, Arena * )
+{
+}
+
+}
+
+/* end of mxml_arena.cpp */
@@ -0,0 +1,109 @@
+/*
+   Mini XML lib PLUS for C++
+
+   Arena class
+
+   Author: agent
+*/
+
+/** \file
+   Memory arena for parsed documents.
+*/
+
+#ifndef MXML_ARENA_H
+#define MXML_ARENA_H
+
+#include <falcon/setup.h>
+#include <falcon/types.h>
+#include <falcon/string.h>
+#include <falcon/basealloc.h>
+
+namespace MXML {
+
+/** Memory where a parsed document is stored.
+
+   The reader allocates the nodes, the attributes and the strings they
+   hold in big blocks of the arena, and interns repeated element and
+   attribute names so that all the nodes with the same name share it.
+   The strings of the nodes are static views on the arena memory.
+
+   Elements allocated in an arena are not released one by one: deleting
+   them calls their destructor, but their memory is released with the
+   whole arena. The arena is reference counted; the document owning it,
+   the Falcon objects wrapping its nodes and the nodes of other trees
+   where its nodes are linked hold a reference.
+
+   When nothing but the document references the arena, and no node was
+   changed after being read, the destructors of the elements have nothing
+   to do; the document can then drop the arena without visiting the tree.
+   Changing a node (or linking nodes of other trees below it) touches
+   the arena, so that the tree is visited and the memory the changes
+   allocated is released as usual.
+
+   The memory of the arena is accounted to the garbage collector, as the
+   Falcon objects wrapping the nodes are what keeps it alive.
+*/
+class Arena: public Falcon::BaseAlloc
+{
+public:
+   Arena();
+
+   void incref();
+   void decref();
+   Falcon::int32 refCount() const { return m_refCount; }
+
+   /** True if the nodes in the arena have been changed after being read. */
+   bool touched() const { return m_bTouched; }
+   void touch() { m_bTouched = true; }
+
+   /** Allocates memory that will be released with the arena. */
+   void *alloc( Falcon::uint32 size );
+
+   /** Releases all the memory allocated in the arena at once.
+      The first block is kept for the next allocations. This can be done
+      only when nothing references the elements and the strings stored
+      in the arena anymore.
+   */
+   void reset();
+
+   /** Stores a string in the arena.
+      \param chars the characters to be stored.
+      \param count count of characters.
+      \param target set to a static view on the stored characters.
+   */
+   void store( const Falcon::uint32 *chars, Falcon::uint32 count, Falcon::String &target );
+
+   /** Stores a name in the arena, sharing it with the same names stored before.
+      \see store
+   */
+   void intern( const Falcon::uint32 *chars, Falcon::uint32 count, Falcon::String &target );
+
+private:
+   class Block;
+   class Name;
+
+   Block *m_blocks;
+   Falcon::byte *m_free;
+   Falcon::uint32 m_avail;
+   Falcon::uint32 m_blockSize;
+
+   Name *m_names;
+   Falcon::uint32 m_namesSize;
+   Falcon::uint32 m_namesCount;
+
+   volatile Falcon::int32 m_refCount;
+   bool m_bTouched;
+
+   ~Arena();
+   Block *allocBlock( Falcon::uint32 size );
+   void freeBlock( Block *block );
+   Falcon::byte *encode( const Falcon::uint32 *chars, Falcon::uint32 count, Falcon::uint32 &charSize );
+   void view( Falcon::byte *data, Falcon::uint32 count, Falcon::uint32 charSize, Falcon::String &target );
+   void growNames();
+};
+
+}
+
+#endif
+
+/* end of mxml_arena.h */
@@ -19,7 +19,8 @@ namespace MXML {
 /** Encapsulates an XML attribute.
    This class represents the node attributes:
    &lt;node_name <b>attrib_name="attrib value"</b>&gt;.
-   The class has support for serializationa and de-serialization.
+   The class has support for serialization; attributes are read
+   along with their node by MXML::Reader.
 */
 class Attribute: public Element
 {
@@ -29,20 +30,13 @@ private:
    /** Value of the attribute */
    Falcon::String m_value;
 
-public:
-   /** Deserializes an attribute
-      Reads an attribute from an XML file at current position.
-      In case of error Throws an MXML::IOError or MXML::MalformedError.
-      @param in the input sream
-      @param style style bits; see MXML::Document::setStyle()
-      @param line the current line in the stream
-      @param pos the current position in line
-      @throws MXML::MalformedError if the attribute is invalid
-      @throws MXML::IOError in case of hard errors on the stream
-   */
-   Attribute( Falcon::Stream &in, int style=0, int line=1, int pos=0  );
+   /** Next attribute of the owner node. */
+   Attribute *m_next;
 
+   friend class Node;
+   friend class Reader;
 
+public:
    /* Creates a new attribute
       \todo chech for name validity and throw an error
       @param name the name of the newborn attribute
@@ -52,13 +46,17 @@ public:
    {
       m_name = name;
       m_value = value;
+      m_next = 0;
    }
 
-   /* Copies an attribute. */
+   /* Copies an attribute.
+      The strings of attributes read in an arena are copied in the heap.
+   */
    Attribute( Attribute &src ): Element( src )
    {
-      m_name= src.m_name;
-      m_value = src.m_value;
+      m_name.bufferize( src.m_name );
+      m_value.bufferize( src.m_value );
+      m_next = 0;
    };
 
    /** Returns current name of the attribute. */
@@ -69,6 +67,9 @@ public:
    */
    const Falcon::String &value() const { return m_value; }
 
+   /** Returns the next attribute of the node, or 0. */
+   Attribute *next() const { return m_next; }
+
    /** Change name of the attribute
       \todo check validity of the name and throw a malformed error if wrong.
    */
@@ -8,19 +8,23 @@
 
 
 #include <mxml_document.h>
+#include <mxml_arena.h>
+#include <mxml_reader.h>
 
 namespace MXML {
 
 Document::Document( const Falcon::String &encoding, const int style )
    :Element(),
-   m_encoding( encoding )
+   m_encoding( encoding ),
+   m_arena( 0 )
 {
    m_style = style;
    m_root = new Node(Node::typeDocument);
    m_root->reserve();
 }
 
-Document::Document( Document &doc )
+Document::Document( Document &doc ):
+   m_arena( 0 )
 {
    m_style = doc.m_style;
    m_root = doc.m_root->clone();
@@ -28,7 +32,8 @@ Document::Document( Document &doc )
 }
 
 Document::Document( Falcon::Stream &in, const int style )
-   throw( MalformedError )
+   throw( MalformedError ):
+   m_arena( 0 )
 {
    m_style = style;
    m_root = new Node( Node::typeDocument );
@@ -38,10 +43,25 @@ Document::Document( Falcon::Stream &in, const int style )
 
 Document::~Document()
 {
-   if ( m_root->shell() == 0 )
-      delete m_root;
-   else
-      m_root->unreserve();
+   releaseRoot();
+}
+
+void Document::releaseRoot()
+{
+   // an unchanged tree that nobody else references goes away with its arena.
+   if ( m_arena == 0 || m_arena->touched() || m_arena->refCount() > 1 )
+   {
+      if ( m_root->shell() == 0 )
+         delete m_root;
+      else
+         m_root->unreserve();
+   }
+
+   if ( m_arena != 0 )
+   {
+      m_arena->decref();
+      m_arena = 0;
+   }
 }
 
 Node *Document::main() const
@@ -63,62 +83,40 @@ void Document::read( Falcon::Stream &stream )
    throw( MalformedError )
 {
    setPosition( 1, 1);
-   if ( m_root->child() != 0 ) {
-      m_root->dispose();
-      m_root = new Node( Node::typeDocument );
-      m_root->reserve();
-   }
+
+   releaseRoot();
+   m_arena = new Arena;
+   m_root = new( m_arena ) Node( Node::typeDocument );
+   m_root->m_arena = m_arena;
+   m_root->reserve();
 
    // load the <?xml document declaration
 
    bool xmlDecl = false;
+   Reader reader( stream, m_arena, m_style, line(), character() );
+   Node *child;
 
-   while ( stream.good() && ! stream.eof() )
+   while ( ( child = reader.read() ) != 0 )
    {
-      // ignore parameter style
-      Node *child = new Node();
-      try
-      {
-         child->read( stream, m_style, line(), character());
-      }
-      catch( MalformedError )
-      {
-         delete child;
-         throw;
-      }
-
-      setPosition( child->line(), child->character() );
       if( child->nodeType() == Node::typeXMLDecl )
       {
          if ( xmlDecl )
-         {
-            MalformedError err( Error::errMultipleXmlDecl, child );
-            delete child;
-            throw err;
-         }
+            throw MalformedError( Error::errMultipleXmlDecl, child );
          xmlDecl = true;
 
          // find the encoding parameter.
          if ( child->hasAttribute( "encoding" ) )
-            m_encoding = child->getAttribute( "encoding" );
+            m_encoding.bufferize( child->getAttribute( "encoding" ) );
          else
             m_encoding = "C";
 
-         delete child;
          continue;
       }
 
-      if ( child->nodeType() == Node::typeData && child->data() == "" )
-         delete child;
-      else {
-         m_root->addBelow( child );
-      }
+      m_root->addBelow( child );
    }
 
-   if ( stream.bad() )
-   {
-      throw IOError( Error::errIo, m_root );
-   }
+   setPosition( reader.line(), reader.character() );
    //todo: validity checks
 }
 
@@ -47,11 +47,15 @@ private:
    Node *m_root;
    int m_style;
    Falcon::String m_encoding;
+   /** Arena where the tree has been read, or 0. */
+   Arena *m_arena;
 
    // Useful just from find.
    Node::find_iterator m_finditer;
    Node::path_iterator m_pathiter;
 
+   void releaseRoot();
+
 public:
 
    /** Creates the document object.
@@ -84,6 +88,10 @@ public:
    /** Destroys the document.
       If you provided a stream at document creation, the stream is NOT colsed.
       It's up to the caller to destroy the stream and dispose of it cleanly.
+
+      A tree that has been read and not changed afterwards is released at once
+      with its arena, unless some of its nodes are still referenced elsewhere.
+      \see Arena
    */
    ~Document();
 
@@ -131,6 +139,9 @@ public:
       Reads the document from the stream; in case of error the
       status of the document will be faulty.
 
+      The previous tree is discarded. The new nodes are allocated in an
+      arena owned by the document; see MXML::Reader.
+
       Example:
       \code
       #include <mxml.h>
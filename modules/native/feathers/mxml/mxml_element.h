@@ -16,6 +16,8 @@
 
 namespace MXML {
 
+class Arena;
+
 /** XML element abstract base class.
 This class provides basic functionality for XML parsing; in particular, it
 provides a way to keep track of current line/position while parsing the
@@ -67,6 +69,17 @@ public:
 
    virtual ~Element() {}
 
+   /** Allocates the element in the heap. */
+   static void *operator new( size_t size );
+   /** Allocates the element in the given arena.
+      Deleting the element then calls its destructor, but the memory is
+      released only with the arena.
+      \see Arena
+   */
+   static void *operator new( size_t size, Arena *arena );
+   static void operator delete( void *mem );
+   static void operator delete( void *mem, Arena *arena );
+
    /** Increments current processing line and set current position in line to 0 */
    void nextLine() { m_line++; m_char = 0; }
    /** Increments current position in line by one. */
@@ -998,7 +998,12 @@ FALCON_FUNC MXMLNode_name( ::Falcon::VMachine *vm )
    MXML::Node *node = static_cast<NodeCarrier *>( self->getUserData() )->node();
 
    if ( i_name == 0 )
-      vm->retval( new CoreString( node->name() ) );
+   {
+      // strings of nodes read from a document are views on its memory.
+      CoreString *name = new CoreString( node->name() );
+      name->bufferize();
+      vm->retval( name );
+   }
    else
       node->name( *i_name->asString() );
 }
@@ -1029,7 +1034,11 @@ FALCON_FUNC MXMLNode_data( ::Falcon::VMachine *vm )
    CoreObject *self = vm->self().asObject();
    MXML::Node *node = static_cast<NodeCarrier *>( self->getUserData() )->node();
    if ( i_data == 0 )
-      vm->retval( new CoreString( node->data() ) );
+   {
+      CoreString *data = new CoreString( node->data() );
+      data->bufferize();
+      vm->retval( data );
+   }
    else
       node->data( *i_data->asString() );
 }
@@ -1122,8 +1131,9 @@ FALCON_FUNC MXMLNode_getAttribute( ::Falcon::VMachine *vm )
       return;
    }
 
-   const String &val = node->getAttribute( *i_attrName->asString() );
-   vm->retval( new CoreString( val ) );
+   CoreString *val = new CoreString( node->getAttribute( *i_attrName->asString() ) );
+   val->bufferize();
+   vm->retval( val );
 }
 
 /*#
@@ -1150,16 +1160,25 @@ FALCON_FUNC MXMLNode_getAttribs( ::Falcon::VMachine *vm )
    CoreObject *self = vm->self().asObject();
    MXML::Node *node = static_cast<NodeCarrier *>( self->getUserData() )->node();
 
-   const MXML::AttribList &attribs = node->attribs();
+   uint32 count = 0;
+   MXML::Attribute *attrib = node->firstAttribute();
+   while( attrib != 0 )
+   {
+      ++count;
+      attrib = attrib->next();
+   }
 
-   LinearDict *dict = new LinearDict( attribs.size() );
+   LinearDict *dict = new LinearDict( count );
 
-   MXML::AttribList::const_iterator iter = attribs.begin();
-   while( iter != attribs.end() )
+   attrib = node->firstAttribute();
+   while( attrib != 0 )
    {
-      dict->put( new CoreString( (*iter)->name()),
-         new CoreString( (*iter)->value()) );
-      ++iter;
+      CoreString *name = new CoreString( attrib->name() );
+      CoreString *value = new CoreString( attrib->value() );
+      name->bufferize();
+      value->bufferize();
+      dict->put( name, value );
+      attrib = attrib->next();
    }
 
    vm->retval( new CoreDict(dict) );
@@ -1571,6 +1590,337 @@ FALCON_FUNC MXMLNode_clone( ::Falcon::VMachine *vm )
    vm->retval( node->clone()->getShell( vm ) );
 }
 
+//=======================================================================
+// MXML reader class
+//
+
+/*#
+   @class MXMLReader
+   @brief Reads an XML document from a stream, one item at a time.
+   @param istream A Falcon Stream instance opened for input.
+   @optparam style A combination of @a MXMLStyle flags.
+   @raise MXMLError on read error.
+
+   This class reads documents that are too large to be loaded as
+   a whole in an @a MXMLDocument. Each call to @a MXMLReader.next reads
+   an item from the stream, and returns the @a MXMLEvent it generates;
+   the name, data and attributes of the item can then be inspected
+   until the next call. The memory used by the reader doesn't depend on
+   the size of the document.
+
+   For example, the following code counts the tags in a document:
+   @code
+      load mxml
+
+      reader = MXMLReader( InputStream( "big.xml" ) )
+      count = 0
+      while (ev = reader.next()) != nil
+         if ev == MXMLEvent.start: ++count
+      end
+   @endcode
+
+   The elements at a given path can be read as complete nodes through
+   @a MXMLReader.find; every node can be handled and discarded before the
+   next one is read:
+   @code
+      reader = MXMLReader( InputStream( "feed.xml" ) )
+      while (entry = reader.find( "/feed/entry" ))
+         > entry.getChildren()[0].data()
+      end
+   @endcode
+
+   The stream must be read with the encoding of the document; the
+   reader doesn't change it according to the <?xml?> declaration.
+*/
+
+/*#
+   @enum MXMLEvent
+   @brief Items read by MXMLReader.
+
+   - start: an element is open; its name and attributes can be read.
+     Empty elements (as <tag/>) generate a start and a close event.
+   - close: an element is closed.
+   - data: text between the elements.
+   - CDATA: a CDATA section.
+   - comment: a comment.
+   - PI: a processing instruction.
+   - directive: a directive, as i.e. DOCTYPE.
+   - decl: the <?xml?> declaration.
+*/
+
+static ReaderCarrier *internal_getReader( VMachine *vm )
+{
+   return static_cast<ReaderCarrier *>( vm->self().asObject()->getUserData() );
+}
+
+static void internal_readerError( const MXML::Error &err )
+{
+   if ( err.type() == MXML::ioError )
+      throw new IoError( ErrorParam( FALCON_MXML_ERROR_BASE + err.numericCode(), __LINE__ )
+         .desc( err.description() )
+         .extra( err.describeLine() ) );
+
+   throw new MXMLError( ErrorParam( FALCON_MXML_ERROR_BASE + err.numericCode(), __LINE__ )
+      .desc( err.description() )
+      .extra( err.describeLine() ) );
+}
+
+static bool internal_readerNext( ReaderCarrier *rc )
+{
+   try
+   {
+      return rc->next() != ReaderCarrier::evNone;
+   }
+   catch( MXML::Error &err )
+   {
+      internal_readerError( err );
+   }
+   return false;
+}
+
+static MXML::Node *internal_readerSubtree( ReaderCarrier *rc )
+{
+   try
+   {
+      return rc->subtree();
+   }
+   catch( MXML::Error &err )
+   {
+      internal_readerError( err );
+   }
+   return 0;
+}
+
+FALCON_FUNC MXMLReader_init( ::Falcon::VMachine *vm )
+{
+   CoreObject *self = vm->self().asObject();
+   Item *i_stream = vm->param(0);
+   Item *i_style = vm->param(1);
+
+   if ( i_stream == 0 || ! i_stream->isObject() || ! i_stream->asObject()->derivedFrom( "Stream" )
+      || ( i_style != 0 && ! i_style->isOrdinal() ) )
+   {
+      throw new  ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "Stream,[I]" ) );
+   }
+
+   Stream *stream = static_cast<Stream *>( i_stream->asObject()->getUserData() );
+   int style = i_style == 0 ? 0 : (int) i_style->forceInteger();
+   self->setUserData( new ReaderCarrier( *i_stream, stream, style ) );
+}
+
+/*#
+   @method next MXMLReader
+   @brief Reads the next item in the document.
+   @return A value in the @a MXMLEvent enumeration, or nil at the end of the document.
+   @raise MXMLError if the document is malformed.
+
+   The name, data and attributes of the item read are available up to
+   the next call.
+*/
+FALCON_FUNC MXMLReader_next( ::Falcon::VMachine *vm )
+{
+   ReaderCarrier *rc = internal_getReader( vm );
+   if ( internal_readerNext( rc ) )
+      vm->retval( (int64) rc->current() );
+   else
+      vm->retnil();
+}
+
+/*#
+   @method name MXMLReader
+   @brief Returns the name of the current item.
+   @return The name of the element open or closed, of the PI or of the
+      directive; an empty string for the other items.
+*/
+FALCON_FUNC MXMLReader_name( ::Falcon::VMachine *vm )
+{
+   ReaderCarrier *rc = internal_getReader( vm );
+
+   CoreString *name;
+   if ( rc->current() == ReaderCarrier::evClose )
+      name = new CoreString( rc->closedName() );
+   else if ( rc->node() != 0 )
+      name = new CoreString( rc->node()->name() );
+   else
+      name = new CoreString;
+
+   name->bufferize();
+   vm->retval( name );
+}
+
+/*#
+   @method data MXMLReader
+   @brief Returns the data of the current item.
+   @return The text, comment, CDATA, or the data of PI and directives.
+
+   The text between elements is returned as a separate @b data event;
+   the data of the start events is always empty.
+*/
+FALCON_FUNC MXMLReader_data( ::Falcon::VMachine *vm )
+{
+   ReaderCarrier *rc = internal_getReader( vm );
+
+   CoreString *data;
+   if ( rc->current() != ReaderCarrier::evClose && rc->node() != 0 )
+      data = new CoreString( rc->node()->data() );
+   else
+      data = new CoreString;
+
+   data->bufferize();
+   vm->retval( data );
+}
+
+/*#
+   @method getAttribute MXMLReader
+   @brief Returns an attribute of the current element.
+   @param attribute The name of the attribute.
+   @return The value of the attribute, or nil if the element doesn't have it.
+*/
+FALCON_FUNC MXMLReader_getAttribute( ::Falcon::VMachine *vm )
+{
+   ReaderCarrier *rc = internal_getReader( vm );
+   Item *i_attrName = vm->param(0);
+
+   if ( i_attrName == 0 || ! i_attrName->isString() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "S" ) );
+   }
+
+   MXML::Node *node = rc->node();
+   if ( rc->current() == ReaderCarrier::evClose || node == 0
+      || ! node->hasAttribute( *i_attrName->asString() ) )
+   {
+      vm->retnil();
+      return;
+   }
+
+   CoreString *val = new CoreString( node->getAttribute( *i_attrName->asString() ) );
+   val->bufferize();
+   vm->retval( val );
+}
+
+/*#
+   @method getAttribs MXMLReader
+   @brief Returns all the attributes of the current element.
+   @return A dictionary of the attribute names and values.
+*/
+FALCON_FUNC MXMLReader_getAttribs( ::Falcon::VMachine *vm )
+{
+   ReaderCarrier *rc = internal_getReader( vm );
+   LinearDict *dict = new LinearDict;
+
+   MXML::Node *node = rc->node();
+   if ( rc->current() != ReaderCarrier::evClose && node != 0 )
+   {
+      MXML::Attribute *attrib = node->firstAttribute();
+      while( attrib != 0 )
+      {
+         CoreString *name = new CoreString( attrib->name() );
+         CoreString *value = new CoreString( attrib->value() );
+         name->bufferize();
+         value->bufferize();
+         dict->put( name, value );
+         attrib = attrib->next();
+      }
+   }
+
+   vm->retval( new CoreDict( dict ) );
+}
+
+/*#
+   @method path MXMLReader
+   @brief Returns the path of the current element.
+   @return The names of the open elements, separated by "/".
+
+   On start and close events, the path includes the element being
+   opened or closed.
+*/
+FALCON_FUNC MXMLReader_path( ::Falcon::VMachine *vm )
+{
+   CoreString *path = new CoreString( internal_getReader( vm )->path() );
+   path->bufferize();
+   vm->retval( path );
+}
+
+/*#
+   @method depth MXMLReader
+   @brief Returns the count of the open elements.
+   @return The depth of the current item in the document.
+*/
+FALCON_FUNC MXMLReader_depth( ::Falcon::VMachine *vm )
+{
+   vm->retval( (int64) internal_getReader( vm )->depth() );
+}
+
+/*#
+   @method line MXMLReader
+   @brief Returns the current line in the stream.
+   @return The line where the last item read ends.
+*/
+FALCON_FUNC MXMLReader_line( ::Falcon::VMachine *vm )
+{
+   vm->retval( (int64) internal_getReader( vm )->line() );
+}
+
+/*#
+   @method subtree MXMLReader
+   @brief Reads the element that has just been open as a node.
+   @return A new MXMLNode holding the element and its children.
+   @raise MXMLError if the element is malformed, or if the last event was not a start event.
+
+   After a start event, this method reads the rest of the element up to its
+   closing tag, and returns it as a separate tree. The close event of the
+   element is not generated.
+*/
+FALCON_FUNC MXMLReader_subtree( ::Falcon::VMachine *vm )
+{
+   ReaderCarrier *rc = internal_getReader( vm );
+   if ( rc->current() != ReaderCarrier::evStart )
+   {
+      throw new MXMLError( ErrorParam( FALCON_MXML_ERROR_BASE + MXML::Error::errHyerarcy, __LINE__ )
+         .desc( FAL_STR( MXML_ERR_NOSTART ) ) );
+   }
+
+   vm->retval( internal_readerSubtree( rc )->getShell( vm ) );
+}
+
+/*#
+   @method find MXMLReader
+   @brief Reads the next element at the given path as a node.
+   @param path The path of the elements to be read, as "/feed/entry".
+   @return A new MXMLNode holding the element and its children, or nil at the end of the document.
+   @raise MXMLError if the document is malformed.
+
+   The items before the element are skipped. Only the element found is kept
+   in memory, as a separate tree; the reader can go on with the items following it.
+   The nodes that are not referenced anymore are released by the garbage
+   collector as any other item.
+*/
+FALCON_FUNC MXMLReader_find( ::Falcon::VMachine *vm )
+{
+   Item *i_path = vm->param(0);
+   if ( i_path == 0 || ! i_path->isString() )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ ).
+         extra( "S" ) );
+   }
+
+   ReaderCarrier *rc = internal_getReader( vm );
+   const String &path = *i_path->asString();
+   while( internal_readerNext( rc ) )
+   {
+      if ( rc->current() == ReaderCarrier::evStart && rc->path() == path )
+      {
+         vm->retval( internal_readerSubtree( rc )->getShell( vm ) );
+         return;
+      }
+   }
+
+   vm->retnil();
+}
+
 //=======================================================================
 // MXML error class
 //
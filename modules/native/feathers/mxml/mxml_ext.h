@@ -72,6 +72,18 @@ FALCON_FUNC MXMLNode_depth( ::Falcon::VMachine *vm );
 FALCON_FUNC MXMLNode_path( ::Falcon::VMachine *vm );
 FALCON_FUNC MXMLNode_clone( ::Falcon::VMachine *vm );
 
+FALCON_FUNC MXMLReader_init( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_next( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_name( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_data( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_getAttribute( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_getAttribs( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_path( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_depth( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_line( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_subtree( ::Falcon::VMachine *vm );
+FALCON_FUNC MXMLReader_find( ::Falcon::VMachine *vm );
+
 
 class MXMLError: public ::Falcon::Error
 {
@@ -18,6 +18,10 @@
 */
 
 #include "mxml_mod.h"
+#include "mxml_arena.h"
+#include "mxml_reader.h"
+
+#include <falcon/mempool.h>
 
 namespace Falcon {
 namespace Ext {
@@ -26,8 +30,20 @@ namespace Ext {
 // Node carrier
 //
 
+NodeCarrier::NodeCarrier( MXML::Node *node, CoreObject *co ):
+   m_node( node )
+{
+   node->shell( co );
+
+   // nodes read in an arena live as long as it.
+   if ( node->arena() != 0 )
+      node->arena()->incref();
+}
+
 NodeCarrier::~NodeCarrier()
 {
+   MXML::Arena *arena = m_node->arena();
+
    // if the carried node has a parent, just unreserve it,
    // else, we have to destroy it.
    if ( m_node->parent() != 0 || m_node->isReserved() )
@@ -36,6 +52,9 @@ NodeCarrier::~NodeCarrier()
    }
    else
       delete m_node;
+
+   if ( arena != 0 )
+      arena->decref();
 }
 
 FalconData *NodeCarrier::clone() const
@@ -45,6 +64,161 @@ FalconData *NodeCarrier::clone() const
 }
 
 
+//===================================================================
+// Reader carrier
+//
+
+ReaderCarrier::ReaderCarrier( const Item &i_stream, Stream *stream, int style ):
+   m_stream( i_stream ),
+   m_arena( new MXML::Arena ),
+   m_node( 0 ),
+   m_event( evNone ),
+   m_depth( 0 ),
+   m_bPop( false ),
+   m_bEmpty( false )
+{
+   m_reader = new MXML::Reader( *stream, m_arena, style );
+}
+
+ReaderCarrier::~ReaderCarrier()
+{
+   delete m_reader;
+   m_arena->decref();
+}
+
+void ReaderCarrier::gcMark( uint32 )
+{
+   memPool->markItem( m_stream );
+}
+
+int ReaderCarrier::line() const
+{
+   return m_reader->line();
+}
+
+int ReaderCarrier::character() const
+{
+   return m_reader->character();
+}
+
+void ReaderCarrier::push( const String &name )
+{
+   m_path += "/";
+   m_path += name;
+   ++m_depth;
+}
+
+void ReaderCarrier::pop()
+{
+   uint32 pos = m_path.rfind( "/" );
+   m_path.remove( pos, m_path.length() - pos );
+   --m_depth;
+}
+
+ReaderCarrier::event ReaderCarrier::next()
+{
+   if ( m_bPop )
+   {
+      pop();
+      m_bPop = false;
+   }
+
+   if ( m_bEmpty )
+   {
+      // the empty tag is still the current node.
+      m_bEmpty = false;
+      m_name.bufferize( m_node->name() );
+      m_bPop = true;
+      return m_event = evClose;
+   }
+
+   // nothing refers to the nodes read up to now.
+   m_node = 0;
+   m_arena->reset();
+
+   MXML::Node *node = 0;
+   switch( m_reader->next( node ) )
+   {
+      case MXML::Reader::itemEnd:
+         if ( m_depth > 0 )
+            throw MXML::MalformedError( MXML::Error::errUnclosed, m_reader );
+         return m_event = evNone;
+
+      case MXML::Reader::itemClose:
+      {
+         if ( m_depth == 0 )
+            throw MXML::MalformedError( MXML::Error::errInvalidNode, m_reader );
+
+         String name;
+         m_reader->closingName( name );
+         if ( name != m_path.subString( m_path.rfind( "/" ) + 1 ) )
+            throw MXML::MalformedError( MXML::Error::errUnclosed, m_reader );
+
+         m_name.bufferize( name );
+         m_bPop = true;
+         return m_event = evClose;
+      }
+
+      case MXML::Reader::itemOpen:
+         m_node = node;
+         push( node->name() );
+         return m_event = evStart;
+
+      case MXML::Reader::itemNode:
+      break;
+   }
+
+   m_node = node;
+   switch( node->nodeType() )
+   {
+      case MXML::Node::typeTag:
+         push( node->name() );
+         m_bEmpty = true;
+         return m_event = evStart;
+
+      case MXML::Node::typeXMLDecl: return m_event = evDecl;
+      case MXML::Node::typeComment: return m_event = evComment;
+      case MXML::Node::typeCDATA: return m_event = evCDATA;
+      case MXML::Node::typePI: return m_event = evPI;
+      case MXML::Node::typeDirective: return m_event = evDirective;
+      default: return m_event = evData;
+   }
+}
+
+MXML::Node *ReaderCarrier::subtree()
+{
+   // the element is copied out of our arena, and its children are read
+   // in an arena that lives as long as the element.
+   MXML::Node *node = new MXML::Node( *m_node );
+
+   if ( m_bEmpty )
+      m_bEmpty = false;
+   else
+   {
+      MXML::Arena *arena = new MXML::Arena;
+      m_reader->arena( arena );
+      try
+      {
+         m_reader->readBelow( node );
+      }
+      catch( MXML::Error & )
+      {
+         m_reader->arena( m_arena );
+         delete node;
+         arena->decref();
+         throw;
+      }
+
+      m_reader->arena( m_arena );
+      arena->decref();
+   }
+
+   m_name.bufferize( node->name() );
+   m_bPop = true;
+   m_event = evClose;
+   return node;
+}
+
 }
 }
 
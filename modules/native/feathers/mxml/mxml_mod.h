@@ -22,10 +22,17 @@
 
 #include <falcon/setup.h>
 #include <falcon/falcondata.h>
+#include <falcon/item.h>
 #include "mxml_node.h"
 
+namespace MXML {
+class Arena;
+class Reader;
+}
+
 namespace Falcon{
 class CoreObject;
+class Stream;
 
 namespace Ext{
 
@@ -35,11 +42,7 @@ class NodeCarrier: public Falcon::FalconData
 
 public:
 
-   NodeCarrier( MXML::Node *node, CoreObject *co ):
-      m_node( node )
-   {
-      node->shell( co );
-   }
+   NodeCarrier( MXML::Node *node, CoreObject *co );
    ~NodeCarrier();
 
    MXML::Node *node() const { return m_node; }
@@ -50,6 +53,89 @@ public:
    CoreObject *shell() const { return m_node->shell(); }
 };
 
+/** Carrier for the MXMLReader class.
+   Reads a stream item by item. The nodes read are stored in an arena
+   that is cleared at each step, so the memory used doesn't depend on
+   the size of the document.
+*/
+class ReaderCarrier: public Falcon::FalconData
+{
+public:
+   /** Events generated by next(). */
+   enum event {
+      /** The stream is over. */
+      evNone = -1,
+      evStart,
+      evClose,
+      evData,
+      evCDATA,
+      evComment,
+      evPI,
+      evDirective,
+      evDecl
+   };
+
+   /** Creates the reader.
+      \param i_stream the Falcon stream object, kept alive by the reader.
+      \param stream the stream carried by the object.
+      \param style MXML style flags.
+   */
+   ReaderCarrier( const Item &i_stream, Stream *stream, int style );
+   virtual ~ReaderCarrier();
+
+   /** Reads the next event.
+      \throws MXML::MalformedError or MXML::IOError.
+   */
+   event next();
+
+   /** Reads the rest of the element after an evStart event.
+      \return a new node, holding the element read and its children.
+   */
+   MXML::Node *subtree();
+
+   /** Current event. */
+   event current() const { return m_event; }
+
+   /** Node read by the last event, if any.
+      The node is valid up to the next call to next().
+   */
+   MXML::Node *node() const { return m_node; }
+
+   /** Name of the element that has been closed by an evClose event. */
+   const String &closedName() const { return m_name; }
+
+   /** Path of the current element, as in MXMLNode.path. */
+   const String &path() const { return m_path; }
+
+   /** Count of the open elements. */
+   int depth() const { return m_depth; }
+
+   /** Position of the last event in the stream. */
+   int line() const;
+   int character() const;
+
+   virtual FalconData *clone() const { return 0; }
+   virtual void gcMark( uint32 mk );
+
+private:
+   Item m_stream;
+   MXML::Arena *m_arena;
+   MXML::Reader *m_reader;
+   MXML::Node *m_node;
+   event m_event;
+
+   String m_name;
+   String m_path;
+   int m_depth;
+   // the element of the last event is still in the path.
+   bool m_bPop;
+   // an empty tag has been read, and its evClose is still to be sent.
+   bool m_bEmpty;
+
+   void push( const String &name );
+   void pop();
+};
+
 }
 }
 #endif
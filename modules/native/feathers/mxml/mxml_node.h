@@ -13,7 +13,6 @@
 #include <falcon/string.h>
 #include <falcon/stream.h>
 #include <falcon/coreobject.h>
-#include <list>
 #include <cassert>
 
 #include <mxml_error.h>
@@ -22,8 +21,7 @@
 namespace MXML
 {
 
-typedef std::list<Attribute *>   AttribList;
-typedef AttribList::iterator AttribListIter;
+class Arena;
 
 
 template <class __Node>
@@ -192,23 +190,35 @@ public:
    };
 
 private:
+   class ArenaHold;
+
    type m_type;
    bool m_bReserve;
    Falcon::String m_name;
    Falcon::String m_data;
-   AttribList m_attrib;
-   AttribList::iterator m_lastFound;
+   Attribute *m_attrib;
+   Attribute *m_lastAttrib;
    Falcon::CoreObject *m_objOwner;
 
+   /** Arena where the node has been read, or 0. */
+   Arena *m_arena;
+   /** References to the arenas of the nodes of other trees linked here. */
+   ArenaHold *m_holds;
+
    Node *m_parent;
    Node *m_child;
    Node *m_last_child;
    Node *m_next;
    Node *m_prev;
 
+   friend class Reader;
+   friend class Document;
+
+   void hold( Node *node );
+   void touch();
+
 protected:
    void nodeIndent( Falcon::Stream &out, const int depth, const int style ) const;
-   void readData( Falcon::Stream &in, const int iStyle );
 
 public:
 
@@ -223,6 +233,8 @@ public:
 
    /** Deserializes a node
       Reads a node from an XML file at current position.
+      The characters read past the end of the node are given back
+      to the stream.
 
       In case of error Throws an MXML::IOError or MXML::MalformedError.
 
@@ -237,7 +249,7 @@ public:
       throw( MalformedError );
 
    /** Copy constructor.
-      See clone()
+      The copy is always allocated in the heap. See clone()
    */
    Node( Node & );
 
@@ -287,21 +299,19 @@ public:
       be ignored by the system.
       \todo check validity of the name and throw a malformed error if wrong.
    */
-   void name( const Falcon::String &new_name ) { m_name = new_name; }
+   void name( const Falcon::String &new_name ) { touch(); m_name = new_name; }
 
    /** Change data of the node.
       The user can also set the data for a node that should not have it (i.e.
       an XMLdecl type), but the data will be ignored by the system.
       \todo check validity of the name and throw a malformed error if wrong.
    */
-   void data( const Falcon::String &new_value ) { m_data = new_value; }
+   void data( const Falcon::String &new_value ) { touch(); m_data = new_value; }
 
    /** Adds a new attribute at the end of the attribute list.
+      The node takes ownership of the attribute.
    */
-   void addAttribute( Attribute *attrib )
-   {
-      m_attrib.push_back( attrib );
-   }
+   void addAttribute( Attribute *attrib );
 
    /** Gets the value of the given attribute.
       If the attribute is present, its value is returned. If it is
@@ -526,8 +536,13 @@ public:
          delete this;
    }
 
-   /** Falcon extension */
-   const AttribList &attribs() const { return m_attrib; }
+   /** Returns the first attribute of the node, or 0.
+      Use Attribute::next() to get the others.
+   */
+   Attribute *firstAttribute() const { return m_attrib; }
+
+   /** Returns the arena where the node has been read, or 0. */
+   Arena *arena() const { return m_arena; }
 };
 
 #include <mxml_iterator.h>
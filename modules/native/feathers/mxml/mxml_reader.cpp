@@ -0,0 +1,599 @@
+/*
+   Mini XML lib PLUS for C++
+
+   Reader class
+
+   Author: agent
+*/
+
+#include <mxml_reader.h>
+#include <mxml_utility.h>
+
+#include <falcon/memory.h>
+#include <falcon/transcoding.h>
+
+// characters read from the stream at once
+#define MXML_READER_BUFFER    4096
+// initial size of the scratch area
+#define MXML_READER_TEXT      256
+// longest entity name
+#define MXML_MAX_ENTITY       32
+
+namespace MXML {
+
+const Falcon::String Reader::s_empty;
+
+static inline bool s_isBlank( Falcon::uint32 chr )
+{
+   return chr == ' ' || chr == '\t' || chr == MXML_SOFT_LINE_TERMINATOR || chr == MXML_LINE_TERMINATOR;
+}
+
+static inline bool s_isNameStart( Falcon::uint32 chr )
+{
+   return ( chr >= 'a' && chr <= 'z' ) || ( chr >= 'A' && chr <= 'Z' ) || chr == '_' || chr >= 0x80;
+}
+
+static inline bool s_isNameChar( Falcon::uint32 chr )
+{
+   return s_isNameStart( chr ) || ( chr >= '0' && chr <= '9' ) || chr == '-' || chr == '.' || chr == ':';
+}
+
+static inline bool s_isEntityChar( Falcon::uint32 chr )
+{
+   return ( chr >= 'a' && chr <= 'z' ) || ( chr >= 'A' && chr <= 'Z' ) ||
+      ( chr >= '0' && chr <= '9' ) || chr == '_' || chr == '-' || chr == '#';
+}
+
+Reader::Reader( Falcon::Stream &in, Arena *arena, const int style, const int line, const int pos ):
+   Element( line, pos ),
+   m_in( in ),
+   m_arena( arena ),
+   m_style( style ),
+   m_pos( 0 ),
+   m_len( 0 ),
+   m_bEof( false ),
+   m_textLen( 0 ),
+   m_textSize( MXML_READER_TEXT )
+{
+   m_buffer = (Falcon::uint32 *) Falcon::memAlloc( MXML_READER_BUFFER * sizeof( Falcon::uint32 ) );
+   m_text = (Falcon::uint32 *) Falcon::memAlloc( m_textSize * sizeof( Falcon::uint32 ) );
+}
+
+Reader::~Reader()
+{
+   Falcon::memFree( m_buffer );
+   Falcon::memFree( m_text );
+}
+
+
+bool Reader::fill()
+{
+   if ( m_bEof )
+      return false;
+
+   m_pos = 0;
+   m_len = m_in.readChars( m_buffer, MXML_READER_BUFFER );
+   if ( m_len > 0 )
+      return true;
+
+   m_len = 0;
+   m_bEof = true;
+
+   if ( m_in.bad() )
+      throw IOError( Error::errIo, this );
+
+   if ( m_in.isTranscoder() && ! static_cast<Falcon::Transcoder &>( m_in ).encoderStatus() )
+      throw MalformedError( Error::errInvalidChar, this );
+
+   return false;
+}
+
+
+void Reader::unread()
+{
+   // the last character pushed back is the first read.
+   while( m_len > m_pos )
+      m_in.unget( m_buffer[ --m_len ] );
+}
+
+
+void Reader::growText()
+{
+   m_textSize *= 2;
+   m_text = (Falcon::uint32 *) Falcon::memRealloc( m_text, m_textSize * sizeof( Falcon::uint32 ) );
+}
+
+
+void Reader::skipBlanks()
+{
+   while( m_pos < m_len || fill() )
+   {
+      Falcon::uint32 chr = m_buffer[ m_pos ];
+      if ( ! s_isBlank( chr ) )
+         return;
+
+      ++m_pos;
+      if ( chr == MXML_LINE_TERMINATOR )
+         nextLine();
+      else
+         nextChar();
+   }
+}
+
+
+Node *Reader::newNode( Node::type tp )
+{
+   Node *node = new( m_arena ) Node( tp, s_empty, s_empty );
+   node->m_arena = m_arena;
+   node->setPosition( beginLine(), beginChar() );
+   node->markBegin();
+   return node;
+}
+
+
+Node *Reader::read()
+{
+   Node *node = 0;
+   switch( next( node ) )
+   {
+      case itemEnd:
+         return 0;
+
+      case itemClose:
+         throw MalformedError( Error::errInvalidNode, this );
+
+      case itemOpen:
+         readBelow( node );
+      break;
+
+      case itemNode:
+      break;
+   }
+
+   return node;
+}
+
+
+void Reader::readBelow( Node *top )
+{
+   Node *current = top;
+
+   while( true )
+   {
+      Node *node = 0;
+      switch( next( node ) )
+      {
+         case itemEnd:
+            current->setPosition( line(), character() );
+            throw MalformedError( Error::errUnclosed, current );
+
+         case itemClose:
+         {
+            // names are interned, so the same name has the same storage.
+            Falcon::String name;
+            closingName( name );
+            if ( name.getRawStorage() != current->m_name.getRawStorage() && name != current->m_name )
+            {
+               current->setPosition( line(), character() );
+               throw MalformedError( Error::errUnclosed, current );
+            }
+
+            closeTag( current );
+            if ( current == top )
+               return;
+            current = current->m_parent;
+         }
+         break;
+
+         case itemNode:
+            current->addBelow( node );
+         break;
+
+         case itemOpen:
+            current->addBelow( node );
+            current = node;
+         break;
+      }
+   }
+}
+
+
+void Reader::closingName( Falcon::String &target )
+{
+   m_arena->intern( m_text, m_textLen, target );
+}
+
+
+Reader::item Reader::next( Node *&node )
+{
+   while( true )
+   {
+      skipBlanks();
+      markBegin();
+
+      Falcon::uint32 chr;
+      if ( ! get( chr ) )
+         return itemEnd;
+
+      if ( chr != '<' )
+      {
+         readText( chr );
+         // blank text between nodes is ignored.
+         if ( m_textLen == 0 )
+            continue;
+
+         node = newNode( Node::typeData );
+         m_arena->store( m_text, m_textLen, node->m_data );
+         node->setPosition( line(), character() );
+         return itemNode;
+      }
+
+      item kind = itemNode;
+      chr = need( Error::errInvalidNode );
+      if ( chr == '/' )
+      {
+         readClosing();
+         return itemClose;
+      }
+      else if ( chr == '!' )
+         node = readBang();
+      else if ( chr == '?' )
+         node = readPI();
+      else if ( s_isNameStart( chr ) )
+      {
+         node = readTag( chr );
+         if ( readAttributes( node, '/' ) )
+            kind = itemOpen;
+      }
+      else
+         throw MalformedError( Error::errInvalidNode, this );
+
+      node->setPosition( line(), character() );
+      return kind;
+   }
+}
+
+
+void Reader::readText( Falcon::uint32 chr )
+{
+   bool bEscape = ! ( m_style & MXML_STYLE_NOESCAPE );
+   m_textLen = 0;
+
+   while( true )
+   {
+      if ( chr == '&' && bEscape )
+         readEntity( 0 );
+      else
+         addText( chr );
+
+      if ( m_pos == m_len && ! fill() )
+         break;
+
+      chr = m_buffer[ m_pos ];
+      if ( chr == '<' )
+         break;
+
+      ++m_pos;
+      if ( chr == MXML_LINE_TERMINATOR )
+         nextLine();
+      else
+         nextChar();
+   }
+
+   // leading blanks are skipped before the text is read.
+   while( m_textLen > 0 && s_isBlank( m_text[ m_textLen - 1 ] ) )
+      --m_textLen;
+}
+
+
+void Reader::readEntity( Falcon::uint32 quote )
+{
+   Falcon::uint32 entity[ MXML_MAX_ENTITY ];
+   Falcon::uint32 len = 0;
+
+   while( true )
+   {
+      Falcon::uint32 chr = need( Error::errUnclosedEntity );
+      if ( chr == ';' )
+         break;
+
+      if ( quote != 0 && chr == quote )
+      {
+         // the attribute value ends here; keep what we have as it is.
+         --m_pos;
+         setPosition( line(), character() - 1 );
+         addText( '&' );
+         for( Falcon::uint32 i = 0; i < len; ++i )
+            addText( entity[i] );
+         return;
+      }
+
+      if ( ! s_isEntityChar( chr ) || len == MXML_MAX_ENTITY )
+         throw MalformedError( Error::errUnclosedEntity, this );
+
+      entity[ len++ ] = chr;
+   }
+
+   if ( len == 0 && quote != 0 )
+      throw MalformedError( Error::errWrongEntity, this );
+
+   Falcon::uint32 chr = parseEntity( entity, len );
+   if ( chr != 0 )
+      addText( chr );
+   else {
+      // for now, we save the unknown entities as they are.
+      addText( '&' );
+      for( Falcon::uint32 i = 0; i < len; ++i )
+         addText( entity[i] );
+      addText( ';' );
+   }
+}
+
+
+void Reader::readName( Falcon::uint32 first )
+{
+   m_textLen = 0;
+   addText( first );
+
+   while( m_pos < m_len || fill() )
+   {
+      Falcon::uint32 chr = m_buffer[ m_pos ];
+      if ( ! s_isNameChar( chr ) )
+         break;
+
+      ++m_pos;
+      nextChar();
+      addText( chr );
+   }
+}
+
+
+Node *Reader::readTag( Falcon::uint32 first )
+{
+   Node *node = newNode( Node::typeTag );
+   readName( first );
+   m_arena->intern( m_text, m_textLen, node->m_name );
+   return node;
+}
+
+
+bool Reader::readAttributes( Node *node, Falcon::uint32 end )
+{
+   while( true )
+   {
+      skipBlanks();
+      Falcon::uint32 chr = need( Error::errUnclosed );
+
+      if ( chr == end )
+      {
+         if ( need( Error::errInvalidNode ) != '>' )
+            throw MalformedError( Error::errInvalidNode, this );
+         return false;
+      }
+
+      if ( chr == '>' && end == '/' )
+         return true;
+
+      if ( ! s_isNameStart( chr ) )
+         throw MalformedError( Error::errInvalidAtt, this );
+
+      readAttribute( node, chr );
+   }
+}
+
+
+void Reader::readAttribute( Node *node, Falcon::uint32 first )
+{
+   Attribute *attrib = new( m_arena ) Attribute( s_empty, s_empty );
+   attrib->setPosition( line(), character() );
+   attrib->markBegin();
+
+   readName( first );
+   m_arena->intern( m_text, m_textLen, attrib->m_name );
+
+   skipBlanks();
+   if ( need( Error::errMalformedAtt ) != '=' )
+      throw MalformedError( Error::errMalformedAtt, this );
+
+   skipBlanks();
+   Falcon::uint32 quote = need( Error::errMalformedAtt );
+   if ( quote != '"' && quote != '\'' )
+      throw MalformedError( Error::errMalformedAtt, this );
+
+   bool bEscape = ! ( m_style & MXML_STYLE_NOESCAPE );
+   m_textLen = 0;
+   while( true )
+   {
+      Falcon::uint32 chr = need( Error::errMalformedAtt );
+      if ( chr == quote )
+         break;
+
+      if ( chr == '&' && bEscape )
+         readEntity( quote );
+      else
+         addText( chr );
+   }
+
+   m_arena->store( m_text, m_textLen, attrib->m_value );
+   attrib->setPosition( line(), character() );
+
+   // link it directly: adding attributes would touch the arena.
+   if ( node->m_lastAttrib == 0 )
+      node->m_attrib = attrib;
+   else
+      node->m_lastAttrib->m_next = attrib;
+   node->m_lastAttrib = attrib;
+}
+
+
+void Reader::readClosing()
+{
+   Falcon::uint32 chr = need( Error::errInvalidNode );
+   if ( ! s_isNameStart( chr ) )
+      throw MalformedError( Error::errInvalidNode, this );
+
+   readName( chr );
+   skipBlanks();
+   if ( need( Error::errInvalidNode ) != '>' )
+      throw MalformedError( Error::errInvalidNode, this );
+}
+
+
+Node *Reader::readBang()
+{
+   Falcon::uint32 chr = need( Error::errInvalidNode );
+   Node *node;
+
+   if ( chr == '-' )
+   {
+      if ( need( Error::errInvalidNode ) != '-' )
+         throw MalformedError( Error::errInvalidNode, this );
+
+      node = newNode( Node::typeComment );
+      m_textLen = 0;
+      skipBlanks();
+      while( true )
+      {
+         chr = need( Error::errCommentInvalid );
+         if ( chr == '-' )
+         {
+            chr = need( Error::errCommentInvalid );
+            if ( chr == '-' )
+            {
+               // any sequence of -- followed by any character != '>' is illegal
+               if ( need( Error::errCommentInvalid ) != '>' )
+                  throw MalformedError( Error::errCommentInvalid, this );
+               break;
+            }
+            addText( '-' );
+         }
+         addText( chr );
+      }
+
+      while( m_textLen > 0 && s_isBlank( m_text[ m_textLen - 1 ] ) )
+         --m_textLen;
+      m_arena->store( m_text, m_textLen, node->m_data );
+   }
+   else if ( chr == '[' )
+   {
+      const char *cdata = "CDATA[";
+      while( *cdata != 0 )
+      {
+         if ( need( Error::errInvalidNode ) != (Falcon::uint32) *cdata )
+            throw MalformedError( Error::errInvalidNode, this );
+         ++cdata;
+      }
+
+      node = newNode( Node::typeCDATA );
+      m_textLen = 0;
+      while( true )
+      {
+         addText( need( Error::errUnclosed ) );
+         if ( m_textLen >= 3 && m_text[ m_textLen - 1 ] == '>' &&
+              m_text[ m_textLen - 2 ] == ']' && m_text[ m_textLen - 3 ] == ']' )
+         {
+            m_textLen -= 3;
+            break;
+         }
+      }
+
+      m_arena->store( m_text, m_textLen, node->m_data );
+   }
+   else if ( s_isNameStart( chr ) )
+   {
+      node = newNode( Node::typeDirective );
+      readName( chr );
+      m_arena->intern( m_text, m_textLen, node->m_name );
+
+      chr = need( Error::errInvalidNode );
+      if ( chr != '>' )
+      {
+         if ( ! s_isBlank( chr ) )
+            throw MalformedError( Error::errInvalidNode, this );
+
+         // skip the '>' in the internal subsets of DOCTYPE directives.
+         int depth = 0;
+         m_textLen = 0;
+         while( true )
+         {
+            chr = need( Error::errUnclosed );
+            if ( chr == '[' )
+               ++depth;
+            else if ( chr == ']' && depth > 0 )
+               --depth;
+            else if ( chr == '>' && depth == 0 )
+               break;
+            addText( chr );
+         }
+
+         m_arena->store( m_text, m_textLen, node->m_data );
+      }
+   }
+   else
+      throw MalformedError( Error::errInvalidNode, this );
+
+   return node;
+}
+
+
+Node *Reader::readPI()
+{
+   Falcon::uint32 chr = need( Error::errInvalidNode );
+   if ( ! s_isNameStart( chr ) )
+      throw MalformedError( Error::errInvalidNode, this );
+
+   Node *node = newNode( Node::typePI );
+   readName( chr );
+   m_arena->intern( m_text, m_textLen, node->m_name );
+
+   chr = need( Error::errInvalidNode );
+   if ( chr == '?' )
+   {
+      if ( need( Error::errInvalidNode ) != '>' )
+         throw MalformedError( Error::errInvalidNode, this );
+      return node;
+   }
+
+   if ( ! s_isBlank( chr ) )
+      throw MalformedError( Error::errInvalidNode, this );
+
+   // check for xml PI.
+   if ( node->m_name == "xml" )
+   {
+      node->m_type = Node::typeXMLDecl;
+      readAttributes( node, '?' );
+      return node;
+   }
+
+   m_textLen = 0;
+   while( true )
+   {
+      addText( need( Error::errInvalidNode ) );
+      if ( m_textLen >= 2 && m_text[ m_textLen - 1 ] == '>' && m_text[ m_textLen - 2 ] == '?' )
+      {
+         m_textLen -= 2;
+         break;
+      }
+   }
+
+   m_arena->store( m_text, m_textLen, node->m_data );
+   return node;
+}
+
+
+void Reader::closeTag( Node *node )
+{
+   // if we have just one data node, let's move it to our data member
+   Node *child = node->m_child;
+   if ( child != 0 && child == node->m_last_child && child->m_type == Node::typeData )
+   {
+      node->m_data = child->m_data;
+      node->m_child = node->m_last_child = 0;
+   }
+
+   node->setPosition( line(), character() );
+}
+
+}
+
+/* end of mxml_reader.cpp */
@@ -0,0 +1,166 @@
+/*
+   Mini XML lib PLUS for C++
+
+   Reader class
+
+   Author: agent
+*/
+
+/** \file
+   Buffered XML parser.
+*/
+
+#ifndef MXML_READER_H
+#define MXML_READER_H
+
+#include <mxml.h>
+#include <mxml_arena.h>
+
+namespace MXML {
+
+/** Reads XML nodes from a stream.
+
+   The reader takes the characters from the stream in blocks, and builds
+   the nodes it reads, their attributes and their strings in an arena.
+   Nested nodes are read iteratively, so the depth of the document doesn't
+   affect the C stack.
+
+   The reader keeps track of the current position in the stream, and it is
+   the generator of the errors it raises.
+*/
+class Reader: public Element
+{
+public:
+   /** Creates the reader.
+      \param in the stream to read from.
+      \param arena where to allocate the nodes.
+      \param style style bits; see MXML::Document::setStyle()
+      \param line the current line in the stream
+      \param pos the current position in line
+   */
+   Reader( Falcon::Stream &in, Arena *arena, const int style = 0, const int line=1, const int pos=0 );
+   virtual ~Reader();
+
+   /** Kinds of items read by next(). */
+   enum item {
+      /** The stream is over. */
+      itemEnd,
+      /** A node without children (text, comment, empty tag and so on). */
+      itemNode,
+      /** A tag that will be closed by an itemClose. */
+      itemOpen,
+      /** The closing tag of the last open tag; see closingName(). */
+      itemClose
+   };
+
+   /** Reads the next item without building the tree.
+      Nested tags are not checked; the caller must match the itemOpen and
+      itemClose items.
+      \param node set to the node read, for itemNode and itemOpen items.
+      eturn the kind of the item read.
+      	hrows MXML::MalformedError if the item is invalid
+      	hrows MXML::IOError in case of hard errors on the stream
+   */
+   item next( Node *&node );
+
+   /** Gets the name of the closing tag read by next().
+      \param target set to a view on the name, stored in the arena.
+   */
+   void closingName( Falcon::String &target );
+
+   /** Reads the children of a tag returned as itemOpen by next().
+      The nodes are read up to the closing tag, and linked below the
+      given node.
+      	hrows MXML::MalformedError if a child is invalid or if the tag is not closed.
+   */
+   void readBelow( Node *node );
+
+   /** Changes the arena where the next nodes are allocated. */
+   void arena( Arena *arena ) { m_arena = arena; }
+   Arena *arena() const { return m_arena; }
+
+   /** Reads the next node with all its children.
+      Blank text between nodes is skipped.
+      \return the node, allocated in the arena, or 0 at the end of the stream.
+      \throws MXML::MalformedError if the node is invalid
+      \throws MXML::IOError in case of hard errors on the stream
+   */
+   Node *read();
+
+   /** Gives the characters read ahead back to the stream.
+      Call this when the stream is to be read further after the reader is done.
+   */
+   void unread();
+
+   /** Readers are not serialized. */
+   virtual void write( Falcon::Stream &, const int ) const {}
+
+private:
+   Falcon::Stream &m_in;
+   Arena *m_arena;
+   int m_style;
+
+   Falcon::uint32 *m_buffer;
+   Falcon::int32 m_pos;
+   Falcon::int32 m_len;
+   bool m_bEof;
+
+   // scratch area where names and texts are collected.
+   Falcon::uint32 *m_text;
+   Falcon::uint32 m_textLen;
+   Falcon::uint32 m_textSize;
+
+   static const Falcon::String s_empty;
+
+   bool fill();
+
+   bool get( Falcon::uint32 &chr )
+   {
+      if ( m_pos == m_len && ! fill() )
+         return false;
+
+      chr = m_buffer[ m_pos++ ];
+      if ( chr == MXML_LINE_TERMINATOR )
+         nextLine();
+      else
+         nextChar();
+      return true;
+   }
+
+   /** Gets the next character, raising the given error at stream end. */
+   Falcon::uint32 need( Error::codes code )
+   {
+      Falcon::uint32 chr;
+      if ( ! get( chr ) )
+         throw MalformedError( code, this );
+      return chr;
+   }
+
+   void addText( Falcon::uint32 chr )
+   {
+      if ( m_textLen == m_textSize )
+         growText();
+      m_text[ m_textLen++ ] = chr;
+   }
+
+   void growText();
+   void skipBlanks();
+   Node *newNode( Node::type tp );
+
+   void readText( Falcon::uint32 first );
+   void readEntity( Falcon::uint32 quote );
+   void readName( Falcon::uint32 first );
+   Node *readTag( Falcon::uint32 first );
+   bool readAttributes( Node *node, Falcon::uint32 end );
+   void readAttribute( Node *node, Falcon::uint32 first );
+   void readClosing();
+   Node *readBang();
+   Node *readPI();
+   void closeTag( Node *node );
+};
+
+}
+
+#endif
+
+/* end of mxml_reader.h */
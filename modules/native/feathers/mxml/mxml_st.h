@@ -21,6 +21,7 @@
 
 FAL_MODSTR( MXML_ERR_IO, "I/O error" );
 FAL_MODSTR( MXML_ERR_INVENC, "Invalid encoding:" );
+FAL_MODSTR( MXML_ERR_NOSTART, "The last item read is not the start of an element" );
 
 
 /* end of mxml_st.h */
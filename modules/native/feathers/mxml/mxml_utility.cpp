@@ -35,6 +35,56 @@ Falcon::uint32 parseEntity( const Falcon::String &entity )
 }
 
 
+/** Parses the name of an entity read as a sequence of characters.
+   Character references (&#nn; and &#xhh;) are decoded as well.
+   \return the character, or 0 if the entity is not known.
+*/
+Falcon::uint32 parseEntity( const Falcon::uint32 *entity, Falcon::uint32 len )
+{
+   if ( len > 1 && entity[0] == '#' )
+   {
+      Falcon::uint32 chr = 0;
+      Falcon::uint32 pos = 1;
+      bool bHex = entity[1] == 'x' || entity[1] == 'X';
+      if ( bHex ) ++pos;
+      if ( pos == len ) return 0;
+
+      for( ; pos < len; ++pos )
+      {
+         Falcon::uint32 digit = entity[pos];
+         if ( digit >= '0' && digit <= '9' ) digit -= '0';
+         else if ( bHex && digit >= 'a' && digit <= 'f' ) digit -= 'a' - 10;
+         else if ( bHex && digit >= 'A' && digit <= 'F' ) digit -= 'A' - 10;
+         else return 0;
+
+         chr = chr * (bHex ? 16 : 10) + digit;
+         if ( chr > 0x10FFFF ) return 0;
+      }
+      return chr;
+   }
+
+   switch( len )
+   {
+      case 2:
+         if ( entity[1] != 't' ) return 0;
+         if ( entity[0] == 'l' ) return '<';
+         if ( entity[0] == 'g' ) return '>';
+      break;
+
+      case 3:
+         if ( entity[0] == 'a' && entity[1] == 'm' && entity[2] == 'p' ) return '&';
+      break;
+
+      case 4:
+         if ( entity[0] == 'q' && entity[1] == 'u' && entity[2] == 'o' && entity[3] == 't' ) return '"';
+         if ( entity[0] == 'a' && entity[1] == 'p' && entity[2] == 'o' && entity[3] == 's' ) return '\'';
+      break;
+   }
+
+   return 0;
+}
+
+
 Falcon::Stream & writeEscape( Falcon::Stream &stream, const Falcon::String &src )
 {
 
@@ -17,6 +17,7 @@ namespace MXML {
 Falcon::String escape( const Falcon::String &unescaped );
 Falcon::Stream & writeEscape( Falcon::Stream &stream, const Falcon::String &src );
 Falcon::uint32 parseEntity( const Falcon::String &entity );
+Falcon::uint32 parseEntity( const Falcon::uint32 *entity, Falcon::uint32 len );
 
 }
 
@@ -102,6 +102,7 @@ FALCON_MODULE_DECL
                  privileges not owned by the process.
       - @b accept: The network system failed while accepting an incoming connection.
                  This usually means that the accepting thread has become unavailable.
+      - @b poll: A @a Poller failed to watch or to wait on some item.
    */
    Falcon::Symbol *c_errcode = self->addClass( "NetErrorCode" );
    self->addClassProperty( c_errcode, "generic").setInteger( FALSOCK_ERR_GENERIC );
@@ -112,6 +113,7 @@ FALCON_MODULE_DECL
    self->addClassProperty( c_errcode, "close").setInteger( FALSOCK_ERR_CLOSE );
    self->addClassProperty( c_errcode, "bind").setInteger( FALSOCK_ERR_BIND );
    self->addClassProperty( c_errcode, "accept").setInteger( FALSOCK_ERR_ACCEPT );
+   self->addClassProperty( c_errcode, "poll").setInteger( FALSOCK_ERR_POLL );
 
 
    //====================================
@@ -194,6 +196,36 @@ FALCON_MODULE_DECL
       addParam("timeout");
    self->addClassProperty( tcpserver, "lastError" );
 
+   //====================================
+   // Poller
+
+   /*#
+      @enum PollEvent
+      @brief Readiness events watched and reported by @a Poller.
+
+      - @b read: The item has data to be read, or a connection to be accepted.
+      - @b write: The item can be written without blocking.
+      - @b hangup: The remote side closed the connection (reported only).
+      - @b error: An error is pending on the item (reported only).
+   */
+   Falcon::Symbol *c_pollevt = self->addClass( "PollEvent" );
+   self->addClassProperty( c_pollevt, "read").setInteger( Falcon::Sys::Poller::e_read );
+   self->addClassProperty( c_pollevt, "write").setInteger( Falcon::Sys::Poller::e_write );
+   self->addClassProperty( c_pollevt, "hangup").setInteger( Falcon::Sys::Poller::e_hangup );
+   self->addClassProperty( c_pollevt, "error").setInteger( Falcon::Sys::Poller::e_error );
+
+   Falcon::Symbol *poller = self->addClass( "Poller", Falcon::Ext::Poller_init );
+   self->addClassMethod( poller, "add", Falcon::Ext::Poller_add ).asSymbol()->
+      addParam("item")->addParam("events")->addParam("edge");
+   self->addClassMethod( poller, "modify", Falcon::Ext::Poller_modify ).asSymbol()->
+      addParam("item")->addParam("events")->addParam("edge");
+   self->addClassMethod( poller, "remove", Falcon::Ext::Poller_remove ).asSymbol()->
+      addParam("item");
+   self->addClassMethod( poller, "wait", Falcon::Ext::Poller_wait ).asSymbol()->
+      addParam("timeout");
+   self->addClassMethod( poller, "count", Falcon::Ext::Poller_count );
+   self->addClassProperty( poller, "lastError" );
+
    //==================================================
    // Error class
 
@@ -223,6 +223,11 @@ FALCON_FUNC  Socket_init( ::Falcon::VMachine *vm )
 
    @a Socket.readAvailable and @a Socket.writeAvailable methods do not use
    this setting.
+
+   On systems supporting it (currently Linux), waits for @a TCPSocket.recv,
+   @a TCPSocket.send and @a TCPServer.accept suspend only the coroutine
+   performing them; the other coroutines keep running in the meanwhile.
+   Elsewhere, and in atomic mode, the wait blocks the whole VM.
 */
 
 FALCON_FUNC  Socket_setTimeout( ::Falcon::VMachine *vm )
@@ -269,6 +274,7 @@ FALCON_FUNC  Socket_dispose( ::Falcon::VMachine *vm )
 {
    CoreObject *self = vm->self().asObject();
    Sys::Socket *tcps = (Sys::Socket *) self->getUserData();
+   vm->descriptorClosed( tcps->descriptor() );
    tcps->terminate();
    vm->retnil();
 }
@@ -752,6 +758,43 @@ FALCON_FUNC TCPSocket_sslClear( ::Falcon::VMachine *vm )
 }
 #endif // WITH_OPENSSL
 
+/* Suspends the current coroutine until the socket is ready, instead of
+   blocking the whole VM in the system wait.
+
+   The operation is re-tried by the return frame handler next when the
+   coroutine is resumed. Returns false if the socket doesn't need a wait
+   (zero timeout, data already available or error), or if the VM can't
+   suspend the coroutine; the caller should then proceed as usual.
+*/
+static bool s_suspendOn( VMachine* vm, Sys::Socket* skt, bool bWrite, ext_func_frame_t next )
+{
+   if ( skt->timeout() == 0 )
+      return false;
+
+   // checking is cheaper than a context switch.
+   if ( (bWrite ? skt->writeAvailable( 0 ) : skt->readAvailable( 0 )) != 0 )
+      return false;
+
+   // the handler must be set before the VM changes context.
+   vm->returnHandler( next );
+   numeric secs = skt->timeout() < 0 ? -1.0 : skt->timeout() / 1000.0;
+   if ( vm->waitDescriptor( skt->descriptor(), bWrite, secs ) )
+      return true;
+
+   vm->returnHandler( 0 );
+   return false;
+}
+
+/* SSL sockets may have data buffered in the SSL layer; let them block. */
+static bool s_canSuspend( Sys::TCPSocket* tcps )
+{
+#if WITH_OPENSSL
+   return tcps->ssl() == 0 || tcps->ssl()->handshakeState != Sys::SSLData::handshake_ok;
+#else
+   return true;
+#endif
+}
+
 /*#
    @method send TCPSocket
    @brief Send data on the network connection.
@@ -791,7 +834,9 @@ FALCON_FUNC TCPSocket_sslClear( ::Falcon::VMachine *vm )
 
    @see Socket.setTimeout
 */
-FALCON_FUNC  TCPSocket_send( ::Falcon::VMachine *vm )
+static bool TCPSocket_send_next( ::Falcon::VMachine *vm );
+
+static bool s_TCPSocket_send( ::Falcon::VMachine *vm )
 {
    CoreObject *self = vm->self().asObject();
    Sys::TCPSocket *tcps = (Sys::TCPSocket *) self->getUserData();
@@ -843,6 +888,9 @@ FALCON_FUNC  TCPSocket_send( ::Falcon::VMachine *vm )
       }
    }
 
+   if ( s_canSuspend( tcps ) && s_suspendOn( vm, tcps, true, &TCPSocket_send_next ) )
+      return true;
+
    vm->idle();
    int32 res = tcps->send( data + start_pos, count );
    vm->unidle();
@@ -869,17 +917,42 @@ FALCON_FUNC  TCPSocket_send( ::Falcon::VMachine *vm )
       self->setProperty( "timedOut", Item( false ) );
    }
 
+   return false;
+}
+
+static bool TCPSocket_send_next( ::Falcon::VMachine *vm )
+{
+   vm->returnHandler( 0 );
+
+   if ( ! vm->currentContext()->descriptorReady() )
+   {
+      vm->self().asObject()->setProperty( "timedOut", Item( true ) );
+      vm->retval( 0 );
+      return false;
+   }
+
+   return s_TCPSocket_send( vm );
+}
+
+FALCON_FUNC  TCPSocket_send( ::Falcon::VMachine *vm )
+{
+   s_TCPSocket_send( vm );
 }
 
 static int s_recv_tcp( VMachine* vm, byte* data, int size, Sys::Address& )
 {
    CoreObject *self = vm->self().asObject();
    Sys::TCPSocket *tcps = (Sys::TCPSocket *) self->getUserData();
+   int32 fd = tcps->descriptor();
 
    vm->idle();
    size = tcps->recv( data, size );
    vm->unidle();
 
+   // recv() closes the socket when the remote side has shut it down.
+   if ( size == 0 && tcps->descriptor() != fd )
+      vm->descriptorClosed( fd );
+
    return size;
 }
 
@@ -1065,7 +1138,9 @@ static void s_Socket_recv_membuf( VMachine* vm, Item* i_target, Item* i_size,
 
    @see Socket.setTimeout
 */
-FALCON_FUNC  TCPSocket_recv( ::Falcon::VMachine *vm )
+static bool TCPSocket_recv_next( ::Falcon::VMachine *vm );
+
+static bool s_TCPSocket_recv( ::Falcon::VMachine *vm )
 {
    Item *i_target = vm->param(0);
    Item *i_size = vm->param(1);
@@ -1077,6 +1152,10 @@ FALCON_FUNC  TCPSocket_recv( ::Falcon::VMachine *vm )
          extra( "S|M, [N]" ) );
    }
 
+   Sys::TCPSocket *tcps = (Sys::TCPSocket *) vm->self().asObject()->getUserData();
+   if ( s_canSuspend( tcps ) && s_suspendOn( vm, tcps, false, &TCPSocket_recv_next ) )
+      return true;
+
    if( i_target->isString() )
    {
       s_Socket_recv_string( vm, i_target, i_size, &s_recv_tcp );
@@ -1084,6 +1163,26 @@ FALCON_FUNC  TCPSocket_recv( ::Falcon::VMachine *vm )
    else {
       s_Socket_recv_membuf( vm, i_target, i_size, &s_recv_tcp );
    }
+
+   return false;
+}
+
+static bool TCPSocket_recv_next( ::Falcon::VMachine *vm )
+{
+   vm->returnHandler( 0 );
+
+   if ( ! vm->currentContext()->descriptorReady() )
+   {
+      s_recv_result( vm, -2, Sys::Address() );
+      return false;
+   }
+
+   return s_TCPSocket_recv( vm );
+}
+
+FALCON_FUNC  TCPSocket_recv( ::Falcon::VMachine *vm )
+{
+   s_TCPSocket_recv( vm );
 }
 
 /*#
@@ -1524,6 +1623,7 @@ FALCON_FUNC  TCPServer_dispose( ::Falcon::VMachine *vm )
 {
    CoreObject *self = vm->self().asObject();
    Sys::ServerSocket *tcps = (Sys::ServerSocket *) self->getUserData();
+   vm->descriptorClosed( tcps->descriptor() );
    tcps->terminate();
    vm->retnil();
 
@@ -1601,10 +1701,13 @@ FALCON_FUNC  TCPServer_bind( ::Falcon::VMachine *vm )
    immediately, providing a valid TCPSocket as return value only if an incoming
    connection was already pending.
 
-   The wait blocks the VM, and thus, also the other coroutines.
-   If a system error occurs during the wait, a NetError is raised.
+   Where supported, the wait suspends only the calling coroutine (see
+   @a Socket.setTimeout); otherwise it blocks the VM, and thus, also the other
+   coroutines. If a system error occurs during the wait, a NetError is raised.
 */
-FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm )
+static bool TCPServer_accept_next( ::Falcon::VMachine *vm );
+
+static bool s_TCPServer_accept( ::Falcon::VMachine *vm )
 {
    CoreObject *self = vm->self().asObject();
    Sys::ServerSocket *srvs = (Sys::ServerSocket *) self->getUserData();
@@ -1621,9 +1724,12 @@ FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm )
    else {
       throw new  ParamError( ErrorParam( e_inv_params, __LINE__ ).
          extra( "[N]" ) );
-      return;
    }
 
+   // a failed listen is reported by accept() below.
+   if ( srvs->listen() && s_suspendOn( vm, srvs, false, &TCPServer_accept_next ) )
+      return true;
+
    vm->idle();
    Sys::TCPSocket *skt = srvs->accept();
    vm->unidle();
@@ -1633,12 +1739,11 @@ FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm )
       self->setProperty( "lastError", srvs->lastError() );
       throw new  NetError( ErrorParam( FALSOCK_ERR_ACCEPT, __LINE__ ).
          desc( FAL_STR( sk_msg_erraccept ) ).sysError( (uint32) srvs->lastError() ) );
-      return;
    }
 
    if ( skt == 0 ) {
       vm->retnil();
-      return;
+      return false;
    }
 
    Item *tcp_class = vm->findWKI( "TCPSocket" );
@@ -1647,8 +1752,379 @@ FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm )
    ret_s->setUserData( skt );
 
    vm->retval( ret_s );
+   return false;
+}
+
+static bool TCPServer_accept_next( ::Falcon::VMachine *vm )
+{
+   vm->returnHandler( 0 );
+
+   if ( ! vm->currentContext()->descriptorReady() )
+   {
+      vm->retnil();
+      return false;
+   }
+
+   return s_TCPServer_accept( vm );
+}
+
+FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm )
+{
+   s_TCPServer_accept( vm );
+}
+
+
+//================================================
+// Poller
+//================================================
+
+PollerCarrier::PollerCarrier():
+   m_poller( new Sys::Poller ),
+   m_fds( &traits::t_int() ),
+   m_fdMap( &traits::t_int(), &traits::t_int() )
+{
+}
+
+PollerCarrier::~PollerCarrier()
+{
+   delete m_poller;
+}
+
+void PollerCarrier::gcMark( uint32 mark )
+{
+   m_items.gcMark( mark );
+}
+
+void PollerCarrier::addItem( int32 fd, const Item &item )
+{
+   int32 pos = (int32) m_items.length();
+   m_items.append( item );
+   m_fds.push( &fd );
+   m_fdMap.insert( &fd, &pos );
+}
+
+bool PollerCarrier::removeItem( int32 fd )
+{
+   int32 *ppos = (int32 *) m_fdMap.find( &fd );
+   if ( ppos == 0 )
+      return false;
+
+   int32 pos = *ppos;
+   int32 last = (int32) m_items.length() - 1;
+   m_fdMap.erase( &fd );
+
+   // move the last entry in the freed slot, so that removal is O(1).
+   if ( pos != last )
+   {
+      int32 lastFd = *(int32 *) m_fds.at( last );
+      m_items.at( pos ) = m_items.at( last );
+      m_fds.set( &lastFd, pos );
+      m_fdMap.insert( &lastFd, &pos );
+   }
+
+   m_items.remove( last );
+   m_fds.pop();
+   return true;
+}
+
+Item *PollerCarrier::findItem( int32 fd )
+{
+   int32 *ppos = (int32 *) m_fdMap.find( &fd );
+   if ( ppos == 0 )
+      return 0;
+   return &m_items.at( *ppos );
+}
+
+/** Gets the descriptor of an item that can be watched by a poller. */
+static bool s_itemDescriptor( const Item &item, int32 &fd )
+{
+   if ( ! item.isObject() )
+      return false;
+
+   CoreObject *obj = item.asObjectSafe();
+   if ( obj->derivedFrom( "Socket" ) || obj->derivedFrom( "TCPServer" ) )
+   {
+      Sys::Socket *skt = (Sys::Socket *) obj->getUserData();
+      if ( skt == 0 )
+         return false;
+      fd = skt->descriptor();
+      return true;
+   }
+
+   if ( obj->derivedFrom( "Stream" ) )
+   {
+      Stream *stream = dyncast<Stream *>( obj->getFalconData() );
+      return stream != 0 && Sys::streamDescriptor( stream, fd );
+   }
+
+   return false;
+}
+
+static void s_pollError( VMachine *vm, Sys::Poller *poller )
+{
+   vm->self().asObject()->setProperty( "lastError", poller->lastError() );
+   throw new NetError( ErrorParam( FALSOCK_ERR_POLL, __LINE__ )
+      .desc( FAL_STR( sk_msg_errpoll ) )
+      .sysError( (uint32) poller->lastError() ) );
+}
+
+/*#
+   @class Poller
+   @brief Watches many sockets and streams for readiness at once.
+
+   A poller receives a set of sockets, servers or streams, each one with
+   a mask of interesting events (see @a PollEvent), and reports in a single
+   call all the items that are ready for the requested operations.
+
+   Compared with calling @a Socket.readAvailable on each socket, a
+   wait on the poller costs a single system call, regardless of the count of
+   watched items; on Linux, the poller is backed by epoll, and the cost
+   of the wait doesn't depend on the count of watched items either.
+   On other POSIX systems poll() is used, and on MS-Windows only sockets
+   can be watched.
+
+   Streams can be watched if they are backed by a system descriptor (files,
+   pipes, standard streams, process streams); the stream buffer and the
+   transcoder eventually applied to them are skipped. Notice that the data
+   already held in the buffer of a stream is not seen by the poller.
+
+   @code
+      load socket
+
+      poller = Poller()
+      poller.add( server, PollEvent.read )
+      loop
+         for item, events in poller.wait()
+            if item == server
+               poller.add( server.accept(), PollEvent.read )
+            else
+               ...
+            end
+         end
+      end
+   @endcode
+
+   @prop lastError Last system error code detected by the poller.
+*/
+
+FALCON_FUNC  Poller_init( ::Falcon::VMachine *vm )
+{
+   PollerCarrier *pc = new PollerCarrier;
+   CoreObject *self = vm->self().asObject();
+   self->setUserData( pc );
+
+   if ( pc->poller()->lastError() != 0 )
+   {
+      self->setProperty( "lastError", pc->poller()->lastError() );
+      throw  new NetError( ErrorParam( FALSOCK_ERR_CREATE, __LINE__ )
+         .desc( FAL_STR( sk_msg_errcreate ) )
+         .sysError( (uint32) pc->poller()->lastError() ) );
+   }
+}
+
+static void s_Poller_set( ::Falcon::VMachine *vm, bool bAdd )
+{
+   Item *i_item = vm->param( 0 );
+   Item *i_events = vm->param( 1 );
+   Item *i_edge = vm->param( 2 );
+   int32 fd;
+
+   if ( i_item == 0 || i_events == 0 || ! i_events->isOrdinal()
+        || ! s_itemDescriptor( *i_item, fd ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .extra( "Socket|TCPServer|Stream, N, [B]" ) );
+   }
+
+   PollerCarrier *pc = dyncast<PollerCarrier *>( vm->self().asObject()->getFalconData() );
+   int32 events = (int32) i_events->forceInteger();
+   bool bEdge = i_edge != 0 && i_edge->isTrue();
+
+   if ( bAdd )
+   {
+      if ( ! pc->poller()->add( fd, events, bEdge ) )
+         s_pollError( vm, pc->poller() );
+      pc->addItem( fd, *i_item );
+   }
+   else if ( ! pc->poller()->modify( fd, events, bEdge ) )
+   {
+      s_pollError( vm, pc->poller() );
+   }
+}
+
+/*#
+   @method add Poller
+   @brief Starts watching a socket or a stream.
+   @param item A Socket, a TCPServer or a Stream.
+   @param events Or'd mask of @a PollEvent values.
+   @optparam edge If true, notify the item only when its status changes.
+   @raise ParamError if the item can't be watched.
+   @raise NetError if the item is already watched, or on system error.
+
+   By default, the poller is level triggered: an item is returned by
+   @a Poller.wait as long as it is ready (i.e. as long as there is unread
+   data). If @b edge is true, the item is notified only when new data arrives,
+   or when the write buffer gets free again; this requires the caller to
+   completely drain the item when notified. The setting is ignored by
+   systems not supporting it.
+
+   TCPServer objects are ready for reading when there is an incoming
+   connection waiting to be accepted; they must have been put in listen
+   state by a previous call to @a TCPServer.accept (with timeout 0).
+*/
+FALCON_FUNC  Poller_add( ::Falcon::VMachine *vm )
+{
+   s_Poller_set( vm, true );
 }
 
+/*#
+   @method modify Poller
+   @brief Changes the events watched on an item.
+   @param item A Socket, a TCPServer or a Stream already added to this poller.
+   @param events Or'd mask of @a PollEvent values.
+   @optparam edge If true, notify the item only when its status changes.
+   @raise NetError if the item is not watched, or on system error.
+*/
+FALCON_FUNC  Poller_modify( ::Falcon::VMachine *vm )
+{
+   s_Poller_set( vm, false );
+}
+
+/*#
+   @method remove Poller
+   @brief Stops watching an item.
+   @param item A Socket, a TCPServer or a Stream added to this poller.
+   @return True if the item was watched, false otherwise.
+
+   Items must be removed before being closed.
+*/
+FALCON_FUNC  Poller_remove( ::Falcon::VMachine *vm )
+{
+   Item *i_item = vm->param( 0 );
+   int32 fd;
+
+   if ( i_item == 0 || ! s_itemDescriptor( *i_item, fd ) )
+   {
+      throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+         .extra( "Socket|TCPServer|Stream" ) );
+   }
+
+   PollerCarrier *pc = dyncast<PollerCarrier *>( vm->self().asObject()->getFalconData() );
+   if ( ! pc->removeItem( fd ) )
+   {
+      vm->regA().setBoolean( false );
+      return;
+   }
+
+   pc->poller()->remove( fd );
+   vm->regA().setBoolean( true );
+}
+
+/*#
+   @method count Poller
+   @brief Returns the count of watched items.
+   @return Count of items currently added to the poller.
+*/
+FALCON_FUNC  Poller_count( ::Falcon::VMachine *vm )
+{
+   PollerCarrier *pc = dyncast<PollerCarrier *>( vm->self().asObject()->getFalconData() );
+   vm->retval( (int64) pc->count() );
+}
+
+// maximum count of items returned by a single wait.
+#define POLLER_BATCH 64
+
+static void s_Poller_collect( ::Falcon::VMachine *vm, int32 msec )
+{
+   PollerCarrier *pc = dyncast<PollerCarrier *>( vm->self().asObject()->getFalconData() );
+   int32 fds[POLLER_BATCH];
+   int32 events[POLLER_BATCH];
+
+   if ( msec != 0 )
+      vm->idle();
+   int32 count = pc->poller()->wait( msec, fds, events, POLLER_BATCH );
+   if ( msec != 0 )
+      vm->unidle();
+
+   if ( count < 0 )
+      s_pollError( vm, pc->poller() );
+
+   CoreArray *ret = new CoreArray( count );
+   for ( int32 i = 0; i < count; ++i )
+   {
+      Item *item = pc->findItem( fds[i] );
+      // the item may have been removed by another coroutine.
+      if ( item == 0 )
+         continue;
+
+      CoreArray *pair = new CoreArray( 2 );
+      pair->append( *item );
+      pair->append( (int64) events[i] );
+      ret->append( pair );
+   }
+
+   vm->retval( ret );
+}
+
+static bool Poller_wait_next( ::Falcon::VMachine *vm )
+{
+   vm->returnHandler( 0 );
+   s_Poller_collect( vm, 0 );
+   return false;
+}
+
+/*#
+   @method wait Poller
+   @brief Waits for some of the watched items to be ready.
+   @optparam timeout Maximum wait in seconds; -1 or nil to wait forever.
+   @return An array of [item, events] pairs.
+   @raise NetError on system error.
+
+   Returns the items that are ready, each one paired with the mask of the
+   @a PollEvent values describing its status (that may include
+   @b PollEvent.hangup and @b PollEvent.error even if they were not
+   requested). If the timeout expires, an empty array is returned.
+   A timeout of 0 just checks the status of the items without waiting.
+
+   At most 64 items are returned by each call; remaining ready items
+   are returned by the next calls.
+
+   Where supported (on Linux), the wait suspends only the calling coroutine,
+   as the waits performed by sockets; otherwise it blocks the whole VM.
+*/
+FALCON_FUNC  Poller_wait( ::Falcon::VMachine *vm )
+{
+   Item *i_timeout = vm->param( 0 );
+   numeric secs = -1.0;
+
+   if ( i_timeout != 0 && ! i_timeout->isNil() )
+   {
+      if ( ! i_timeout->isOrdinal() )
+      {
+         throw new ParamError( ErrorParam( e_inv_params, __LINE__ )
+            .extra( "[N]" ) );
+      }
+      secs = i_timeout->forceNumeric();
+   }
+
+   PollerCarrier *pc = dyncast<PollerCarrier *>( vm->self().asObject()->getFalconData() );
+   int32 fd = pc->poller()->descriptor();
+
+   if ( secs != 0.0 && fd != -1 )
+   {
+      // a quick check is cheaper than a context switch.
+      s_Poller_collect( vm, 0 );
+      if ( vm->regA().asArray()->length() != 0 )
+         return;
+
+      vm->returnHandler( &Poller_wait_next );
+      if ( vm->waitDescriptor( fd, false, secs < 0.0 ? -1.0 : secs ) )
+         return;
+      vm->returnHandler( 0 );
+   }
+
+   s_Poller_collect( vm, secs < 0.0 ? -1 : (int32)( secs * 1000.0 ) );
+}
 
 /*#
    @class NetError
@@ -25,6 +25,10 @@
 #include <falcon/module.h>
 #include <falcon/error.h>
 #include <falcon/error_base.h>
+#include <falcon/falcondata.h>
+#include <falcon/itemarray.h>
+#include <falcon/genericmap.h>
+#include <falcon/genericvector.h>
 
 #ifndef FALCON_SOCKET_ERROR_BASE
    #define FALCON_SOCKET_ERROR_BASE        1170
@@ -39,6 +43,7 @@
 #define FALSOCK_ERR_CLOSE  (FALCON_SOCKET_ERROR_BASE + 6)
 #define FALSOCK_ERR_BIND  (FALCON_SOCKET_ERROR_BASE + 7)
 #define FALSOCK_ERR_ACCEPT  (FALCON_SOCKET_ERROR_BASE + 8)
+#define FALSOCK_ERR_POLL  (FALCON_SOCKET_ERROR_BASE + 9)
 
 #if WITH_OPENSSL
 #define FALSOCK_ERR_SSLCONFIG (FALCON_SOCKET_ERROR_BASE + 10)
@@ -46,6 +51,11 @@
 #endif
 
 namespace Falcon {
+
+namespace Sys {
+   class Poller;
+}
+
 namespace Ext {
 
 // =============================================
@@ -103,6 +113,46 @@ FALCON_FUNC  TCPServer_dispose( ::Falcon::VMachine *vm );
 FALCON_FUNC  TCPServer_bind( ::Falcon::VMachine *vm );
 FALCON_FUNC  TCPServer_accept( ::Falcon::VMachine *vm );
 
+/** Carrier for the Poller script class.
+   Keeps the system poller together with the items that are watched,
+   so that they stay alive while registered and can be returned by wait().
+*/
+class PollerCarrier: public FalconData
+{
+public:
+   PollerCarrier();
+   virtual ~PollerCarrier();
+
+   virtual void gcMark( uint32 mark );
+   virtual FalconData *clone() const { return 0; }
+
+   Sys::Poller *poller() const { return m_poller; }
+
+   /** Records an item watched on a descriptor. */
+   void addItem( int32 fd, const Item &item );
+   /** Forgets the item watched on a descriptor. */
+   bool removeItem( int32 fd );
+   /** Returns the item watched on a descriptor, or 0 if none. */
+   Item *findItem( int32 fd );
+
+   uint32 count() const { return m_items.length(); }
+
+private:
+   Sys::Poller *m_poller;
+   ItemArray m_items;
+   /** Descriptors of the items in m_items, in the same order. */
+   GenericVector m_fds;
+   /** descriptor -> position in m_items */
+   Map m_fdMap;
+};
+
+FALCON_FUNC  Poller_init( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_add( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_modify( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_remove( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_wait( ::Falcon::VMachine *vm );
+FALCON_FUNC  Poller_count( ::Falcon::VMachine *vm );
+
 class NetError: public ::Falcon::Error
 {
 public:
@@ -24,6 +24,7 @@
 #include <falcon/string.h>
 #include <falcon/falcondata.h>
 #include <falcon/vm_sys.h>
+#include <falcon/stream.h>
 
 #if WITH_OPENSSL
 #include <openssl/bio.h>
@@ -216,6 +217,9 @@ public:
    int32 timeout() const { return m_timeout; }
    void timeout( int32 t ) { m_timeout = t; }
 
+   /** Returns the system level descriptor of this socket. */
+   int32 descriptor() const { return d.m_iSystemData; }
+
    int readAvailable( int32 msec,const Sys::SystemData *sysData = 0 );
    int writeAvailable( int32 msec, const Sys::SystemData *sysData = 0 );
 
@@ -455,12 +459,83 @@ public:
    ServerSocket( bool ipv6 = true );
    ~ServerSocket();
 
+   /** Puts the socket in listening mode, if not already listening.
+      Called automatically by accept().
+      \return false on error.
+   */
+   bool listen();
+
    /** Accepts incoming calls.
       Returns a TCP socket on success, null if no new incoming data is arriving.
    */
    TCPSocket *accept();
 };
 
+//================================================
+// Poller
+//================================================
+
+/** Readiness notification for many descriptors at once.
+   Backed by epoll on Linux, by poll() on other POSIX systems and by
+   select() on MS-Windows.
+*/
+class Poller
+{
+   void *m_systemData;
+   int64 m_lastError;
+
+public:
+   /** Readiness events; can be or'd together. */
+   typedef enum
+   {
+      e_read = 1,
+      e_write = 2,
+      e_hangup = 4,
+      e_error = 8
+   } t_event;
+
+   Poller();
+   ~Poller();
+
+   /** Starts watching a descriptor.
+      \param fd The descriptor.
+      \param events An or'd mask of e_read and e_write.
+      \param edge true to be notified only on status changes (edge triggered).
+         Systems not supporting it ignore the setting.
+      \return false on error (i.e. if the descriptor is already watched).
+   */
+   bool add( int32 fd, int32 events, bool edge = false );
+
+   /** Changes the events for which a descriptor is watched. */
+   bool modify( int32 fd, int32 events, bool edge = false );
+
+   /** Stops watching a descriptor. */
+   bool remove( int32 fd );
+
+   /** Waits for some descriptor to be ready.
+      \param msec Timeout in milliseconds; -1 waits forever, 0 just polls.
+      \param fds Array receiving the ready descriptors.
+      \param events Array receiving the events ready on each descriptor.
+      \param size Size of the fds and events arrays.
+      \return count of ready descriptors, or -1 on error.
+   */
+   int32 wait( int32 msec, int32 *fds, int32 *events, int32 size );
+
+   /** Descriptor becoming readable when some watched descriptor is ready.
+      Useful to wait on the whole set through another wait (as the VM
+      descriptor waits); -1 if the system can't provide it.
+   */
+   int32 descriptor() const;
+
+   int64 lastError() const { return m_lastError; }
+};
+
+/** Gets the system descriptor of a Falcon stream.
+   Buffers and transcoders are skipped to reach the underlying file stream.
+   \return false if the stream has not a descriptor that can be polled.
+*/
+bool streamDescriptor( Stream *stream, int32 &fd );
+
 }
 }
 
@@ -25,6 +25,10 @@
 #include <unistd.h>
 #include <falcon/autocstring.h>
 #include <falcon/vm_sys_posix.h>
+#include <falcon/fstream_sys_unix.h>
+#include <falcon/streambuffer.h>
+#include <falcon/transcoding.h>
+#include <falcon/memory.h>
 
 #include <netdb.h>
 #include <errno.h>
@@ -32,6 +36,10 @@
 #include <string.h>
 #include "socket_sys.h"
 
+#ifdef __linux__
+   #include <sys/epoll.h>
+#endif
+
 // Sun doesn't provide strerror_r
 #if ( defined (__SUNPRO_CC) && __SUNPRO_CC <= 0x580 )
 static int strerror_r(int errnum, char * buf, unsigned n)
@@ -269,60 +277,40 @@ void *Address::getHostSystemData( int id ) const
 // Socket
 //================================================
 
+// poll() is used instead of select(), that can't handle descriptors >= FD_SETSIZE.
 static int s_select( int skt, int32 msec, int32 mode )
 {
-   struct timeval tv, *tvp;
-   fd_set set;
-
-   FD_ZERO( &set );
-   FD_SET( skt, &set );
-   if ( msec >= 0 ) {
-      tvp = &tv;
-      tv.tv_sec = msec / 1000;
-      tv.tv_usec = (msec % 1000 ) * 1000;
-   }
-   else
-      tvp = 0;
-
-   int count;
-
+   struct pollfd poller;
+   poller.fd = skt;
    switch( mode )
    {
-      case 0: count = select( skt + 1, &set, 0, 0, tvp ); break;
-      case 1: count = select( skt + 1, 0, &set, 0, tvp ); break;
-      case 2: count = select( skt + 1, 0, 0, &set, tvp ); break;
+      case 0: poller.events = POLLIN; break;
+      case 1: poller.events = POLLOUT; break;
+      default: poller.events = POLLPRI; break;
    }
 
+   int count;
+   while( ( count = poll( &poller, 1, msec ) ) == -1 && errno == EINTR );
+
    return count;
 }
 
 static int s_select_connect( int skt, int32 msec )
 {
-   struct timeval tv, *tvp;
-   fd_set write_set, error_set;
-
-   FD_ZERO( &write_set );
-   FD_SET( skt, &write_set );
-   FD_ZERO( &error_set );
-   FD_SET( skt, &error_set );
+   struct pollfd poller;
+   poller.fd = skt;
+   poller.events = POLLOUT;
 
-   if ( msec >= 0 ) {
-      tvp = &tv;
-      tv.tv_sec = msec / 1000;
-      tv.tv_usec = (msec % 1000 ) * 1000;
-   }
-   else
-      tvp = 0;
+   int count;
+   while( ( count = poll( &poller, 1, msec ) ) == -1 && errno == EINTR );
 
-   int count = select( skt + 1, 0, &write_set, &error_set, tvp );
    // nothing done
    if ( count == 0 )
       return 0;
 
-   if ( FD_ISSET( skt, &write_set ) )
+   if ( count > 0 && (poller.revents & (POLLERR | POLLHUP)) == 0 )
       return 1; // connection succesful
 
-
    return -1; // error
 }
 
@@ -347,47 +335,43 @@ void Socket::terminate()
 int Socket::readAvailable( int32 msec, const Sys::SystemData *sysData )
 {
    m_lastError = 0;
-   struct timeval tv, *tvp;
-   fd_set set;
-   int last;
+   struct pollfd poller[2];
+   int fds;
+
+   poller[0].fd = (int) d.m_iSystemData;
+   poller[0].events = POLLIN;
 
-   FD_ZERO( &set );
-   FD_SET( d.m_iSystemData, &set );
-   if( sysData != 0 )
+   if ( sysData != 0 )
    {
-      last = sysData->m_sysData->interruptPipe[0];
-      FD_SET( last, &set );
-      if( last < d.m_iSystemData )
-         last = d.m_iSystemData;
+      fds = 2;
+      poller[1].fd = sysData->m_sysData->interruptPipe[0];
+      poller[1].events = POLLIN;
    }
    else
-      last = d.m_iSystemData;
+      fds = 1;
 
-   if ( msec >= 0 ) {
-      tvp = &tv;
-      tv.tv_sec = msec / 1000;
-      tv.tv_usec = (msec % 1000 ) * 1000;
-   }
-   else
-      tvp = 0;
+   int res;
+   while( ( res = poll( poller, fds, msec ) ) == -1 && errno == EINTR );
 
-   switch( select( last + 1, &set, 0, 0, tvp ) )
+   if ( res > 0 )
    {
-      case 1:
-      case 2:
-         if ( sysData != 0 && FD_ISSET( sysData->m_sysData->interruptPipe[0], &set ) )
-         {
-            return -2;
-         }
+      if( sysData != 0 && (poller[1].revents & POLLIN) != 0 )
+      {
+         return -2;
+      }
 
-      return 1;
+      if( (poller[0].revents & POLLNVAL ) != 0 )
+      {
+         m_lastError = EBADF;
+         return -1;
+      }
 
-      case -1:
-         if( errno == EINPROGRESS ) {
-            m_lastError = 0;
-            return 0;
-         }
-         m_lastError = errno;
+      if( (poller[0].revents & ( POLLIN | POLLHUP | POLLERR ) ) != 0 )
+         return 1;
+   }
+   else if ( res < 0 )
+   {
+      m_lastError = errno;
       return -1;
    }
 
@@ -413,7 +397,7 @@ int Socket::writeAvailable( int32 msec, const Sys::SystemData *sysData )
       fds = 1;
 
    int res;
-   while( ( res = poll( poller, fds, msec ) ) == EAGAIN );
+   while( ( res = poll( poller, fds, msec ) ) == -1 && errno == EINTR );
 
    if ( res > 0 )
    {
@@ -425,7 +409,8 @@ int Socket::writeAvailable( int32 msec, const Sys::SystemData *sysData )
       if( (poller[0].revents & ( POLLOUT | POLLHUP ) ) != 0 )
          return 1;
    }
-   else {
+   else if ( res < 0 )
+   {
       m_lastError = errno;
       return -1;
    }
@@ -978,18 +963,26 @@ ServerSocket::~ServerSocket()
 {
 }
 
-TCPSocket *ServerSocket::accept()
+bool ServerSocket::listen()
 {
-   int srv = (int) d.m_iSystemData;
-
    if ( ! m_bListening ) {
-      if ( ::listen( srv, SOMAXCONN ) != 0 ) {
+      if ( ::listen( (int) d.m_iSystemData, SOMAXCONN ) != 0 ) {
          m_lastError = errno;
-         return 0;
+         return false;
       }
       m_bListening = true;
    }
 
+   return true;
+}
+
+TCPSocket *ServerSocket::accept()
+{
+   int srv = (int) d.m_iSystemData;
+
+   if ( ! listen() )
+      return 0;
+
    if ( s_select( srv, m_timeout, 0 ) ) {
       socklen_t addrlen;
       struct sockaddr *address;
@@ -1006,7 +999,7 @@ TCPSocket *ServerSocket::accept()
       }
 
       int skt = ::accept( srv, address, &addrlen );
-      TCPSocket *s = new TCPSocket( (void *) &skt );
+      TCPSocket *s = new TCPSocket( (void *) (long) skt );
 
       char hostName[64];
       char servName[64];
@@ -1143,6 +1136,273 @@ int32 UDPSocket::sendTo( byte *buffer, int32 size, Address &where )
    return retsize;
 }
 
+//================================================
+// Poller
+//================================================
+
+#ifdef __linux__
+
+Poller::Poller():
+   m_lastError(0)
+{
+   int epfd = epoll_create( 256 );
+   if ( epfd == -1 )
+      m_lastError = errno;
+   m_systemData = (void*)(long) epfd;
+}
+
+Poller::~Poller()
+{
+   int epfd = (int)(long) m_systemData;
+   if ( epfd != -1 )
+      ::close( epfd );
+}
+
+static bool s_epoll_ctl( int epfd, int op, int32 fd, int32 events, bool edge, int64& lastError )
+{
+   struct epoll_event evt;
+   evt.events = 0;
+   if ( (events & Poller::e_read) != 0 ) evt.events |= EPOLLIN;
+   if ( (events & Poller::e_write) != 0 ) evt.events |= EPOLLOUT;
+   if ( edge ) evt.events |= EPOLLET;
+   evt.data.fd = fd;
+
+   if ( epoll_ctl( epfd, op, fd, &evt ) != 0 )
+   {
+      lastError = errno;
+      return false;
+   }
+
+   lastError = 0;
+   return true;
+}
+
+bool Poller::add( int32 fd, int32 events, bool edge )
+{
+   return s_epoll_ctl( (int)(long) m_systemData, EPOLL_CTL_ADD, fd, events, edge, m_lastError );
+}
+
+bool Poller::modify( int32 fd, int32 events, bool edge )
+{
+   return s_epoll_ctl( (int)(long) m_systemData, EPOLL_CTL_MOD, fd, events, edge, m_lastError );
+}
+
+bool Poller::remove( int32 fd )
+{
+   return s_epoll_ctl( (int)(long) m_systemData, EPOLL_CTL_DEL, fd, 0, false, m_lastError );
+}
+
+int32 Poller::wait( int32 msec, int32 *fds, int32 *events, int32 size )
+{
+   struct epoll_event evts[64];
+   if ( size > 64 )
+      size = 64;
+
+   int res;
+   while( ( res = epoll_wait( (int)(long) m_systemData, evts, size, msec ) ) == -1 && errno == EINTR );
+   if ( res < 0 )
+   {
+      m_lastError = errno;
+      return -1;
+   }
+
+   for ( int i = 0; i < res; ++i )
+   {
+      int32 ev = 0;
+      if ( (evts[i].events & EPOLLIN) != 0 ) ev |= e_read;
+      if ( (evts[i].events & EPOLLOUT) != 0 ) ev |= e_write;
+      if ( (evts[i].events & EPOLLHUP) != 0 ) ev |= e_hangup;
+      if ( (evts[i].events & EPOLLERR) != 0 ) ev |= e_error;
+      fds[i] = evts[i].data.fd;
+      events[i] = ev;
+   }
+
+   m_lastError = 0;
+   return res;
+}
+
+int32 Poller::descriptor() const
+{
+   return (int32)(long) m_systemData;
+}
+
+#else
+
+// poll() fallback: a growable array of pollfd structures.
+struct PollerData
+{
+   struct pollfd *fds;
+   int32 size;
+   int32 allocated;
+   // round robin start, so that busy descriptors don't starve the others.
+   int32 next;
+};
+
+Poller::Poller():
+   m_lastError(0)
+{
+   PollerData *pd = (PollerData*) memAlloc( sizeof( PollerData ) );
+   pd->fds = 0;
+   pd->size = pd->allocated = pd->next = 0;
+   m_systemData = pd;
+}
+
+Poller::~Poller()
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   if ( pd->fds != 0 )
+      memFree( pd->fds );
+   memFree( pd );
+}
+
+static int32 s_poll_find( PollerData *pd, int32 fd )
+{
+   for ( int32 i = 0; i < pd->size; ++i )
+   {
+      if ( pd->fds[i].fd == fd )
+         return i;
+   }
+   return -1;
+}
+
+static short s_poll_events( int32 events )
+{
+   short ev = 0;
+   if ( (events & Poller::e_read) != 0 ) ev |= POLLIN;
+   if ( (events & Poller::e_write) != 0 ) ev |= POLLOUT;
+   return ev;
+}
+
+bool Poller::add( int32 fd, int32 events, bool )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   if ( s_poll_find( pd, fd ) != -1 )
+   {
+      m_lastError = EEXIST;
+      return false;
+   }
+
+   if ( pd->size == pd->allocated )
+   {
+      pd->allocated = pd->allocated == 0 ? 16 : pd->allocated * 2;
+      pd->fds = (struct pollfd*) memRealloc( pd->fds, pd->allocated * sizeof( struct pollfd ) );
+   }
+
+   pd->fds[pd->size].fd = fd;
+   pd->fds[pd->size].events = s_poll_events( events );
+   pd->fds[pd->size].revents = 0;
+   pd->size++;
+   m_lastError = 0;
+   return true;
+}
+
+bool Poller::modify( int32 fd, int32 events, bool )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   int32 pos = s_poll_find( pd, fd );
+   if ( pos == -1 )
+   {
+      m_lastError = ENOENT;
+      return false;
+   }
+
+   pd->fds[pos].events = s_poll_events( events );
+   m_lastError = 0;
+   return true;
+}
+
+bool Poller::remove( int32 fd )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   int32 pos = s_poll_find( pd, fd );
+   if ( pos == -1 )
+   {
+      m_lastError = ENOENT;
+      return false;
+   }
+
+   pd->fds[pos] = pd->fds[--pd->size];
+   m_lastError = 0;
+   return true;
+}
+
+int32 Poller::wait( int32 msec, int32 *fds, int32 *events, int32 size )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+
+   int res;
+   while( ( res = poll( pd->fds, pd->size, msec ) ) == -1 && errno == EINTR );
+   if ( res < 0 )
+   {
+      m_lastError = errno;
+      return -1;
+   }
+
+   int32 count = 0;
+   for ( int32 i = 0; i < pd->size && count < size && res > 0; ++i )
+   {
+      struct pollfd &pfd = pd->fds[ (pd->next + i) % pd->size ];
+      if ( pfd.revents == 0 )
+         continue;
+
+      int32 ev = 0;
+      if ( (pfd.revents & POLLIN) != 0 ) ev |= e_read;
+      if ( (pfd.revents & POLLOUT) != 0 ) ev |= e_write;
+      if ( (pfd.revents & POLLHUP) != 0 ) ev |= e_hangup;
+      if ( (pfd.revents & (POLLERR|POLLNVAL)) != 0 ) ev |= e_error;
+      fds[count] = pfd.fd;
+      events[count] = ev;
+      ++count;
+      --res;
+   }
+
+   if ( pd->size > 0 )
+      pd->next = (pd->next + 1) % pd->size;
+
+   m_lastError = 0;
+   return count;
+}
+
+int32 Poller::descriptor() const
+{
+   return -1;
+}
+
+#endif
+
+bool streamDescriptor( Stream *stream, int32 &fd )
+{
+   while( stream != 0 )
+   {
+      BaseFileStream *fs = dynamic_cast<BaseFileStream*>( stream );
+      if ( fs != 0 )
+      {
+         const UnixFileSysData *data =
+               static_cast<const UnixFileSysData*>( fs->getFileSysData() );
+         fd = data->m_handle;
+         return true;
+      }
+
+      StreamBuffer *sb = dynamic_cast<StreamBuffer*>( stream );
+      if ( sb != 0 )
+      {
+         stream = sb->underlying();
+         continue;
+      }
+
+      Transcoder *tc = dynamic_cast<Transcoder*>( stream );
+      if ( tc != 0 )
+      {
+         stream = tc->underlying();
+         continue;
+      }
+
+      break;
+   }
+
+   return false;
+}
+
 } // namespace
 }
 
@@ -23,6 +23,7 @@
 #include <ws2tcpip.h>
 
 #include <falcon/mt.h>
+#include <falcon/memory.h>
 
 #ifdef __MINGW32__
    #define _inline __inline
@@ -677,18 +678,26 @@ ServerSocket::~ServerSocket()
 {
 }
 
-TCPSocket *ServerSocket::accept()
+bool ServerSocket::listen()
 {
-   SOCKET srv = (SOCKET) d.m_iSystemData;
-
    if ( ! m_bListening ) {
-      if ( ::listen( srv, SOMAXCONN ) != 0 ) {
+      if ( ::listen( (SOCKET) d.m_iSystemData, SOMAXCONN ) != 0 ) {
          m_lastError = WSAGetLastError();
-         return 0;
+         return false;
       }
       m_bListening = true;
    }
 
+   return true;
+}
+
+TCPSocket *ServerSocket::accept()
+{
+   SOCKET srv = (SOCKET) d.m_iSystemData;
+
+   if ( ! listen() )
+      return 0;
+
    if ( s_select( srv, m_timeout, 0 ) ) {
       int addrlen;
       struct sockaddr *address;
@@ -843,6 +852,168 @@ int32 UDPSocket::sendTo( byte *buffer, int32 size, Address &where )
    return retsize;
 }
 
+//================================================
+// Poller
+//================================================
+
+// select() based; winsock fd_set is an array, so the limit is on the
+// count of descriptors (FD_SETSIZE) and not on their value.
+struct PollerData
+{
+   SOCKET *fds;
+   int32 *events;
+   int32 size;
+   int32 allocated;
+};
+
+Poller::Poller():
+   m_lastError(0)
+{
+   PollerData *pd = (PollerData*) memAlloc( sizeof( PollerData ) );
+   pd->fds = 0;
+   pd->events = 0;
+   pd->size = pd->allocated = 0;
+   m_systemData = pd;
+}
+
+Poller::~Poller()
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   if ( pd->fds != 0 )
+   {
+      memFree( pd->fds );
+      memFree( pd->events );
+   }
+   memFree( pd );
+}
+
+static int32 s_poll_find( PollerData *pd, int32 fd )
+{
+   for ( int32 i = 0; i < pd->size; ++i )
+   {
+      if ( pd->fds[i] == (SOCKET) fd )
+         return i;
+   }
+   return -1;
+}
+
+bool Poller::add( int32 fd, int32 events, bool )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   if ( s_poll_find( pd, fd ) != -1 || pd->size == FD_SETSIZE )
+   {
+      m_lastError = WSAEINVAL;
+      return false;
+   }
+
+   if ( pd->size == pd->allocated )
+   {
+      pd->allocated = pd->allocated == 0 ? 16 : pd->allocated * 2;
+      pd->fds = (SOCKET*) memRealloc( pd->fds, pd->allocated * sizeof( SOCKET ) );
+      pd->events = (int32*) memRealloc( pd->events, pd->allocated * sizeof( int32 ) );
+   }
+
+   pd->fds[pd->size] = (SOCKET) fd;
+   pd->events[pd->size] = events;
+   pd->size++;
+   m_lastError = 0;
+   return true;
+}
+
+bool Poller::modify( int32 fd, int32 events, bool )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   int32 pos = s_poll_find( pd, fd );
+   if ( pos == -1 )
+   {
+      m_lastError = WSAENOTSOCK;
+      return false;
+   }
+
+   pd->events[pos] = events;
+   m_lastError = 0;
+   return true;
+}
+
+bool Poller::remove( int32 fd )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   int32 pos = s_poll_find( pd, fd );
+   if ( pos == -1 )
+   {
+      m_lastError = WSAENOTSOCK;
+      return false;
+   }
+
+   pd->size--;
+   pd->fds[pos] = pd->fds[pd->size];
+   pd->events[pos] = pd->events[pd->size];
+   m_lastError = 0;
+   return true;
+}
+
+int32 Poller::wait( int32 msec, int32 *fds, int32 *events, int32 size )
+{
+   PollerData *pd = (PollerData*) m_systemData;
+   fd_set rset, wset, eset;
+   FD_ZERO( &rset );
+   FD_ZERO( &wset );
+   FD_ZERO( &eset );
+
+   for ( int32 i = 0; i < pd->size; ++i )
+   {
+      if ( (pd->events[i] & e_read) != 0 ) FD_SET( pd->fds[i], &rset );
+      if ( (pd->events[i] & e_write) != 0 ) FD_SET( pd->fds[i], &wset );
+      FD_SET( pd->fds[i], &eset );
+   }
+
+   struct timeval tv, *tvp;
+   if ( msec >= 0 )
+   {
+      tv.tv_sec = msec / 1000;
+      tv.tv_usec = (msec % 1000) * 1000;
+      tvp = &tv;
+   }
+   else
+      tvp = 0;
+
+   int res = select( 0, &rset, &wset, &eset, tvp );
+   if ( res == SOCKET_ERROR )
+   {
+      m_lastError = WSAGetLastError();
+      return -1;
+   }
+
+   int32 count = 0;
+   for ( int32 i = 0; i < pd->size && count < size && res > 0; ++i )
+   {
+      int32 ev = 0;
+      if ( FD_ISSET( pd->fds[i], &rset ) ) ev |= e_read;
+      if ( FD_ISSET( pd->fds[i], &wset ) ) ev |= e_write;
+      if ( FD_ISSET( pd->fds[i], &eset ) ) ev |= e_error;
+      if ( ev != 0 )
+      {
+         fds[count] = (int32) pd->fds[i];
+         events[count] = ev;
+         ++count;
+      }
+   }
+
+   m_lastError = 0;
+   return count;
+}
+
+int32 Poller::descriptor() const
+{
+   return -1;
+}
+
+bool streamDescriptor( Stream *, int32 & )
+{
+   // winsock can't select on file handles.
+   return false;
+}
+
 } // namespace
 }
 